@@ -6,32 +6,48 @@
 #include "Engine/Core/Debug/Log.hpp"
 #include "Engine/Core/Debug/Profiler.hpp"
 #include "Engine/Core/Time/Clock.hpp"
-
-#include "Engine/Renderer/RenderContext.hpp"
-#include "Engine/Renderer/Debug/DebugRenderSystem.hpp"
-
 #include "Engine/Math/RNG.hpp"
-
-#include "Engine/ImGUI/ImGUISystem.hpp"
-#include "Engine/Input/InputSystem.hpp"
-#include "Engine/Audio/AudioSystem.hpp"
 #include "Engine/Physics/PhysicsSystem.hpp"
 
 #include "Game/GameCommon.hpp"
+#include "Game/DiscBatcher.hpp"
+#include "Game/Benchmarks.hpp"
+#include "Game/BuildEvaluator.hpp"
+#include "Game/Checks.hpp"
+#include "Game/FrameScheduler.hpp"
+#include "Game/GameProfiler.hpp"
+#include "Game/DialogueBankBuilder.hpp"
+#include "Game/EngineBackends.hpp"
+#include "Game/GridLevelFile.hpp"
+#include "Game/GridHistory.hpp"
+#include "Game/GridShapeMatcher.hpp"
+#include "Game/InputJournal.hpp"
+#include "Game/InputQueue.hpp"
+#include "Game/InputSampler.hpp"
+#include "Game/GameRandom.hpp"
+#include "Game/JobSystem.hpp"
+#include "Game/RenderThread.hpp"
+
+#include <chrono>
+#include <stdlib.h>
 
 //--------------------------------------------------------------------------
 // Global Singletons
 //--------------------------------------------------------------------------
-RenderContext* g_theRenderer = nullptr;		// Created and owned by the App
+RenderContext* g_theRenderer = nullptr;		// Created and owned by the windowed engine back ends
 InputSystem* g_theInputSystem = nullptr;
 AudioSystem* g_theAudioSystem = nullptr;
 App* g_theApp = nullptr;					// Created and owned by Main_Windows.cpp
 bool g_isInDebug = false;
 RNG* g_theRNG = nullptr;
+GameRandom* g_theGameRandom = nullptr;
 PhysicsSystem* g_thePhysicsSystem = nullptr;
 Game* g_theGame = nullptr;
 WindowContext* g_theWindowContext = nullptr;
 ImGUISystem* g_theImGUISystem = nullptr;
+DiscBatcher* g_theDiscBatcher = nullptr;
+JobSystem* g_theJobSystem = nullptr;
+EngineBackends* g_theEngineBackends = nullptr;
 
 //--------------------------------------------------------------------------
 /**
@@ -39,30 +55,44 @@ ImGUISystem* g_theImGUISystem = nullptr;
 */
 void App::Startup()
 {
-	g_theRNG = new RNG();
+	int configSeed = g_gameConfigBlackboard.GetValue( "sessionSeed", 0 );
+	SeedRandom( configSeed != 0 ? (uint64_t) configSeed : (uint64_t) std::chrono::steady_clock::now().time_since_epoch().count() );
 	g_theEventSystem = new EventSystem();
 	g_theConsole = new DevConsole( "SquirrelFixedFont" );
-	g_theRenderer = new RenderContext( g_theWindowContext );
-	g_theDebugRenderSystem = new DebugRenderSystem(g_theRenderer, 50.0f, 100.0f, "SquirrelFixedFont");
-	g_theInputSystem = new InputSystem();
-	g_theAudioSystem = new AudioSystem();
+	g_theJobSystem = new JobSystem( g_gameConfigBlackboard.GetValue( "jobWorkerCount", -1 ) );
+	g_theEngineBackends = CreateEngineBackends();
 	g_thePhysicsSystem = new PhysicsSystem();
-	g_theImGUISystem = new ImGUISystem( g_theRenderer );
+	g_theDiscBatcher = new DiscBatcher();
 
 	g_theGame = new Game();
 
 	LogSystemStartup( "Data/Log/Log.txt" );
 	ProfilerSystemInit();
+	GameProfilerSetThreadName( "Main" );
 
 	ClockSystemStartup();
 	m_gameClock = new Clock(&Clock::Master);
 
+	m_frameScheduler = new FrameScheduler();
+	m_frameScheduler->Configure( g_gameConfigBlackboard.GetValue( "simulationHz", DEFAULT_SIMULATION_HZ ), g_gameConfigBlackboard.GetValue( "targetFrameHz", DEFAULT_TARGET_FRAME_HZ ) );
+	m_frameScheduler->SetBudget( g_gameConfigBlackboard.GetValue( "maxSubstepsPerFrame", DEFAULT_MAX_SUBSTEPS_PER_FRAME ), g_gameConfigBlackboard.GetValue( "simulationBudgetMs", DEFAULT_SIMULATION_BUDGET_MS ) );
+
+	m_renderThread = new RenderThread();
+	m_renderThread->Start( g_theEngineBackends->HasDisplay() && g_gameConfigBlackboard.GetValue( "renderThread", true ) );
+
+	m_inputJournal = new InputJournal();
+	std::string recordPath = g_gameConfigBlackboard.GetValue( "recordInput", "" );
+	if( !recordPath.empty() && !m_inputJournal->BeginRecording( recordPath, m_sessionSeed, m_frameScheduler->GetTickSeconds() ) )
+	{
+		ERROR_RECOVERABLE( "Could not record input to " + recordPath );
+	}
+	m_inputQueue = new InputQueue();
+	m_inputSampler = new InputSampler();
+
 	g_theEventSystem->Startup();
-	g_theRenderer->Startup();
-	g_theDebugRenderSystem->Startup();
+	g_theEngineBackends->Startup();
 	g_theConsole->Startup();
 	g_thePhysicsSystem->Startup();
-	g_theImGUISystem->Startup();
 
 	g_theGame->Startup();
 
@@ -75,28 +105,39 @@ void App::Startup()
 */
 void App::Shutdown()
 {
+	m_inputSampler->Stop();
+	SAFE_DELETE( m_inputSampler );
+	SAFE_DELETE( m_inputQueue );
+
+	if( m_inputJournal->IsRecording() )
+	{
+		m_inputJournal->EndRecording( m_simulationTick, g_theGame->ComputeStateHash() );
+	}
+	SAFE_DELETE( m_inputJournal );
+
+	m_renderThread->Stop();
+	SAFE_DELETE( m_renderThread );
+
 	g_theGame->Shutdown();
 
-	g_theImGUISystem->Shutdown();
 	g_thePhysicsSystem->Shutdown();
 	g_theConsole->Shutdown();
-	g_theDebugRenderSystem->Shutdown();
-	g_theRenderer->Shutdown();
+	g_theEngineBackends->Shutdown();
 	g_theEventSystem->Shutdown();
 
 	ProfilerSystemDeinit();
 	LogSystemShutdown();
 
 	SAFE_DELETE( g_theGame );
+	SAFE_DELETE( g_theJobSystem );
 
 	SAFE_DELETE(m_gameClock);
-	SAFE_DELETE( g_theImGUISystem );
-	SAFE_DELETE( g_theAudioSystem );
-	SAFE_DELETE( g_theInputSystem );
+	SAFE_DELETE( m_frameScheduler );
+	SAFE_DELETE( g_theDiscBatcher );
 	SAFE_DELETE( g_theConsole );
-	SAFE_DELETE( g_theDebugRenderSystem );
-	SAFE_DELETE( g_theRenderer );
+	SAFE_DELETE( g_theEngineBackends );
 	SAFE_DELETE( g_theRNG );
+	SAFE_DELETE( g_theGameRandom );
 }
 
 //--------------------------------------------------------------------------
@@ -119,10 +160,35 @@ void App::RunFrame()
 	}
 
 
+	GameProfilerBeginFrame();
 	BeginFrame();
-	Update((float)m_gameClock->GetFrameTime());
+
+	// The frame shows the state the last frame's ticks left. It's recorded
+	// and handed to the render thread first so this frame's ticks run while
+	// it's drawn, EndFrame waits for it before the renderer presents.
+	float frameSeconds = (float) m_gameClock->GetFrameTime();
+	Update( frameSeconds );
 	Render();
+
+	int maxSubsteps = m_frameScheduler->BeginFrame( frameSeconds );
+	int substepsRun = 0;
+	while( substepsRun < maxSubsteps && ( substepsRun == 0 || !m_frameScheduler->IsOverTimeBudget() ) )
+	{
+		PumpInput();
+		UpdateSimulation( m_frameScheduler->GetTickSeconds() );
+		++substepsRun;
+	}
+	m_frameScheduler->EndFrame( substepsRun );
+
+	// Paused or slowed down, no tick ran. Input still lands before the next
+	// one, and keys that unpause or speed up still get through.
+	if( substepsRun == 0 )
+	{
+		DrainInputQueue();
+	}
+
 	EndFrame();
+	GameProfilerEndFrame();
 }
 
 //--------------------------------------------------------------------------
@@ -131,6 +197,7 @@ void App::RunFrame()
 */
 bool App::HandleKeyPressed( unsigned char keyCode )
 {
+	RecordInput( INPUT_EVENT_KEY_DOWN, keyCode );
 	if( g_theConsole->HandleKeyPress( keyCode ) )
 	{
 		return true;
@@ -149,8 +216,7 @@ bool App::HandleKeyPressed( unsigned char keyCode )
 		return true;
 		break;
 	case 'w': // F8 press
-		delete g_theGame;
-		g_theGame = new Game();
+		RestartGame();
 		return true;
 		break;
 	case 'p': // F1 press
@@ -170,6 +236,7 @@ bool App::HandleKeyPressed( unsigned char keyCode )
 */
 bool App::HandleCharPressed( unsigned char keyCode )
 {
+	RecordInput( INPUT_EVENT_CHAR, keyCode );
 	if( g_theConsole->HandleCharPress( keyCode ) )
 	{
 		return true;
@@ -180,12 +247,16 @@ bool App::HandleCharPressed( unsigned char keyCode )
 //--------------------------------------------------------------------------
 /**
 * HandleKeyReleased
+* Returns IsKeyReleaseConsumed as it was before the key was acted on.
 */
 bool App::HandleKeyReleased( unsigned char keyCode )
 {
-	if( g_theConsole->HandleKeyReleased( keyCode ) )
+	RecordInput( INPUT_EVENT_KEY_UP, keyCode );
+	bool isConsumed = IsKeyReleaseConsumed( keyCode );
+	if( g_theConsole->IsOpen() )
 	{
-		return true;
+		g_theConsole->HandleKeyReleased( keyCode );
+		return isConsumed;
 	}
 	switch( keyCode )
 	{
@@ -199,10 +270,22 @@ bool App::HandleKeyReleased( unsigned char keyCode )
 		g_theEventSystem->FireEvent( "help" );
 		break;
 	default:
-		return g_theGame->HandleKeyReleased( keyCode );
+		g_theGame->HandleKeyReleased( keyCode );
 		break;
 	}
-	return true;
+	return isConsumed;
+}
+
+//--------------------------------------------------------------------------
+/**
+* HandleUIEvent
+* UI that changes the simulation comes through here so it's journaled like
+* a key.
+*/
+bool App::HandleUIEvent( eGameUIEvent uiEvent )
+{
+	RecordInput( INPUT_EVENT_UI, (uint8_t) uiEvent );
+	return g_theGame->HandleUIEvent( uiEvent );
 }
 
 //--------------------------------------------------------------------------
@@ -215,6 +298,62 @@ bool App::HandleQuitRequested()
 	return true;
 }
 
+//--------------------------------------------------------------------------
+/**
+* QueueInput
+* Called by whatever samples input, the event is applied at the start of
+* the next tick. Returns false if the queue was full and it was dropped.
+*/
+bool App::QueueInput( eInputEventType type, uint8_t code )
+{
+	return m_inputQueue->Push( type, code, GameProfilerNowNs() );
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsKeyReleaseConsumed
+* Whether a key release stops here: the open console takes every key, App
+* takes its own and the game passes the rest on. HandleKeyReleased returns
+* this, and the window proc answers Windows with it before the queued key
+* gets there.
+*/
+bool App::IsKeyReleaseConsumed( unsigned char keyCode ) const
+{
+	if( g_theConsole->IsOpen() )
+	{
+		return true;
+	}
+	switch( keyCode )
+	{
+	case 'T':
+	case 'Y':
+	case 'H':
+		return true;
+	default:
+		return false;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsCharConsumed
+* Same for HandleCharPressed, only the console takes characters.
+*/
+bool App::IsCharConsumed( unsigned char keyCode ) const
+{
+	UNUSED( keyCode );
+	return g_theConsole->IsOpen();
+}
+
+//--------------------------------------------------------------------------
+/**
+* StartInputSampler
+*/
+void App::StartInputSampler( float tapsPerSecond )
+{
+	m_inputSampler->Start( m_inputQueue, tapsPerSecond );
+}
+
 //--------------------------------------------------------------------------
 /**
 * QuitEvent
@@ -260,103 +399,78 @@ void App::Pause()
 */
 void App::BeginFrame()
 {
-	ClockSystemBeginFrame();
-	g_theImGUISystem->		BeginFrame();
-	g_theEventSystem->		BeginFrame();
-	g_theRenderer->			BeginFrame();
-	g_theConsole->			BeginFrame();
-	g_theInputSystem->		BeginFrame();
-	g_theAudioSystem->		BeginFrame();
-	g_theDebugRenderSystem->BeginFrame();
+	GAME_PROFILE_SCOPE( "App::BeginFrame" );
+	{ GAME_PROFILE_SCOPE( "Clock" );			ClockSystemBeginFrame(); }
+	{ GAME_PROFILE_SCOPE( "EventSystem" );		g_theEventSystem->		BeginFrame(); }
+	{ GAME_PROFILE_SCOPE( "DevConsole" );		g_theConsole->			BeginFrame(); }
+	g_theEngineBackends->BeginFrame();
 }
 
 
+//--------------------------------------------------------------------------
+/**
+* UpdateSimulation
+* One fixed step, called zero or more times a frame by the FrameScheduler.
+*/
+void App::UpdateSimulation( float tickSeconds )
+{
+	DrainInputQueue();
+	DispatchReplayInput();
+	g_theGame->UpdateGame( tickSeconds );
+	++m_simulationTick;
+}
+
 //--------------------------------------------------------------------------
 /**
 * Update
+* Once a frame, before the simulation ticks.
 */
 void App::Update( float deltaSeconds )
 {
-	g_theConsole->			Update();
-	g_theGame->				UpdateGame( deltaSeconds );
-	g_theDebugRenderSystem->Update();
+	GAME_PROFILE_SCOPE( "App::Update" );
+	{ GAME_PROFILE_SCOPE( "DevConsole" );		g_theConsole->			Update(); }
+	{ GAME_PROFILE_SCOPE( "Game::UpdateFrame" );	g_theGame->				UpdateFrame( deltaSeconds ); }
+	g_theEngineBackends->Update();
 }
 
 //--------------------------------------------------------------------------
 /**
-* RenderDebugRenderDebugLeftJoystick
+* Render
+* Records the frame and submits it to the render thread. With nothing to
+* show it on, headless, there's no frame to record.
 */
-void App::RenderDebugLeftJoystick() const
+void App::Render()
 {
-	float inRangex = 2.0f;
-	float inRangey = 2.0f;
-	float outerRadius = 8.0f;
-	float posRadius = 0.5f;
-	const XboxController& curController = g_theInputSystem->GetControllerByID(0);
-	if( !curController.IsConnected() )
+	if( !g_theEngineBackends->HasDisplay() )
+	{
 		return;
-	const AnalogJoystick& curLJoystick = curController.GetLeftJoystick();
-	const Vec2& upRightRef = g_theGame->m_DevColsoleCamera.GetOrthoTopRight();
-
-	Vec3 center
-	(	
-		upRightRef.x - inRangex - outerRadius
-		,	upRightRef.y - inRangey - outerRadius
-		,	0.0f
-	);
-
-	Vertex_PCU centerVert( center, Rgba( 0.4f, 0.4f, 0.4f, 0.5f ), Vec2( 0.0f, 0.0f ) );
-	DrawDisc( centerVert , outerRadius );
-
-
+	}
 
-	centerVert.color.r = 0.1f;
-	centerVert.color.g = 0.1f;
-	centerVert.color.b = 0.1f;
-	DrawDisc( centerVert , outerRadius * curLJoystick.GetOuterDeadZoneFraction() );
-	centerVert.color.r = 0.3f;
-	centerVert.color.g = 0.3f;
-	centerVert.color.b = 0.3f;
-	DrawDisc( centerVert , outerRadius * curLJoystick.GetInnerDeadZoneFraction() );
+	GAME_PROFILE_SCOPE( "App::Render" );
+	m_renderCommands = &m_renderThread->BeginFrame();
+	m_renderCommands->ClearScreen( Rgba::BLACK );
 
-	Vec3 rawCenter
-	(
-		center.x + curLJoystick.GetRawPosition().x * outerRadius
-		,	center.y + curLJoystick.GetRawPosition().y * outerRadius
-		,	0.0f	
-	);
-	Vertex_PCU rawInput( rawCenter, Rgba( 1.0f, 0.0f, 0.0f, 1.0f ), Vec2( 0.0f, 0.0f ) );
-	DrawDisc( rawInput , posRadius );
+	{
+		GAME_PROFILE_SCOPE( "Game::GameRender" );
+		g_theGame->GameRender( *m_renderCommands, m_frameScheduler->GetInterpolationAlpha() );
+	}
+	m_renderCommands->FlushDiscs();
+	m_renderCommands->AddCallback( RenderOverlays, this );
 
-	Vec3 fixedCenter
-	(
-		center.x + curLJoystick.GetPosition().x * outerRadius
-		,	center.y + curLJoystick.GetPosition().y * outerRadius
-		,	0.0f	
-	);
-	Vertex_PCU fixedInput( fixedCenter, Rgba( 0.0f, 0.7f, 0.7f, 1.0f ), Vec2( 0.0f, 0.0f ) );
-	DrawDisc( fixedInput , posRadius );
+	m_renderFence = m_renderThread->Submit();
+	m_renderCommands = nullptr;
 }
 
 //--------------------------------------------------------------------------
 /**
-* Render
+* RenderOverlays
+* ImGUI, then the console or the debug screen overlay. Runs on the render
+* thread, which is safe because the main thread leaves these systems alone
+* until the frame's fence.
 */
-void App::Render() const
+void App::RenderOverlays( void* app )
 {
-	g_theRenderer->ClearScreen( Rgba::BLACK );
-
-	g_theGame->GameRender();
-	g_theImGUISystem->Render();
-
-	if( g_theConsole->IsOpen() )
-	{
-		g_theConsole->Render( g_theRenderer, g_theGame->m_DevColsoleCamera, m_consoleTextHeight );
-	}
-	else
-	{
-		g_theDebugRenderSystem->RenderToScreen();
-	}
+	g_theEngineBackends->RenderOverlays( g_theGame->m_DevColsoleCamera, ( (App*) app )->m_consoleTextHeight );
 }
 
 //--------------------------------------------------------------------------
@@ -365,12 +479,13 @@ void App::Render() const
 */
 void App::EndFrame()
 {
-	g_theConsole->		EndFrame();
-	g_theAudioSystem->	EndFrame();
-	g_theInputSystem->	EndFrame();
-	g_theRenderer->		EndFrame();
-	g_theEventSystem->	EndFrame();
-	g_theImGUISystem->	EndFrame();
+	GAME_PROFILE_SCOPE( "App::EndFrame" );
+	m_renderThread->WaitForFence( m_renderFence );
+	{ GAME_PROFILE_SCOPE( "DevConsole" );	g_theConsole->		EndFrame(); }
+	g_theEngineBackends->EndFrame();
+	{ GAME_PROFILE_SCOPE( "EventSystem" );	g_theEventSystem->	EndFrame(); }
+	g_theJobSystem->EndFrame();
+	PublishInputStats();
 }
 
 //--------------------------------------------------------------------------
@@ -396,6 +511,19 @@ void App::ToggleDebug()
 void App::RegisterEvents()
 {
 	g_theEventSystem->SubscribeEventCallbackFunction( "quit", QuitEvent );
+	g_theEventSystem->SubscribeEventCallbackFunction( "bench_collision", Command_BenchmarkCollision );
+	g_theEventSystem->SubscribeEventCallbackFunction( "bench_pieces", Command_BenchmarkPieces );
+	g_theEventSystem->SubscribeEventCallbackFunction( "bench_shapes", Command_BenchmarkShapes );
+	g_theEventSystem->SubscribeEventCallbackFunction( "run_checks", Command_RunChecks );
+	g_theEventSystem->SubscribeEventCallbackFunction( "profile_export", Command_ExportProfile );
+	g_theEventSystem->SubscribeEventCallbackFunction( "dialogue_compile", Command_CompileDialogue );
+	g_theEventSystem->SubscribeEventCallbackFunction( "level_save", Command_SaveLevel );
+	g_theEventSystem->SubscribeEventCallbackFunction( "level_load", Command_LoadLevel );
+	g_theEventSystem->SubscribeEventCallbackFunction( "grid_undo", Command_UndoGrid );
+	g_theEventSystem->SubscribeEventCallbackFunction( "grid_redo", Command_RedoGrid );
+	g_theEventSystem->SubscribeEventCallbackFunction( "shape_add", Command_AddTargetShape );
+	g_theEventSystem->SubscribeEventCallbackFunction( "shape_find", Command_FindTargetShapes );
+	g_theEventSystem->SubscribeEventCallbackFunction( "build_target", Command_SetBuildTarget );
 }
 
 //--------------------------------------------------------------------------
@@ -407,3 +535,227 @@ Clock* App::GetGameClock() const
 	return m_gameClock;
 }
 
+//--------------------------------------------------------------------------
+/**
+* WaitForNextFrame
+*/
+void App::WaitForNextFrame()
+{
+	m_frameScheduler->WaitForNextFrame();
+}
+
+//--------------------------------------------------------------------------
+/**
+* SeedRandom
+* Game code draws from the g_theGameRandom streams. The engine RNG and the
+* C runtime generator are seeded too for anything in the engine using them.
+*/
+void App::SeedRandom( uint64_t seed )
+{
+	m_sessionSeed = seed;
+	SAFE_DELETE( g_theRNG );
+	g_theRNG = new RNG( (unsigned int) seed );
+	srand( (unsigned int) seed );
+
+	if( g_theGameRandom == nullptr )
+	{
+		g_theGameRandom = new GameRandom( seed );
+	}
+	else
+	{
+		g_theGameRandom->Reseed( seed );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* RecordInput
+* Stamped with the tick the input lands before. Live input is drained at
+* the start of a tick, or between frames when none ran, so that is always
+* the next tick to run.
+*/
+void App::RecordInput( eInputEventType type, uint8_t code )
+{
+	if( m_inputJournal != nullptr && m_inputJournal->IsRecording() )
+	{
+		m_inputJournal->Record( m_simulationTick, type, code );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* DispatchReplayInput
+* Feeds the journal's input for this tick through the same handlers live
+* input uses.
+*/
+void App::DispatchReplayInput()
+{
+	if( m_inputJournal == nullptr || !m_inputJournal->IsReplaying() )
+	{
+		return;
+	}
+
+	InputEvent event;
+	while( m_inputJournal->PopEventForTick( m_simulationTick, &event ) )
+	{
+		switch( event.type )
+		{
+		case INPUT_EVENT_KEY_DOWN:	HandleKeyPressed( event.code );						break;
+		case INPUT_EVENT_KEY_UP:	HandleKeyReleased( event.code );					break;
+		case INPUT_EVENT_CHAR:		HandleCharPressed( event.code );					break;
+		case INPUT_EVENT_UI:		HandleUIEvent( (eGameUIEvent) event.code );			break;
+		default:																		break;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* PumpInput
+* Lets the platform layer sample input between ticks, so a long frame
+* doesn't hold keys back until the next one. The pump feeds ImGUI too,
+* which the render thread may still be drawing, so it waits its turn.
+*/
+void App::PumpInput()
+{
+	if( m_inputPump != nullptr && m_renderThread->GetCompletedFrame() >= m_renderFence )
+	{
+		m_inputPump();
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* DrainInputQueue
+* Applies queued input in the order it was sampled. Live input is dropped
+* while replaying, the journal is the only input a replay gets.
+*/
+void App::DrainInputQueue()
+{
+	if( m_inputQueue->IsEmpty() )
+	{
+		return;
+	}
+
+	// The handlers reach into the console and other engine systems the
+	// render thread may still be drawing with.
+	m_renderThread->WaitForFence( m_renderFence );
+
+	bool isReplaying = m_inputJournal->IsReplaying();
+	TimedInputEvent event;
+	while( m_inputQueue->Pop( &event ) )
+	{
+		uint64_t nowNs = GameProfilerNowNs();
+		double latencyMs = nowNs > event.timestampNs ? (double) ( nowNs - event.timestampNs ) * 0.000001 : 0.0;
+		++m_inputFrameEvents;
+		m_inputFrameTotalMs += latencyMs;
+		m_inputFrameMaxMs = latencyMs > m_inputFrameMaxMs ? latencyMs : m_inputFrameMaxMs;
+
+		if( isReplaying )
+		{
+			continue;
+		}
+
+		switch( event.type )
+		{
+		case INPUT_EVENT_KEY_DOWN:
+			HandleKeyPressed( event.code );
+			if( event.code == 27 && !g_theConsole->HandleESCPress() ) // VK_ESCAPE
+			{
+				g_theEventSystem->FireEvent( "quit" );
+			}
+			break;
+		case INPUT_EVENT_KEY_UP:	HandleKeyReleased( event.code );					break;
+		case INPUT_EVENT_CHAR:		HandleCharPressed( event.code );					break;
+		case INPUT_EVENT_UI:		HandleUIEvent( (eGameUIEvent) event.code );			break;
+		default:																		break;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* PublishInputStats
+*/
+void App::PublishInputStats()
+{
+	m_inputStats.eventsLastFrame = m_inputFrameEvents;
+	m_inputStats.averageMsLastFrame = m_inputFrameEvents > 0 ? m_inputFrameTotalMs / (double) m_inputFrameEvents : 0.0;
+	m_inputStats.maxMsLastFrame = m_inputFrameMaxMs;
+	m_inputStats.totalEvents += (uint64_t) m_inputFrameEvents;
+	m_inputStats.totalMs += m_inputFrameTotalMs;
+	m_inputStats.maxMs = m_inputFrameMaxMs > m_inputStats.maxMs ? m_inputFrameMaxMs : m_inputStats.maxMs;
+	m_inputStats.droppedEvents = m_inputQueue->GetDroppedCount();
+
+	m_inputFrameEvents = 0;
+	m_inputFrameTotalMs = 0.0;
+	m_inputFrameMaxMs = 0.0;
+}
+
+//--------------------------------------------------------------------------
+/**
+* BeginReplay
+* Restarts the game from the journal's seed and tick rate, with the
+* entities the recording started with. Replays run one tick per frame, so
+* only the headless runner drives them.
+*/
+bool App::BeginReplay( const std::string& journalPath )
+{
+	if( !m_inputJournal->LoadForReplay( journalPath ) )
+	{
+		return false;
+	}
+
+	SeedRandom( m_inputJournal->GetSeed() );
+	m_frameScheduler->Configure( 1.0f / m_inputJournal->GetTickSeconds(), 0.0f );
+	m_frameScheduler->SetLockstep( true );
+	m_simulationTick = 0;
+	RestartGame();
+	g_theGame->SpawnRandomEntities( m_inputJournal->GetStartEntityCount() );
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsReplayFinished
+*/
+bool App::IsReplayFinished() const
+{
+	return m_inputJournal->IsReplayFinished( m_simulationTick );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetExpectedReplayHash
+*/
+uint64_t App::GetExpectedReplayHash() const
+{
+	return m_inputJournal->GetFinalStateHash();
+}
+
+//--------------------------------------------------------------------------
+/**
+* RestartGame
+* Resets the Game in place, the render thread may still be drawing it.
+*/
+void App::RestartGame()
+{
+	m_renderThread->WaitForIdle();
+	g_theGame->ResetGame();
+}
+
+//--------------------------------------------------------------------------
+/**
+* SpawnStartEntities
+* Random entities for the session to start with. A recording takes the
+* count in its header, and a replay spawns them again before tick 0.
+*/
+void App::SpawnStartEntities( int entityCount )
+{
+	if( m_inputJournal->IsRecording() && m_simulationTick == 0 )
+	{
+		m_inputJournal->SetStartEntityCount( entityCount );
+	}
+	g_theGame->SpawnRandomEntities( entityCount );
+}
+
@@ -1,11 +1,17 @@
 #pragma once
 #include "Engine/Math/Vec2.hpp"
-#include "Engine/Renderer/Camera.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/EventSystem.hpp"
 #include "Game/Game.hpp"
+#include "Game/InputJournal.hpp"
+#include "Game/InputQueue.hpp"
 
 class Clock;
+class FrameScheduler;
+class InputJournal;
+class InputSampler;
+class RenderThread;
+class RenderCommandBuffer;
 
 //--------------------------------------------------------------------------
 class App
@@ -21,7 +27,14 @@ public:
 	bool HandleKeyPressed( unsigned char keyCode );
 	bool HandleCharPressed( unsigned char keyCode );
 	bool HandleKeyReleased( unsigned char keyCode );
+	bool HandleUIEvent( eGameUIEvent uiEvent );
 	bool HandleQuitRequested();
+	bool QueueInput( eInputEventType type, uint8_t code );
+	bool IsKeyReleaseConsumed( unsigned char keyCode ) const;
+	bool IsCharConsumed( unsigned char keyCode ) const;
+	void SetInputPump( void (*inputPump)() ) { m_inputPump = inputPump; }
+	void StartInputSampler( float tapsPerSecond );
+	const InputLatencyStats& GetInputLatencyStats() const { return m_inputStats; }
 
 	static bool QuitEvent( EventArgs& args );
 
@@ -30,18 +43,52 @@ public:
 	void Pause();	
 
 	Clock* GetGameClock() const;
+	FrameScheduler* GetFrameScheduler() const { return m_frameScheduler; }
+	RenderThread* GetRenderThread() const { return m_renderThread; }
+	RenderCommandBuffer* GetRenderCommands() const { return m_renderCommands; }
+	void WaitForNextFrame();
+
+	void RestartGame();
+	void SpawnStartEntities( int entityCount );	// Before the first tick, so the journal has it.
+
+	bool BeginReplay( const std::string& journalPath );
+	bool IsReplayFinished() const;
+	uint64_t GetExpectedReplayHash() const;
+	uint64_t GetSimulationTick() const { return m_simulationTick; }
+	uint64_t GetSessionSeed() const { return m_sessionSeed; }
 
 private:
 	void BeginFrame();
+	void UpdateSimulation( float tickSeconds );
 	void Update( float deltaSeconds );
-	void Render() const;
-	void RenderDebugLeftJoystick() const;
+	void Render();
+	static void RenderOverlays( void* app );
 	void EndFrame();
 	void ToggleDebug();
 	void RegisterEvents();
+	void SeedRandom( uint64_t seed );
+	void RecordInput( eInputEventType type, uint8_t code );
+	void DispatchReplayInput();
+	void PumpInput();
+	void DrainInputQueue();
+	void PublishInputStats();
 	
 private:
 	Clock* m_gameClock = nullptr;
+	FrameScheduler* m_frameScheduler = nullptr;
+	InputJournal* m_inputJournal = nullptr;
+	InputQueue* m_inputQueue = nullptr;
+	InputSampler* m_inputSampler = nullptr;
+	void (*m_inputPump)() = nullptr;	// Samples more input mid frame, set by the platform layer.
+	InputLatencyStats m_inputStats;
+	int m_inputFrameEvents = 0;
+	double m_inputFrameTotalMs = 0.0;
+	double m_inputFrameMaxMs = 0.0;
+	RenderThread* m_renderThread = nullptr;
+	RenderCommandBuffer* m_renderCommands = nullptr;	// Being recorded, between Render's BeginFrame and Submit.
+	uint64_t m_renderFence = 0;
+	uint64_t m_simulationTick = 0;		// Ticks simulated since startup or the replay began.
+	uint64_t m_sessionSeed = 0;
 
 private:
 	bool m_isQuitting = false;
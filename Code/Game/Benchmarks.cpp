@@ -0,0 +1,366 @@
+#include "Game/Benchmarks.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/EngineBackends.hpp"
+#include "Game/Grid.hpp"
+#include "Game/GridPiece.hpp"
+#include "Game/GridShapeMatcher.hpp"
+#include "Game/SpatialHash.hpp"
+
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+//--------------------------------------------------------------------------
+/**
+* BenchmarkPrint
+*/
+void BenchmarkPrint( const std::string& text )
+{
+	PrintReportLine( text );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetElapsedMilliseconds
+*/
+static double GetElapsedMilliseconds( std::chrono::high_resolution_clock::time_point start )
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::high_resolution_clock::now() - start ).count();
+}
+
+//--------------------------------------------------------------------------
+/**
+* BruteForcePairCount
+* The all-pairs loop the spatial hash replaces.
+*/
+static int BruteForcePairCount( const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<float>& radii )
+{
+	int pairCount = 0;
+	int count = (int) xs.size();
+	for( int itemA = 0; itemA < count; ++itemA )
+	{
+		for( int itemB = itemA + 1; itemB < count; ++itemB )
+		{
+			float deltaX = xs[itemB] - xs[itemA];
+			float deltaY = ys[itemB] - ys[itemA];
+			float combinedRadius = radii[itemA] + radii[itemB];
+			if( deltaX * deltaX + deltaY * deltaY < combinedRadius * combinedRadius )
+			{
+				++pairCount;
+			}
+		}
+	}
+	return pairCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* RunCollisionBenchmark
+* Random circles over the world, overlap pairs by brute force vs the
+* spatial hash (build + pair search) at 1k, 10k and 100k items.
+*/
+void RunCollisionBenchmark()
+{
+	const int ITEM_COUNTS[] = { 1000, 10000, 100000 };
+	const float RADIUS = 0.25f;
+
+	uint32_t randomState = 0x9E3779B9;
+	auto nextRandom = [&randomState]()
+	{
+		randomState ^= randomState << 13;
+		randomState ^= randomState >> 17;
+		randomState ^= randomState << 5;
+		return (float) ( randomState >> 8 ) * ( 1.0f / 16777216.0f );
+	};
+
+	BenchmarkPrint( "items      brute ms      hash ms   pairs" );
+	for( int itemCount : ITEM_COUNTS )
+	{
+		std::vector<float> xs( itemCount );
+		std::vector<float> ys( itemCount );
+		std::vector<float> radii( itemCount, RADIUS );
+		for( int itemIdx = 0; itemIdx < itemCount; ++itemIdx )
+		{
+			xs[itemIdx] = nextRandom() * WORLD_WIDTH;
+			ys[itemIdx] = nextRandom() * WORLD_HEIGHT;
+		}
+
+		auto bruteStart = std::chrono::high_resolution_clock::now();
+		int brutePairs = BruteForcePairCount( xs, ys, radii );
+		double bruteMs = GetElapsedMilliseconds( bruteStart );
+
+		SpatialHash hash( Vec2( 0.0f, 0.0f ), Vec2( WORLD_WIDTH, WORLD_HEIGHT ), 1.0f );
+		std::vector<SpatialHashPair> pairs;
+		auto hashStart = std::chrono::high_resolution_clock::now();
+		hash.Clear();
+		for( int itemIdx = 0; itemIdx < itemCount; ++itemIdx )
+		{
+			hash.AddItem( xs[itemIdx], ys[itemIdx], radii[itemIdx], (uint32_t) itemIdx );
+		}
+		hash.Build();
+		hash.FindOverlapPairs( &pairs );
+		double hashMs = GetElapsedMilliseconds( hashStart );
+
+		char line[128];
+		snprintf( line, sizeof( line ), "%-8d %10.3f   %10.3f   %d%s", itemCount, bruteMs, hashMs, (int) pairs.size(), brutePairs == (int) pairs.size() ? "" : "  MISMATCH" );
+		BenchmarkPrint( line );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* Command_BenchmarkCollision
+*/
+bool Command_BenchmarkCollision( EventArgs& args )
+{
+	UNUSED( args );
+	RunCollisionBenchmark();
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* PieceFitsPerCell
+* The cell by cell check the bitboard replaces.
+*/
+static bool PieceFitsPerCell( const Grid& grid, const GridPieceShape& shape, const IntVec2& origin )
+{
+	bool isSupported = origin.y == 0;
+	for( int row = 0; row < shape.height; ++row )
+	{
+		for( int column = 0; column < shape.width; ++column )
+		{
+			if( ( shape.rows[row] & ( 1 << column ) ) == 0 )
+			{
+				continue;
+			}
+			IntVec2 cell( origin.x + column, origin.y + row );
+			if( !grid.IsInBounds( cell ) || grid.IsOccupied( cell ) )
+			{
+				return false;
+			}
+			const IntVec2 neighbors[4] = { IntVec2( cell.x - 1, cell.y ), IntVec2( cell.x + 1, cell.y ), IntVec2( cell.x, cell.y - 1 ), IntVec2( cell.x, cell.y + 1 ) };
+			for( const IntVec2& neighbor : neighbors )
+			{
+				isSupported = isSupported || ( grid.IsInBounds( neighbor ) && grid.IsOccupied( neighbor ) );
+			}
+		}
+	}
+	return isSupported;
+}
+
+//--------------------------------------------------------------------------
+/**
+* RunPieceBenchmark
+* Every supported placement of every piece orientation on a random 1024x256
+* board a quarter full, cell by cell vs the bitboard (capture included).
+*/
+void RunPieceBenchmark()
+{
+	const IntVec2 BOARD_SIZE( 1024, 256 );
+
+	uint32_t randomState = 0x9E3779B9;
+	Grid grid( BOARD_SIZE );
+	for( int blockIdx = 0; blockIdx < BOARD_SIZE.x * BOARD_SIZE.y / 4; ++blockIdx )
+	{
+		randomState ^= randomState << 13;
+		randomState ^= randomState >> 17;
+		randomState ^= randomState << 5;
+		grid.PlaceBlock( Block( IntVec2( (int) ( randomState % BOARD_SIZE.x ), (int) ( ( randomState >> 10 ) % BOARD_SIZE.y ) ), 0 ) );
+	}
+
+	BenchmarkPrint( "piece            orients   cell ms   bitboard ms   placements" );
+	for( int pieceIdx = 0; pieceIdx < NUM_GRID_PIECES; ++pieceIdx )
+	{
+		const GridPieceOrientations& orientations = GetGridPieceOrientations( (eGridPiece) pieceIdx );
+
+		auto cellStart = std::chrono::high_resolution_clock::now();
+		int cellPlacements = 0;
+		for( int shapeIdx = 0; shapeIdx < orientations.count; ++shapeIdx )
+		{
+			for( int y = 0; y < BOARD_SIZE.y; ++y )
+			{
+				for( int x = 0; x < BOARD_SIZE.x; ++x )
+				{
+					cellPlacements += PieceFitsPerCell( grid, orientations.shapes[shapeIdx], IntVec2( x, y ) ) ? 1 : 0;
+				}
+			}
+		}
+		double cellMs = GetElapsedMilliseconds( cellStart );
+
+		auto boardStart = std::chrono::high_resolution_clock::now();
+		GridBitboard board;
+		board.Capture( grid );
+		int boardPlacements = 0;
+		for( int shapeIdx = 0; shapeIdx < orientations.count; ++shapeIdx )
+		{
+			boardPlacements += CountPiecePlacements( board, orientations.shapes[shapeIdx], true );
+		}
+		double boardMs = GetElapsedMilliseconds( boardStart );
+
+		char line[128];
+		snprintf( line, sizeof( line ), "%-16s %7d %9.3f %13.3f   %d%s", GRID_PIECE_ART[pieceIdx], orientations.count, cellMs, boardMs, boardPlacements, cellPlacements == boardPlacements ? "" : "  MISMATCH" );
+		BenchmarkPrint( line );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* Command_BenchmarkPieces
+*/
+bool Command_BenchmarkPieces( EventArgs& args )
+{
+	UNUSED( args );
+	RunPieceBenchmark();
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* BruteForceShapeCount
+* Every orientation of every target against every box, cell by cell: the
+* template matching the shape matcher replaces.
+*/
+static int BruteForceShapeCount( const Grid& grid, const GridShapeMatcher& matcher )
+{
+	const IntVec2& dimensions = grid.GetDimensions();
+	int matchCount = 0;
+	for( int targetIdx = 0; targetIdx < matcher.GetTargetCount(); ++targetIdx )
+	{
+		for( const GridShapeOrientation& orientation : matcher.GetTarget( targetIdx ).orientations )
+		{
+			for( int y = 0; y + orientation.size.y <= dimensions.y; ++y )
+			{
+				for( int x = 0; x + orientation.size.x <= dimensions.x; ++x )
+				{
+					bool isMatch = true;
+					for( int row = 0; row < orientation.size.y && isMatch; ++row )
+					{
+						for( int column = 0; column < orientation.size.x && isMatch; ++column )
+						{
+							bool isShapeCell = ( ( orientation.rows[row] >> column ) & 1 ) != 0;
+							isMatch = isShapeCell == grid.IsOccupied( IntVec2( x + column, y + row ) );
+						}
+					}
+					matchCount += isMatch ? 1 : 0;
+				}
+			}
+		}
+	}
+	return matchCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* RunShapeBenchmark
+* The pieces as target shapes on a 512x256 board, found again after every
+* random placement: brute force over the board, a full rolling hash
+* rescan, and the incremental recheck around the placed block.
+*/
+void RunShapeBenchmark()
+{
+	const IntVec2 BOARD_SIZE( 512, 256 );
+	const int SHORT_RUN_PLACEMENTS = 20;
+	const int LONG_RUN_PLACEMENTS = 20000;
+
+	Grid grid( BOARD_SIZE );
+	grid.EnableShapeMatching();
+	GridShapeMatcher* matcher = grid.GetShapeMatcher();
+	for( int pieceIdx = 0; pieceIdx < NUM_GRID_PIECES; ++pieceIdx )
+	{
+		const GridPieceShape& shape = GetGridPieceOrientations( (eGridPiece) pieceIdx ).shapes[0];
+		std::vector<IntVec2> cells;
+		for( int row = 0; row < shape.height; ++row )
+		{
+			for( int column = 0; column < shape.width; ++column )
+			{
+				if( ( shape.rows[row] >> column ) & 1 )
+				{
+					cells.push_back( IntVec2( column, row ) );
+				}
+			}
+		}
+		matcher->AddTarget( GRID_PIECE_ART[pieceIdx], cells );
+	}
+
+	uint32_t randomState = 0x9E3779B9;
+	auto nextCell = [&randomState, &BOARD_SIZE]()
+	{
+		randomState ^= randomState << 13;
+		randomState ^= randomState >> 17;
+		randomState ^= randomState << 5;
+		return IntVec2( (int) ( randomState % BOARD_SIZE.x ), (int) ( ( randomState >> 10 ) % BOARD_SIZE.y ) );
+	};
+	for( int blockIdx = 0; blockIdx < BOARD_SIZE.x * BOARD_SIZE.y / 8; ++blockIdx )
+	{
+		grid.PlaceBlock( Block( nextCell(), 0 ) );
+	}
+	matcher->Update();
+
+	// The same placements for brute force and the full rescan, checked against each other.
+	std::vector<IntVec2> placements;
+	for( int placementIdx = 0; placementIdx < SHORT_RUN_PLACEMENTS; ++placementIdx )
+	{
+		placements.push_back( nextCell() );
+	}
+
+	Grid bruteGrid;
+	bruteGrid.CopyFrom( grid );
+	auto bruteStart = std::chrono::high_resolution_clock::now();
+	int bruteMatches = 0;
+	for( const IntVec2& cell : placements )
+	{
+		bruteGrid.PlaceBlock( Block( cell, 0 ) );
+		bruteMatches = BruteForceShapeCount( bruteGrid, *matcher );
+	}
+	double bruteMs = GetElapsedMilliseconds( bruteStart );
+
+	auto rescanStart = std::chrono::high_resolution_clock::now();
+	int rescanMatches = 0;
+	for( const IntVec2& cell : placements )
+	{
+		grid.PlaceBlock( Block( cell, 0 ) );
+		matcher->InvalidateAll();
+		rescanMatches = matcher->GetTotalMatchCount();
+	}
+	double rescanMs = GetElapsedMilliseconds( rescanStart );
+	bool isMismatched = rescanMatches != bruteMatches;
+
+	auto incrementalStart = std::chrono::high_resolution_clock::now();
+	int incrementalMatches = 0;
+	for( int placementIdx = 0; placementIdx < LONG_RUN_PLACEMENTS; ++placementIdx )
+	{
+		IntVec2 cell = nextCell();
+		if( !grid.PlaceBlock( Block( cell, 0 ) ) )
+		{
+			grid.RemoveBlock( cell );
+		}
+		incrementalMatches = matcher->GetTotalMatchCount();
+	}
+	double incrementalMs = GetElapsedMilliseconds( incrementalStart );
+	isMismatched = isMismatched || incrementalMatches != BruteForceShapeCount( grid, *matcher );
+
+	char line[128];
+	BenchmarkPrint( "method         changes   ms/change   matches" );
+	snprintf( line, sizeof( line ), "brute force    %7d %11.4f   %d", SHORT_RUN_PLACEMENTS, bruteMs / SHORT_RUN_PLACEMENTS, bruteMatches );
+	BenchmarkPrint( line );
+	snprintf( line, sizeof( line ), "full rescan    %7d %11.4f   %d", SHORT_RUN_PLACEMENTS, rescanMs / SHORT_RUN_PLACEMENTS, rescanMatches );
+	BenchmarkPrint( line );
+	snprintf( line, sizeof( line ), "incremental    %7d %11.4f   %d%s", LONG_RUN_PLACEMENTS, incrementalMs / LONG_RUN_PLACEMENTS, incrementalMatches, isMismatched ? "  MISMATCH" : "" );
+	BenchmarkPrint( line );
+
+	const GridShapeMatcherStats& stats = matcher->GetStats();
+	snprintf( line, sizeof( line ), "boxes hashed %llu, hash hits %llu, false hits %llu", (unsigned long long) stats.windowsChecked, (unsigned long long) stats.hashHits, (unsigned long long) stats.falseHits );
+	BenchmarkPrint( line );
+}
+
+//--------------------------------------------------------------------------
+/**
+* Command_BenchmarkShapes
+*/
+bool Command_BenchmarkShapes( EventArgs& args )
+{
+	UNUSED( args );
+	RunShapeBenchmark();
+	return true;
+}
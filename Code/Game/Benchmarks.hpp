@@ -0,0 +1,19 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+
+#include <string>
+
+//--------------------------------------------------------------------------
+// Micro benchmarks for the game's hot paths. Results go to stdout in the
+// headless runner and to the dev console otherwise.
+//--------------------------------------------------------------------------
+void BenchmarkPrint( const std::string& text );
+
+void RunCollisionBenchmark();
+bool Command_BenchmarkCollision( EventArgs& args );
+
+void RunPieceBenchmark();
+bool Command_BenchmarkPieces( EventArgs& args );
+
+void RunShapeBenchmark();
+bool Command_BenchmarkShapes( EventArgs& args );
@@ -1,3 +1,13 @@
 #include "Game/Block.hpp"
 
-
+//--------------------------------------------------------------------------
+/**
+* Block
+*/
+Block::Block( const IntVec2& location, uint8_t colorIndex, uint8_t material, uint8_t flags )
+	: location( location )
+	, colorIndex( colorIndex )
+	, material( material )
+	, flags( flags )
+{
+}
@@ -1,13 +1,45 @@
 #pragma once
 #include "Engine/Math/IntVec2.hpp"
 
-#include "Engine/Core/Graphics/Rgba.hpp"
+#include <stdint.h>
 
-class Block
+//--------------------------------------------------------------------------
+// Materials a block can be made of. Stored per cell as one byte in the Grid.
+//--------------------------------------------------------------------------
+enum eBlockMaterial : uint8_t
+{
+	BLOCK_MATERIAL_DEFAULT = 0,
+	BLOCK_MATERIAL_WOOD,
+	BLOCK_MATERIAL_STONE,
+	BLOCK_MATERIAL_METAL,
+
+	NUM_BLOCK_MATERIALS
+};
+
+//--------------------------------------------------------------------------
+// Per cell flag bits.
+//--------------------------------------------------------------------------
+enum eBlockFlag : uint8_t
 {
+	BLOCK_FLAG_NONE		= 0,
+	BLOCK_FLAG_LOCKED	= 1 << 0,	// Placed by the level, player can't remove it.
+	BLOCK_FLAG_TARGET	= 1 << 1,	// Part of the shape the player is asked to build.
+};
 
+//--------------------------------------------------------------------------
+// A Block is a value used to read and write cells of a Grid. The Grid itself
+// never stores Blocks, it keeps each attribute in its own packed array.
+//--------------------------------------------------------------------------
+class Block
+{
+public:
+	Block() {}
+	Block( const IntVec2& location, uint8_t colorIndex, uint8_t material = BLOCK_MATERIAL_DEFAULT, uint8_t flags = BLOCK_FLAG_NONE );
 
+public:
 	IntVec2 location;
 
-	Rgba color;
-};
\ No newline at end of file
+	uint8_t colorIndex = 0;		// Index into the Grid's palette.
+	uint8_t material = BLOCK_MATERIAL_DEFAULT;
+	uint8_t flags = BLOCK_FLAG_NONE;
+};
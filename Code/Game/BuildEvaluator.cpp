@@ -0,0 +1,144 @@
+#include "Game/BuildEvaluator.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+
+#include "Game/TranspositionCache.hpp"
+#include "Game/Benchmarks.hpp"
+#include "Game/Game.hpp"
+#include "Game/Grid.hpp"
+#include "Game/GridConnectivity.hpp"
+#include "Game/GameUtils.hpp"
+#include "Game/GameProfiler.hpp"
+
+constexpr uint64_t BUILD_TARGET_SALT = 0x7C1D2E3F4A5B6C8Dull;
+
+//--------------------------------------------------------------------------
+/**
+* BuildEvaluator
+*/
+BuildEvaluator::BuildEvaluator( SharedTranspositionCache* cache )
+	: m_cache( cache )
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~BuildEvaluator
+*/
+BuildEvaluator::~BuildEvaluator()
+{
+	m_cache = nullptr;
+}
+
+//--------------------------------------------------------------------------
+/**
+* SetTarget
+* Cells off the board are ignored.
+*/
+void BuildEvaluator::SetTarget( const IntVec2& dimensions, const std::vector<IntVec2>& targetCells )
+{
+	m_dimensions = dimensions;
+	m_wordsPerRow = ( dimensions.x + 63 ) >> 6;
+	m_targetRows.assign( (size_t) m_wordsPerRow * dimensions.y, 0 );
+	m_targetCellCount = 0;
+	m_targetHash = 0;
+
+	for( const IntVec2& cell : targetCells )
+	{
+		if( (unsigned int) cell.x >= (unsigned int) dimensions.x || (unsigned int) cell.y >= (unsigned int) dimensions.y )
+		{
+			continue;
+		}
+		uint64_t& word = m_targetRows[(size_t) cell.y * m_wordsPerRow + ( cell.x >> 6 )];
+		uint64_t bit = 1ull << ( cell.x & 63 );
+		if( ( word & bit ) == 0 )
+		{
+			word |= bit;
+			++m_targetCellCount;
+			m_targetHash ^= SplitMix64( ( (uint64_t) cell.y * dimensions.x + cell.x ) ^ BUILD_TARGET_SALT );
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* Evaluate
+*/
+BuildEvaluation BuildEvaluator::Evaluate( const Grid& grid )
+{
+	if( m_cache == nullptr )
+	{
+		return EvaluateUncached( grid );
+	}
+
+	uint64_t key = grid.GetZobristHash() ^ m_targetHash;
+	BuildEvaluation evaluation;
+	if( m_cache->Find( key, &evaluation ) )
+	{
+		return evaluation;
+	}
+
+	evaluation = EvaluateUncached( grid );
+	m_cache->Insert( key, evaluation );
+	return evaluation;
+}
+
+//--------------------------------------------------------------------------
+/**
+* EvaluateUncached
+* One pass over the board 64 cells at a time.
+*/
+BuildEvaluation BuildEvaluator::EvaluateUncached( const Grid& grid ) const
+{
+	GAME_PROFILE_SCOPE( "BuildEvaluator::EvaluateUncached" );
+	ASSERT_RECOVERABLE( grid.GetDimensions().x == m_dimensions.x && grid.GetDimensions().y == m_dimensions.y, "BuildEvaluator target is for a different board size" );
+
+	BuildEvaluation evaluation;
+	int rowCount = grid.GetDimensions().y < m_dimensions.y ? grid.GetDimensions().y : m_dimensions.y;
+	for( int y = 0; y < rowCount; ++y )
+	{
+		const uint64_t* targetRow = &m_targetRows[(size_t) y * m_wordsPerRow];
+		for( int wordIdx = 0; wordIdx < m_wordsPerRow; ++wordIdx )
+		{
+			uint64_t occupancy = grid.GetRowBits( y, wordIdx << 6 );
+			evaluation.matchedCells += CountSetBits( occupancy & targetRow[wordIdx] );
+			evaluation.extraBlocks += CountSetBits( occupancy & ~targetRow[wordIdx] );
+		}
+	}
+	evaluation.missingCells = m_targetCellCount - evaluation.matchedCells;
+
+	const GridConnectivity* connectivity = grid.GetConnectivity();
+	evaluation.floatingStructures = connectivity != nullptr ? connectivity->GetFloatingComponentCount() : 0;
+	evaluation.UpdateScore( m_targetCellCount );
+	return evaluation;
+}
+
+//--------------------------------------------------------------------------
+/**
+* UpdateScore
+* From the counts, for callers that keep those up to date move by move.
+*/
+void BuildEvaluation::UpdateScore( int targetCellCount )
+{
+	float cellCount = targetCellCount > 0 ? (float) targetCellCount : 1.0f;
+	score = ( (float) matchedCells - BUILD_EXTRA_BLOCK_PENALTY * (float) extraBlocks - BUILD_FLOATING_PENALTY * (float) floatingStructures ) / cellCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Command_SetBuildTarget
+* build_target file=Data/Levels/Tuna.glvl
+*/
+bool Command_SetBuildTarget( EventArgs& args )
+{
+	std::string levelPath = args.GetValue( "file", "" );
+	if( !g_theGame->SetBuildTarget( levelPath ) )
+	{
+		BenchmarkPrint( "Could not load build target " + levelPath );
+		return true;
+	}
+
+	const BuildEvaluation& evaluation = g_theGame->GetBuildEvaluation();
+	BenchmarkPrint( "Build target " + levelPath + ": " + std::to_string( evaluation.matchedCells ) + " matched, " + std::to_string( evaluation.missingCells ) + " missing, "
+		+ std::to_string( evaluation.extraBlocks ) + " extra" );
+	return true;
+}
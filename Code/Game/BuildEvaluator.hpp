@@ -0,0 +1,65 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Math/IntVec2.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class Grid;
+class SharedTranspositionCache;
+
+//--------------------------------------------------------------------------
+// How a board measures up against a target build.
+//--------------------------------------------------------------------------
+struct BuildEvaluation
+{
+	int matchedCells = 0;			// Target cells holding a block.
+	int missingCells = 0;			// Target cells still empty.
+	int extraBlocks = 0;			// Blocks outside the target.
+	int floatingStructures = 0;		// Only counted when the Grid tracks connectivity.
+	float score = 0.0f;				// 1 for an exact, grounded build.
+
+	bool IsComplete() const { return missingCells == 0 && extraBlocks == 0; }
+	void UpdateScore( int targetCellCount );
+};
+
+constexpr float BUILD_EXTRA_BLOCK_PENALTY = 0.5f;	// In target cells.
+constexpr float BUILD_FLOATING_PENALTY = 1.0f;		// In target cells, per floating structure.
+constexpr int DEFAULT_BUILD_CACHE_CAPACITY = 1 << 16;
+
+//--------------------------------------------------------------------------
+// Scores a Grid against a target set of cells. Given a cache, Evaluate
+// caches results on the board's Zobrist hash combined with the target's, so
+// a board seen before (a repeated or undone state) costs one lookup instead
+// of a rescan. The cache isn't owned, and evaluators with different targets
+// or on different threads can share one. Without a cache Evaluate rescans.
+//--------------------------------------------------------------------------
+class BuildEvaluator
+{
+public:
+	explicit BuildEvaluator( SharedTranspositionCache* cache = nullptr );
+	~BuildEvaluator();
+
+	void SetTarget( const IntVec2& dimensions, const std::vector<IntVec2>& targetCells );
+	const IntVec2& GetDimensions() const { return m_dimensions; }
+	int GetTargetCellCount() const { return m_targetCellCount; }
+	uint64_t GetTargetHash() const { return m_targetHash; }
+	bool IsTarget( const IntVec2& cell ) const { return ( GetTargetRowBits( cell.y, cell.x >> 6 ) >> ( cell.x & 63 ) ) & 1; }
+	uint64_t GetTargetRowBits( int y, int wordIndex ) const { return m_targetRows[(size_t) y * m_wordsPerRow + wordIndex]; }
+
+	BuildEvaluation Evaluate( const Grid& grid );
+	BuildEvaluation EvaluateUncached( const Grid& grid ) const;
+	SharedTranspositionCache* GetCache() const { return m_cache; }
+
+private:
+	IntVec2 m_dimensions;
+	int m_wordsPerRow = 0;
+	std::vector<uint64_t> m_targetRows;		// Row y, cells [64 * word, 64 * word + 64) at [y * m_wordsPerRow + word].
+	int m_targetCellCount = 0;
+	uint64_t m_targetHash = 0;
+
+	SharedTranspositionCache* m_cache = nullptr;
+};
+
+bool Command_SetBuildTarget( EventArgs& args );
@@ -0,0 +1,396 @@
+#include "Game/BuildSolver.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+
+#include "Game/Grid.hpp"
+#include "Game/GridConnectivity.hpp"
+#include "Game/JobSystem.hpp"
+#include "Game/GameUtils.hpp"
+#include "Game/GameProfiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+constexpr int SOLVER_JOB_BATCH_SIZE = 4;
+constexpr int SOLVER_TABLE_SHARDS = 64;
+
+//--------------------------------------------------------------------------
+/**
+* BuildSolver
+* Runs on the calling thread alone when jobSystem is null.
+*/
+BuildSolver::BuildSolver( const BuildSolverSettings& settings, JobSystem* jobSystem )
+	: m_settings( settings )
+	, m_jobSystem( jobSystem )
+	, m_table( DEFAULT_SOLVER_TABLE_CAPACITY, SOLVER_TABLE_SHARDS )
+	, m_evaluator( &m_table )
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~BuildSolver
+*/
+BuildSolver::~BuildSolver()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* Solve
+*/
+BuildSolverResult BuildSolver::Solve( const Grid& start, const std::vector<IntVec2>& targetCells )
+{
+	GAME_PROFILE_SCOPE( "BuildSolver::Solve" );
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	m_evaluator.SetTarget( start.GetDimensions(), targetCells );
+	m_table.Clear();
+
+	int threadCount = m_jobSystem != nullptr ? m_jobSystem->GetThreadCount() : 1;
+	m_scratch.clear();
+	m_scratch.resize( (size_t) threadCount );
+	for( ThreadScratch& scratch : m_scratch )
+	{
+		scratch.grid.reset( new Grid() );
+		scratch.grid->EnableConnectivity();
+		scratch.grid->CopyFrom( start );
+	}
+
+	Node root;
+	root.key = start.GetZobristHash() ^ m_evaluator.GetTargetHash();
+	root.evaluation = m_evaluator.Evaluate( *m_scratch[0].grid );
+	m_beams.clear();
+	m_beams.emplace_back( 1, root );
+
+	int maxDepth = m_settings.maxDepth > 0 ? m_settings.maxDepth : 4 * ( root.evaluation.missingCells + root.evaluation.extraBlocks );
+	BuildSolverResult result;
+	result.isSolved = root.evaluation.IsComplete();
+
+	int solvedIndex = -1;
+	while( !result.isSolved && (int) m_beams.size() <= maxDepth && !m_beams.back().empty() )
+	{
+		int parentCount = (int) m_beams.back().size();
+		if( m_jobSystem != nullptr && parentCount > 1 )
+		{
+			JobHandle expand = m_jobSystem->ParallelFor( "BuildSolverExpand", parentCount, SOLVER_JOB_BATCH_SIZE, ExpandNodesJob, this );
+			m_jobSystem->Wait( expand );
+		}
+		else
+		{
+			ExpandNodesJob( this, 0, parentCount );
+		}
+
+		std::vector<Node> children;
+		for( ThreadScratch& scratch : m_scratch )
+		{
+			children.insert( children.end(), scratch.children.begin(), scratch.children.end() );
+			scratch.children.clear();
+		}
+
+		// A finished build ends the search even if the beam would have cut it
+		// (floating scaffold can outscore it).
+		for( int childIdx = 0; childIdx < (int) children.size(); ++childIdx )
+		{
+			if( children[childIdx].evaluation.IsComplete() )
+			{
+				std::swap( children[0], children[childIdx] );
+				children.resize( 1 );
+				solvedIndex = 0;
+				result.isSolved = true;
+				break;
+			}
+		}
+
+		// Best first, ties broken by key so the beam doesn't depend on which
+		// thread got to a board first.
+		auto isBetter = []( const Node& a, const Node& b )
+		{
+			return a.evaluation.score != b.evaluation.score ? a.evaluation.score > b.evaluation.score : a.key < b.key;
+		};
+		if( (int) children.size() > m_settings.beamWidth )
+		{
+			std::partial_sort( children.begin(), children.begin() + m_settings.beamWidth, children.end(), isBetter );
+			children.resize( (size_t) m_settings.beamWidth );
+		}
+		else
+		{
+			std::sort( children.begin(), children.end(), isBetter );
+		}
+		m_beams.push_back( std::move( children ) );
+	}
+
+	if( solvedIndex >= 0 )
+	{
+		GetPath( (int) m_beams.size() - 1, solvedIndex, &result.moves );
+	}
+	result.depthReached = (int) m_beams.size() - 1;
+	for( const ThreadScratch& scratch : m_scratch )
+	{
+		result.nodesExpanded += scratch.nodesExpanded;
+		result.nodesGenerated += scratch.nodesGenerated;
+		result.duplicatesSkipped += scratch.duplicatesSkipped;
+	}
+	result.seconds = std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - startTime ).count();
+	return result;
+}
+
+//--------------------------------------------------------------------------
+/**
+* ExpandNodesJob
+* Each thread writes only its own scratch, so batches can go anywhere.
+*/
+void BuildSolver::ExpandNodesJob( void* solver, int beginIndex, int endIndex )
+{
+	BuildSolver* buildSolver = (BuildSolver*) solver;
+	int threadIndex = buildSolver->m_jobSystem != nullptr ? JobSystem::GetCurrentThreadIndex() : 0;
+	ThreadScratch& scratch = buildSolver->m_scratch[threadIndex];
+	for( int nodeIdx = beginIndex; nodeIdx < endIndex; ++nodeIdx )
+	{
+		buildSolver->ExpandNode( scratch, nodeIdx );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* ExpandNode
+* Brings the thread's board from the start to the node, tries every move
+* from there and puts the board back.
+*/
+void BuildSolver::ExpandNode( ThreadScratch& scratch, int nodeIndex )
+{
+	Grid& grid = *scratch.grid;
+	int depth = (int) m_beams.size() - 1;
+	GetPath( depth, nodeIndex, &scratch.path );
+	for( const BuildSolverMove& move : scratch.path )
+	{
+		ApplyMove( grid, move );
+	}
+	++scratch.nodesExpanded;
+
+	// One pass over the board: fill target cells a block can go in, scaffold
+	// under those it can't yet, take down blocks outside the target unless
+	// the level locked them.
+	const GridBitboard& board = scratch.board;
+	scratch.board.Capture( grid );
+	const GridPieceShape& singleBlock = GetGridPieceOrientations( GRID_PIECE_MONOMINO ).shapes[0];
+	int wordCount = board.GetWordsPerRow();
+	scratch.placementMasks.resize( (size_t) wordCount );
+
+	BuildSolverMove move;
+	for( int y = 0; y < grid.GetDimensions().y; ++y )
+	{
+		GetPiecePlacementRow( board, singleBlock, y, m_settings.requireSupport, scratch.placementMasks.data() );
+		for( int wordIdx = 0; wordIdx < wordCount; ++wordIdx )
+		{
+			int startX = wordIdx << 6;
+			uint64_t occupancy = board.GetWindow( y, startX );
+			uint64_t targetBits = m_evaluator.GetTargetRowBits( y, wordIdx );
+			uint64_t emptyTargets = targetBits & ~occupancy;
+
+			move.isRemoval = false;
+			move.block = Block( IntVec2( 0, y ), m_settings.colorIndex );
+			uint64_t placeableBits = emptyTargets & scratch.placementMasks[wordIdx];
+			while( placeableBits != 0 )
+			{
+				move.block.location.x = startX + CountTrailingZeros( placeableBits );
+				placeableBits &= placeableBits - 1;
+				TryMove( scratch, nodeIndex, move );
+			}
+
+			uint64_t unsupportedBits = m_settings.allowScaffold ? emptyTargets & ~scratch.placementMasks[wordIdx] : 0;
+			while( unsupportedBits != 0 )
+			{
+				TryScaffoldMoves( scratch, nodeIndex, IntVec2( startX + CountTrailingZeros( unsupportedBits ), y ) );
+				unsupportedBits &= unsupportedBits - 1;
+			}
+
+			move.isRemoval = true;
+			uint64_t extraBits = occupancy & ~targetBits;
+			while( extraBits != 0 )
+			{
+				IntVec2 cell( startX + CountTrailingZeros( extraBits ), y );
+				extraBits &= extraBits - 1;
+				grid.GetBlock( cell, &move.block );
+				if( ( move.block.flags & BLOCK_FLAG_LOCKED ) == 0 )
+				{
+					TryMove( scratch, nodeIndex, move );
+				}
+			}
+		}
+	}
+
+	for( int moveIdx = (int) scratch.path.size() - 1; moveIdx >= 0; --moveIdx )
+	{
+		RevertMove( grid, scratch.path[moveIdx] );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* TryScaffoldMoves
+* A block in a free, supported cell next to the target cell, or at the foot
+* of the empty column under it so any height can be reached.
+*/
+void BuildSolver::TryScaffoldMoves( ThreadScratch& scratch, int nodeIndex, const IntVec2& targetCell )
+{
+	const Grid& grid = *scratch.grid;
+	BuildSolverMove move;
+	move.block.colorIndex = m_settings.colorIndex;
+
+	const IntVec2 neighbors[4] = { IntVec2( targetCell.x - 1, targetCell.y ), IntVec2( targetCell.x + 1, targetCell.y ), IntVec2( targetCell.x, targetCell.y - 1 ), IntVec2( targetCell.x, targetCell.y + 1 ) };
+	for( const IntVec2& neighbor : neighbors )
+	{
+		if( grid.IsInBounds( neighbor ) && !grid.IsOccupied( neighbor ) && !m_evaluator.IsTarget( neighbor ) && IsSupported( grid, neighbor ) )
+		{
+			move.block.location = neighbor;
+			TryMove( scratch, nodeIndex, move );
+		}
+	}
+
+	IntVec2 columnFoot( targetCell.x, targetCell.y - 1 );
+	while( columnFoot.y > 0 && !grid.IsOccupied( IntVec2( targetCell.x, columnFoot.y - 1 ) ) )
+	{
+		--columnFoot.y;
+	}
+	if( columnFoot.y < targetCell.y - 1 && !m_evaluator.IsTarget( columnFoot ) )
+	{
+		move.block.location = columnFoot;
+		TryMove( scratch, nodeIndex, move );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* TryMove
+* Scores the move from the parent's counts and keeps it if the board it
+* makes hasn't been reached before.
+*/
+void BuildSolver::TryMove( ThreadScratch& scratch, int nodeIndex, const BuildSolverMove& move )
+{
+	Grid& grid = *scratch.grid;
+	const Node& parent = m_beams.back()[nodeIndex];
+	++scratch.nodesGenerated;
+
+	ApplyMove( grid, move );
+	Node child;
+	child.parentIndex = nodeIndex;
+	child.move = move;
+	child.key = grid.GetZobristHash() ^ m_evaluator.GetTargetHash();
+	child.evaluation = parent.evaluation;
+	int delta = move.isRemoval ? -1 : 1;
+	if( m_evaluator.IsTarget( move.block.location ) )
+	{
+		child.evaluation.matchedCells += delta;
+		child.evaluation.missingCells -= delta;
+	}
+	else
+	{
+		child.evaluation.extraBlocks += delta;
+	}
+	child.evaluation.floatingStructures = grid.GetConnectivity()->GetFloatingComponentCount();
+	child.evaluation.UpdateScore( m_evaluator.GetTargetCellCount() );
+	RevertMove( grid, move );
+
+	if( m_table.FindOrInsert( child.key, child.evaluation ) )
+	{
+		++scratch.duplicatesSkipped;
+		return;
+	}
+	scratch.children.push_back( child );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetPath
+* Moves from the start to the node, in order.
+*/
+void BuildSolver::GetPath( int depth, int nodeIndex, std::vector<BuildSolverMove>* out_path ) const
+{
+	out_path->resize( (size_t) depth );
+	for( int pathIdx = depth - 1; pathIdx >= 0; --pathIdx )
+	{
+		const Node& node = m_beams[pathIdx + 1][nodeIndex];
+		( *out_path )[pathIdx] = node.move;
+		nodeIndex = node.parentIndex;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsSupported
+* Row 0 is the ground.
+*/
+bool BuildSolver::IsSupported( const Grid& grid, const IntVec2& cell )
+{
+	return cell.y == 0
+		|| grid.IsOccupied( IntVec2( cell.x - 1, cell.y ) ) || grid.IsOccupied( IntVec2( cell.x + 1, cell.y ) )
+		|| grid.IsOccupied( IntVec2( cell.x, cell.y - 1 ) ) || grid.IsOccupied( IntVec2( cell.x, cell.y + 1 ) );
+}
+
+//--------------------------------------------------------------------------
+/**
+* ApplyMove
+*/
+void BuildSolver::ApplyMove( Grid& grid, const BuildSolverMove& move )
+{
+	if( move.isRemoval )
+	{
+		grid.RemoveBlock( move.block.location );
+	}
+	else
+	{
+		grid.PlaceBlock( move.block );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* RevertMove
+* Removals carry the block they took, so it goes back as it was.
+*/
+void BuildSolver::RevertMove( Grid& grid, const BuildSolverMove& move )
+{
+	if( move.isRemoval )
+	{
+		grid.PlaceBlock( move.block );
+	}
+	else
+	{
+		grid.RemoveBlock( move.block.location );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* RunBuildSolver
+* Headless -solve: the target is every block of the target level, the board
+* starts as the start level or empty. Returns non zero if unsolved.
+*/
+int RunBuildSolver( const std::string& targetPath, const std::string& startPath, const BuildSolverSettings& settings, JobSystem* jobSystem )
+{
+	Grid target;
+	if( !target.LoadLevelFile( targetPath ) )
+	{
+		printf( "could not load target level %s\n", targetPath.c_str() );
+		return 1;
+	}
+	std::vector<IntVec2> targetCells;
+	target.GetOccupiedCells( &targetCells );
+	const IntVec2& dimensions = target.GetDimensions();
+
+	Grid start( dimensions );
+	if( !startPath.empty() && ( !start.LoadLevelFile( startPath ) || start.GetDimensions().x != dimensions.x || start.GetDimensions().y != dimensions.y ) )
+	{
+		printf( "could not load start level %s (or its size differs from the target)\n", startPath.c_str() );
+		return 1;
+	}
+
+	BuildSolver solver( settings, jobSystem );
+	BuildSolverResult result = solver.Solve( start, targetCells );
+	TranspositionCacheStats tableStats = solver.GetTableStats();
+	printf( "solve %s: %s  par: %d  depth: %d  threads: %d  beam: %d\n", targetPath.c_str(), result.isSolved ? "SOLVED" : "UNSOLVED", result.GetParMoves(), result.depthReached, jobSystem != nullptr ? jobSystem->GetThreadCount() : 1, settings.beamWidth );
+	printf( "nodes expanded: %llu  generated: %llu  duplicates: %llu  seconds: %.3f  nodes/sec: %.1f\n", (unsigned long long) result.nodesExpanded, (unsigned long long) result.nodesGenerated, (unsigned long long) result.duplicatesSkipped, result.seconds, result.GetNodesPerSecond() );
+	printf( "table lookups: %llu  hit rate: %.1f%%  evictions: %llu\n", (unsigned long long) tableStats.lookups, 100.0 * tableStats.GetHitRate(), (unsigned long long) tableStats.evictions );
+	return result.isSolved ? 0 : 2;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+
+#include "Game/Block.hpp"
+#include "Game/BuildEvaluator.hpp"
+#include "Game/GridPiece.hpp"
+#include "Game/TranspositionCache.hpp"
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Grid;
+class JobSystem;
+
+constexpr int DEFAULT_SOLVER_BEAM_WIDTH = 256;
+constexpr int DEFAULT_SOLVER_TABLE_CAPACITY = 1 << 20;
+
+struct BuildSolverSettings
+{
+	int beamWidth = DEFAULT_SOLVER_BEAM_WIDTH;
+	int maxDepth = 0;				// 0 allows four times the moves the build needs at least.
+	bool requireSupport = true;		// Blocks go in row 0 or next to another block.
+	bool allowScaffold = true;		// Extra blocks under unsupported target cells, taken down later.
+	uint8_t colorIndex = 0;			// Of every placed block.
+};
+
+struct BuildSolverMove
+{
+	Block block;
+	bool isRemoval = false;
+};
+
+struct BuildSolverResult
+{
+	bool isSolved = false;
+	std::vector<BuildSolverMove> moves;	// Par for the level when solved.
+	int depthReached = 0;
+	uint64_t nodesExpanded = 0;
+	uint64_t nodesGenerated = 0;		// Children scored, duplicates included.
+	uint64_t duplicatesSkipped = 0;		// Already reached, found in the table.
+	double seconds = 0.0;
+
+	int GetParMoves() const { return (int) moves.size(); }
+	double GetNodesPerSecond() const { return seconds > 0.0 ? (double) nodesGenerated / seconds : 0.0; }
+};
+
+//--------------------------------------------------------------------------
+// Finds a sequence of block placements and removals that turns a Grid into
+// a target build, by beam search: each depth keeps the beamWidth best
+// scoring boards (BuildEvaluation score) and expands all of them.
+//
+// A beam is expanded in parallel on the job system. Each thread keeps its
+// own copy of the start board (sharing chunk cells until written) and
+// reaches a node by replaying its moves, finds the legal placements 64
+// cells at a time on a GridBitboard of it, then scores every child move by
+// applying and reverting it, so scoring is incremental: the Zobrist hash and
+// connectivity follow each move and the counts come from the parent's. A
+// transposition table shared by every thread drops boards already reached
+// by another order of the same moves, at any depth.
+//
+// The first depth holding a finished build gives the par. Beam search can
+// miss a shorter solution it pruned, so par is an upper bound; widening the
+// beam tightens it.
+//--------------------------------------------------------------------------
+class BuildSolver
+{
+public:
+	BuildSolver( const BuildSolverSettings& settings, JobSystem* jobSystem );
+	~BuildSolver();
+
+	BuildSolverResult Solve( const Grid& start, const std::vector<IntVec2>& targetCells );
+	TranspositionCacheStats GetTableStats() const { return m_table.GetStats(); }
+
+private:
+	struct Node
+	{
+		int parentIndex = -1;		// In the previous depth's beam.
+		BuildSolverMove move;
+		uint64_t key = 0;
+		BuildEvaluation evaluation;
+	};
+
+	struct ThreadScratch
+	{
+		std::unique_ptr<Grid> grid;
+		GridBitboard board;
+		std::vector<uint64_t> placementMasks;
+		std::vector<Node> children;
+		std::vector<BuildSolverMove> path;
+		uint64_t nodesExpanded = 0;
+		uint64_t nodesGenerated = 0;
+		uint64_t duplicatesSkipped = 0;
+	};
+
+	static void ExpandNodesJob( void* solver, int beginIndex, int endIndex );
+	void ExpandNode( ThreadScratch& scratch, int nodeIndex );
+	void TryScaffoldMoves( ThreadScratch& scratch, int nodeIndex, const IntVec2& targetCell );
+	void TryMove( ThreadScratch& scratch, int nodeIndex, const BuildSolverMove& move );
+	void GetPath( int depth, int nodeIndex, std::vector<BuildSolverMove>* out_path ) const;
+
+	static bool IsSupported( const Grid& grid, const IntVec2& cell );
+	static void ApplyMove( Grid& grid, const BuildSolverMove& move );
+	static void RevertMove( Grid& grid, const BuildSolverMove& move );
+
+private:
+	BuildSolverSettings m_settings;
+	JobSystem* m_jobSystem = nullptr;
+	SharedTranspositionCache m_table;
+	BuildEvaluator m_evaluator;					// Caches in m_table.
+
+	std::vector<std::vector<Node>> m_beams;		// One per depth, the start alone at 0.
+	std::vector<ThreadScratch> m_scratch;		// Per job system thread.
+};
+
+int RunBuildSolver( const std::string& targetPath, const std::string& startPath, const BuildSolverSettings& settings, JobSystem* jobSystem );
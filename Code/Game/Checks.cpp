@@ -0,0 +1,957 @@
+#include "Game/Checks.hpp"
+#include "Game/Benchmarks.hpp"
+#include "Game/BuildEvaluator.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Grid.hpp"
+#include "Game/GridConnectivity.hpp"
+#include "Game/GridHistory.hpp"
+#include "Game/GridLevelFile.hpp"
+#include "Game/GridPiece.hpp"
+#include "Game/GridShapeMatcher.hpp"
+#include "Game/InputJournal.hpp"
+#include "Game/JobSystem.hpp"
+#include "Game/TimerWheel.hpp"
+#include "Game/TranspositionCache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <stdio.h>
+#include <unordered_map>
+#include <vector>
+
+constexpr const char* CHECK_JOURNAL_PATH = "Check.journal";
+
+//--------------------------------------------------------------------------
+/**
+* NextRandom
+* xorshift32, so every run checks the same cases.
+*/
+static uint32_t NextRandom( uint32_t& state )
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+//--------------------------------------------------------------------------
+/**
+* ReportCheck
+*/
+static void ReportCheck( const char* name, int caseCount, int failureCount )
+{
+	char line[128];
+	snprintf( line, sizeof( line ), "%-20s %8d %9d%s", name, caseCount, failureCount, failureCount == 0 ? "" : "  FAILED" );
+	BenchmarkPrint( line );
+}
+
+//--------------------------------------------------------------------------
+/**
+* ToggleBlock
+* Places a block, or removes the one that's there. Either way the cell is
+* written.
+*/
+static void ToggleBlock( Grid& grid, const IntVec2& cell, uint8_t colorIndex )
+{
+	if( !grid.PlaceBlock( Block( cell, colorIndex ) ) )
+	{
+		grid.RemoveBlock( cell );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* RandomCell
+*/
+static IntVec2 RandomCell( uint32_t& state, const IntVec2& dimensions )
+{
+	int x = (int) ( NextRandom( state ) % (uint32_t) dimensions.x );
+	int y = (int) ( NextRandom( state ) % (uint32_t) dimensions.y );
+	return IntVec2( x, y );
+}
+
+//--------------------------------------------------------------------------
+/**
+* AddPieceTargets
+* First orientation of every piece, the same targets the shape benchmark
+* uses.
+*/
+static void AddPieceTargets( GridShapeMatcher* matcher )
+{
+	for( int pieceIdx = 0; pieceIdx < NUM_GRID_PIECES; ++pieceIdx )
+	{
+		const GridPieceShape& shape = GetGridPieceOrientations( (eGridPiece) pieceIdx ).shapes[0];
+		std::vector<IntVec2> cells;
+		for( int row = 0; row < shape.height; ++row )
+		{
+			for( int column = 0; column < shape.width; ++column )
+			{
+				if( ( shape.rows[row] >> column ) & 1 )
+				{
+					cells.push_back( IntVec2( column, row ) );
+				}
+			}
+		}
+		matcher->AddTarget( GRID_PIECE_ART[pieceIdx], cells );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* ComputeZobristHash
+* From every block on the board, ignoring the running hash.
+*/
+static uint64_t ComputeZobristHash( const Grid& grid )
+{
+	std::vector<IntVec2> cells;
+	grid.GetOccupiedCells( &cells );
+	uint64_t hash = 0;
+	for( const IntVec2& cell : cells )
+	{
+		Block block;
+		grid.GetBlock( cell, &block );
+		hash ^= Grid::GetZobristKey( grid.GetCellIndex( cell ), block.colorIndex, block.material, block.flags );
+	}
+	return hash;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsConnectivityRebuildEqual
+* The incremental components against a Rebuild on a copy of the board: the
+* same counts, and a one to one mapping of component ids that agrees on
+* every block.
+*/
+static bool IsConnectivityRebuildEqual( const Grid& grid )
+{
+	Grid rebuilt;
+	rebuilt.CopyFrom( grid );
+	rebuilt.EnableConnectivity();
+	GridConnectivity* incremental = grid.GetConnectivity();
+	GridConnectivity* reference = rebuilt.GetConnectivity();
+	if( incremental->GetComponentCount() != reference->GetComponentCount() || incremental->GetGroundedComponentCount() != reference->GetGroundedComponentCount() )
+	{
+		return false;
+	}
+
+	std::vector<IntVec2> cells;
+	grid.GetOccupiedCells( &cells );
+	std::unordered_map<int, int> incrementalToReference;
+	std::unordered_map<int, int> referenceToIncremental;
+	for( const IntVec2& cell : cells )
+	{
+		GridComponentInfo incrementalInfo = incremental->GetComponent( cell );
+		GridComponentInfo referenceInfo = reference->GetComponent( cell );
+		if( !incrementalInfo.IsValid() || !referenceInfo.IsValid() || incrementalInfo.blockCount != referenceInfo.blockCount
+			|| incrementalInfo.groundContacts != referenceInfo.groundContacts )
+		{
+			return false;
+		}
+		auto forward = incrementalToReference.emplace( incrementalInfo.componentId, referenceInfo.componentId ).first;
+		auto backward = referenceToIncremental.emplace( referenceInfo.componentId, incrementalInfo.componentId ).first;
+		if( forward->second != referenceInfo.componentId || backward->second != incrementalInfo.componentId )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsShapeRescanEqual
+* Per target match counts against a full rescan on a copy of the board.
+*/
+static bool IsShapeRescanEqual( const Grid& grid )
+{
+	Grid rescanned;
+	rescanned.CopyFrom( grid );
+	rescanned.EnableShapeMatching();
+	AddPieceTargets( rescanned.GetShapeMatcher() );
+	GridShapeMatcher* incremental = grid.GetShapeMatcher();
+	GridShapeMatcher* reference = rescanned.GetShapeMatcher();
+	for( int targetIdx = 0; targetIdx < incremental->GetTargetCount(); ++targetIdx )
+	{
+		if( incremental->GetMatchCount( targetIdx ) != reference->GetMatchCount( targetIdx ) )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* CheckPiecePlacement
+* GetPiecePlacementMask and GetPiecePlacementRow against CanPlacePiece at
+* every origin, for every orientation of every piece, on random boards of
+* odd sizes so the board edges land mid word.
+*/
+static void CheckPiecePlacement( int* out_caseCount, int* out_failureCount )
+{
+	uint32_t randomState = 0x2545F491;
+	for( int boardIdx = 0; boardIdx < 6; ++boardIdx )
+	{
+		IntVec2 dimensions( 1 + (int) ( NextRandom( randomState ) % 300 ), 1 + (int) ( NextRandom( randomState ) % 60 ) );
+		Grid grid( dimensions );
+		int blockCount = grid.GetCellCount() * ( 1 + boardIdx ) / 10;
+		for( int blockIdx = 0; blockIdx < blockCount; ++blockIdx )
+		{
+			grid.PlaceBlock( Block( RandomCell( randomState, dimensions ), 0 ) );
+		}
+
+		GridBitboard board;
+		board.Capture( grid );
+		std::vector<uint64_t> rowMasks( (size_t) board.GetWordsPerRow() );
+		for( int pieceIdx = 0; pieceIdx < NUM_GRID_PIECES; ++pieceIdx )
+		{
+			const GridPieceOrientations& orientations = GetGridPieceOrientations( (eGridPiece) pieceIdx );
+			for( int shapeIdx = 0; shapeIdx < orientations.count; ++shapeIdx )
+			{
+				const GridPieceShape& shape = orientations.shapes[shapeIdx];
+				for( int requireSupport = 0; requireSupport < 2; ++requireSupport )
+				{
+					for( int y = 0; y < dimensions.y; ++y )
+					{
+						GetPiecePlacementRow( board, shape, y, requireSupport != 0, rowMasks.data() );
+						for( int wordIdx = 0; wordIdx < board.GetWordsPerRow(); ++wordIdx )
+						{
+							uint64_t mask = GetPiecePlacementMask( board, shape, y, wordIdx << 6, requireSupport != 0 );
+							*out_failureCount += mask != rowMasks[wordIdx] ? 1 : 0;
+							for( int bitIdx = 0; bitIdx < 64; ++bitIdx )
+							{
+								bool isLegal = CanPlacePiece( grid, shape, IntVec2( ( wordIdx << 6 ) + bitIdx, y ), requireSupport != 0 );
+								*out_failureCount += ( ( ( mask >> bitIdx ) & 1 ) != 0 ) != isLegal ? 1 : 0;
+								++*out_caseCount;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* CheckShapeMatches
+* Incremental matches after random placements and removals, against a
+* full rescan.
+*/
+static void CheckShapeMatches( int* out_caseCount, int* out_failureCount )
+{
+	const IntVec2 BOARD_SIZE( 150, 90 );
+
+	uint32_t randomState = 0x68E31DA4;
+	Grid grid( BOARD_SIZE );
+	grid.EnableShapeMatching();
+	AddPieceTargets( grid.GetShapeMatcher() );
+	for( int blockIdx = 0; blockIdx < grid.GetCellCount() / 8; ++blockIdx )
+	{
+		grid.PlaceBlock( Block( RandomCell( randomState, BOARD_SIZE ), 0 ) );
+	}
+
+	for( int changeIdx = 1; changeIdx <= 4000; ++changeIdx )
+	{
+		ToggleBlock( grid, RandomCell( randomState, BOARD_SIZE ), 0 );
+		if( changeIdx % 50 == 0 )
+		{
+			*out_failureCount += IsShapeRescanEqual( grid ) ? 0 : 1;
+			++*out_caseCount;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* CheckConnectivity
+* Fills a board, then removes blocks until it's nearly empty, so
+* components split and lose their ground. The incremental state is
+* compared against a Rebuild along the way.
+*/
+static void CheckConnectivity( int* out_caseCount, int* out_failureCount )
+{
+	const IntVec2 BOARD_SIZE( 120, 80 );
+
+	uint32_t randomState = 0x1B873593;
+	Grid grid( BOARD_SIZE );
+	grid.EnableConnectivity();
+	for( int blockIdx = 0; blockIdx < grid.GetCellCount() * 3 / 4; ++blockIdx )
+	{
+		grid.PlaceBlock( Block( RandomCell( randomState, BOARD_SIZE ), 0 ) );
+		if( blockIdx % 500 == 0 )
+		{
+			*out_failureCount += IsConnectivityRebuildEqual( grid ) ? 0 : 1;
+			++*out_caseCount;
+		}
+	}
+
+	std::vector<IntVec2> cells;
+	for( int removeIdx = 1; grid.GetBlockCount() > 0; ++removeIdx )
+	{
+		grid.GetOccupiedCells( &cells );
+		grid.RemoveBlock( cells[NextRandom( randomState ) % cells.size()] );
+		if( removeIdx % 100 == 0 || grid.GetBlockCount() == 0 )
+		{
+			*out_failureCount += IsConnectivityRebuildEqual( grid ) ? 0 : 1;
+			++*out_caseCount;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* CheckHistory
+* Random edits, undo, redo, rewind and replay against a stack of the hashes
+* each checkpoint should bring back. The running hash has to match the one
+* recomputed from the board, and connectivity and shape matches have to
+* match a rebuild after every restore. The frame limit is small so the
+* oldest frames get merged.
+*/
+static void CheckHistory( int* out_caseCount, int* out_failureCount )
+{
+	const IntVec2 BOARD_SIZE( 200, 100 );
+	const int MAX_FRAMES = 12;
+
+	uint32_t randomState = 0x5BD1E995;
+	Grid grid( BOARD_SIZE );
+	grid.EnableConnectivity();
+	grid.EnableShapeMatching();
+	AddPieceTargets( grid.GetShapeMatcher() );
+	grid.AddPaletteColor( Rgba( 0.25f, 0.5f, 1.0f, 1.0f ) );
+	for( int blockIdx = 0; blockIdx < grid.GetCellCount() / 6; ++blockIdx )
+	{
+		grid.PlaceBlock( Block( RandomCell( randomState, BOARD_SIZE ), (uint8_t) ( blockIdx & 1 ) ) );
+	}
+	grid.EnableHistory( MAX_FRAMES );
+	GridHistory* history = grid.GetHistory();
+
+	std::vector<uint64_t> checkpointHashes = { grid.GetZobristHash() };
+	std::vector<uint64_t> redoHashes;
+	for( int stepIdx = 0; stepIdx < 400; ++stepIdx )
+	{
+		uint32_t op = NextRandom( randomState ) % 10;
+		if( op < 5 )
+		{
+			// Edits either stay in one chunk or spread over the board.
+			IntVec2 center = RandomCell( randomState, BOARD_SIZE );
+			int editCount = 1 + (int) ( NextRandom( randomState ) % 40 );
+			for( int editIdx = 0; editIdx < editCount; ++editIdx )
+			{
+				IntVec2 cell = RandomCell( randomState, op < 3 ? IntVec2( 24, 24 ) : BOARD_SIZE );
+				cell = op < 3 ? IntVec2( center.x + cell.x, center.y + cell.y ) : cell;
+				if( grid.IsInBounds( cell ) )
+				{
+					ToggleBlock( grid, cell, (uint8_t) ( NextRandom( randomState ) & 1 ) );
+				}
+			}
+			bool hasChanges = history->GetUndoCount() > (int) checkpointHashes.size() - 1;
+			history->Checkpoint();
+			if( hasChanges )
+			{
+				checkpointHashes.push_back( grid.GetZobristHash() );
+				redoHashes.clear();
+				if( (int) checkpointHashes.size() - 1 > MAX_FRAMES )
+				{
+					checkpointHashes.erase( checkpointHashes.begin() + 1 );
+				}
+			}
+		}
+		else if( op < 8 )
+		{
+			int frameCount = op == 5 ? 1 : 1 + (int) ( NextRandom( randomState ) % 6 );
+			int undoneCount = frameCount == 1 ? ( history->Undo() ? 1 : 0 ) : history->Rewind( frameCount );
+			int expectedCount = std::min( frameCount, (int) checkpointHashes.size() - 1 );
+			*out_failureCount += undoneCount != expectedCount ? 1 : 0;
+			for( int frameIdx = 0; frameIdx < expectedCount; ++frameIdx )
+			{
+				redoHashes.push_back( checkpointHashes.back() );
+				checkpointHashes.pop_back();
+			}
+		}
+		else
+		{
+			int frameCount = op == 8 ? 1 : 1 + (int) ( NextRandom( randomState ) % 6 );
+			int redoneCount = frameCount == 1 ? ( history->Redo() ? 1 : 0 ) : history->Replay( frameCount );
+			int expectedCount = std::min( frameCount, (int) redoHashes.size() );
+			*out_failureCount += redoneCount != expectedCount ? 1 : 0;
+			for( int frameIdx = 0; frameIdx < expectedCount; ++frameIdx )
+			{
+				checkpointHashes.push_back( redoHashes.back() );
+				redoHashes.pop_back();
+			}
+		}
+
+		bool isHashRight = grid.GetZobristHash() == checkpointHashes.back() && grid.GetZobristHash() == ComputeZobristHash( grid );
+		bool isCountRight = history->GetUndoCount() == (int) checkpointHashes.size() - 1 && history->GetRedoCount() == (int) redoHashes.size();
+		*out_failureCount += isHashRight && isCountRight ? 0 : 1;
+		*out_failureCount += IsConnectivityRebuildEqual( grid ) ? 0 : 1;
+		*out_failureCount += IsShapeRescanEqual( grid ) ? 0 : 1;
+		*out_caseCount += 3;
+	}
+
+	history->RewindToStart();
+	*out_failureCount += grid.GetZobristHash() == checkpointHashes.front() && IsConnectivityRebuildEqual( grid ) ? 0 : 1;
+	++*out_caseCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* CheckLevelFile
+* A random board through BuildGridLevel and LoadLevelBlob comes back block
+* for block, trusted or not, and corrupted copies are turned down without
+* touching the Grid they were loaded into.
+*/
+static void CheckLevelFile( int* out_caseCount, int* out_failureCount )
+{
+	const IntVec2 BOARD_SIZE( 100, 70 );	// Edge chunks part off the board.
+
+	uint32_t randomState = 0x85EBCA6B;
+	Grid grid( BOARD_SIZE );
+	grid.AddPaletteColor( Rgba( 1.0f, 0.5f, 0.25f, 1.0f ) );
+	grid.AddPaletteColor( Rgba( 0.25f, 0.5f, 1.0f, 1.0f ) );
+	for( int blockIdx = 0; blockIdx < grid.GetCellCount() / 5; ++blockIdx )
+	{
+		uint8_t colorIndex = (uint8_t) ( NextRandom( randomState ) % (uint32_t) grid.GetPaletteSize() );
+		uint8_t material = (uint8_t) ( NextRandom( randomState ) % NUM_BLOCK_MATERIALS );
+		grid.PlaceBlock( Block( RandomCell( randomState, BOARD_SIZE ), colorIndex, material ) );
+	}
+	grid.RemoveBlock( IntVec2( BOARD_SIZE.x - 1, 0 ) );
+	grid.PlaceBlock( Block( IntVec2( BOARD_SIZE.x - 1, 0 ), 1, BLOCK_MATERIAL_STONE ) );
+
+	std::vector<uint8_t> blob;
+	BuildGridLevel( grid, &blob );
+	Grid loaded;
+	Grid trusted;
+	bool isLoaded = loaded.LoadLevelBlob( std::vector<uint8_t>( blob ) );
+	bool isTrustedLoaded = trusted.LoadLevelBlob( std::vector<uint8_t>( blob ), LEVEL_TRUSTED );
+	std::vector<IntVec2> cells;
+	grid.GetOccupiedCells( &cells );
+	for( const Grid* level : { &loaded, &trusted } )
+	{
+		bool isSame = ( level == &loaded ? isLoaded : isTrustedLoaded ) && level->GetZobristHash() == grid.GetZobristHash() && level->GetBlockCount() == grid.GetBlockCount()
+			&& level->GetZobristHash() == ComputeZobristHash( *level ) && level->GetPaletteSize() == grid.GetPaletteSize();
+		for( int cellIdx = 0; isSame && cellIdx < (int) cells.size(); ++cellIdx )
+		{
+			Block expected;
+			Block actual;
+			grid.GetBlock( cells[cellIdx], &expected );
+			isSame = level->GetBlock( cells[cellIdx], &actual ) && actual.colorIndex == expected.colorIndex && actual.material == expected.material && actual.flags == expected.flags;
+		}
+		*out_failureCount += isSame ? 0 : 1;
+		++*out_caseCount;
+	}
+	if( !isLoaded )
+	{
+		return;
+	}
+
+	const GridLevelHeader& header = *(const GridLevelHeader*) blob.data();
+	uint32_t chunkCountX = header.chunkCountX;
+	uint32_t imagesOffset = header.imagesOffset;
+	uint32_t edgeChunkOffset = header.chunkTableOffset + ( chunkCountX - 1 ) * (uint32_t) sizeof( GridLevelChunk );
+	auto tryCorrupted = [&]( auto corrupt )
+	{
+		std::vector<uint8_t> corrupted( blob );
+		corrupt( corrupted );
+		bool isRejected = !loaded.LoadLevelBlob( std::move( corrupted ) );
+		*out_failureCount += isRejected && loaded.GetZobristHash() == grid.GetZobristHash() && loaded.GetBlockCount() == grid.GetBlockCount() ? 0 : 1;
+		++*out_caseCount;
+	};
+
+	tryCorrupted( []( std::vector<uint8_t>& level ) { level.pop_back(); } );
+	tryCorrupted( []( std::vector<uint8_t>& level ) { ( (GridLevelHeader*) level.data() )->zobristHash ^= 1; } );
+	tryCorrupted( []( std::vector<uint8_t>& level ) { ( (GridLevelHeader*) level.data() )->blockCount += 1; } );
+	tryCorrupted( []( std::vector<uint8_t>& level ) { ( (GridLevelHeader*) level.data() )->width += GRID_CHUNK_SIZE; } );
+
+	// The block at the bottom right, in the edge chunk. Corruptions keep the
+	// stored hash consistent so only the check under test can catch them.
+	const IntVec2 edgeCell( BOARD_SIZE.x - 1, 0 );
+	const int edgeLocalX = edgeCell.x & GRID_CHUNK_MASK;
+	Block edgeBlock;
+	grid.GetBlock( edgeCell, &edgeBlock );
+	auto getEdgeImage = [&]( std::vector<uint8_t>& level )
+	{
+		const GridLevelChunk* entry = (const GridLevelChunk*) &level[edgeChunkOffset];
+		return (GridChunkCells*) &level[imagesOffset + entry->imageIndex * sizeof( GridChunkCells )];
+	};
+
+	// Palette index past the palette on a block.
+	tryCorrupted( [&]( std::vector<uint8_t>& level )
+	{
+		uint8_t badColorIndex = (uint8_t) grid.GetPaletteSize();
+		getEdgeImage( level )->colorIndices[edgeLocalX] = badColorIndex;
+		( (GridLevelHeader*) level.data() )->zobristHash ^= Grid::GetZobristKey( edgeCell.x, edgeBlock.colorIndex, edgeBlock.material, edgeBlock.flags )
+			^ Grid::GetZobristKey( edgeCell.x, badColorIndex, edgeBlock.material, edgeBlock.flags );
+	} );
+
+	// The block moved one cell past the board edge, keeping the popcount.
+	tryCorrupted( [&]( std::vector<uint8_t>& level )
+	{
+		GridChunkCells* cells = getEdgeImage( level );
+		cells->occupancy[0] = ( cells->occupancy[0] & ~( 1u << edgeLocalX ) ) | ( 1u << ( edgeLocalX + 1 ) );
+		cells->colorIndices[edgeLocalX + 1] = edgeBlock.colorIndex;
+		cells->materials[edgeLocalX + 1] = edgeBlock.material;
+		cells->flags[edgeLocalX + 1] = edgeBlock.flags;
+		( (GridLevelHeader*) level.data() )->zobristHash ^= Grid::GetZobristKey( edgeCell.x, edgeBlock.colorIndex, edgeBlock.material, edgeBlock.flags )
+			^ Grid::GetZobristKey( edgeCell.x + 1, edgeBlock.colorIndex, edgeBlock.material, edgeBlock.flags );
+	} );
+
+	// The chunk table's block count out of step with its image.
+	tryCorrupted( [&]( std::vector<uint8_t>& level )
+	{
+		GridLevelChunk* entry = (GridLevelChunk*) &level[edgeChunkOffset];
+		entry->blockCount += 1;
+		( (GridLevelHeader*) level.data() )->blockCount += 1;
+	} );
+
+	// The edge chunk sharing the first chunk's image, which is checked first
+	// and has blocks all the way across, so some now sit past the board edge.
+	tryCorrupted( [&]( std::vector<uint8_t>& level )
+	{
+		GridLevelHeader* levelHeader = (GridLevelHeader*) level.data();
+		const GridLevelChunk* firstEntry = (const GridLevelChunk*) &level[levelHeader->chunkTableOffset];
+		GridLevelChunk* edgeEntry = (GridLevelChunk*) &level[edgeChunkOffset];
+		const GridChunkCells* sharedCells = (const GridChunkCells*) &level[imagesOffset + firstEntry->imageIndex * sizeof( GridChunkCells )];
+		const GridChunkCells* edgeCells = getEdgeImage( level );
+		const int edgeOriginX = (int) ( chunkCountX - 1 ) << GRID_CHUNK_SIZE_BITS;
+		for( const GridChunkCells* cells : { edgeCells, sharedCells } )
+		{
+			for( int localIndex = 0; localIndex < GRID_CHUNK_CELL_COUNT; ++localIndex )
+			{
+				int localX = localIndex & GRID_CHUNK_MASK;
+				int localY = localIndex >> GRID_CHUNK_SIZE_BITS;
+				if( ( cells->occupancy[localY] & ( 1u << localX ) ) != 0 )
+				{
+					levelHeader->zobristHash ^= Grid::GetZobristKey( localY * BOARD_SIZE.x + edgeOriginX + localX, cells->colorIndices[localIndex], cells->materials[localIndex], cells->flags[localIndex] );
+				}
+			}
+		}
+		levelHeader->blockCount += firstEntry->blockCount - edgeEntry->blockCount;
+		*edgeEntry = *firstEntry;
+	} );
+}
+
+//--------------------------------------------------------------------------
+/**
+* TimerCheckRecord
+*/
+struct TimerCheckRecord
+{
+	const TimerWheel* wheel = nullptr;
+	uint64_t dueTick = 0;
+	uint64_t firedTick = 0;
+	int fireCount = 0;
+	bool isCancelled = false;
+};
+
+//--------------------------------------------------------------------------
+/**
+* OnCheckTimerFired
+*/
+static void OnCheckTimerFired( void* userData )
+{
+	TimerCheckRecord* record = (TimerCheckRecord*) userData;
+	record->firedTick = record->wheel->GetCurrentTick();
+	++record->fireCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* CheckTimerWheel
+* One shot timers from one tick to past the third level, scheduled in
+* rounds so later ones start mid wheel, some cancelled. Every timer has to
+* fire once on its due tick, cancelled ones never. One second ticks keep
+* the float delays exact.
+*/
+static void CheckTimerWheel( int* out_caseCount, int* out_failureCount )
+{
+	const int ROUNDS = 3;
+	const int TIMERS_PER_ROUND = 800;
+
+	uint32_t randomState = 0xC2B2AE35;
+	TimerWheel wheel( 1.0f );
+	std::vector<TimerCheckRecord> records( (size_t) ( ROUNDS * TIMERS_PER_ROUND ) );
+	for( int roundIdx = 0; roundIdx < ROUNDS; ++roundIdx )
+	{
+		std::vector<TimerHandle> handles;
+		for( int timerIdx = 0; timerIdx < TIMERS_PER_ROUND; ++timerIdx )
+		{
+			TimerCheckRecord& record = records[roundIdx * TIMERS_PER_ROUND + timerIdx];
+			uint32_t maxDelay = timerIdx % 4 == 0 ? 300000u : 5000u;
+			uint64_t delayTicks = 1 + NextRandom( randomState ) % maxDelay;
+			record.wheel = &wheel;
+			record.dueTick = wheel.GetCurrentTick() + delayTicks;
+			handles.push_back( wheel.Schedule( (float) delayTicks, OnCheckTimerFired, &record ) );
+		}
+		for( int timerIdx = 0; timerIdx < TIMERS_PER_ROUND; timerIdx += 7 )
+		{
+			records[roundIdx * TIMERS_PER_ROUND + timerIdx].isCancelled = true;
+			*out_failureCount += wheel.Cancel( handles[timerIdx] ) ? 0 : 1;
+		}
+
+		// Part of the way through, so the next round lands on a turning wheel.
+		uint64_t stopTick = wheel.GetCurrentTick() + ( roundIdx + 1 < ROUNDS ? 150000 : 400000 );
+		while( wheel.GetCurrentTick() < stopTick )
+		{
+			wheel.Advance( (float) ( 1 + NextRandom( randomState ) % 3000 ) );
+		}
+	}
+
+	*out_failureCount += wheel.GetPendingCount() != 0 ? 1 : 0;
+	for( const TimerCheckRecord& record : records )
+	{
+		bool isRight = record.isCancelled ? record.fireCount == 0 : record.fireCount == 1 && record.firedTick == record.dueTick;
+		*out_failureCount += isRight ? 0 : 1;
+		++*out_caseCount;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* CheckInputJournal
+* Events with tick gaps from zero to a few thousand, so every varint length
+* gets written, read back in order with the final tick and hash, and the
+* start entity count set after recording began.
+*/
+static void CheckInputJournal( int* out_caseCount, int* out_failureCount )
+{
+	const uint64_t SEED = 0x0123456789ABCDEFull;
+	const uint64_t STATE_HASH = 0xFEDCBA9876543210ull;
+	const int START_ENTITY_COUNT = 500;
+
+	uint32_t randomState = 0x27D4EB2F;
+	std::vector<InputEvent> events;
+	uint64_t tick = 0;
+	for( int eventIdx = 0; eventIdx < 2000; ++eventIdx )
+	{
+		uint32_t gapKind = NextRandom( randomState ) % 4;
+		tick += gapKind == 0 ? 0 : NextRandom( randomState ) % ( gapKind == 3 ? 20000u : 100u );
+		InputEvent event;
+		event.tick = tick;
+		event.type = (eInputEventType) ( NextRandom( randomState ) % INPUT_EVENT_END );
+		event.code = (uint8_t) NextRandom( randomState );
+		events.push_back( event );
+	}
+	uint64_t finalTick = tick + 10;
+
+	InputJournal recorder;
+	bool isWritten = recorder.BeginRecording( CHECK_JOURNAL_PATH, SEED, 1.0f / 60.0f );
+	for( const InputEvent& event : events )
+	{
+		recorder.Record( event.tick, event.type, event.code );
+	}
+	recorder.SetStartEntityCount( START_ENTITY_COUNT );
+	isWritten = recorder.EndRecording( finalTick, STATE_HASH ) && isWritten;
+
+	InputJournal player;
+	bool isRead = isWritten && player.LoadForReplay( CHECK_JOURNAL_PATH );
+	remove( CHECK_JOURNAL_PATH );
+	bool isRight = isRead && player.GetSeed() == SEED && player.GetTickSeconds() == 1.0f / 60.0f && player.GetFinalTick() == finalTick
+		&& player.GetFinalStateHash() == STATE_HASH && player.GetEventCount() == (int) events.size() && player.GetStartEntityCount() == START_ENTITY_COUNT;
+	*out_failureCount += isRight ? 0 : 1;
+	++*out_caseCount;
+	if( !isRight )
+	{
+		return;
+	}
+
+	size_t nextEvent = 0;
+	InputEvent event;
+	for( uint64_t replayTick = 0; replayTick <= finalTick; ++replayTick )
+	{
+		while( player.PopEventForTick( replayTick, &event ) )
+		{
+			const InputEvent* expected = nextEvent < events.size() ? &events[nextEvent] : nullptr;
+			isRight = expected != nullptr && expected->tick == replayTick && expected->type == event.type && expected->code == event.code;
+			*out_failureCount += isRight ? 0 : 1;
+			++*out_caseCount;
+			++nextEvent;
+		}
+	}
+	*out_failureCount += nextEvent == events.size() ? 0 : 1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* CheckTranspositionCache
+* Random finds and inserts against a list based LRU, with keys spread over
+* the table and with keys that all share one home slot, so probing and
+* backward shift deletion get exercised. Results, sizes and hit counts have
+* to agree.
+*/
+static void CheckTranspositionCache( int* out_caseCount, int* out_failureCount )
+{
+	const int CAPACITY = 61;
+
+	uint32_t randomState = 0x165667B1;
+	for( int keyKind = 0; keyKind < 2; ++keyKind )
+	{
+		TranspositionCache cache( CAPACITY );
+		std::list<std::pair<uint64_t, int>> reference;		// Newest first.
+		uint64_t referenceHits = 0;
+		for( int opIdx = 0; opIdx < 20000; ++opIdx )
+		{
+			uint64_t keyIndex = NextRandom( randomState ) % ( 3 * CAPACITY );
+			uint64_t key = keyKind == 0 ? SplitMix64( keyIndex ) : ( keyIndex + 1 ) << 40;
+			auto found = std::find_if( reference.begin(), reference.end(), [key]( const std::pair<uint64_t, int>& entry ) { return entry.first == key; } );
+
+			if( NextRandom( randomState ) & 1 )
+			{
+				BuildEvaluation evaluation;
+				bool isFound = cache.Find( key, &evaluation );
+				bool isRight = isFound == ( found != reference.end() ) && ( !isFound || evaluation.matchedCells == found->second );
+				*out_failureCount += isRight ? 0 : 1;
+				if( found != reference.end() )
+				{
+					++referenceHits;
+					reference.splice( reference.begin(), reference, found );
+				}
+			}
+			else
+			{
+				BuildEvaluation evaluation;
+				evaluation.matchedCells = opIdx;
+				cache.Insert( key, evaluation );
+				if( found != reference.end() )
+				{
+					reference.erase( found );
+				}
+				reference.emplace_front( key, opIdx );
+				if( (int) reference.size() > CAPACITY )
+				{
+					reference.pop_back();
+				}
+			}
+			*out_failureCount += cache.GetSize() != (int) reference.size() ? 1 : 0;
+			++*out_caseCount;
+		}
+		*out_failureCount += cache.GetStats().hits != referenceHits ? 1 : 0;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* CheckBuildEvaluator
+* Cached and uncached evaluations against a cell by cell count, after
+* random placements and removals. Each change is undone half the time, so
+* boards come back and have to be found in the cache.
+*/
+static void CheckBuildEvaluator( int* out_caseCount, int* out_failureCount )
+{
+	const IntVec2 BOARD_SIZE( 130, 50 );	// Rows end mid word.
+
+	uint32_t randomState = 0x3C6EF372;
+	std::vector<IntVec2> targetCells;
+	std::vector<bool> isTarget( (size_t) ( BOARD_SIZE.x * BOARD_SIZE.y ), false );
+	for( int targetIdx = 0; targetIdx < BOARD_SIZE.x * BOARD_SIZE.y / 5; ++targetIdx )
+	{
+		IntVec2 cell = RandomCell( randomState, BOARD_SIZE );
+		targetCells.push_back( cell );
+		isTarget[cell.y * BOARD_SIZE.x + cell.x] = true;
+	}
+	int targetCellCount = (int) std::count( isTarget.begin(), isTarget.end(), true );
+
+	SharedTranspositionCache cache( 1024, 4 );
+	BuildEvaluator cached( &cache );
+	BuildEvaluator uncached;
+	cached.SetTarget( BOARD_SIZE, targetCells );
+	uncached.SetTarget( BOARD_SIZE, targetCells );
+
+	Grid grid( BOARD_SIZE );
+	grid.EnableConnectivity();
+	for( int changeIdx = 0; changeIdx < 3000; ++changeIdx )
+	{
+		IntVec2 cell = RandomCell( randomState, BOARD_SIZE );
+		ToggleBlock( grid, cell, 0 );
+		if( NextRandom( randomState ) & 1 )
+		{
+			ToggleBlock( grid, cell, 0 );
+		}
+
+		BuildEvaluation expected;
+		for( int y = 0; y < BOARD_SIZE.y; ++y )
+		{
+			for( int x = 0; x < BOARD_SIZE.x; ++x )
+			{
+				bool isOccupied = grid.IsOccupied( IntVec2( x, y ) );
+				expected.matchedCells += isOccupied && isTarget[y * BOARD_SIZE.x + x] ? 1 : 0;
+				expected.extraBlocks += isOccupied && !isTarget[y * BOARD_SIZE.x + x] ? 1 : 0;
+			}
+		}
+		expected.missingCells = targetCellCount - expected.matchedCells;
+		expected.floatingStructures = grid.GetConnectivity()->GetFloatingComponentCount();
+		expected.UpdateScore( targetCellCount );
+
+		for( const BuildEvaluation& actual : { cached.Evaluate( grid ), uncached.Evaluate( grid ) } )
+		{
+			bool isRight = actual.matchedCells == expected.matchedCells && actual.missingCells == expected.missingCells && actual.extraBlocks == expected.extraBlocks
+				&& actual.floatingStructures == expected.floatingStructures && actual.score == expected.score;
+			*out_failureCount += isRight ? 0 : 1;
+			++*out_caseCount;
+		}
+	}
+	*out_failureCount += cached.GetTargetCellCount() == targetCellCount && cache.GetStats().hits > 0 ? 0 : 1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* JobGraphCheckRecord
+* Nodes 0 to 3 are the diamond's top, sides and bottom.
+*/
+struct JobGraphCheckRecord
+{
+	static constexpr int RANGE_COUNT = 1000;
+
+	std::atomic<int> nextStamp { 1 };
+	std::atomic<int> nodeStamps[4] {};			// Order each node ran in, 0 until it has.
+	std::atomic<int> rangeVisits[RANGE_COUNT] {};
+	std::atomic<int> earlyBatchCount { 0 };		// Batches run before the bottom.
+	int tailVisitCount = 0;						// Indices visited once when the tail ran.
+};
+
+struct JobGraphCheckNode
+{
+	JobGraphCheckRecord* record = nullptr;
+	int nodeIndex = 0;
+};
+
+//--------------------------------------------------------------------------
+/**
+* RunJobGraphCheckNode
+*/
+static void RunJobGraphCheckNode( void* userData )
+{
+	JobGraphCheckNode* node = (JobGraphCheckNode*) userData;
+	node->record->nodeStamps[node->nodeIndex].store( node->record->nextStamp.fetch_add( 1 ) );
+}
+
+//--------------------------------------------------------------------------
+/**
+* RunJobGraphCheckRange
+*/
+static void RunJobGraphCheckRange( void* userData, int beginIndex, int endIndex )
+{
+	JobGraphCheckRecord* record = (JobGraphCheckRecord*) userData;
+	if( record->nodeStamps[3].load() == 0 )
+	{
+		record->earlyBatchCount.fetch_add( 1 );
+	}
+	for( int rangeIdx = beginIndex; rangeIdx < endIndex; ++rangeIdx )
+	{
+		record->rangeVisits[rangeIdx].fetch_add( 1 );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* RunJobGraphCheckTail
+*/
+static void RunJobGraphCheckTail( void* userData )
+{
+	JobGraphCheckRecord* record = (JobGraphCheckRecord*) userData;
+	for( int rangeIdx = 0; rangeIdx < JobGraphCheckRecord::RANGE_COUNT; ++rangeIdx )
+	{
+		record->tailVisitCount += record->rangeVisits[rangeIdx].load() == 1 ? 1 : 0;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* CheckJobGraph
+* A diamond (top, two sides, bottom), a ParallelFor that depends on the
+* bottom, and a tail added by hand after both, on a few workers. Every job
+* has to run after the ones it depends on, and the tail after every batch.
+* Rounds vary the batch size and race dependencies against finishing jobs.
+*/
+static void CheckJobGraph( int* out_caseCount, int* out_failureCount )
+{
+	const int ROUNDS = 200;
+
+	JobSystem jobSystem( 3 );
+	for( int roundIdx = 0; roundIdx < ROUNDS; ++roundIdx )
+	{
+		JobGraphCheckRecord record;
+		JobGraphCheckNode nodes[4];
+		for( int nodeIdx = 0; nodeIdx < 4; ++nodeIdx )
+		{
+			nodes[nodeIdx].record = &record;
+			nodes[nodeIdx].nodeIndex = nodeIdx;
+		}
+
+		JobHandle top = jobSystem.Schedule( "CheckGraphTop", RunJobGraphCheckNode, &nodes[0] );
+		JobHandle sides[2];
+		sides[0] = jobSystem.Schedule( "CheckGraphSide", RunJobGraphCheckNode, &nodes[1], &top, 1 );
+		sides[1] = jobSystem.Schedule( "CheckGraphSide", RunJobGraphCheckNode, &nodes[2], &top, 1 );
+		JobHandle bottom = jobSystem.Schedule( "CheckGraphBottom", RunJobGraphCheckNode, &nodes[3], sides, 2 );
+		JobHandle range = jobSystem.ParallelFor( "CheckGraphRange", JobGraphCheckRecord::RANGE_COUNT, 1 + roundIdx % 64, RunJobGraphCheckRange, &record, &bottom, 1 );
+		JobHandle tail = jobSystem.CreateJob( "CheckGraphTail", RunJobGraphCheckTail, &record );
+		jobSystem.AddDependency( tail, range );
+		jobSystem.AddDependency( tail, bottom );
+		jobSystem.Submit( tail );
+		jobSystem.Wait( tail );
+
+		int stamps[4];
+		for( int nodeIdx = 0; nodeIdx < 4; ++nodeIdx )
+		{
+			stamps[nodeIdx] = record.nodeStamps[nodeIdx].load();
+		}
+		bool isOrdered = stamps[0] != 0 && stamps[0] < stamps[1] && stamps[0] < stamps[2] && stamps[1] < stamps[3] && stamps[2] < stamps[3];
+		*out_failureCount += isOrdered ? 0 : 1;
+		++*out_caseCount;
+
+		bool isRangeAfter = record.earlyBatchCount.load() == 0 && record.tailVisitCount == JobGraphCheckRecord::RANGE_COUNT;
+		*out_failureCount += isRangeAfter ? 0 : 1;
+		++*out_caseCount;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* RunChecks
+*/
+int RunChecks()
+{
+	struct CheckEntry
+	{
+		const char* name;
+		void (*run)( int* out_caseCount, int* out_failureCount );
+	};
+	const CheckEntry checks[] =
+	{
+		{ "piece placement",	CheckPiecePlacement },
+		{ "shape matches",		CheckShapeMatches },
+		{ "connectivity",		CheckConnectivity },
+		{ "history",			CheckHistory },
+		{ "level file",			CheckLevelFile },
+		{ "timer wheel",		CheckTimerWheel },
+		{ "input journal",		CheckInputJournal },
+		{ "transposition cache",	CheckTranspositionCache },
+		{ "build evaluator",	CheckBuildEvaluator },
+		{ "job graph",			CheckJobGraph },
+	};
+
+	BenchmarkPrint( "check                   cases  failures" );
+	int totalFailures = 0;
+	for( const CheckEntry& check : checks )
+	{
+		int caseCount = 0;
+		int failureCount = 0;
+		check.run( &caseCount, &failureCount );
+		ReportCheck( check.name, caseCount, failureCount );
+		totalFailures += failureCount;
+	}
+	return totalFailures;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Command_RunChecks
+*/
+bool Command_RunChecks( EventArgs& args )
+{
+	UNUSED( args );
+	RunChecks();
+	return true;
+}
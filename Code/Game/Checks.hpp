@@ -0,0 +1,10 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+
+//--------------------------------------------------------------------------
+// Correctness checks for the incremental and bit parallel code paths, each
+// against the slow way of getting the same answer on randomized input.
+// Output goes through BenchmarkPrint. Returns how many cases failed.
+//--------------------------------------------------------------------------
+int RunChecks();
+bool Command_RunChecks( EventArgs& args );
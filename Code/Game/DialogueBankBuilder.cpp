@@ -0,0 +1,231 @@
+#include "Game/DialogueBankBuilder.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Benchmarks.hpp"
+
+#include "Engine/Core/XML/XMLUtils.hpp"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+//--------------------------------------------------------------------------
+/**
+* Intern
+*/
+DialogueLineId DialogueBankBuilder::Intern( std::string_view text )
+{
+	std::string key( text );
+	auto found = m_lookup.find( key );
+	if( found != m_lookup.end() )
+	{
+		return found->second;
+	}
+
+	DialogueLineId lineId = (DialogueLineId) m_lines.size();
+	m_lines.push_back( key );
+	m_lookup.emplace( std::move( key ), lineId );
+	return lineId;
+}
+
+//--------------------------------------------------------------------------
+/**
+* AddLine
+* Banks are created the first time they're named.
+*/
+DialogueLineId DialogueBankBuilder::AddLine( std::string_view bankName, std::string_view text )
+{
+	DialogueLineId nameLineId = Intern( bankName );
+	BankLines* bank = nullptr;
+	for( BankLines& existing : m_banks )
+	{
+		if( existing.nameLineId == nameLineId )
+		{
+			bank = &existing;
+			break;
+		}
+	}
+	if( bank == nullptr )
+	{
+		m_banks.push_back( BankLines{ nameLineId, {} } );
+		bank = &m_banks.back();
+	}
+
+	DialogueLineId lineId = Intern( text );
+	bank->lineIds.push_back( lineId );
+	return lineId;
+}
+
+//--------------------------------------------------------------------------
+/**
+* AddKey
+* A later key with the same name replaces the earlier one.
+*/
+void DialogueBankBuilder::AddKey( std::string_view key, DialogueLineId lineId )
+{
+	DialogueLineId keyLineId = Intern( key );
+	for( DialogueBankKey& existing : m_keys )
+	{
+		if( existing.keyLineId == keyLineId )
+		{
+			existing.lineId = lineId;
+			return;
+		}
+	}
+	m_keys.push_back( DialogueBankKey{ keyLineId, lineId } );
+}
+
+//--------------------------------------------------------------------------
+/**
+* AddFromXml
+*/
+bool DialogueBankBuilder::AddFromXml( const std::string& xmlPath )
+{
+	tinyxml2::XMLDocument document;
+	if( document.LoadFile( xmlPath.c_str() ) != tinyxml2::XML_SUCCESS )
+	{
+		return false;
+	}
+	const XmlElement* root = document.RootElement();
+	if( root == nullptr )
+	{
+		return false;
+	}
+
+	for( const XmlElement* bankElement = root->FirstChildElement( "Bank" ); bankElement != nullptr; bankElement = bankElement->NextSiblingElement( "Bank" ) )
+	{
+		const char* bankName = bankElement->Attribute( "name" );
+		if( bankName == nullptr )
+		{
+			ERROR_RECOVERABLE( "Dialogue bank without a name in " + xmlPath );
+			continue;
+		}
+
+		for( const XmlElement* lineElement = bankElement->FirstChildElement( "Line" ); lineElement != nullptr; lineElement = lineElement->NextSiblingElement( "Line" ) )
+		{
+			const char* text = lineElement->GetText();
+			DialogueLineId lineId = AddLine( bankName, text ? text : "" );
+
+			const char* key = lineElement->Attribute( "key" );
+			if( key != nullptr )
+			{
+				AddKey( key, lineId );
+			}
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Build
+*/
+void DialogueBankBuilder::Build( std::vector<uint8_t>* out_blob ) const
+{
+	DialogueBankHeader header;
+	memset( &header, 0, sizeof( header ) );
+	header.magic = DIALOGUE_BANK_MAGIC;
+	header.version = DIALOGUE_BANK_VERSION;
+
+	std::vector<DialogueBankLine> lines;
+	std::vector<char> text;
+	lines.reserve( m_lines.size() );
+	for( const std::string& line : m_lines )
+	{
+		lines.push_back( DialogueBankLine{ (uint32_t) text.size(), (uint32_t) line.size() } );
+		text.insert( text.end(), line.begin(), line.end() );
+		text.push_back( '\0' );
+		header.maxLineLength = std::max( header.maxLineLength, (uint32_t) line.size() );
+	}
+	if( text.empty() )
+	{
+		text.push_back( '\0' );
+	}
+
+	std::vector<DialogueBankEntry> banks;
+	std::vector<DialogueLineId> bankLineIds;
+	for( const BankLines& bank : m_banks )
+	{
+		banks.push_back( DialogueBankEntry{ bank.nameLineId, (uint32_t) bankLineIds.size(), (uint32_t) bank.lineIds.size() } );
+		bankLineIds.insert( bankLineIds.end(), bank.lineIds.begin(), bank.lineIds.end() );
+	}
+
+	std::vector<DialogueBankKey> keys = m_keys;
+	std::sort( keys.begin(), keys.end(), [this]( const DialogueBankKey& a, const DialogueBankKey& b ) { return m_lines[a.keyLineId] < m_lines[b.keyLineId]; } );
+
+	uint32_t offset = (uint32_t) sizeof( DialogueBankHeader );
+	header.lineCount = (uint32_t) lines.size();
+	header.linesOffset = offset;
+	offset += header.lineCount * (uint32_t) sizeof( DialogueBankLine );
+	header.bankCount = (uint32_t) banks.size();
+	header.banksOffset = offset;
+	offset += header.bankCount * (uint32_t) sizeof( DialogueBankEntry );
+	header.bankLineIdCount = (uint32_t) bankLineIds.size();
+	header.bankLineIdsOffset = offset;
+	offset += header.bankLineIdCount * (uint32_t) sizeof( DialogueLineId );
+	header.keyCount = (uint32_t) keys.size();
+	header.keysOffset = offset;
+	offset += header.keyCount * (uint32_t) sizeof( DialogueBankKey );
+	header.textBytes = (uint32_t) text.size();
+	header.textOffset = offset;
+	header.totalBytes = offset + header.textBytes;
+
+	out_blob->assign( header.totalBytes, 0 );
+	uint8_t* blob = out_blob->data();
+	memcpy( blob, &header, sizeof( header ) );
+	memcpy( blob + header.linesOffset, lines.data(), lines.size() * sizeof( DialogueBankLine ) );
+	memcpy( blob + header.banksOffset, banks.data(), banks.size() * sizeof( DialogueBankEntry ) );
+	memcpy( blob + header.bankLineIdsOffset, bankLineIds.data(), bankLineIds.size() * sizeof( DialogueLineId ) );
+	memcpy( blob + header.keysOffset, keys.data(), keys.size() * sizeof( DialogueBankKey ) );
+	memcpy( blob + header.textOffset, text.data(), text.size() );
+}
+
+//--------------------------------------------------------------------------
+/**
+* WriteToFile
+*/
+bool DialogueBankBuilder::WriteToFile( const std::string& bankPath ) const
+{
+	std::vector<uint8_t> blob;
+	Build( &blob );
+
+	FILE* file = fopen( bankPath.c_str(), "wb" );
+	if( file == nullptr )
+	{
+		return false;
+	}
+	size_t written = fwrite( blob.data(), 1, blob.size(), file );
+	fclose( file );
+	return written == blob.size();
+}
+
+//--------------------------------------------------------------------------
+/**
+* CompileDialogueBank
+*/
+bool CompileDialogueBank( const std::string& xmlPath, const std::string& bankPath )
+{
+	DialogueBankBuilder builder;
+	if( !builder.AddFromXml( xmlPath ) )
+	{
+		BenchmarkPrint( "Could not read dialogue from " + xmlPath );
+		return false;
+	}
+	if( !builder.WriteToFile( bankPath ) )
+	{
+		BenchmarkPrint( "Could not write dialogue bank " + bankPath );
+		return false;
+	}
+	BenchmarkPrint( "Compiled " + std::to_string( builder.GetLineCount() ) + " dialogue lines to " + bankPath );
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Command_CompileDialogue
+* dialogue_compile [xml=Data/Dialogue/Dialogue.xml] [bank=Data/Dialogue/Dialogue.dlgb]
+*/
+bool Command_CompileDialogue( EventArgs& args )
+{
+	CompileDialogueBank( args.GetValue( "xml", DIALOGUE_XML_PATH ), args.GetValue( "bank", DIALOGUE_BANK_PATH ) );
+	return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include "Game/DialogueTable.hpp"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+constexpr const char* DIALOGUE_XML_PATH = "Data/Dialogue/Dialogue.xml";
+constexpr const char* DIALOGUE_BANK_PATH = "Data/Dialogue/Dialogue.dlgb";
+
+//--------------------------------------------------------------------------
+// Offline side of the dialogue banks: collects lines from authored XML,
+// interns them and lays them out in the DialogueTable blob format.
+//
+// <DialogueBanks>
+//   <Bank name="good">
+//     <Line>Great!</Line>
+//     <Line key="greeting">hello, you ready?</Line>
+//   </Bank>
+// </DialogueBanks>
+//
+// A line with a key can also be fetched by that key.
+//--------------------------------------------------------------------------
+class DialogueBankBuilder
+{
+public:
+	DialogueLineId Intern( std::string_view text );
+	DialogueLineId AddLine( std::string_view bankName, std::string_view text );
+	void AddKey( std::string_view key, DialogueLineId lineId );
+	bool AddFromXml( const std::string& xmlPath );
+
+	void Build( std::vector<uint8_t>* out_blob ) const;
+	bool WriteToFile( const std::string& bankPath ) const;
+
+	int GetLineCount() const { return (int) m_lines.size(); }
+
+private:
+	struct BankLines
+	{
+		DialogueLineId nameLineId;
+		std::vector<DialogueLineId> lineIds;
+	};
+
+	std::vector<std::string> m_lines;
+	std::unordered_map<std::string, DialogueLineId> m_lookup;
+	std::vector<BankLines> m_banks;
+	std::vector<DialogueBankKey> m_keys;
+};
+
+bool CompileDialogueBank( const std::string& xmlPath, const std::string& bankPath );
+bool Command_CompileDialogue( EventArgs& args );
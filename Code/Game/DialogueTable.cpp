@@ -0,0 +1,253 @@
+#include "Game/DialogueTable.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/GameRandom.hpp"
+
+//--------------------------------------------------------------------------
+/**
+* LoadFromFile
+*/
+bool DialogueTable::LoadFromFile( const std::string& bankPath )
+{
+	Clear();
+	if( !m_mappedFile.Open( bankPath ) )
+	{
+		return false;
+	}
+	if( !Bind( m_mappedFile.GetData(), m_mappedFile.GetSize() ) )
+	{
+		Clear();
+		return false;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* LoadFromBlob
+* Takes ownership of a blob built in memory, the layout is the same as the
+* file.
+*/
+bool DialogueTable::LoadFromBlob( std::vector<uint8_t>&& blob )
+{
+	Clear();
+	m_ownedBlob = std::move( blob );
+	if( !Bind( m_ownedBlob.data(), m_ownedBlob.size() ) )
+	{
+		Clear();
+		return false;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Clear
+*/
+void DialogueTable::Clear()
+{
+	m_mappedFile.Close();
+	m_ownedBlob.clear();
+	m_header = nullptr;
+	m_lines = nullptr;
+	m_banks = nullptr;
+	m_bankLineIds = nullptr;
+	m_keys = nullptr;
+	m_text = nullptr;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsSectionInBlob
+*/
+static bool IsSectionInBlob( size_t blobSize, uint32_t offset, uint32_t count, size_t recordSize )
+{
+	return ( offset % 4 ) == 0 && (uint64_t) offset + (uint64_t) count * recordSize <= (uint64_t) blobSize;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Bind
+* Checks the header and that every section fits in the blob, then points
+* straight into it. Individual records are range checked when read.
+*/
+bool DialogueTable::Bind( const uint8_t* data, size_t size )
+{
+	if( size < sizeof( DialogueBankHeader ) )
+	{
+		return false;
+	}
+
+	const DialogueBankHeader* header = (const DialogueBankHeader*) data;
+	if( header->magic != DIALOGUE_BANK_MAGIC || header->version != DIALOGUE_BANK_VERSION || header->totalBytes != size )
+	{
+		return false;
+	}
+	if( !IsSectionInBlob( size, header->linesOffset, header->lineCount, sizeof( DialogueBankLine ) )
+		|| !IsSectionInBlob( size, header->banksOffset, header->bankCount, sizeof( DialogueBankEntry ) )
+		|| !IsSectionInBlob( size, header->bankLineIdsOffset, header->bankLineIdCount, sizeof( DialogueLineId ) )
+		|| !IsSectionInBlob( size, header->keysOffset, header->keyCount, sizeof( DialogueBankKey ) )
+		|| (uint64_t) header->textOffset + header->textBytes > (uint64_t) size
+		|| header->textBytes == 0 || data[header->textOffset + header->textBytes - 1] != '\0' )
+	{
+		return false;
+	}
+
+	m_header = header;
+	m_lines = (const DialogueBankLine*) ( data + header->linesOffset );
+	m_banks = (const DialogueBankEntry*) ( data + header->banksOffset );
+	m_bankLineIds = (const DialogueLineId*) ( data + header->bankLineIdsOffset );
+	m_keys = (const DialogueBankKey*) ( data + header->keysOffset );
+	m_text = (const char*) ( data + header->textOffset );
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetLine
+*/
+std::string_view DialogueTable::GetLine( DialogueLineId lineId ) const
+{
+	if( m_header == nullptr || lineId >= m_header->lineCount )
+	{
+		return std::string_view();
+	}
+	const DialogueBankLine& line = m_lines[lineId];
+	if( (uint64_t) line.textOffset + line.length >= m_header->textBytes )
+	{
+		return std::string_view();
+	}
+	return std::string_view( m_text + line.textOffset, line.length );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetLineCString
+*/
+const char* DialogueTable::GetLineCString( DialogueLineId lineId ) const
+{
+	std::string_view line = GetLine( lineId );
+	return line.empty() ? "" : line.data();
+}
+
+//--------------------------------------------------------------------------
+/**
+* FindBank
+* Returns -1 when there is no bank with that name.
+*/
+int DialogueTable::FindBank( std::string_view bankName ) const
+{
+	for( int bankIdx = 0; bankIdx < GetBankCount(); ++bankIdx )
+	{
+		if( GetLine( m_banks[bankIdx].nameLineId ) == bankName )
+		{
+			return bankIdx;
+		}
+	}
+	return -1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetBankSize
+*/
+int DialogueTable::GetBankSize( int bankIndex ) const
+{
+	if( bankIndex < 0 || bankIndex >= GetBankCount() )
+	{
+		return 0;
+	}
+	const DialogueBankEntry& bank = m_banks[bankIndex];
+	if( (uint64_t) bank.firstLineIdIndex + bank.lineIdCount > m_header->bankLineIdCount )
+	{
+		return 0;
+	}
+	return (int) bank.lineIdCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetBankLine
+*/
+DialogueLineId DialogueTable::GetBankLine( int bankIndex, int index ) const
+{
+	if( index < 0 || index >= GetBankSize( bankIndex ) )
+	{
+		return INVALID_DIALOGUE_LINE;
+	}
+	return m_bankLineIds[m_banks[bankIndex].firstLineIdIndex + (uint32_t) index];
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetRandomLine
+* Uniform over the bank, drawn from the caller's stream.
+*/
+DialogueLineId DialogueTable::GetRandomLine( int bankIndex, RandomStream& random ) const
+{
+	int bankSize = GetBankSize( bankIndex );
+	ASSERT_RECOVERABLE( bankSize > 0, "dialogue bank empty " );
+	if( bankSize == 0 )
+	{
+		return INVALID_DIALOGUE_LINE;
+	}
+
+	return GetBankLine( bankIndex, random.NextIntInRange( 0, bankSize - 1 ) );
+}
+
+//--------------------------------------------------------------------------
+/**
+* FindKeyedLine
+*/
+DialogueLineId DialogueTable::FindKeyedLine( std::string_view key ) const
+{
+	int low = 0;
+	int high = m_header ? (int) m_header->keyCount : 0;
+	while( low < high )
+	{
+		int mid = ( low + high ) / 2;
+		int compare = GetLine( m_keys[mid].keyLineId ).compare( key );
+		if( compare == 0 )
+		{
+			return m_keys[mid].lineId;
+		}
+		if( compare < 0 )
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+	return INVALID_DIALOGUE_LINE;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Push
+*/
+bool DialogueQueue::Push( DialogueLineId lineId )
+{
+	if( IsFull() )
+	{
+		return false;
+	}
+	m_lineIds[( m_head + m_count ) % DIALOGUE_QUEUE_CAPACITY] = lineId;
+	++m_count;
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Pop
+*/
+bool DialogueQueue::Pop()
+{
+	if( IsEmpty() )
+	{
+		return false;
+	}
+	m_head = ( m_head + 1 ) % DIALOGUE_QUEUE_CAPACITY;
+	--m_count;
+	return true;
+}
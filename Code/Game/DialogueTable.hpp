@@ -0,0 +1,126 @@
+#pragma once
+#include "Game/MappedFile.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class RandomStream;
+
+//--------------------------------------------------------------------------
+// Dialogue lines live in one compiled bank blob and are referred to by id.
+// The blob is either mapped straight from disk (Data/Dialogue/*.dlgb) or,
+// in development, built in memory from the XML by DialogueBankBuilder.
+// Either way nothing is parsed or copied per line and lookups never
+// allocate.
+//--------------------------------------------------------------------------
+typedef uint32_t DialogueLineId;
+constexpr DialogueLineId INVALID_DIALOGUE_LINE = 0xFFFFFFFFu;
+
+//--------------------------------------------------------------------------
+// Bank file layout. Every section is a flat array of 4 byte aligned,
+// little endian records addressed by byte offsets from the start of the
+// blob, text last. Bank and key names are lines in the text table too.
+// Keys are sorted by name for binary search.
+//--------------------------------------------------------------------------
+constexpr uint32_t DIALOGUE_BANK_MAGIC = 0x42474C44;	// "DLGB"
+constexpr uint32_t DIALOGUE_BANK_VERSION = 1;
+
+struct DialogueBankHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t totalBytes;
+	uint32_t maxLineLength;
+	uint32_t lineCount;
+	uint32_t linesOffset;		// DialogueBankLine[lineCount]
+	uint32_t bankCount;
+	uint32_t banksOffset;		// DialogueBankEntry[bankCount]
+	uint32_t bankLineIdCount;
+	uint32_t bankLineIdsOffset;	// DialogueLineId[bankLineIdCount]
+	uint32_t keyCount;
+	uint32_t keysOffset;		// DialogueBankKey[keyCount]
+	uint32_t textBytes;
+	uint32_t textOffset;		// char[textBytes], every line null terminated
+};
+
+struct DialogueBankLine
+{
+	uint32_t textOffset;
+	uint32_t length;
+};
+
+struct DialogueBankEntry
+{
+	DialogueLineId nameLineId;
+	uint32_t firstLineIdIndex;
+	uint32_t lineIdCount;
+};
+
+struct DialogueBankKey
+{
+	DialogueLineId keyLineId;
+	DialogueLineId lineId;
+};
+
+//--------------------------------------------------------------------------
+class DialogueTable
+{
+public:
+	bool LoadFromFile( const std::string& bankPath );
+	bool LoadFromBlob( std::vector<uint8_t>&& blob );
+	void Clear();
+	bool IsLoaded() const { return m_header != nullptr; }
+
+	std::string_view GetLine( DialogueLineId lineId ) const;
+	const char* GetLineCString( DialogueLineId lineId ) const;
+	int GetLineCount() const { return m_header ? (int) m_header->lineCount : 0; }
+	int GetMaxLineLength() const { return m_header ? (int) m_header->maxLineLength : 0; }
+
+	int FindBank( std::string_view bankName ) const;
+	int GetBankCount() const { return m_header ? (int) m_header->bankCount : 0; }
+	int GetBankSize( int bankIndex ) const;
+	DialogueLineId GetBankLine( int bankIndex, int index ) const;
+	DialogueLineId GetRandomLine( int bankIndex, RandomStream& random ) const;
+
+	DialogueLineId FindKeyedLine( std::string_view key ) const;
+
+private:
+	bool Bind( const uint8_t* data, size_t size );
+
+private:
+	MappedFile m_mappedFile;
+	std::vector<uint8_t> m_ownedBlob;
+
+	const DialogueBankHeader* m_header = nullptr;
+	const DialogueBankLine* m_lines = nullptr;
+	const DialogueBankEntry* m_banks = nullptr;
+	const DialogueLineId* m_bankLineIds = nullptr;
+	const DialogueBankKey* m_keys = nullptr;
+	const char* m_text = nullptr;
+};
+
+//--------------------------------------------------------------------------
+// Fixed capacity FIFO of line ids. Pushing onto a full queue fails rather
+// than growing.
+//--------------------------------------------------------------------------
+constexpr int DIALOGUE_QUEUE_CAPACITY = 32;
+
+class DialogueQueue
+{
+public:
+	bool Push( DialogueLineId lineId );
+	bool Pop();
+	void Clear() { m_head = 0; m_count = 0; }
+
+	DialogueLineId Front() const { return m_count > 0 ? m_lineIds[m_head] : INVALID_DIALOGUE_LINE; }
+	int GetSize() const { return m_count; }
+	bool IsEmpty() const { return m_count == 0; }
+	bool IsFull() const { return m_count == DIALOGUE_QUEUE_CAPACITY; }
+
+private:
+	DialogueLineId m_lineIds[DIALOGUE_QUEUE_CAPACITY];
+	int m_head = 0;
+	int m_count = 0;
+};
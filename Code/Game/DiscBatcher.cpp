@@ -0,0 +1,115 @@
+#include "Game/DiscBatcher.hpp"
+#include "Game/GameCommon.hpp"
+
+#include "Game/EngineBackends.hpp"
+
+#include <math.h>
+
+//--------------------------------------------------------------------------
+// Unit circle sampled at DISC_MAX_SIDES + 1 points (last one repeats the
+// first), coarser LODs step through it with a stride.
+//--------------------------------------------------------------------------
+static float s_unitCircleCos[DISC_MAX_SIDES + 1];
+static float s_unitCircleSin[DISC_MAX_SIDES + 1];
+static bool s_isUnitCircleBuilt = false;
+
+//--------------------------------------------------------------------------
+/**
+* BuildUnitCircle
+*/
+static void BuildUnitCircle()
+{
+	const double TWO_PI = 6.283185307179586;
+	for( int pointIdx = 0; pointIdx < DISC_MAX_SIDES; ++pointIdx )
+	{
+		double radians = TWO_PI * (double) pointIdx / (double) DISC_MAX_SIDES;
+		s_unitCircleCos[pointIdx] = (float) cos( radians );
+		s_unitCircleSin[pointIdx] = (float) sin( radians );
+	}
+	s_unitCircleCos[DISC_MAX_SIDES] = s_unitCircleCos[0];
+	s_unitCircleSin[DISC_MAX_SIDES] = s_unitCircleSin[0];
+	s_isUnitCircleBuilt = true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* DiscBatcher
+*/
+DiscBatcher::DiscBatcher()
+{
+	if( !s_isUnitCircleBuilt )
+	{
+		BuildUnitCircle();
+	}
+	m_verts.reserve( DISC_MAX_SIDES * 3 * 16 );
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~DiscBatcher
+*/
+DiscBatcher::~DiscBatcher()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* AddDisc
+*/
+void DiscBatcher::AddDisc( const Vec3& center, float radius, const Rgba& color )
+{
+	int numSides = GetSideCountForRadius( radius );
+	int stride = DISC_MAX_SIDES / numSides;
+	Vec2 uv( 0.0f, 0.0f );
+
+	size_t firstVert = m_verts.size();
+	m_verts.resize( firstVert + (size_t) numSides * 3 );
+	Vertex_PCU* verts = &m_verts[firstVert];
+
+	Vertex_PCU centerVert( center, color, uv );
+	for( int sideIdx = 0; sideIdx < numSides; ++sideIdx )
+	{
+		int startPoint = sideIdx * stride;
+		int endPoint = startPoint + stride;
+
+		verts[0] = centerVert;
+		verts[1] = Vertex_PCU( Vec3( center.x + radius * s_unitCircleCos[startPoint], center.y + radius * s_unitCircleSin[startPoint], center.z ), color, uv );
+		verts[2] = Vertex_PCU( Vec3( center.x + radius * s_unitCircleCos[endPoint], center.y + radius * s_unitCircleSin[endPoint], center.z ), color, uv );
+		verts += 3;
+	}
+	++m_discCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Flush
+* Draws everything added since the last flush under the current camera.
+*/
+void DiscBatcher::Flush()
+{
+	m_drawCallsLastFlush = 0;
+	if( !m_verts.empty() )
+	{
+		g_theEngineBackends->DrawVertexArray( (int) m_verts.size(), m_verts.data() );
+		m_drawCallsLastFlush = 1;
+	}
+	m_verts.clear();
+	m_discCount = 0;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetSideCountForRadius
+* Roughly one side per 3 pixels of circumference, snapped to a power of two
+* between DISC_MIN_SIDES and DISC_MAX_SIDES.
+*/
+int DiscBatcher::GetSideCountForRadius( float radius ) const
+{
+	float circumferencePixels = 6.2831853f * radius * m_pixelsPerUnit;
+	int numSides = DISC_MIN_SIDES;
+	while( numSides < DISC_MAX_SIDES && (float) numSides * 3.0f < circumferencePixels )
+	{
+		numSides *= 2;
+	}
+	return numSides;
+}
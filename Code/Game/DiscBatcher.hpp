@@ -0,0 +1,36 @@
+#pragma once
+#include "Engine/Core/Vertex/Vertex_PCU.hpp"
+
+#include <vector>
+
+constexpr int DISC_MAX_SIDES = 64;
+constexpr int DISC_MIN_SIDES = 8;
+constexpr float DISC_DEFAULT_PIXELS_PER_UNIT = 10.0f;
+
+//--------------------------------------------------------------------------
+// Collects every disc drawn in a frame into one vertex array and submits it
+// with a single draw call. Rim points come from a precomputed unit circle,
+// and the side count drops for discs that are small on screen.
+//--------------------------------------------------------------------------
+class DiscBatcher
+{
+public:
+	DiscBatcher();
+	~DiscBatcher();
+
+	void AddDisc( const Vec3& center, float radius, const Rgba& color );
+	void Flush();
+
+	void SetPixelsPerUnit( float pixelsPerUnit ) { m_pixelsPerUnit = pixelsPerUnit; }
+	int GetSideCountForRadius( float radius ) const;
+
+	int GetDiscCount() const { return m_discCount; }
+	int GetVertexCount() const { return (int) m_verts.size(); }
+	int GetDrawCallsLastFlush() const { return m_drawCallsLastFlush; }
+
+private:
+	std::vector<Vertex_PCU> m_verts;
+	float m_pixelsPerUnit = DISC_DEFAULT_PIXELS_PER_UNIT;
+	int m_discCount = 0;
+	int m_drawCallsLastFlush = 0;
+};
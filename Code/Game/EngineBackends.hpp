@@ -0,0 +1,55 @@
+#pragma once
+#include "Engine/Core/Graphics/Rgba.hpp"
+#include "Engine/Core/Vertex/Vertex_PCU.hpp"
+
+#include <string>
+
+class Camera;
+
+//--------------------------------------------------------------------------
+// Everything the game needs from the engine's renderer, debug render, ImGUI,
+// input and audio systems. The App makes one with CreateEngineBackends and
+// the game reaches it through g_theEngineBackends.
+//
+// EngineBackends_Windows.cpp owns and drives the real systems.
+// EngineBackends_Headless.cpp is the null set the GAME_HEADLESS build links
+// instead: nothing is created, there's no display so the App records no
+// frames, and widgets are dropped. Each file only builds in its
+// configuration, the same way Main_Windows.cpp and Main_Headless.cpp do.
+//
+// The renderer, debug render and overlay calls are made by whichever thread
+// executes render commands, the rest from the main thread.
+//--------------------------------------------------------------------------
+class EngineBackends
+{
+public:
+	virtual ~EngineBackends() {}
+
+	virtual void Startup() = 0;
+	virtual void Shutdown() = 0;
+	virtual void BeginFrame() = 0;
+	virtual void Update() = 0;
+	virtual void EndFrame() = 0;
+
+	// Renderer
+	virtual bool HasDisplay() const = 0;
+	virtual void BindDefaultShader( const char* shaderXMLPath ) = 0;
+	virtual void ClearScreen( const Rgba& color ) = 0;
+	virtual void BeginCamera( Camera* camera ) = 0;
+	virtual void DrawVertexArray( int vertexCount, const Vertex_PCU* vertices ) = 0;
+
+	// Debug render, ImGUI and the console
+	virtual void OpenDebugRender() = 0;
+	virtual void RenderDebugToCamera( const Camera* camera ) = 0;
+	virtual void RenderOverlays( const Camera& consoleCamera, float consoleTextHeight ) = 0;
+	virtual void BeginWindow( const char* name, int windowFlags ) = 0;
+	virtual void Text( const std::string& text ) = 0;
+	virtual bool SelectableText( const char* text, bool isSelected ) = 0;
+	virtual void EndWindow() = 0;
+};
+
+EngineBackends* CreateEngineBackends();
+
+// Benchmark and check reports: the dev console, or stdout with no window.
+// Works before the App has started.
+void PrintReportLine( const std::string& text );
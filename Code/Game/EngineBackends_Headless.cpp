@@ -0,0 +1,53 @@
+#if defined(GAME_HEADLESS)
+#include "Game/EngineBackends.hpp"
+#include "Game/GameCommon.hpp"
+
+#include <stdio.h>
+
+//--------------------------------------------------------------------------
+// No window, GPU, audio device or controller. The renderer, input and audio
+// globals are never created and stay nullptr.
+//--------------------------------------------------------------------------
+class NullEngineBackends : public EngineBackends
+{
+public:
+	void Startup() override																{}
+	void Shutdown() override															{}
+	void BeginFrame() override															{}
+	void Update() override																{}
+	void EndFrame() override															{}
+
+	bool HasDisplay() const override													{ return false; }
+	void BindDefaultShader( const char* shaderXMLPath ) override						{ UNUSED( shaderXMLPath ); }
+	void ClearScreen( const Rgba& color ) override										{ UNUSED( color ); }
+	void BeginCamera( Camera* camera ) override											{ UNUSED( camera ); }
+	void DrawVertexArray( int vertexCount, const Vertex_PCU* vertices ) override		{ UNUSED( vertexCount ); UNUSED( vertices ); }
+
+	void OpenDebugRender() override														{}
+	void RenderDebugToCamera( const Camera* camera ) override							{ UNUSED( camera ); }
+	void RenderOverlays( const Camera& consoleCamera, float consoleTextHeight ) override	{ UNUSED( consoleCamera ); UNUSED( consoleTextHeight ); }
+	void BeginWindow( const char* name, int windowFlags ) override						{ UNUSED( name ); UNUSED( windowFlags ); }
+	void Text( const std::string& text ) override										{ UNUSED( text ); }
+	bool SelectableText( const char* text, bool isSelected ) override					{ UNUSED( text ); UNUSED( isSelected ); return false; }
+	void EndWindow() override															{}
+};
+
+//--------------------------------------------------------------------------
+/**
+* CreateEngineBackends
+*/
+EngineBackends* CreateEngineBackends()
+{
+	return new NullEngineBackends();
+}
+
+//--------------------------------------------------------------------------
+/**
+* PrintReportLine
+*/
+void PrintReportLine( const std::string& text )
+{
+	printf( "%s\n", text.c_str() );
+}
+
+#endif
@@ -0,0 +1,265 @@
+#if !defined(GAME_HEADLESS)
+#include "Game/EngineBackends.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/GameProfiler.hpp"
+
+#include "Engine/Core/Debug/DevConsole.hpp"
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Renderer/RenderContext.hpp"
+#include "Engine/Renderer/Camera.hpp"
+#include "Engine/Renderer/Debug/DebugRenderSystem.hpp"
+#include "Engine/ImGUI/ImGUISystem.hpp"
+#include "Engine/Input/InputSystem.hpp"
+#include "Engine/Audio/AudioSystem.hpp"
+
+//--------------------------------------------------------------------------
+// Owns the engine systems for the windowed build and keeps the g_the*
+// globals pointing at them, the engine itself reaches them that way.
+//--------------------------------------------------------------------------
+class WindowsEngineBackends : public EngineBackends
+{
+public:
+	WindowsEngineBackends();
+	~WindowsEngineBackends();
+
+	void Startup() override;
+	void Shutdown() override;
+	void BeginFrame() override;
+	void Update() override;
+	void EndFrame() override;
+
+	bool HasDisplay() const override { return true; }
+	void BindDefaultShader( const char* shaderXMLPath ) override;
+	void ClearScreen( const Rgba& color ) override;
+	void BeginCamera( Camera* camera ) override;
+	void DrawVertexArray( int vertexCount, const Vertex_PCU* vertices ) override;
+
+	void OpenDebugRender() override;
+	void RenderDebugToCamera( const Camera* camera ) override;
+	void RenderOverlays( const Camera& consoleCamera, float consoleTextHeight ) override;
+	void BeginWindow( const char* name, int windowFlags ) override;
+	void Text( const std::string& text ) override;
+	bool SelectableText( const char* text, bool isSelected ) override;
+	void EndWindow() override;
+};
+
+//--------------------------------------------------------------------------
+/**
+* CreateEngineBackends
+*/
+EngineBackends* CreateEngineBackends()
+{
+	return new WindowsEngineBackends();
+}
+
+//--------------------------------------------------------------------------
+/**
+* PrintReportLine
+*/
+void PrintReportLine( const std::string& text )
+{
+	g_theConsole->PrintString( text, DevConsole::CONSOLE_INFO );
+}
+
+//--------------------------------------------------------------------------
+/**
+* WindowsEngineBackends
+*/
+WindowsEngineBackends::WindowsEngineBackends()
+{
+	g_theRenderer = new RenderContext( g_theWindowContext );
+	g_theDebugRenderSystem = new DebugRenderSystem(g_theRenderer, 50.0f, 100.0f, "SquirrelFixedFont");
+	g_theInputSystem = new InputSystem();
+	g_theAudioSystem = new AudioSystem();
+	g_theImGUISystem = new ImGUISystem( g_theRenderer );
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~WindowsEngineBackends
+*/
+WindowsEngineBackends::~WindowsEngineBackends()
+{
+	SAFE_DELETE( g_theImGUISystem );
+	SAFE_DELETE( g_theAudioSystem );
+	SAFE_DELETE( g_theInputSystem );
+	SAFE_DELETE( g_theDebugRenderSystem );
+	SAFE_DELETE( g_theRenderer );
+}
+
+//--------------------------------------------------------------------------
+/**
+* Startup
+*/
+void WindowsEngineBackends::Startup()
+{
+	g_theRenderer->Startup();
+	g_theDebugRenderSystem->Startup();
+	g_theImGUISystem->Startup();
+}
+
+//--------------------------------------------------------------------------
+/**
+* Shutdown
+*/
+void WindowsEngineBackends::Shutdown()
+{
+	g_theImGUISystem->Shutdown();
+	g_theDebugRenderSystem->Shutdown();
+	g_theRenderer->Shutdown();
+}
+
+//--------------------------------------------------------------------------
+/**
+* BeginFrame
+* Engine systems stay on the main thread, none of them are known to be
+* safe to call alongside each other.
+*/
+void WindowsEngineBackends::BeginFrame()
+{
+	{ GAME_PROFILE_SCOPE( "ImGUISystem" );		g_theImGUISystem->		BeginFrame(); }
+	{ GAME_PROFILE_SCOPE( "Renderer" );			g_theRenderer->			BeginFrame(); }
+	{ GAME_PROFILE_SCOPE( "InputSystem" );		g_theInputSystem->		BeginFrame(); }
+	{ GAME_PROFILE_SCOPE( "AudioSystem" );		g_theAudioSystem->		BeginFrame(); }
+	{ GAME_PROFILE_SCOPE( "DebugRender" );		g_theDebugRenderSystem->BeginFrame(); }
+}
+
+//--------------------------------------------------------------------------
+/**
+* Update
+*/
+void WindowsEngineBackends::Update()
+{
+	GAME_PROFILE_SCOPE( "DebugRender" );
+	g_theDebugRenderSystem->Update();
+}
+
+//--------------------------------------------------------------------------
+/**
+* EndFrame
+*/
+void WindowsEngineBackends::EndFrame()
+{
+	{ GAME_PROFILE_SCOPE( "AudioSystem" );	g_theAudioSystem->	EndFrame(); }
+	{ GAME_PROFILE_SCOPE( "InputSystem" );	g_theInputSystem->	EndFrame(); }
+	{ GAME_PROFILE_SCOPE( "Renderer" );		g_theRenderer->		EndFrame(); }
+	{ GAME_PROFILE_SCOPE( "ImGUISystem" );	g_theImGUISystem->	EndFrame(); }
+}
+
+//--------------------------------------------------------------------------
+/**
+* BindDefaultShader
+*/
+void WindowsEngineBackends::BindDefaultShader( const char* shaderXMLPath )
+{
+	g_theRenderer->m_shader = g_theRenderer->CreateOrGetShaderFromXML( shaderXMLPath );
+}
+
+//--------------------------------------------------------------------------
+/**
+* ClearScreen
+*/
+void WindowsEngineBackends::ClearScreen( const Rgba& color )
+{
+	g_theRenderer->ClearScreen( color );
+}
+
+//--------------------------------------------------------------------------
+/**
+* BeginCamera
+*/
+void WindowsEngineBackends::BeginCamera( Camera* camera )
+{
+	camera->SetColorTargetView( g_theRenderer->GetColorTargetView() );
+	camera->SetDepthTargetView( g_theRenderer->GetDepthTargetView() );
+	g_theRenderer->BeginCamera( camera );
+}
+
+//--------------------------------------------------------------------------
+/**
+* DrawVertexArray
+*/
+void WindowsEngineBackends::DrawVertexArray( int vertexCount, const Vertex_PCU* vertices )
+{
+	g_theRenderer->DrawVertexArray( vertexCount, vertices );
+}
+
+//--------------------------------------------------------------------------
+/**
+* OpenDebugRender
+*/
+void WindowsEngineBackends::OpenDebugRender()
+{
+	EventArgs args;
+	g_theDebugRenderSystem->Command_Open(args);
+}
+
+//--------------------------------------------------------------------------
+/**
+* RenderDebugToCamera
+*/
+void WindowsEngineBackends::RenderDebugToCamera( const Camera* camera )
+{
+	g_theDebugRenderSystem->RenderToCamera( camera );
+}
+
+//--------------------------------------------------------------------------
+/**
+* RenderOverlays
+* ImGUI, then the console or the debug screen overlay.
+*/
+void WindowsEngineBackends::RenderOverlays( const Camera& consoleCamera, float consoleTextHeight )
+{
+	{
+		GAME_PROFILE_SCOPE( "ImGUISystem::Render" );
+		g_theImGUISystem->Render();
+	}
+
+	GAME_PROFILE_SCOPE( "Console/DebugRender" );
+	if( g_theConsole->IsOpen() )
+	{
+		g_theConsole->Render( g_theRenderer, consoleCamera, consoleTextHeight );
+	}
+	else
+	{
+		g_theDebugRenderSystem->RenderToScreen();
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* BeginWindow
+*/
+void WindowsEngineBackends::BeginWindow( const char* name, int windowFlags )
+{
+	ImGUI_BeginWindow( name, 0, windowFlags );
+}
+
+//--------------------------------------------------------------------------
+/**
+* Text
+*/
+void WindowsEngineBackends::Text( const std::string& text )
+{
+	ImGUI_Text( text );
+}
+
+//--------------------------------------------------------------------------
+/**
+* SelectableText
+*/
+bool WindowsEngineBackends::SelectableText( const char* text, bool isSelected )
+{
+	return ImGUI_SelectableText( text, isSelected );
+}
+
+//--------------------------------------------------------------------------
+/**
+* EndWindow
+*/
+void WindowsEngineBackends::EndWindow()
+{
+	ImGUI_EndWindow();
+}
+
+#endif
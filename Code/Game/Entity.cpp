@@ -95,9 +95,7 @@ bool Entity::IsOffScreen() const
 */
 Vec2 Entity::GetForwardVector() const
 {
-	Vec2 forwardVec = Vec2( CosDegrees( m_orientationDegrees ), SinDegrees( m_orientationDegrees ) ); 
-	forwardVec.Normalize();
-	return forwardVec;
+	return Vec2( CosDegrees( m_orientationDegrees ), SinDegrees( m_orientationDegrees ) );
 }
 
 //--------------------------------------------------------------------------
@@ -0,0 +1,354 @@
+#include "Game/EntityKinematics.hpp"
+#include "Game/EntityStore.hpp"
+#include "Game/GameUtils.hpp"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(GAME_AVX2_DISPATCH)
+#define KINEMATICS_AVX2
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define KINEMATICS_SSE2
+#include <emmintrin.h>
+#endif
+
+//--------------------------------------------------------------------------
+// Range reduction is to the nearest quarter turn, leaving |r| <= pi/4 where
+// the Taylor series below are good to float precision.
+//--------------------------------------------------------------------------
+constexpr float DEGREES_TO_RADIANS = 3.14159265358979f / 180.0f;
+constexpr float INV_90 = 1.0f / 90.0f;
+constexpr float INV_360 = 1.0f / 360.0f;
+
+constexpr float SIN_C3 = -1.0f / 6.0f;
+constexpr float SIN_C5 = 1.0f / 120.0f;
+constexpr float SIN_C7 = -1.0f / 5040.0f;
+constexpr float COS_C2 = -1.0f / 2.0f;
+constexpr float COS_C4 = 1.0f / 24.0f;
+constexpr float COS_C6 = -1.0f / 720.0f;
+constexpr float COS_C8 = 1.0f / 40320.0f;
+
+//--------------------------------------------------------------------------
+// Every path does the same multiplies and adds in the same order, with no
+// FMA, so they give the same bits and replays hash the same on any CPU.
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+/**
+* WrapDegrees
+* Into [-180, 180].
+*/
+float WrapDegrees( float degrees )
+{
+	return degrees - 360.0f * nearbyintf( degrees * INV_360 );
+}
+
+//--------------------------------------------------------------------------
+/**
+* FastSinCosDegrees
+*/
+void FastSinCosDegrees( float degrees, float* out_sin, float* out_cos )
+{
+	float quadrant = nearbyintf( degrees * INV_90 );
+	float r = ( degrees - quadrant * 90.0f ) * DEGREES_TO_RADIANS;
+	float r2 = r * r;
+
+	float s = r * ( 1.0f + r2 * ( SIN_C3 + r2 * ( SIN_C5 + r2 * SIN_C7 ) ) );
+	float c = 1.0f + r2 * ( COS_C2 + r2 * ( COS_C4 + r2 * ( COS_C6 + r2 * COS_C8 ) ) );
+
+	switch( (int) quadrant & 3 )
+	{
+	case 0: *out_sin = s;	*out_cos = c;	break;
+	case 1: *out_sin = c;	*out_cos = -s;	break;
+	case 2: *out_sin = -s;	*out_cos = -c;	break;
+	default: *out_sin = -c;	*out_cos = s;	break;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* IntegrateScalar
+* Reference kernel, also runs the tail of the SIMD loops.
+*/
+static void IntegrateScalar( EntityBucket& bucket, float deltaSeconds, int start, int end )
+{
+	for( int entityIdx = start; entityIdx < end; ++entityIdx )
+	{
+		float angularVelocity = bucket.angularVelocity[entityIdx] + (float) bucket.rotateDirection[entityIdx] * bucket.angularAcceleration[entityIdx] * deltaSeconds;
+		float orientationDegrees = WrapDegrees( bucket.orientationDegrees[entityIdx] + angularVelocity * deltaSeconds );
+		bucket.angularVelocity[entityIdx] = angularVelocity;
+		bucket.orientationDegrees[entityIdx] = orientationDegrees;
+
+		float forwardY;
+		float forwardX;
+		FastSinCosDegrees( orientationDegrees, &forwardY, &forwardX );
+		bucket.forwardX[entityIdx] = forwardX;
+		bucket.forwardY[entityIdx] = forwardY;
+
+		float thrust = (float) bucket.isAccelerating[entityIdx] * bucket.acceleration[entityIdx] * deltaSeconds;
+		float velocityX = bucket.velocityX[entityIdx] + forwardX * thrust;
+		float velocityY = bucket.velocityY[entityIdx] + forwardY * thrust;
+		bucket.velocityX[entityIdx] = velocityX;
+		bucket.velocityY[entityIdx] = velocityY;
+
+		bucket.positionX[entityIdx] += velocityX * deltaSeconds;
+		bucket.positionY[entityIdx] += velocityY * deltaSeconds;
+	}
+}
+
+#if defined(KINEMATICS_AVX2)
+//--------------------------------------------------------------------------
+/**
+* SinCosDegrees8
+*/
+static GAME_TARGET_AVX2 void SinCosDegrees8( __m256 degrees, __m256* out_sin, __m256* out_cos )
+{
+	__m256 quadrant = _mm256_round_ps( _mm256_mul_ps( degrees, _mm256_set1_ps( INV_90 ) ), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
+	__m256 r = _mm256_mul_ps( _mm256_sub_ps( degrees, _mm256_mul_ps( quadrant, _mm256_set1_ps( 90.0f ) ) ), _mm256_set1_ps( DEGREES_TO_RADIANS ) );
+	__m256 r2 = _mm256_mul_ps( r, r );
+
+	__m256 s = _mm256_add_ps( _mm256_mul_ps( r2, _mm256_set1_ps( SIN_C7 ) ), _mm256_set1_ps( SIN_C5 ) );
+	s = _mm256_add_ps( _mm256_mul_ps( r2, s ), _mm256_set1_ps( SIN_C3 ) );
+	s = _mm256_add_ps( _mm256_mul_ps( r2, s ), _mm256_set1_ps( 1.0f ) );
+	s = _mm256_mul_ps( r, s );
+
+	__m256 c = _mm256_add_ps( _mm256_mul_ps( r2, _mm256_set1_ps( COS_C8 ) ), _mm256_set1_ps( COS_C6 ) );
+	c = _mm256_add_ps( _mm256_mul_ps( r2, c ), _mm256_set1_ps( COS_C4 ) );
+	c = _mm256_add_ps( _mm256_mul_ps( r2, c ), _mm256_set1_ps( COS_C2 ) );
+	c = _mm256_add_ps( _mm256_mul_ps( r2, c ), _mm256_set1_ps( 1.0f ) );
+
+	// Odd quadrants swap sin and cos, quadrants 2-3 negate sin, 1-2 negate cos.
+	__m256i q = _mm256_cvtps_epi32( quadrant );
+	__m256 swapMask = _mm256_castsi256_ps( _mm256_cmpeq_epi32( _mm256_and_si256( q, _mm256_set1_epi32( 1 ) ), _mm256_set1_epi32( 1 ) ) );
+	__m256 sinSign = _mm256_castsi256_ps( _mm256_slli_epi32( _mm256_and_si256( q, _mm256_set1_epi32( 2 ) ), 30 ) );
+	__m256 cosSign = _mm256_castsi256_ps( _mm256_slli_epi32( _mm256_and_si256( _mm256_add_epi32( q, _mm256_set1_epi32( 1 ) ), _mm256_set1_epi32( 2 ) ), 30 ) );
+
+	*out_sin = _mm256_xor_ps( _mm256_blendv_ps( s, c, swapMask ), sinSign );
+	*out_cos = _mm256_xor_ps( _mm256_blendv_ps( c, s, swapMask ), cosSign );
+}
+
+//--------------------------------------------------------------------------
+/**
+* IntegrateAVX2
+* Handles whole groups of 8 from startIndex and returns where it stopped.
+*/
+static GAME_TARGET_AVX2 int IntegrateAVX2( EntityBucket& bucket, float deltaSeconds, int startIndex, int endIndex )
+{
+	int vectorEnd = startIndex + ( ( endIndex - startIndex ) & ~7 );
+	__m256 dt = _mm256_set1_ps( deltaSeconds );
+
+	for( int entityIdx = startIndex; entityIdx < vectorEnd; entityIdx += 8 )
+	{
+		__m128i rotateBytes = _mm_loadl_epi64( (const __m128i*) &bucket.rotateDirection[entityIdx] );
+		__m128i accelBytes = _mm_loadl_epi64( (const __m128i*) &bucket.isAccelerating[entityIdx] );
+		__m256 rotateDirection = _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( rotateBytes ) );
+		__m256 isAccelerating = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( accelBytes ) );
+
+		__m256 angularVelocity = _mm256_loadu_ps( &bucket.angularVelocity[entityIdx] );
+		__m256 angularAcceleration = _mm256_loadu_ps( &bucket.angularAcceleration[entityIdx] );
+		angularVelocity = _mm256_add_ps( angularVelocity, _mm256_mul_ps( _mm256_mul_ps( rotateDirection, angularAcceleration ), dt ) );
+
+		__m256 orientation = _mm256_add_ps( _mm256_loadu_ps( &bucket.orientationDegrees[entityIdx] ), _mm256_mul_ps( angularVelocity, dt ) );
+		__m256 turns = _mm256_round_ps( _mm256_mul_ps( orientation, _mm256_set1_ps( INV_360 ) ), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
+		orientation = _mm256_sub_ps( orientation, _mm256_mul_ps( turns, _mm256_set1_ps( 360.0f ) ) );
+
+		_mm256_storeu_ps( &bucket.angularVelocity[entityIdx], angularVelocity );
+		_mm256_storeu_ps( &bucket.orientationDegrees[entityIdx], orientation );
+
+		__m256 forwardY;
+		__m256 forwardX;
+		SinCosDegrees8( orientation, &forwardY, &forwardX );
+		_mm256_storeu_ps( &bucket.forwardX[entityIdx], forwardX );
+		_mm256_storeu_ps( &bucket.forwardY[entityIdx], forwardY );
+
+		__m256 thrust = _mm256_mul_ps( _mm256_mul_ps( isAccelerating, _mm256_loadu_ps( &bucket.acceleration[entityIdx] ) ), dt );
+		__m256 velocityX = _mm256_add_ps( _mm256_loadu_ps( &bucket.velocityX[entityIdx] ), _mm256_mul_ps( forwardX, thrust ) );
+		__m256 velocityY = _mm256_add_ps( _mm256_loadu_ps( &bucket.velocityY[entityIdx] ), _mm256_mul_ps( forwardY, thrust ) );
+		_mm256_storeu_ps( &bucket.velocityX[entityIdx], velocityX );
+		_mm256_storeu_ps( &bucket.velocityY[entityIdx], velocityY );
+
+		_mm256_storeu_ps( &bucket.positionX[entityIdx], _mm256_add_ps( _mm256_loadu_ps( &bucket.positionX[entityIdx] ), _mm256_mul_ps( velocityX, dt ) ) );
+		_mm256_storeu_ps( &bucket.positionY[entityIdx], _mm256_add_ps( _mm256_loadu_ps( &bucket.positionY[entityIdx] ), _mm256_mul_ps( velocityY, dt ) ) );
+	}
+	return vectorEnd;
+}
+
+//--------------------------------------------------------------------------
+/**
+* ComputeForwardVectorsAVX2
+* Whole groups of 8, returns where it stopped.
+*/
+static GAME_TARGET_AVX2 int ComputeForwardVectorsAVX2( const float* orientationDegrees, float* out_forwardX, float* out_forwardY, int count )
+{
+	int entityIdx = 0;
+	for( ; entityIdx + 8 <= count; entityIdx += 8 )
+	{
+		__m256 forwardY;
+		__m256 forwardX;
+		SinCosDegrees8( _mm256_loadu_ps( orientationDegrees + entityIdx ), &forwardY, &forwardX );
+		_mm256_storeu_ps( out_forwardX + entityIdx, forwardX );
+		_mm256_storeu_ps( out_forwardY + entityIdx, forwardY );
+	}
+	return entityIdx;
+}
+#endif
+
+#if defined(KINEMATICS_SSE2)
+//--------------------------------------------------------------------------
+/**
+* Select4
+* SSE2 has no blendv, mask lanes are all ones or all zeros.
+*/
+static inline __m128 Select4( __m128 ifFalse, __m128 ifTrue, __m128 mask )
+{
+	return _mm_or_ps( _mm_and_ps( mask, ifTrue ), _mm_andnot_ps( mask, ifFalse ) );
+}
+
+//--------------------------------------------------------------------------
+/**
+* SinCosDegrees4
+*/
+static void SinCosDegrees4( __m128 degrees, __m128* out_sin, __m128* out_cos )
+{
+	__m128i q = _mm_cvtps_epi32( _mm_mul_ps( degrees, _mm_set1_ps( INV_90 ) ) );	// Round to nearest.
+	__m128 quadrant = _mm_cvtepi32_ps( q );
+	__m128 r = _mm_mul_ps( _mm_sub_ps( degrees, _mm_mul_ps( quadrant, _mm_set1_ps( 90.0f ) ) ), _mm_set1_ps( DEGREES_TO_RADIANS ) );
+	__m128 r2 = _mm_mul_ps( r, r );
+
+	__m128 s = _mm_add_ps( _mm_mul_ps( r2, _mm_set1_ps( SIN_C7 ) ), _mm_set1_ps( SIN_C5 ) );
+	s = _mm_add_ps( _mm_mul_ps( r2, s ), _mm_set1_ps( SIN_C3 ) );
+	s = _mm_add_ps( _mm_mul_ps( r2, s ), _mm_set1_ps( 1.0f ) );
+	s = _mm_mul_ps( r, s );
+
+	__m128 c = _mm_add_ps( _mm_mul_ps( r2, _mm_set1_ps( COS_C8 ) ), _mm_set1_ps( COS_C6 ) );
+	c = _mm_add_ps( _mm_mul_ps( r2, c ), _mm_set1_ps( COS_C4 ) );
+	c = _mm_add_ps( _mm_mul_ps( r2, c ), _mm_set1_ps( COS_C2 ) );
+	c = _mm_add_ps( _mm_mul_ps( r2, c ), _mm_set1_ps( 1.0f ) );
+
+	// Odd quadrants swap sin and cos, quadrants 2-3 negate sin, 1-2 negate cos.
+	__m128 swapMask = _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_and_si128( q, _mm_set1_epi32( 1 ) ), _mm_set1_epi32( 1 ) ) );
+	__m128 sinSign = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( q, _mm_set1_epi32( 2 ) ), 30 ) );
+	__m128 cosSign = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( _mm_add_epi32( q, _mm_set1_epi32( 1 ) ), _mm_set1_epi32( 2 ) ), 30 ) );
+
+	*out_sin = _mm_xor_ps( Select4( s, c, swapMask ), sinSign );
+	*out_cos = _mm_xor_ps( Select4( c, s, swapMask ), cosSign );
+}
+
+//--------------------------------------------------------------------------
+/**
+* IntegrateSSE2
+* Handles whole groups of 4 from startIndex and returns where it stopped.
+*/
+static int IntegrateSSE2( EntityBucket& bucket, float deltaSeconds, int startIndex, int endIndex )
+{
+	int vectorEnd = startIndex + ( ( endIndex - startIndex ) & ~3 );
+	__m128 dt = _mm_set1_ps( deltaSeconds );
+
+	for( int entityIdx = startIndex; entityIdx < vectorEnd; entityIdx += 4 )
+	{
+		// Widen four int8 / uint8 lanes to int32 by unpacking into the top byte and shifting down.
+		int rotateBytes;
+		int accelBytes;
+		memcpy( &rotateBytes, &bucket.rotateDirection[entityIdx], 4 );
+		memcpy( &accelBytes, &bucket.isAccelerating[entityIdx], 4 );
+		__m128i rotateWide = _mm_cvtsi32_si128( rotateBytes );
+		rotateWide = _mm_unpacklo_epi8( rotateWide, rotateWide );
+		rotateWide = _mm_srai_epi32( _mm_unpacklo_epi16( rotateWide, rotateWide ), 24 );
+		__m128i accelWide = _mm_cvtsi32_si128( accelBytes );
+		accelWide = _mm_unpacklo_epi8( accelWide, accelWide );
+		accelWide = _mm_srli_epi32( _mm_unpacklo_epi16( accelWide, accelWide ), 24 );
+		__m128 rotateDirection = _mm_cvtepi32_ps( rotateWide );
+		__m128 isAccelerating = _mm_cvtepi32_ps( accelWide );
+
+		__m128 angularVelocity = _mm_loadu_ps( &bucket.angularVelocity[entityIdx] );
+		__m128 angularAcceleration = _mm_loadu_ps( &bucket.angularAcceleration[entityIdx] );
+		angularVelocity = _mm_add_ps( angularVelocity, _mm_mul_ps( _mm_mul_ps( rotateDirection, angularAcceleration ), dt ) );
+
+		__m128 orientation = _mm_add_ps( _mm_loadu_ps( &bucket.orientationDegrees[entityIdx] ), _mm_mul_ps( angularVelocity, dt ) );
+		__m128 turns = _mm_cvtepi32_ps( _mm_cvtps_epi32( _mm_mul_ps( orientation, _mm_set1_ps( INV_360 ) ) ) );
+		orientation = _mm_sub_ps( orientation, _mm_mul_ps( turns, _mm_set1_ps( 360.0f ) ) );
+
+		_mm_storeu_ps( &bucket.angularVelocity[entityIdx], angularVelocity );
+		_mm_storeu_ps( &bucket.orientationDegrees[entityIdx], orientation );
+
+		__m128 forwardY;
+		__m128 forwardX;
+		SinCosDegrees4( orientation, &forwardY, &forwardX );
+		_mm_storeu_ps( &bucket.forwardX[entityIdx], forwardX );
+		_mm_storeu_ps( &bucket.forwardY[entityIdx], forwardY );
+
+		__m128 thrust = _mm_mul_ps( _mm_mul_ps( isAccelerating, _mm_loadu_ps( &bucket.acceleration[entityIdx] ) ), dt );
+		__m128 velocityX = _mm_add_ps( _mm_loadu_ps( &bucket.velocityX[entityIdx] ), _mm_mul_ps( forwardX, thrust ) );
+		__m128 velocityY = _mm_add_ps( _mm_loadu_ps( &bucket.velocityY[entityIdx] ), _mm_mul_ps( forwardY, thrust ) );
+		_mm_storeu_ps( &bucket.velocityX[entityIdx], velocityX );
+		_mm_storeu_ps( &bucket.velocityY[entityIdx], velocityY );
+
+		_mm_storeu_ps( &bucket.positionX[entityIdx], _mm_add_ps( _mm_loadu_ps( &bucket.positionX[entityIdx] ), _mm_mul_ps( velocityX, dt ) ) );
+		_mm_storeu_ps( &bucket.positionY[entityIdx], _mm_add_ps( _mm_loadu_ps( &bucket.positionY[entityIdx] ), _mm_mul_ps( velocityY, dt ) ) );
+	}
+	return vectorEnd;
+}
+#endif
+
+//--------------------------------------------------------------------------
+/**
+* IntegrateKinematics
+* Turn, thrust along the forward vector, then move, for the whole bucket.
+* Orientation is kept wrapped to [-180, 180] so precision doesn't drift.
+*/
+void IntegrateKinematics( EntityBucket& bucket, float deltaSeconds )
+{
+	IntegrateKinematicsRange( bucket, deltaSeconds, 0, bucket.GetCount() );
+}
+
+//--------------------------------------------------------------------------
+/**
+* IntegrateKinematicsRange
+* Same as IntegrateKinematics for [startIndex, endIndex) only.
+*/
+void IntegrateKinematicsRange( EntityBucket& bucket, float deltaSeconds, int startIndex, int endIndex )
+{
+	int handled = startIndex;
+#if defined(KINEMATICS_AVX2)
+	if( IsAVX2Supported() )
+	{
+		handled = IntegrateAVX2( bucket, deltaSeconds, startIndex, endIndex );
+	}
+#endif
+#if defined(KINEMATICS_SSE2)
+	handled = IntegrateSSE2( bucket, deltaSeconds, handled, endIndex );
+#endif
+	IntegrateScalar( bucket, deltaSeconds, handled, endIndex );
+}
+
+//--------------------------------------------------------------------------
+/**
+* ComputeForwardVectors
+*/
+void ComputeForwardVectors( const float* orientationDegrees, float* out_forwardX, float* out_forwardY, int count )
+{
+	int entityIdx = 0;
+#if defined(KINEMATICS_AVX2)
+	if( IsAVX2Supported() )
+	{
+		entityIdx = ComputeForwardVectorsAVX2( orientationDegrees, out_forwardX, out_forwardY, count );
+	}
+#endif
+#if defined(KINEMATICS_SSE2)
+	for( ; entityIdx + 4 <= count; entityIdx += 4 )
+	{
+		__m128 forwardY;
+		__m128 forwardX;
+		SinCosDegrees4( _mm_loadu_ps( orientationDegrees + entityIdx ), &forwardY, &forwardX );
+		_mm_storeu_ps( out_forwardX + entityIdx, forwardX );
+		_mm_storeu_ps( out_forwardY + entityIdx, forwardY );
+	}
+#endif
+	for( ; entityIdx < count; ++entityIdx )
+	{
+		FastSinCosDegrees( orientationDegrees[entityIdx], &out_forwardY[entityIdx], &out_forwardX[entityIdx] );
+	}
+}
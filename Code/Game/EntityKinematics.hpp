@@ -0,0 +1,21 @@
+#pragma once
+#include <stdint.h>
+
+struct EntityBucket;
+
+//--------------------------------------------------------------------------
+// Batched movement integration over an EntityBucket's arrays. Uses AVX2 when
+// the CPU has it, SSE2 otherwise, with a scalar loop for the tail and for
+// other platforms. Every path does the same float operations in the same
+// order, so they give the same bits.
+//--------------------------------------------------------------------------
+void IntegrateKinematics( EntityBucket& bucket, float deltaSeconds );
+
+// For splitting a bucket across jobs. Every path gives the same bits, so
+// the results don't depend on how the work was split.
+void IntegrateKinematicsRange( EntityBucket& bucket, float deltaSeconds, int startIndex, int endIndex );
+void ComputeForwardVectors( const float* orientationDegrees, float* out_forwardX, float* out_forwardY, int count );
+
+// Scalar version of the kernel's sin/cos, about 1e-7 from the real thing.
+void FastSinCosDegrees( float degrees, float* out_sin, float* out_cos );
+float WrapDegrees( float degrees );
@@ -0,0 +1,454 @@
+#include "Game/EntityStore.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/RenderCommandBuffer.hpp"
+#include "Game/EntityKinematics.hpp"
+#include "Game/GameProfiler.hpp"
+#include "Game/JobSystem.hpp"
+
+#include <algorithm>
+#include <string.h>
+
+//--------------------------------------------------------------------------
+// Movers and projectiles are integrated in batches on the job system. The
+// batch size is a multiple of 8 so every entity takes the same SIMD or
+// scalar path however many workers there are, keeping replays exact.
+//--------------------------------------------------------------------------
+constexpr int ENTITY_JOB_BATCH_SIZE = 2048;
+
+struct KinematicsJobArgs
+{
+	EntityBucket* bucket = nullptr;
+	float deltaSeconds = 0.0f;
+};
+
+//--------------------------------------------------------------------------
+/**
+* SwapAndPop
+* Moves the last element over index and shrinks the array by one.
+*/
+template< typename T >
+static void SwapAndPop( std::vector<T>& values, int index )
+{
+	values[index] = values.back();
+	values.pop_back();
+}
+
+//--------------------------------------------------------------------------
+/**
+* IntegrateKinematicsJob
+* Saves the batch's positions for interpolation, then integrates it.
+*/
+static void IntegrateKinematicsJob( void* userData, int startIndex, int endIndex )
+{
+	if( endIndex <= startIndex )
+	{
+		return;
+	}
+	KinematicsJobArgs* args = (KinematicsJobArgs*) userData;
+	EntityBucket& bucket = *args->bucket;
+	size_t byteCount = (size_t) ( endIndex - startIndex ) * sizeof( float );
+	memcpy( &bucket.previousPositionX[startIndex], &bucket.positionX[startIndex], byteCount );
+	memcpy( &bucket.previousPositionY[startIndex], &bucket.positionY[startIndex], byteCount );
+	IntegrateKinematicsRange( bucket, args->deltaSeconds, startIndex, endIndex );
+}
+
+//--------------------------------------------------------------------------
+/**
+* EntityStore
+*/
+EntityStore::EntityStore()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~EntityStore
+*/
+EntityStore::~EntityStore()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* CreateEntity
+*/
+EntityHandle EntityStore::CreateEntity( eEntityType type, const EntityDesc& desc )
+{
+	uint32_t slotIndex;
+	if( m_firstFreeSlot != 0xFFFFFFFF )
+	{
+		slotIndex = m_firstFreeSlot;
+		m_firstFreeSlot = m_slots[slotIndex].denseIndex;
+	}
+	else
+	{
+		slotIndex = (uint32_t) m_slots.size();
+		m_slots.push_back( EntitySlot() );
+	}
+
+	EntityBucket& bucket = m_buckets[type];
+	EntitySlot& slot = m_slots[slotIndex];
+	slot.denseIndex = (uint32_t) bucket.GetCount();
+	slot.type = type;
+	slot.isUsed = true;
+
+	bucket.positionX.push_back( desc.position.x );
+	bucket.positionY.push_back( desc.position.y );
+	bucket.previousPositionX.push_back( desc.position.x );
+	bucket.previousPositionY.push_back( desc.position.y );
+	bucket.velocityX.push_back( desc.velocity.x );
+	bucket.velocityY.push_back( desc.velocity.y );
+	float forwardX;
+	float forwardY;
+	float orientationDegrees = WrapDegrees( desc.orientationDegrees );
+	FastSinCosDegrees( orientationDegrees, &forwardY, &forwardX );
+	bucket.orientationDegrees.push_back( orientationDegrees );
+	bucket.forwardX.push_back( forwardX );
+	bucket.forwardY.push_back( forwardY );
+	bucket.angularVelocity.push_back( desc.angularVelocity );
+	bucket.acceleration.push_back( desc.acceleration );
+	bucket.angularAcceleration.push_back( desc.angularAcceleration );
+	bucket.physicsRadius.push_back( desc.physicsRadius );
+	bucket.cosmeticRadius.push_back( desc.cosmeticRadius );
+	bucket.health.push_back( desc.health );
+	bucket.collisionDamage.push_back( desc.collisionDamage );
+	bucket.rotateDirection.push_back( 0 );
+	bucket.isAccelerating.push_back( 0 );
+	bucket.isGarbage.push_back( 0 );
+	bucket.tint.push_back( desc.tint );
+	bucket.slotIndices.push_back( slotIndex );
+
+	EntityHandle handle;
+	handle.slotIndex = slotIndex;
+	handle.generation = slot.generation;
+	return handle;
+}
+
+//--------------------------------------------------------------------------
+/**
+* DestroyEntity
+* Only flags it, the entity is removed on the next CollectGarbage.
+*/
+void EntityStore::DestroyEntity( EntityHandle handle )
+{
+	if( IsValid( handle ) )
+	{
+		const EntitySlot& slot = GetSlot( handle );
+		m_buckets[slot.type].isGarbage[slot.denseIndex] = 1;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* DestroyAll
+*/
+void EntityStore::DestroyAll()
+{
+	for( int typeIdx = 0; typeIdx < NUM_ENTITY_TYPES; ++typeIdx )
+	{
+		EntityBucket& bucket = m_buckets[typeIdx];
+		std::fill( bucket.isGarbage.begin(), bucket.isGarbage.end(), (uint8_t) 1 );
+	}
+	CollectGarbage();
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsValid
+* True while the handle's entity is still stored, even if flagged garbage.
+*/
+bool EntityStore::IsValid( EntityHandle handle ) const
+{
+	return handle.slotIndex < m_slots.size()
+		&& m_slots[handle.slotIndex].isUsed
+		&& m_slots[handle.slotIndex].generation == handle.generation;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsAlive
+*/
+bool EntityStore::IsAlive( EntityHandle handle ) const
+{
+	if( !IsValid( handle ) )
+	{
+		return false;
+	}
+	const EntitySlot& slot = GetSlot( handle );
+	return !m_buckets[slot.type].isGarbage[slot.denseIndex];
+}
+
+//--------------------------------------------------------------------------
+/**
+* Update
+* One pass per bucket, then compaction.
+*/
+void EntityStore::Update( float deltaSeconds )
+{
+	EntityBucket& props = m_buckets[ENTITY_TYPE_PROP];
+	props.previousPositionX = props.positionX;
+	props.previousPositionY = props.positionY;
+
+	{
+		GAME_PROFILE_SCOPE( "IntegrateKinematics" );
+		KinematicsJobArgs moverArgs;
+		moverArgs.bucket = &m_buckets[ENTITY_TYPE_MOVER];
+		moverArgs.deltaSeconds = deltaSeconds;
+		KinematicsJobArgs projectileArgs;
+		projectileArgs.bucket = &m_buckets[ENTITY_TYPE_PROJECTILE];
+		projectileArgs.deltaSeconds = deltaSeconds;
+
+		if( g_theJobSystem != nullptr )
+		{
+			JobHandle movers = g_theJobSystem->ParallelFor( "IntegrateMovers", moverArgs.bucket->GetCount(), ENTITY_JOB_BATCH_SIZE, IntegrateKinematicsJob, &moverArgs );
+			JobHandle projectiles = g_theJobSystem->ParallelFor( "IntegrateProjectiles", projectileArgs.bucket->GetCount(), ENTITY_JOB_BATCH_SIZE, IntegrateKinematicsJob, &projectileArgs );
+			g_theJobSystem->Wait( movers );
+			g_theJobSystem->Wait( projectiles );
+		}
+		else
+		{
+			IntegrateKinematicsJob( &moverArgs, 0, moverArgs.bucket->GetCount() );
+			IntegrateKinematicsJob( &projectileArgs, 0, projectileArgs.bucket->GetCount() );
+		}
+	}
+	{
+		GAME_PROFILE_SCOPE( "UpdateProjectiles" );
+		UpdateProjectiles( m_buckets[ENTITY_TYPE_PROJECTILE] );
+	}
+	{
+		GAME_PROFILE_SCOPE( "CollectGarbage" );
+		CollectGarbage();
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* Render
+* Every entity is drawn as a disc of its cosmetic radius, debug adds the
+* physics radius on top. Positions are blended from the previous update by
+* interpolationAlpha.
+*/
+void EntityStore::Render( RenderCommandBuffer& commands, float interpolationAlpha ) const
+{
+	for( int typeIdx = 0; typeIdx < NUM_ENTITY_TYPES; ++typeIdx )
+	{
+		const EntityBucket& bucket = m_buckets[typeIdx];
+		for( int entityIdx = 0; entityIdx < bucket.GetCount(); ++entityIdx )
+		{
+			float previousX = bucket.previousPositionX[entityIdx];
+			float previousY = bucket.previousPositionY[entityIdx];
+			Vec3 center( previousX + ( bucket.positionX[entityIdx] - previousX ) * interpolationAlpha, previousY + ( bucket.positionY[entityIdx] - previousY ) * interpolationAlpha, 0.0f );
+			commands.AddDisc( center, bucket.cosmeticRadius[entityIdx], bucket.tint[entityIdx] );
+			if( g_isInDebug )
+			{
+				commands.AddDisc( center, bucket.physicsRadius[entityIdx], Rgba( 0.0f, 1.0f, 1.0f, 0.5f ) );
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* CollectGarbage
+* Walks each bucket back to front so swapped in entities were already visited.
+*/
+void EntityStore::CollectGarbage()
+{
+	for( int typeIdx = 0; typeIdx < NUM_ENTITY_TYPES; ++typeIdx )
+	{
+		EntityBucket& bucket = m_buckets[typeIdx];
+		for( int entityIdx = bucket.GetCount() - 1; entityIdx >= 0; --entityIdx )
+		{
+			if( bucket.isGarbage[entityIdx] )
+			{
+				RemoveFromBucket( bucket, entityIdx );
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetPosition
+*/
+Vec2 EntityStore::GetPosition( EntityHandle handle ) const
+{
+	const EntitySlot& slot = GetSlot( handle );
+	const EntityBucket& bucket = m_buckets[slot.type];
+	return Vec2( bucket.positionX[slot.denseIndex], bucket.positionY[slot.denseIndex] );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetVelocity
+*/
+Vec2 EntityStore::GetVelocity( EntityHandle handle ) const
+{
+	const EntitySlot& slot = GetSlot( handle );
+	const EntityBucket& bucket = m_buckets[slot.type];
+	return Vec2( bucket.velocityX[slot.denseIndex], bucket.velocityY[slot.denseIndex] );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetForwardVector
+*/
+Vec2 EntityStore::GetForwardVector( EntityHandle handle ) const
+{
+	const EntitySlot& slot = GetSlot( handle );
+	const EntityBucket& bucket = m_buckets[slot.type];
+	return Vec2( bucket.forwardX[slot.denseIndex], bucket.forwardY[slot.denseIndex] );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetPhysicsRadius
+*/
+float EntityStore::GetPhysicsRadius( EntityHandle handle ) const
+{
+	const EntitySlot& slot = GetSlot( handle );
+	return m_buckets[slot.type].physicsRadius[slot.denseIndex];
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetCosmeticRadius
+*/
+float EntityStore::GetCosmeticRadius( EntityHandle handle ) const
+{
+	const EntitySlot& slot = GetSlot( handle );
+	return m_buckets[slot.type].cosmeticRadius[slot.denseIndex];
+}
+
+//--------------------------------------------------------------------------
+/**
+* SetVelocity
+*/
+void EntityStore::SetVelocity( EntityHandle handle, const Vec2& velocity )
+{
+	const EntitySlot& slot = GetSlot( handle );
+	EntityBucket& bucket = m_buckets[slot.type];
+	bucket.velocityX[slot.denseIndex] = velocity.x;
+	bucket.velocityY[slot.denseIndex] = velocity.y;
+}
+
+//--------------------------------------------------------------------------
+/**
+* SetAcceleration
+*/
+void EntityStore::SetAcceleration( EntityHandle handle, bool on )
+{
+	const EntitySlot& slot = GetSlot( handle );
+	m_buckets[slot.type].isAccelerating[slot.denseIndex] = on ? 1 : 0;
+}
+
+//--------------------------------------------------------------------------
+/**
+* SetRotationDirection
+*/
+void EntityStore::SetRotationDirection( EntityHandle handle, int rotationDirection )
+{
+	const EntitySlot& slot = GetSlot( handle );
+	m_buckets[slot.type].rotateDirection[slot.denseIndex] = (int8_t) rotationDirection;
+}
+
+//--------------------------------------------------------------------------
+/**
+* TakeDamage
+*/
+void EntityStore::TakeDamage( EntityHandle handle, float damage )
+{
+	const EntitySlot& slot = GetSlot( handle );
+	EntityBucket& bucket = m_buckets[slot.type];
+	if( ( bucket.health[slot.denseIndex] -= damage ) <= 0.0f )
+	{
+		bucket.isGarbage[slot.denseIndex] = 1;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetEntityCount
+*/
+int EntityStore::GetEntityCount() const
+{
+	int entityCount = 0;
+	for( int typeIdx = 0; typeIdx < NUM_ENTITY_TYPES; ++typeIdx )
+	{
+		entityCount += m_buckets[typeIdx].GetCount();
+	}
+	return entityCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetHandle
+*/
+EntityHandle EntityStore::GetHandle( eEntityType type, int denseIndex ) const
+{
+	EntityHandle handle;
+	handle.slotIndex = m_buckets[type].slotIndices[denseIndex];
+	handle.generation = m_slots[handle.slotIndex].generation;
+	return handle;
+}
+
+//--------------------------------------------------------------------------
+/**
+* UpdateProjectiles
+* Projectiles die once fully off screen.
+*/
+void EntityStore::UpdateProjectiles( EntityBucket& bucket )
+{
+	int count = bucket.GetCount();
+	for( int entityIdx = 0; entityIdx < count; ++entityIdx )
+	{
+		float x = bucket.positionX[entityIdx];
+		float y = bucket.positionY[entityIdx];
+		float radius = bucket.cosmeticRadius[entityIdx];
+		if( x + radius < 0.0f || y + radius < 0.0f || x - radius > WORLD_WIDTH || y - radius > WORLD_HEIGHT )
+		{
+			bucket.isGarbage[entityIdx] = 1;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* RemoveFromBucket
+* Swap-and-pop every array, fix up the moved entity's slot and free ours.
+*/
+void EntityStore::RemoveFromBucket( EntityBucket& bucket, int denseIndex )
+{
+	uint32_t removedSlot = bucket.slotIndices[denseIndex];
+	uint32_t movedSlot = bucket.slotIndices.back();
+
+	SwapAndPop( bucket.positionX, denseIndex );
+	SwapAndPop( bucket.positionY, denseIndex );
+	SwapAndPop( bucket.previousPositionX, denseIndex );
+	SwapAndPop( bucket.previousPositionY, denseIndex );
+	SwapAndPop( bucket.velocityX, denseIndex );
+	SwapAndPop( bucket.velocityY, denseIndex );
+	SwapAndPop( bucket.orientationDegrees, denseIndex );
+	SwapAndPop( bucket.forwardX, denseIndex );
+	SwapAndPop( bucket.forwardY, denseIndex );
+	SwapAndPop( bucket.angularVelocity, denseIndex );
+	SwapAndPop( bucket.acceleration, denseIndex );
+	SwapAndPop( bucket.angularAcceleration, denseIndex );
+	SwapAndPop( bucket.physicsRadius, denseIndex );
+	SwapAndPop( bucket.cosmeticRadius, denseIndex );
+	SwapAndPop( bucket.health, denseIndex );
+	SwapAndPop( bucket.collisionDamage, denseIndex );
+	SwapAndPop( bucket.rotateDirection, denseIndex );
+	SwapAndPop( bucket.isAccelerating, denseIndex );
+	SwapAndPop( bucket.isGarbage, denseIndex );
+	SwapAndPop( bucket.tint, denseIndex );
+	SwapAndPop( bucket.slotIndices, denseIndex );
+
+	m_slots[movedSlot].denseIndex = (uint32_t) denseIndex;
+
+	EntitySlot& slot = m_slots[removedSlot];
+	slot.isUsed = false;
+	++slot.generation;
+	slot.denseIndex = m_firstFreeSlot;
+	m_firstFreeSlot = removedSlot;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Core/Graphics/Rgba.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+class RenderCommandBuffer;
+
+//--------------------------------------------------------------------------
+// Each type gets its own bucket and its own update pass.
+//--------------------------------------------------------------------------
+enum eEntityType : uint8_t
+{
+	ENTITY_TYPE_PROP = 0,		// Never moves.
+	ENTITY_TYPE_MOVER,			// Integrates velocity and rotation, wraps nothing.
+	ENTITY_TYPE_PROJECTILE,		// Like a mover but dies once off screen.
+
+	NUM_ENTITY_TYPES
+};
+
+//--------------------------------------------------------------------------
+// Refers to an entity without pointing at it. Stale once the entity is
+// collected, the generation no longer matches its slot.
+//--------------------------------------------------------------------------
+struct EntityHandle
+{
+	uint32_t slotIndex = 0xFFFFFFFF;
+	uint32_t generation = 0;
+
+	bool IsNull() const { return slotIndex == 0xFFFFFFFF; }
+	bool operator==( const EntityHandle& other ) const { return slotIndex == other.slotIndex && generation == other.generation; }
+	bool operator!=( const EntityHandle& other ) const { return !( *this == other ); }
+};
+
+//--------------------------------------------------------------------------
+// Everything needed to spawn an entity. Radii are already scaled.
+//--------------------------------------------------------------------------
+struct EntityDesc
+{
+	Vec2 position = Vec2( 0.0f, 0.0f );
+	Vec2 velocity = Vec2( 0.0f, 0.0f );
+	float orientationDegrees = 0.0f;
+	float angularVelocity = 0.0f;
+	float acceleration = 0.0f;
+	float angularAcceleration = 0.0f;
+	float physicsRadius = 1.0f;
+	float cosmeticRadius = 1.0f;
+	float health = 1.0f;
+	float collisionDamage = 1.0f;
+	Rgba tint = Rgba( 1.0f, 1.0f, 1.0f, 1.0f );
+};
+
+//--------------------------------------------------------------------------
+// Structure-of-arrays storage for every live entity of one type. Index i of
+// every array is the same entity, the arrays are kept dense.
+//--------------------------------------------------------------------------
+struct EntityBucket
+{
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> previousPositionX;	// Position before the last Update, for interpolated rendering.
+	std::vector<float> previousPositionY;
+	std::vector<float> velocityX;
+	std::vector<float> velocityY;
+	std::vector<float> orientationDegrees;
+	std::vector<float> forwardX;			// Refreshed by every kinematics pass.
+	std::vector<float> forwardY;
+	std::vector<float> angularVelocity;
+	std::vector<float> acceleration;
+	std::vector<float> angularAcceleration;
+	std::vector<float> physicsRadius;
+	std::vector<float> cosmeticRadius;
+	std::vector<float> health;
+	std::vector<float> collisionDamage;
+	std::vector<int8_t> rotateDirection;	// 1 counter clockwise, -1 clockwise, 0 none.
+	std::vector<uint8_t> isAccelerating;
+	std::vector<uint8_t> isGarbage;
+	std::vector<Rgba> tint;
+	std::vector<uint32_t> slotIndices;		// Back reference for swap-and-pop.
+
+	int GetCount() const { return (int) slotIndices.size(); }
+};
+
+//--------------------------------------------------------------------------
+// Pooled entity storage. Entities are addressed through handles, updated
+// bucket by bucket and compacted with swap-and-pop once they die.
+//--------------------------------------------------------------------------
+class EntityStore
+{
+public:
+	EntityStore();
+	~EntityStore();
+
+	EntityHandle CreateEntity( eEntityType type, const EntityDesc& desc );
+	void DestroyEntity( EntityHandle handle );
+	void DestroyAll();
+	bool IsValid( EntityHandle handle ) const;
+	bool IsAlive( EntityHandle handle ) const;
+
+	void Update( float deltaSeconds );
+	void Render( RenderCommandBuffer& commands, float interpolationAlpha ) const;
+	void CollectGarbage();
+
+	// Per entity access, handle must be valid.
+	Vec2 GetPosition( EntityHandle handle ) const;
+	Vec2 GetVelocity( EntityHandle handle ) const;
+	Vec2 GetForwardVector( EntityHandle handle ) const;
+	float GetPhysicsRadius( EntityHandle handle ) const;
+	float GetCosmeticRadius( EntityHandle handle ) const;
+	void SetVelocity( EntityHandle handle, const Vec2& velocity );
+	void SetAcceleration( EntityHandle handle, bool on );
+	void SetRotationDirection( EntityHandle handle, int rotationDirection );
+	void TakeDamage( EntityHandle handle, float damage );
+
+	int GetEntityCount() const;
+	EntityBucket& GetBucket( eEntityType type ) { return m_buckets[type]; }
+	const EntityBucket& GetBucket( eEntityType type ) const { return m_buckets[type]; }
+	EntityHandle GetHandle( eEntityType type, int denseIndex ) const;
+
+private:
+	struct EntitySlot
+	{
+		uint32_t generation = 0;
+		uint32_t denseIndex = 0;		// Index into the bucket while alive, next free slot while free.
+		eEntityType type = ENTITY_TYPE_PROP;
+		bool isUsed = false;
+	};
+
+	void UpdateProjectiles( EntityBucket& bucket );
+	void RemoveFromBucket( EntityBucket& bucket, int denseIndex );
+
+	const EntitySlot& GetSlot( EntityHandle handle ) const { return m_slots[handle.slotIndex]; }
+
+private:
+	EntityBucket m_buckets[NUM_ENTITY_TYPES];
+	std::vector<EntitySlot> m_slots;
+	uint32_t m_firstFreeSlot = 0xFFFFFFFF;
+};
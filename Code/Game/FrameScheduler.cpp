@@ -0,0 +1,164 @@
+#include "Game/FrameScheduler.hpp"
+
+#include <thread>
+
+//--------------------------------------------------------------------------
+/**
+* FrameScheduler
+*/
+FrameScheduler::FrameScheduler()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~FrameScheduler
+*/
+FrameScheduler::~FrameScheduler()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* Configure
+* A target frame rate of zero or less disables pacing.
+*/
+void FrameScheduler::Configure( float simulationHz, float targetFrameHz )
+{
+	m_tickSeconds = 1.0 / (double) ( simulationHz > 0.0f ? simulationHz : DEFAULT_SIMULATION_HZ );
+	m_framePeriodSeconds = targetFrameHz > 0.0f ? 1.0 / (double) targetFrameHz : 0.0;
+	m_accumulatorSeconds = 0.0;
+	m_hasNextFrameTime = false;
+}
+
+//--------------------------------------------------------------------------
+/**
+* SetBudget
+*/
+void FrameScheduler::SetBudget( int maxSubstepsPerFrame, float simulationBudgetMs )
+{
+	m_maxSubstepsPerFrame = maxSubstepsPerFrame > 0 ? maxSubstepsPerFrame : 1;
+	m_simulationBudgetSeconds = (double) simulationBudgetMs * 0.001;
+}
+
+//--------------------------------------------------------------------------
+/**
+* BeginFrame
+* Banks the (already dilated) frame time and returns the most substeps this
+* frame may run. The caller runs them, checking IsOverTimeBudget between
+* substeps, then reports how many it ran to EndFrame.
+*/
+int FrameScheduler::BeginFrame( double frameSeconds )
+{
+	m_simulationStartTime = std::chrono::steady_clock::now();
+	if( m_isLockstep )
+	{
+		m_stats.substepsOwed = 1;
+		return 1;
+	}
+
+	m_accumulatorSeconds += frameSeconds > 0.0 ? frameSeconds : 0.0;
+	m_stats.substepsOwed = (int) ( m_accumulatorSeconds / m_tickSeconds );
+	return m_stats.substepsOwed < m_maxSubstepsPerFrame ? m_stats.substepsOwed : m_maxSubstepsPerFrame;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsOverTimeBudget
+* Zero or negative budget means only the substep count limits a frame.
+*/
+bool FrameScheduler::IsOverTimeBudget() const
+{
+	if( m_simulationBudgetSeconds <= 0.0 || m_isLockstep )
+	{
+		return false;
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_simulationStartTime;
+	return elapsed.count() >= m_simulationBudgetSeconds;
+}
+
+//--------------------------------------------------------------------------
+/**
+* EndFrame
+* Whole ticks still owed after the substeps that ran are dropped, only the
+* fraction of a tick carries into the next frame.
+*/
+void FrameScheduler::EndFrame( int substepsRun )
+{
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_simulationStartTime;
+	m_stats.simulationMs = elapsed.count();
+	m_stats.substepsRun = substepsRun;
+	m_stats.totalSubsteps += (uint64_t) substepsRun;
+	m_stats.secondsDropped = 0.0;
+
+	if( m_isLockstep )
+	{
+		return;
+	}
+
+	m_accumulatorSeconds -= (double) substepsRun * m_tickSeconds;
+	int ticksStillOwed = (int) ( m_accumulatorSeconds / m_tickSeconds );
+	if( ticksStillOwed > 0 )
+	{
+		m_stats.secondsDropped = (double) ticksStillOwed * m_tickSeconds;
+		m_stats.totalSecondsDropped += m_stats.secondsDropped;
+		m_accumulatorSeconds -= m_stats.secondsDropped;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* WaitForNextFrame
+* Sleeps until the next frame slot, spinning with yields for the last 2ms
+* because sleeps overshoot. If we're already a whole frame late the
+* schedule restarts from now rather than rushing to catch up.
+*/
+void FrameScheduler::WaitForNextFrame()
+{
+	if( m_framePeriodSeconds <= 0.0 )
+	{
+		return;
+	}
+
+	using namespace std::chrono;
+	steady_clock::time_point now = steady_clock::now();
+	steady_clock::duration period = duration_cast<steady_clock::duration>( duration<double>( m_framePeriodSeconds ) );
+
+	if( !m_hasNextFrameTime )
+	{
+		m_nextFrameTime = now;
+		m_hasNextFrameTime = true;
+	}
+	m_nextFrameTime += period;
+	if( now > m_nextFrameTime + period )
+	{
+		m_nextFrameTime = now;
+		return;
+	}
+
+	const steady_clock::duration SPIN_WINDOW = milliseconds( 2 );
+	steady_clock::duration remaining = m_nextFrameTime - now;
+	if( remaining > SPIN_WINDOW )
+	{
+		std::this_thread::sleep_for( remaining - SPIN_WINDOW );
+	}
+	while( steady_clock::now() < m_nextFrameTime )
+	{
+		std::this_thread::yield();
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetInterpolationAlpha
+* How far between the previous and current tick the frame should be drawn.
+*/
+float FrameScheduler::GetInterpolationAlpha() const
+{
+	if( m_isLockstep )
+	{
+		return 1.0f;
+	}
+	float alpha = (float) ( m_accumulatorSeconds / m_tickSeconds );
+	return alpha < 1.0f ? alpha : 1.0f;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <chrono>
+#include <stdint.h>
+
+constexpr float DEFAULT_SIMULATION_HZ = 60.0f;
+constexpr float DEFAULT_TARGET_FRAME_HZ = 60.0f;
+constexpr int DEFAULT_MAX_SUBSTEPS_PER_FRAME = 16;
+constexpr float DEFAULT_SIMULATION_BUDGET_MS = 12.0f;
+
+//--------------------------------------------------------------------------
+// What the scheduler did on the last frame, plus running totals.
+//--------------------------------------------------------------------------
+struct FrameSchedulerStats
+{
+	int substepsOwed = 0;			// Whole ticks the accumulated time asked for.
+	int substepsRun = 0;
+	double secondsDropped = 0.0;	// Simulation time thrown away to stay within budget.
+	double simulationMs = 0.0;		// Wall time spent in the substeps.
+
+	uint64_t totalSubsteps = 0;
+	double totalSecondsDropped = 0.0;
+};
+
+//--------------------------------------------------------------------------
+// Decides how many fixed simulation ticks each frame runs. Frame time goes
+// into an accumulator and whole ticks come out; the remainder becomes the
+// interpolation alpha used to draw between the last two simulated states.
+// Clock dilation therefore shows up as more or fewer substeps of the same
+// size, never as a bigger step.
+//
+// Each frame is bounded by a substep count and a wall time budget. Owed
+// ticks that don't fit are dropped instead of carried over, so a slow frame
+// or a large fast-forward can't spiral into ever longer frames.
+//
+// Also paces frames to a target rate by sleeping, then spinning the last
+// couple of milliseconds, instead of burning a core.
+//--------------------------------------------------------------------------
+class FrameScheduler
+{
+public:
+	FrameScheduler();
+	~FrameScheduler();
+
+	void Configure( float simulationHz, float targetFrameHz );
+	void SetBudget( int maxSubstepsPerFrame, float simulationBudgetMs );
+	void SetLockstep( bool isLockstep ) { m_isLockstep = isLockstep; }
+
+	int BeginFrame( double frameSeconds );
+	bool IsOverTimeBudget() const;
+	void EndFrame( int substepsRun );
+	void WaitForNextFrame();
+
+	float GetTickSeconds() const { return (float) m_tickSeconds; }
+	float GetInterpolationAlpha() const;
+	const FrameSchedulerStats& GetStats() const { return m_stats; }
+
+private:
+	double m_tickSeconds = 1.0 / DEFAULT_SIMULATION_HZ;
+	double m_framePeriodSeconds = 1.0 / DEFAULT_TARGET_FRAME_HZ;
+	double m_accumulatorSeconds = 0.0;
+	int m_maxSubstepsPerFrame = DEFAULT_MAX_SUBSTEPS_PER_FRAME;
+	double m_simulationBudgetSeconds = DEFAULT_SIMULATION_BUDGET_MS * 0.001;
+	bool m_isLockstep = false;	// One tick per frame no matter how much time passed, for headless runs.
+
+	FrameSchedulerStats m_stats;
+	std::chrono::steady_clock::time_point m_simulationStartTime;
+
+	std::chrono::steady_clock::time_point m_nextFrameTime;
+	bool m_hasNextFrameTime = false;
+};
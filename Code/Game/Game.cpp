@@ -1,28 +1,35 @@
-#include "Engine/Renderer/RenderContext.hpp"
-#include "Engine/Renderer/SpriteSheet.hpp"
-#include "Engine/Renderer/SpriteDefinition.hpp"
-#include "Engine/Renderer/BitmapFont.hpp"
-#include "Engine/Renderer/Shaders/Shader.hpp"
-#include "Engine/Renderer/SpriteAnimDefinition.hpp"
-#include "Engine/Renderer/Debug/DebugRenderSystem.hpp"
-
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/Vec2.hpp"
 
 #include "Engine/Core/Debug/DevConsole.hpp"
 #include "Engine/Core/EventSystem.hpp"
-#include "Engine/Core/Time/StopWatch.hpp"
-
-#include "Engine/ImGUI/ImGUISystem.hpp"
-#include "Engine/Input/InputSystem.hpp"
 
 #include "Game/Game.hpp"
 #include "Game/GameCommon.hpp"
 #include "Game/App.hpp"
+#include "Game/FrameScheduler.hpp"
+#include "Game/GameProfiler.hpp"
+#include "Game/DialogueBankBuilder.hpp"
+#include "Game/EngineBackends.hpp"
+#include "Game/InputJournal.hpp"
+#include "Game/GameRandom.hpp"
+#include "Game/JobSystem.hpp"
+#include "Game/RenderCommandBuffer.hpp"
+#include "Game/RenderThread.hpp"
+#include "Game/Grid.hpp"
+#include "Game/GridRenderer.hpp"
+#include "Game/GridConnectivity.hpp"
+#include "Game/GridHistory.hpp"
+#include "Game/GridShapeMatcher.hpp"
+#include "Game/EntityStore.hpp"
+#include "Game/SpatialHash.hpp"
+#include "Game/TranspositionCache.hpp"
 #include <vector>
 
-#include <Math.h>
+#include <math.h>
+
+constexpr float RANDOM_TEXT_SECONDS = 7.0f;		// Quiet time before a random line.
 //--------------------------------------------------------------------------
 /**
 * Game
@@ -47,41 +54,44 @@ Game::~Game()
 */
 void Game::Startup()
 {
-	m_shader = g_theRenderer->CreateOrGetShaderFromXML( "Data/Shaders/shader.xml" );
-	g_theRenderer->m_shader = m_shader;
+	g_theEngineBackends->BindDefaultShader( "Data/Shaders/shader.xml" );
 
 	m_DevColsoleCamera.SetOrthographicProjection( Vec2( -100.0f, -50.0f ), Vec2( 100.0f,  50.0f ) );
 	m_DevColsoleCamera.SetModelMatrix( Matrix44::IDENTITY );
+	m_CurentCamera.SetOrthographicProjection( Vec2(), Vec2( WORLD_WIDTH, WORLD_HEIGHT ) );
+	m_CurentCamera.SetModelMatrix( Matrix44::IDENTITY );
 
-	EventArgs args;
-	g_theDebugRenderSystem->Command_Open(args);
-
-
-	player_bad_response.push_back("...");
-	player_bad_response.push_back("Boooooo...");
-	
-	player_good_response.push_back("Great!");
-	player_good_response.push_back("Good!");
-	player_good_response.push_back("Nice, lets move on.");
-
-	player_recovery_response.push_back("Really? It's going to be like that?");
-	player_recovery_response.push_back("You probably weren't ready for that.");
+	g_theEngineBackends->OpenDebugRender();
 
-	player_random_diolog.push_back( "Do.. do do.. do do...");
-	player_random_diolog.push_back( "Well, your still here I guess." );
-	player_random_diolog.push_back( "Wonder what's for dinner." );
-	player_random_diolog.push_back( "I might set up a party next week..." );
-	player_random_diolog.push_back( "I can see your doing your best, I guess." );
-	player_random_diolog.push_back( "Don't mind me. I'm just waiting." );
-	player_random_diolog.push_back( "Hmmm, tuna, tomato, block.. oh wait, shouldn't give hints" );
-	player_random_diolog.push_back( "You can do it! (I wonder how well they can build.)" );
 
-	responseTimer = new StopWatch( g_theApp->GetGameClock() );
-	responseTimer->SetAndReset( 0.01f );
+	LoadDialogue();
+	m_shownText.reserve( (size_t) m_dialogue.GetMaxLineLength() + 1 );
 
-	randomTextTimer = new StopWatch( g_theApp->GetGameClock() );
+	BeginSession();
+}
 
-	player_text_queue.push("hello, you ready?");
+//--------------------------------------------------------------------------
+/**
+* BeginSession
+* The conversation from the greeting, with no answer given yet. Random
+* chatter runs from the start, as it did before the timer wheel.
+*/
+void Game::BeginSession()
+{
+	m_timers = new TimerWheel( g_theApp->GetFrameScheduler()->GetTickSeconds() );
+	m_responseTimer = TimerHandle();
+	m_randomTextTimer = TimerHandle();
+
+	m_textQueue.Clear();
+	m_shownLineId = INVALID_DIALOGUE_LINE;
+	yes = KeyButtonState();
+	no = KeyButtonState();
+	begun = false;
+	m_isSkipTextRequested = false;
+
+	RestartResponseTimer( 0.01f );
+	RestartRandomTextTimer();
+	m_textQueue.Push( m_lineGreeting );
 }
 
 //--------------------------------------------------------------------------
@@ -90,7 +100,41 @@ void Game::Startup()
 */
 void Game::Shutdown()
 {
+	SAFE_DELETE( m_timers );
+}
 
+//--------------------------------------------------------------------------
+/**
+* LoadDialogue
+* Maps the compiled bank. The XML is only read when the bank is missing or
+* dialogueFromXml is set, so writers can iterate without recompiling.
+*/
+void Game::LoadDialogue()
+{
+	std::string bankPath = g_gameConfigBlackboard.GetValue( "dialogueBank", DIALOGUE_BANK_PATH );
+	std::string xmlPath = g_gameConfigBlackboard.GetValue( "dialogueXml", DIALOGUE_XML_PATH );
+	bool isLoaded = !g_gameConfigBlackboard.GetValue( "dialogueFromXml", false ) && m_dialogue.LoadFromFile( bankPath );
+	if( !isLoaded )
+	{
+		DialogueBankBuilder builder;
+		std::vector<uint8_t> blob;
+		if( builder.AddFromXml( xmlPath ) )
+		{
+			builder.Build( &blob );
+			isLoaded = m_dialogue.LoadFromBlob( std::move( blob ) );
+		}
+	}
+	ASSERT_RECOVERABLE( isLoaded, "No dialogue, missing " + bankPath + " and " + xmlPath );
+
+	m_bankBad = m_dialogue.FindBank( "bad" );
+	m_bankGood = m_dialogue.FindBank( "good" );
+	m_bankRecovery = m_dialogue.FindBank( "recovery" );
+	m_bankRandom = m_dialogue.FindBank( "random" );
+
+	m_lineGreeting = m_dialogue.FindKeyedLine( "greeting" );
+	m_lineGetStarted = m_dialogue.FindKeyedLine( "get_started" );
+	m_lineGetStartedAnyway = m_dialogue.FindKeyedLine( "get_started_anyway" );
+	m_lineLeaveItToYou = m_dialogue.FindKeyedLine( "leave_it_to_you" );
 }
 
 static int g_index = 0;
@@ -101,6 +145,11 @@ static int g_index = 0;
 */
 bool Game::HandleKeyPressed( unsigned char keyCode )
 {
+	if( keyCode == ' ' ) // VK_SPACE
+	{
+		m_isSkipTextRequested = true;
+		return true;
+	}
 	if( keyCode == 'O' )
 	{
 		g_index = ++g_index % ( 8 * 2 );
@@ -118,102 +167,325 @@ bool Game::HandleKeyPressed( unsigned char keyCode )
 //--------------------------------------------------------------------------
 /**
 * HandleKeyReleased
+* Never consumes the key, see App::IsKeyReleaseConsumed.
 */
-bool Game::HandleKeyReleased( unsigned char keyCode )
+void Game::HandleKeyReleased( unsigned char keyCode )
 {
 	UNUSED(keyCode);
-	return false;
+}
+
+//--------------------------------------------------------------------------
+/**
+* HandleUIEvent
+* The answer to the opening question, only counts once.
+*/
+bool Game::HandleUIEvent( eGameUIEvent uiEvent )
+{
+	if( begun )
+	{
+		return false;
+	}
+
+	switch( uiEvent )
+	{
+	case GAME_UI_YES:
+		PushTextToPlayer( GetGoodResponse() );
+		PushTextToPlayer( m_lineGetStarted );
+		PushTextToPlayer( m_lineLeaveItToYou );
+		break;
+	case GAME_UI_NO:
+		PushTextToPlayer( GetBadResponse() );
+		PushTextToPlayer( GetRecoveryResponse() );
+		PushTextToPlayer( m_lineGetStartedAnyway );
+		PushTextToPlayer( m_lineLeaveItToYou );
+		break;
+	default:
+		return false;
+	}
+	begun = true;
+	RestartRandomTextTimer();
+	return true;
 }
 
 
 //--------------------------------------------------------------------------
 /**
 * GameRender
+* Records the world into commands, the RenderThread draws it later.
+*/
+void Game::GameRender( RenderCommandBuffer& commands, float interpolationAlpha ) const
+{
+	commands.BeginCamera( &m_CurentCamera );
+	{
+		GAME_PROFILE_SCOPE( "GridRenderer::Render" );
+		m_gridRenderer->Render( commands );
+	}
+	{
+		GAME_PROFILE_SCOPE( "EntityStore::Render" );
+		m_entities->Render( commands, interpolationAlpha );
+	}
+
+	commands.AddCallback( RenderDebugToCamera, (void*) this );
+}
+
+//--------------------------------------------------------------------------
+/**
+* RenderDebugToCamera
+* Runs on the render thread.
 */
-void Game::GameRender() const
+void Game::RenderDebugToCamera( void* game )
 {
-	g_theDebugRenderSystem->RenderToCamera( &m_DevColsoleCamera );
+	g_theEngineBackends->RenderDebugToCamera( &( (const Game*) game )->m_DevColsoleCamera );
 }
 
 //--------------------------------------------------------------------------
 /**
 * UpdateGame
+* One fixed simulation tick.
 */
 void Game::UpdateGame( float deltaSeconds )
 {
-	UpdateTextToPlayer( deltaSeconds );
-	ImGUIWidget();
-	UpdateCamera( deltaSeconds );
+	GAME_PROFILE_SCOPE( "Game::UpdateGame" );
+	{
+		GAME_PROFILE_SCOPE( "Entities" );
+		m_entities->Update( deltaSeconds );
+		m_isSpatialHashBuilt = false;
+	}
+	{
+		GAME_PROFILE_SCOPE( "TextToPlayer" );
+		UpdateTextToPlayer( deltaSeconds );
+	}
+	{
+		GAME_PROFILE_SCOPE( "Timers" );
+		m_timers->Advance( deltaSeconds );
+	}
+
+	// Every tick that changed the board is one step of the history.
+	m_grid->GetHistory()->Checkpoint();
+	UpdateBuildEvaluation();
 }
 
+//--------------------------------------------------------------------------
+/**
+* UpdateBuildEvaluation
+* Only when the board changed. A board seen before, like one restored by an
+* undo, comes out of the cache.
+*/
+void Game::UpdateBuildEvaluation()
+{
+	if( m_buildEvaluator == nullptr )
+	{
+		return;
+	}
 
+	// A level load can leave the board a different size than the target.
+	const IntVec2& dimensions = m_grid->GetDimensions();
+	if( dimensions.x != m_buildEvaluator->GetDimensions().x || dimensions.y != m_buildEvaluator->GetDimensions().y )
+	{
+		return;
+	}
+
+	uint64_t boardHash = m_grid->GetZobristHash();
+	if( m_isBuildEvaluated && boardHash == m_buildEvaluatedHash )
+	{
+		return;
+	}
+
+	GAME_PROFILE_SCOPE( "BuildEvaluator::Evaluate" );
+	m_buildEvaluation = m_buildEvaluator->Evaluate( *m_grid );
+	m_buildEvaluatedHash = boardHash;
+	m_isBuildEvaluated = true;
+}
 
 //--------------------------------------------------------------------------
 /**
-* GetBadResponse
+* SetBuildTarget
+* Every block of the level is a target cell.
+*/
+bool Game::SetBuildTarget( const std::string& levelPath, eLevelTrust trust )
+{
+	Grid target;
+	if( !target.LoadLevelFile( levelPath, trust ) )
+	{
+		return false;
+	}
+	std::vector<IntVec2> targetCells;
+	target.GetOccupiedCells( &targetCells );
+
+	if( m_buildEvaluator == nullptr )
+	{
+		m_buildEvaluator = new BuildEvaluator( m_buildCache );
+	}
+	m_buildEvaluator->SetTarget( target.GetDimensions(), targetCells );
+	m_isBuildEvaluated = false;
+	UpdateBuildEvaluation();
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* UpdateFrame
+* Once per rendered frame: input sampling, UI and render prep.
 */
-const std::string& Game::GetBadResponse()
+void Game::UpdateFrame( float deltaSeconds )
 {
-	ASSERT_RECOVERABLE(player_bad_response.size(), "player_bad_response empty ");
+	{
+		GAME_PROFILE_SCOPE( "ImGUIWidget" );
+		ImGUIWidget();
+	}
+	UNUSED( deltaSeconds );
+	GAME_PROFILE_SCOPE( "GridRenderer::Update" );
+	m_gridRenderer->Update();
+}
+
+
 
-	float roll = GetRandomFloatFromZeroToOne();
-	uint idx = (uint)( ( (float)player_bad_response.size() - 1 ) * roll );
-	return player_bad_response[idx];
+//--------------------------------------------------------------------------
+/**
+* GetSpatialHash
+* Nothing in a tick queries it yet, so it's only rebuilt for whoever asks.
+*/
+const SpatialHash* Game::GetSpatialHash()
+{
+	if( !m_isSpatialHashBuilt )
+	{
+		GAME_PROFILE_SCOPE( "SpatialHash" );
+		m_spatialHash->BuildFromEntities( *m_entities );
+		m_isSpatialHashBuilt = true;
+	}
+	return m_spatialHash;
+}
+
+//--------------------------------------------------------------------------
+/**
+* SpawnRandomEntities
+* Movers scattered over the world, used to stress the entity update. All
+* the rolls come from the spawn stream in one batch.
+*/
+void Game::SpawnRandomEntities( int count )
+{
+	constexpr int ROLLS_PER_ENTITY = 9;
+	std::vector<float> rolls( (size_t) count * ROLLS_PER_ENTITY );
+	g_theGameRandom->GetStream( RANDOM_STREAM_SPAWN ).FillFloatsZeroToOne( rolls.data(), (int) rolls.size() );
+
+	for( int spawnIdx = 0; spawnIdx < count; ++spawnIdx )
+	{
+		const float* roll = &rolls[(size_t) spawnIdx * ROLLS_PER_ENTITY];
+		EntityDesc desc;
+		desc.position = Vec2( roll[0] * WORLD_WIDTH, roll[1] * WORLD_HEIGHT );
+		desc.velocity = Vec2( roll[2] * 20.0f - 10.0f, roll[3] * 20.0f - 10.0f );
+		desc.orientationDegrees = roll[4] * 360.0f;
+		desc.angularVelocity = roll[5] * 180.0f - 90.0f;
+		desc.physicsRadius = 0.5f;
+		desc.cosmeticRadius = 0.6f;
+		desc.tint = Rgba( roll[6], roll[7], roll[8], 1.0f );
+		m_entities->CreateEntity( ENTITY_TYPE_MOVER, desc );
+	}
+	m_isSpatialHashBuilt = false;
+}
+
+//--------------------------------------------------------------------------
+/**
+* ComputeStateHash
+* Folds the simulated state into one number so replays can be checked
+* against the recording. Render and UI state are left out.
+*/
+uint64_t Game::ComputeStateHash() const
+{
+	uint64_t hash = STATE_HASH_SEED;
+
+	for( int chunkIdx = 0; chunkIdx < m_grid->GetChunkCount(); ++chunkIdx )
+	{
+		const GridChunk& chunk = m_grid->GetChunk( chunkIdx );
+		if( chunk.cells != nullptr && chunk.blockCount > 0 )
+		{
+			hash = HashBytes( hash, &chunkIdx, sizeof( chunkIdx ) );
+			hash = HashBytes( hash, chunk.cells.get(), sizeof( GridChunkCells ) );
+		}
+	}
+
+	for( int typeIdx = 0; typeIdx < NUM_ENTITY_TYPES; ++typeIdx )
+	{
+		const EntityBucket& bucket = m_entities->GetBucket( (eEntityType) typeIdx );
+		hash = HashVector( hash, bucket.positionX );
+		hash = HashVector( hash, bucket.positionY );
+		hash = HashVector( hash, bucket.velocityX );
+		hash = HashVector( hash, bucket.velocityY );
+		hash = HashVector( hash, bucket.orientationDegrees );
+		hash = HashVector( hash, bucket.health );
+	}
+
+	DialogueLineId shownLine = m_textQueue.Front();
+	int queuedLines = m_textQueue.GetSize();
+	uint64_t timerTick = m_timers->GetCurrentTick();
+	int pendingTimers = m_timers->GetPendingCount();
+	hash = HashBytes( hash, &shownLine, sizeof( shownLine ) );
+	hash = HashBytes( hash, &queuedLines, sizeof( queuedLines ) );
+	hash = HashBytes( hash, &timerTick, sizeof( timerTick ) );
+	hash = HashBytes( hash, &pendingTimers, sizeof( pendingTimers ) );
+	hash = HashBytes( hash, &begun, sizeof( begun ) );
+	hash = g_theGameRandom->HashState( hash );
+	return hash;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetBadResponse
+*/
+DialogueLineId Game::GetBadResponse() const
+{
+	return m_dialogue.GetRandomLine( m_bankBad, g_theGameRandom->GetStream( RANDOM_STREAM_DIALOGUE ) );
 }
 
 //--------------------------------------------------------------------------
 /**
 * GetGoodResponse
 */
-const std::string& Game::GetGoodResponse()
+DialogueLineId Game::GetGoodResponse() const
 {
-	ASSERT_RECOVERABLE( player_good_response.size(), "player_good_response empty " );
-	float roll = GetRandomFloatFromZeroToOne();
-	uint idx = (uint)(((float)player_good_response.size() - 1) * roll);
-	return player_good_response[idx];
+	return m_dialogue.GetRandomLine( m_bankGood, g_theGameRandom->GetStream( RANDOM_STREAM_DIALOGUE ) );
 }
 
 //--------------------------------------------------------------------------
 /**
 * GetRecoveryResponse
 */
-const std::string& Game::GetRecoveryResponse()
+DialogueLineId Game::GetRecoveryResponse() const
 {
-	ASSERT_RECOVERABLE(player_recovery_response.size(), "player_recovery_response empty ");
-	float roll = GetRandomFloatFromZeroToOne();
-	uint idx = (uint)(((float)player_recovery_response.size() - 1) * roll);
-	return player_recovery_response[idx];
+	return m_dialogue.GetRandomLine( m_bankRecovery, g_theGameRandom->GetStream( RANDOM_STREAM_DIALOGUE ) );
 }
 
 //--------------------------------------------------------------------------
 /**
 * GetRandomText
 */
-const std::string& Game::GetRandomText()
+DialogueLineId Game::GetRandomText() const
 {
-	ASSERT_RECOVERABLE(player_random_diolog.size(), "player_random_diolog empty ");
-	float roll = GetRandomFloatFromZeroToOne();
-	uint idx = (uint)(((float)player_random_diolog.size() - 1) * roll);
-	return player_random_diolog[idx];
+	return m_dialogue.GetRandomLine( m_bankRandom, g_theGameRandom->GetStream( RANDOM_STREAM_DIALOGUE ) );
 }
 
 //--------------------------------------------------------------------------
 /**
 * PushTextToPlayer
 */
-void Game::PushTextToPlayer( const std::string& text )
+void Game::PushTextToPlayer( DialogueLineId lineId )
 {
-	player_text_queue.push( text );
-	responseTimer->SetAndReset(0.000001f);
+	if( lineId == INVALID_DIALOGUE_LINE )
+	{
+		return;
+	}
+	ASSERT_RECOVERABLE( !m_textQueue.IsFull(), "player text queue full, line dropped " );
+	m_textQueue.Push( lineId );
+	RestartResponseTimer( 0.0f );
 }
 
 //--------------------------------------------------------------------------
 /**
 * GetNextTextToPlayer
 */
-const std::string& Game::SeeTextToPlayer() const
+std::string_view Game::SeeTextToPlayer() const
 {
-	return player_text_queue.front();
+	return m_dialogue.GetLine( m_textQueue.Front() );
 }
 
 //--------------------------------------------------------------------------
@@ -223,9 +495,9 @@ const std::string& Game::SeeTextToPlayer() const
 bool Game::PopTextToPlayer()
 {
 	// Ensure there's always something to show, if you want blank. Post "".
-	if( player_text_queue.size() > 1 )
+	if( m_textQueue.GetSize() > 1 )
 	{
-		player_text_queue.pop();
+		m_textQueue.Pop();
 		return true;
 	}
 	return false;
@@ -238,21 +510,83 @@ bool Game::PopTextToPlayer()
 */
 void Game::UpdateTextToPlayer(float deltaSeconds)
 {
-	if( responseTimer->HasElapsed() || g_theInputSystem->KeyWasPressed( KEY_SPACEBAR ) )
+	UNUSED( deltaSeconds );
+	bool skipPressed = m_isSkipTextRequested;
+	m_isSkipTextRequested = false;
+	if( skipPressed )
 	{
-		if( PopTextToPlayer() )
-		{
-			randomTextTimer->Reset();
-		}
-		responseTimer->SetAndReset(3.0f);
+		OnResponseTimer();
+		OnRandomTextTimer();
 	}
-	if ( ( randomTextTimer->HasElapsed() || g_theInputSystem->KeyWasPressed( KEY_SPACEBAR ) ) && player_text_queue.size() == 1 )
+}
+
+//--------------------------------------------------------------------------
+/**
+* RestartResponseTimer
+*/
+void Game::RestartResponseTimer( float delaySeconds )
+{
+	m_timers->Cancel( m_responseTimer );
+	m_responseTimer = m_timers->Schedule( delaySeconds, ResponseTimerCallback, this );
+}
+
+//--------------------------------------------------------------------------
+/**
+* RestartRandomTextTimer
+*/
+void Game::RestartRandomTextTimer()
+{
+	m_timers->Cancel( m_randomTextTimer );
+	m_randomTextTimer = m_timers->Schedule( RANDOM_TEXT_SECONDS, RandomTextTimerCallback, this );
+}
+
+//--------------------------------------------------------------------------
+/**
+* OnResponseTimer
+* Shows the next queued line, then waits a while before the one after.
+*/
+void Game::OnResponseTimer()
+{
+	if( PopTextToPlayer() )
+	{
+		RestartRandomTextTimer();
+	}
+	RestartResponseTimer( 3.0f );
+}
+
+//--------------------------------------------------------------------------
+/**
+* OnRandomTextTimer
+* Only chatters when nothing else is waiting. If something is, the next
+* pop restarts this timer anyway.
+*/
+void Game::OnRandomTextTimer()
+{
+	if( m_textQueue.GetSize() == 1 )
 	{
 		PushTextToPlayer( GetRandomText() );
-		randomTextTimer->Reset();
+		RestartRandomTextTimer();
 	}
 }
 
+//--------------------------------------------------------------------------
+/**
+* ResponseTimerCallback
+*/
+void Game::ResponseTimerCallback( void* game )
+{
+	( (Game*) game )->OnResponseTimer();
+}
+
+//--------------------------------------------------------------------------
+/**
+* RandomTextTimerCallback
+*/
+void Game::RandomTextTimerCallback( void* game )
+{
+	( (Game*) game )->OnRandomTextTimer();
+}
+
 //--------------------------------------------------------------------------
 /**
 * ImGUIWidget
@@ -260,74 +594,138 @@ void Game::UpdateTextToPlayer(float deltaSeconds)
 void Game::ImGUIWidget()
 {
 	int flags = ( 1 ) | (1 << 1) | (1 << 2) | (1 << 3) | (1 << 13);
+	if( m_shownLineId != m_textQueue.Front() )
+	{
+		m_shownLineId = m_textQueue.Front();
+		m_shownText.assign( SeeTextToPlayer() );
+	}
+
 	if( begun )
 	{
 
-		ImGUI_BeginWindow("top left Widget", 0, flags);
+		g_theEngineBackends->BeginWindow( "top left Widget", flags );
 
-		ImGUI_Text( SeeTextToPlayer() );
+		g_theEngineBackends->Text( m_shownText );
 
-		ImGUI_EndWindow();
+		g_theEngineBackends->EndWindow();
 	}
 	else
 	{
-		ImGUI_BeginWindow("beginning Widget", 0, flags);
+		g_theEngineBackends->BeginWindow( "beginning Widget", flags );
 
-		ImGUI_Text( SeeTextToPlayer() );
-		ImGUI_Text( "" );
-		ImGUI_Text( "" );
+		g_theEngineBackends->Text( m_shownText );
+		g_theEngineBackends->Text( "" );
+		g_theEngineBackends->Text( "" );
 
 
 		bool yesButton = yes.IsPressed();
 		bool noButton = no.IsPressed();
-		yes.UpdateStatus( ImGUI_SelectableText( "Yes", yesButton ) );
-		no.UpdateStatus( ImGUI_SelectableText( "No", noButton ) );
+		yes.UpdateStatus( g_theEngineBackends->SelectableText( "Yes", yesButton ) );
+		no.UpdateStatus( g_theEngineBackends->SelectableText( "No", noButton ) );
 
 		if( yes.WasJustPressed() )
 		{
-			PushTextToPlayer( GetGoodResponse() );
-			PushTextToPlayer( "Ok, lets get started");
-			PushTextToPlayer( "I'll leave the rest to you");
-			begun = true;
-			randomTextTimer->SetAndReset( 7.0f );
+			g_theApp->HandleUIEvent( GAME_UI_YES );
 		}
-		if( no.WasJustPressed() )
+		else if( no.WasJustPressed() )
 		{
-			PushTextToPlayer( GetBadResponse() );
-			PushTextToPlayer( GetRecoveryResponse() );
-			PushTextToPlayer("Ok, lets get started anyway...");
-			PushTextToPlayer("I'll leave the rest to you");
-			begun = true;
-			randomTextTimer->SetAndReset( 7.0f );
+			g_theApp->HandleUIEvent( GAME_UI_NO );
 		}
-		ImGUI_EndWindow();
+		g_theEngineBackends->EndWindow();
 	}
 
-
-}
-
-//--------------------------------------------------------------------------
-/**
-* UpdateCamera
-*/
-void Game::UpdateCamera( float deltaSeconds )
-{
-	UNUSED( deltaSeconds );
-	m_CurentCamera.SetModelMatrix( Matrix44::IDENTITY );
-	m_CurentCamera.SetOrthographicProjection( Vec2(), Vec2(WORLD_WIDTH, WORLD_HEIGHT) );
-	m_CurentCamera.SetColorTargetView( g_theRenderer->GetColorTargetView() );
-	m_CurentCamera.SetDepthTargetView( g_theRenderer->GetDepthTargetView() );
-	g_theRenderer->BeginCamera( &m_CurentCamera );
+	if( g_isInDebug )
+	{
+		g_theEngineBackends->BeginWindow( "Grid Stats", flags );
+		g_theEngineBackends->Text( "Blocks: " + std::to_string( m_grid->GetBlockCount() ) );
+		g_theEngineBackends->Text( "Chunks re-meshed this frame: " + std::to_string( m_gridRenderer->GetChunksRebuiltLastUpdate() ) );
+		g_theEngineBackends->Text( "Chunks re-meshed total: " + std::to_string( m_gridRenderer->GetTotalChunksRebuilt() ) );
+		g_theEngineBackends->Text( "Grid vertices: " + std::to_string( m_gridRenderer->GetVertexCount() ) );
+		GridConnectivity* connectivity = m_grid->GetConnectivity();
+		g_theEngineBackends->Text( "Structures grounded / floating: " + std::to_string( connectivity->GetGroundedComponentCount() ) + " / " + std::to_string( connectivity->GetFloatingComponentCount() ) );
+		g_theEngineBackends->Text( "Structure re-links: " + std::to_string( connectivity->GetStats().splitRebuilds ) );
+		GridShapeMatcher* shapeMatcher = m_grid->GetShapeMatcher();
+		g_theEngineBackends->Text( "Target shapes found: " + std::to_string( shapeMatcher->GetFoundTargetCount() ) + " / " + std::to_string( shapeMatcher->GetTargetCount() ) );
+		if( m_buildEvaluator != nullptr )
+		{
+			TranspositionCacheStats buildCacheStats = m_buildCache->GetStats();
+			g_theEngineBackends->Text( "Build matched / missing / extra: " + std::to_string( m_buildEvaluation.matchedCells ) + " / " + std::to_string( m_buildEvaluation.missingCells ) + " / " + std::to_string( m_buildEvaluation.extraBlocks ) );
+			g_theEngineBackends->Text( "Build score: " + std::to_string( m_buildEvaluation.score ) );
+			g_theEngineBackends->Text( "Build cache hit rate: " + std::to_string( (int) ( 100.0 * buildCacheStats.GetHitRate() ) ) + "% of " + std::to_string( buildCacheStats.lookups ) );
+		}
+		else
+		{
+			g_theEngineBackends->Text( "Build target: none" );
+		}
+		GridHistory* history = m_grid->GetHistory();
+		g_theEngineBackends->Text( "History undo / redo: " + std::to_string( history->GetUndoCount() ) + " / " + std::to_string( history->GetRedoCount() ) );
+		g_theEngineBackends->Text( "History chunks held: " + std::to_string( history->GetRetainedChunkCount() ) );
+		g_theEngineBackends->Text( "Entities: " + std::to_string( m_entities->GetEntityCount() ) );
+		g_theEngineBackends->EndWindow();
+
+		const FrameSchedulerStats& schedulerStats = g_theApp->GetFrameScheduler()->GetStats();
+		g_theEngineBackends->BeginWindow( "Simulation Stats", flags );
+		g_theEngineBackends->Text( "Substeps run / owed: " + std::to_string( schedulerStats.substepsRun ) + " / " + std::to_string( schedulerStats.substepsOwed ) );
+		g_theEngineBackends->Text( "Simulation ms: " + std::to_string( schedulerStats.simulationMs ) );
+		g_theEngineBackends->Text( "Dropped this frame (s): " + std::to_string( schedulerStats.secondsDropped ) );
+		g_theEngineBackends->Text( "Dropped total (s): " + std::to_string( schedulerStats.totalSecondsDropped ) );
+		g_theEngineBackends->Text( "Substeps total: " + std::to_string( schedulerStats.totalSubsteps ) );
+		g_theEngineBackends->Text( "Timers pending: " + std::to_string( m_timers->GetPendingCount() ) );
+		g_theEngineBackends->EndWindow();
+
+		const RenderThreadStats& renderStats = g_theApp->GetRenderThread()->GetStats();
+		g_theEngineBackends->BeginWindow( "Render Stats", flags );
+		g_theEngineBackends->Text( std::string( "Render thread: " ) + ( g_theApp->GetRenderThread()->IsThreaded() ? "on" : "off" ) );
+		g_theEngineBackends->Text( "Execute ms: " + std::to_string( renderStats.executeMs ) );
+		g_theEngineBackends->Text( "Main thread wait ms: " + std::to_string( renderStats.waitMs ) );
+		g_theEngineBackends->Text( "Commands: " + std::to_string( renderStats.commandCount ) );
+		g_theEngineBackends->Text( "Vertices / discs: " + std::to_string( renderStats.vertexCount ) + " / " + std::to_string( renderStats.discCount ) );
+		g_theEngineBackends->EndWindow();
+
+		const JobSystemStats& jobStats = g_theJobSystem->GetLastFrameStats();
+		g_theEngineBackends->BeginWindow( "Job Stats", flags );
+		g_theEngineBackends->Text( "Workers: " + std::to_string( jobStats.workerCount ) );
+		g_theEngineBackends->Text( "Jobs run: " + std::to_string( jobStats.jobsRun ) );
+		g_theEngineBackends->Text( "Jobs stolen: " + std::to_string( jobStats.jobsStolen ) );
+		g_theEngineBackends->Text( "Jobs run inline: " + std::to_string( jobStats.jobsRunInline ) );
+		g_theEngineBackends->Text( "Busy ms (all threads): " + std::to_string( jobStats.busyMs ) );
+		g_theEngineBackends->EndWindow();
+
+		const InputLatencyStats& inputStats = g_theApp->GetInputLatencyStats();
+		g_theEngineBackends->BeginWindow( "Input Stats", flags );
+		g_theEngineBackends->Text( "Events this frame: " + std::to_string( inputStats.eventsLastFrame ) );
+		g_theEngineBackends->Text( "Latency avg / max ms: " + std::to_string( inputStats.averageMsLastFrame ) + " / " + std::to_string( inputStats.maxMsLastFrame ) );
+		g_theEngineBackends->Text( "Latency max ms (session): " + std::to_string( inputStats.maxMs ) );
+		g_theEngineBackends->Text( "Events total / dropped: " + std::to_string( inputStats.totalEvents ) + " / " + std::to_string( inputStats.droppedEvents ) );
+		g_theEngineBackends->EndWindow();
+
+		GameProfilerImGUIWidget( flags );
+	}
 }
 
 //--------------------------------------------------------------------------
 /**
 * ResetGame
+* Back to a fresh session without rebuilding the Game: the dialogue stays
+* mapped and the board rewinds through its history, so only chunks changed
+* since the start are touched: re-meshed, re-linked and rechecked for shapes.
+* The start is the last level loaded, or the board the game began with.
 */
 void Game::ResetGame()
 {
-	DeconstructGame();
-	ConstructGame();
+	GridHistory* history = m_grid->GetHistory();
+	history->RewindToStart();
+	history->Reset();
+	m_isBuildEvaluated = false;
+
+	SAFE_DELETE( m_spatialHash );
+	SAFE_DELETE( m_entities );
+	m_entities = new EntityStore();
+	m_spatialHash = new SpatialHash( Vec2( 0.0f, 0.0f ), Vec2( WORLD_WIDTH, WORLD_HEIGHT ), 1.0f );
+	m_isSpatialHashBuilt = false;
+
+	SAFE_DELETE( m_timers );
+	BeginSession();
 }
 
 //--------------------------------------------------------------------------
@@ -336,7 +734,41 @@ void Game::ResetGame()
 */
 void Game::ConstructGame()
 {
+	IntVec2 gridDimensions( g_gameConfigBlackboard.GetValue( "gridWidth", 10 ), g_gameConfigBlackboard.GetValue( "gridHeight", 10 ) );
+	m_grid = new Grid( gridDimensions );
+	m_grid->EnableConnectivity();
+	m_grid->EnableShapeMatching();
+	std::string levelPath = g_gameConfigBlackboard.GetValue( "levelFile", "" );
+	if( !levelPath.empty() && !m_grid->LoadLevelFile( levelPath, LEVEL_TRUSTED ) )
+	{
+		ERROR_RECOVERABLE( "Could not load level " + levelPath );
+	}
+	m_grid->EnableHistory( g_gameConfigBlackboard.GetValue( "gridHistorySize", DEFAULT_GRID_HISTORY_SIZE ) );
+
+	// Level files, ';' between them.
+	std::string targetShapes = g_gameConfigBlackboard.GetValue( "targetShapes", "" );
+	for( size_t pathStart = 0; pathStart < targetShapes.size(); )
+	{
+		size_t pathEnd = targetShapes.find( ';', pathStart );
+		pathEnd = pathEnd == std::string::npos ? targetShapes.size() : pathEnd;
+		std::string shapePath = targetShapes.substr( pathStart, pathEnd - pathStart );
+		if( !shapePath.empty() && m_grid->GetShapeMatcher()->AddTargetFromLevel( shapePath, LEVEL_TRUSTED ) < 0 )
+		{
+			ERROR_RECOVERABLE( "Could not load target shape " + shapePath );
+		}
+		pathStart = pathEnd + 1;
+	}
+
+	m_buildCache = new SharedTranspositionCache( DEFAULT_BUILD_CACHE_CAPACITY, 1 );
+	std::string buildTargetPath = g_gameConfigBlackboard.GetValue( "buildTarget", "" );
+	if( !buildTargetPath.empty() && !SetBuildTarget( buildTargetPath, LEVEL_TRUSTED ) )
+	{
+		ERROR_RECOVERABLE( "Could not load build target " + buildTargetPath );
+	}
 
+	m_entities = new EntityStore();
+	m_spatialHash = new SpatialHash( Vec2( 0.0f, 0.0f ), Vec2( WORLD_WIDTH, WORLD_HEIGHT ), 1.0f );
+	m_gridRenderer = new GridRenderer( m_grid );
 }
 
 //--------------------------------------------------------------------------
@@ -345,5 +777,10 @@ void Game::ConstructGame()
 */
 void Game::DeconstructGame()
 {
-
+	SAFE_DELETE( m_spatialHash );
+	SAFE_DELETE( m_entities );
+	SAFE_DELETE( m_gridRenderer );
+	SAFE_DELETE( m_buildEvaluator );
+	SAFE_DELETE( m_buildCache );
+	SAFE_DELETE( m_grid );
 }
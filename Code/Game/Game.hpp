@@ -1,12 +1,30 @@
 #pragma once
 #include "Game/GameCommon.hpp"
+#include "Game/BuildEvaluator.hpp"
+#include "Game/DialogueTable.hpp"
+#include "Game/Grid.hpp"
+#include "Game/TimerWheel.hpp"
 
 #include "Engine/Input/KeyButtonState.hpp"
+#include "Engine/Renderer/Camera.hpp"
 
-#include <queue>
+#include <string_view>
 
-class Shader;
-class StopWatch;
+class GridRenderer;
+class RenderCommandBuffer;
+class EntityStore;
+class SpatialHash;
+class SharedTranspositionCache;
+
+//--------------------------------------------------------------------------
+// UI actions that change the simulation. They're routed through
+// App::HandleUIEvent so input journals capture them.
+//--------------------------------------------------------------------------
+enum eGameUIEvent : uint8_t
+{
+	GAME_UI_YES,
+	GAME_UI_NO,
+};
 
 class Game
 {
@@ -19,28 +37,51 @@ public:
 	void Shutdown();
 
 	bool HandleKeyPressed( unsigned char keyCode );
-	bool HandleKeyReleased( unsigned char keyCode );
+	void HandleKeyReleased( unsigned char keyCode );
+	bool HandleUIEvent( eGameUIEvent uiEvent );
 
-	void GameRender() const;
+	void GameRender( RenderCommandBuffer& commands, float interpolationAlpha ) const;
 	void UpdateGame( float deltaSeconds );
+	void UpdateFrame( float deltaSeconds );
 
-	const std::string& GetBadResponse(); 
-	const std::string& GetGoodResponse(); 
-	const std::string& GetRecoveryResponse(); 
-	const std::string& GetRandomText(); 
+	DialogueLineId GetBadResponse() const; 
+	DialogueLineId GetGoodResponse() const; 
+	DialogueLineId GetRecoveryResponse() const; 
+	DialogueLineId GetRandomText() const; 
 
-	void PushTextToPlayer( const std::string& text );
-	const std::string& SeeTextToPlayer() const;
+	void PushTextToPlayer( DialogueLineId lineId );
+	std::string_view SeeTextToPlayer() const;
 	bool PopTextToPlayer();
 
 	void UpdateTextToPlayer( float deltaSeconds );
 
+	TimerWheel* GetTimers() const { return m_timers; }
+
+	Grid* GetGrid() const { return m_grid; }
+	EntityStore* GetEntities() const { return m_entities; }
+	const SpatialHash* GetSpatialHash();	// Built on first use after the entities change.
+
+	bool SetBuildTarget( const std::string& levelPath, eLevelTrust trust = LEVEL_UNTRUSTED );
+	const BuildEvaluation& GetBuildEvaluation() const { return m_buildEvaluation; }
+
+	void SpawnRandomEntities( int count );
+	uint64_t ComputeStateHash() const;
+
 private:
 	void ImGUIWidget();
+	void LoadDialogue();
+	void UpdateBuildEvaluation();
 
-	void UpdateCamera( float deltaSeconds );
+	void RestartResponseTimer( float delaySeconds );
+	void RestartRandomTextTimer();
+	void OnResponseTimer();
+	void OnRandomTextTimer();
+	static void ResponseTimerCallback( void* game );
+	static void RandomTextTimerCallback( void* game );
+	static void RenderDebugToCamera( void* game );
 
 private:
+	void BeginSession();
 	void ResetGame();
 
 	// Helper Methods
@@ -49,21 +90,47 @@ private:
 private:
 	bool m_isQuitting = false;
 
-	Shader* m_shader;
 
-	std::vector<std::string> player_bad_response;
-	std::vector<std::string> player_good_response;
-	std::vector<std::string> player_recovery_response;
-	std::vector<std::string> player_random_diolog;
+	Grid* m_grid = nullptr;
+	GridRenderer* m_gridRenderer = nullptr;
+	EntityStore* m_entities = nullptr;
+	SpatialHash* m_spatialHash = nullptr;
+	bool m_isSpatialHashBuilt = false;
+
+	// Scoring the board against buildTarget, redone when the board's hash changes.
+	SharedTranspositionCache* m_buildCache = nullptr;
+	BuildEvaluator* m_buildEvaluator = nullptr;		// nullptr without a build target.
+	BuildEvaluation m_buildEvaluation;
+	uint64_t m_buildEvaluatedHash = 0;
+	bool m_isBuildEvaluated = false;
+
+	DialogueTable m_dialogue;
+	DialogueQueue m_textQueue;
+
+	int m_bankBad = -1;
+	int m_bankGood = -1;
+	int m_bankRecovery = -1;
+	int m_bankRandom = -1;
+
+	// Scripted lines, looked up by key at startup.
+	DialogueLineId m_lineGreeting = INVALID_DIALOGUE_LINE;
+	DialogueLineId m_lineGetStarted = INVALID_DIALOGUE_LINE;
+	DialogueLineId m_lineGetStartedAnyway = INVALID_DIALOGUE_LINE;
+	DialogueLineId m_lineLeaveItToYou = INVALID_DIALOGUE_LINE;
 
-	std::queue<std::string> player_text_queue;
+	// ImGUI wants a std::string, this keeps the shown line in one reused
+	// buffer sized for the longest line.
+	DialogueLineId m_shownLineId = INVALID_DIALOGUE_LINE;
+	std::string m_shownText;
 
 	KeyButtonState yes;
 	KeyButtonState no;
 	bool begun = false;
+	bool m_isSkipTextRequested = false;
 
-	StopWatch* responseTimer;
-	StopWatch* randomTextTimer;
+	TimerWheel* m_timers = nullptr;
+	TimerHandle m_responseTimer;
+	TimerHandle m_randomTextTimer;
 
 	mutable Camera m_CurentCamera;
 	mutable Camera m_DevColsoleCamera;
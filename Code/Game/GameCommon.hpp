@@ -1,4 +1,11 @@
 #pragma once
+//--------------------------------------------------------------------------
+// Build with GAME_HEADLESS defined (the Headless configuration) to get the
+// windowless simulation runner, Main_Headless.cpp. It links the null engine
+// back ends, EngineBackends_Headless.cpp, so no RenderContext, ImGUISystem,
+// AudioSystem or InputSystem is created and their globals stay nullptr.
+// Game code only reaches those systems through g_theEngineBackends.
+//--------------------------------------------------------------------------
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/Vertex/Vertex_PCU.hpp"
 #include "Game/GameUtils.hpp"
@@ -21,6 +28,9 @@ extern AudioSystem* g_theAudioSystem;
 class RNG;
 extern RNG* g_theRNG;
 
+class GameRandom;
+extern GameRandom* g_theGameRandom;	// Per subsystem streams, seeded with the session seed.
+
 class Game;
 extern Game* g_theGame;
 
@@ -30,6 +40,15 @@ extern WindowContext* g_theWindowContext;
 class ImGUISystem;
 extern ImGUISystem* g_theImGUISystem;
 
+class DiscBatcher;
+extern DiscBatcher* g_theDiscBatcher;	// Only the thread executing render commands uses it.
+
+class JobSystem;
+extern JobSystem* g_theJobSystem;		// Created and owned by the App
+
+class EngineBackends;
+extern EngineBackends* g_theEngineBackends;	// Created and owned by the App
+
 extern bool g_isInDebug;
 
 //--------------------------------------------------------------------------
@@ -0,0 +1,349 @@
+#include "Game/GameProfiler.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Benchmarks.hpp"
+#include "Game/EngineBackends.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+#include <string.h>
+
+//--------------------------------------------------------------------------
+// Ring written only by its owning thread. writeCount is the number of zones
+// ever written, the slot for zone n is n & (size - 1).
+//--------------------------------------------------------------------------
+struct GameProfilerRing
+{
+	GameProfilerZone zones[GAME_PROFILER_RING_SIZE];
+	std::atomic<uint64_t> writeCount{ 0 };
+	const char* threadName = nullptr;
+	int threadIndex = 0;
+	int depth = 0;
+};
+
+static std::unique_ptr<GameProfilerRing> s_rings[GAME_PROFILER_MAX_THREADS];
+static std::atomic<int> s_ringCount{ 0 };
+static thread_local GameProfilerRing* t_ring = nullptr;
+
+static const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now();
+
+static uint64_t s_frameStartNs = 0;
+static double s_lastFrameMs = 0.0;
+static std::vector<GameProfilerSummaryEntry> s_summary;
+static std::vector<GameProfilerZone> s_scratchZones;
+
+//--------------------------------------------------------------------------
+/**
+* GetThreadRing
+* Lazily registers a ring for the calling thread. Returns null once every
+* slot is taken, zones on such threads are silently dropped.
+*/
+static GameProfilerRing* GetThreadRing()
+{
+	if( t_ring == nullptr )
+	{
+		int ringIndex = s_ringCount.load( std::memory_order_relaxed );
+		while( ringIndex < GAME_PROFILER_MAX_THREADS && !s_ringCount.compare_exchange_weak( ringIndex, ringIndex + 1 ) )
+		{
+		}
+		if( ringIndex >= GAME_PROFILER_MAX_THREADS )
+		{
+			return nullptr;
+		}
+		s_rings[ringIndex].reset( new GameProfilerRing() );
+		s_rings[ringIndex]->threadIndex = ringIndex;
+		t_ring = s_rings[ringIndex].get();
+	}
+	return t_ring;
+}
+
+//--------------------------------------------------------------------------
+/**
+* CopyRingZones
+* Appends the ring's zones that ended at or after sinceNs. Anything the
+* writer overwrote while we copied is thrown away rather than reported torn.
+* The oldest slot is left out too, the writer may be partway into it.
+*/
+static void CopyRingZones( const GameProfilerRing& ring, uint64_t sinceNs, std::vector<GameProfilerZone>* out_zones )
+{
+	uint64_t writeCount = ring.writeCount.load( std::memory_order_acquire );
+	uint64_t first = writeCount >= (uint64_t) GAME_PROFILER_RING_SIZE ? writeCount + 1 - GAME_PROFILER_RING_SIZE : 0;
+
+	size_t startSize = out_zones->size();
+	uint64_t zoneIndex = writeCount;
+	while( zoneIndex > first )
+	{
+		const GameProfilerZone& zone = ring.zones[( zoneIndex - 1 ) & ( GAME_PROFILER_RING_SIZE - 1 )];
+		if( zone.endNs < sinceNs )
+		{
+			break;
+		}
+		out_zones->push_back( zone );
+		--zoneIndex;
+	}
+
+	uint64_t writeCountAfter = ring.writeCount.load( std::memory_order_acquire );
+	uint64_t firstValid = writeCountAfter >= (uint64_t) GAME_PROFILER_RING_SIZE ? writeCountAfter + 1 - GAME_PROFILER_RING_SIZE : 0;
+	if( firstValid > zoneIndex )
+	{
+		// Copied newest first, so the lapped zones are at the tail.
+		size_t numLapped = (size_t) ( firstValid - zoneIndex );
+		size_t numCopied = out_zones->size() - startSize;
+		out_zones->resize( startSize + ( numLapped < numCopied ? numCopied - numLapped : 0 ) );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* GameProfileScope
+*/
+GameProfileScope::GameProfileScope( const char* name )
+	: m_name( name )
+{
+	GameProfilerRing* ring = GetThreadRing();
+	if( ring != nullptr )
+	{
+		++ring->depth;
+	}
+	m_startNs = GameProfilerNowNs();
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~GameProfileScope
+*/
+GameProfileScope::~GameProfileScope()
+{
+	uint64_t endNs = GameProfilerNowNs();
+	GameProfilerRing* ring = t_ring;
+	if( ring == nullptr )
+	{
+		return;
+	}
+
+	--ring->depth;
+	uint64_t writeCount = ring->writeCount.load( std::memory_order_relaxed );
+	GameProfilerZone& zone = ring->zones[writeCount & ( GAME_PROFILER_RING_SIZE - 1 )];
+	zone.name = m_name;
+	zone.startNs = m_startNs;
+	zone.endNs = endNs;
+	zone.depth = ring->depth;
+	ring->writeCount.store( writeCount + 1, std::memory_order_release );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GameProfilerNowNs
+*/
+uint64_t GameProfilerNowNs()
+{
+	return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - s_epoch ).count();
+}
+
+//--------------------------------------------------------------------------
+/**
+* GameProfilerSetThreadName
+* Shows up as the track name in the trace viewer.
+*/
+void GameProfilerSetThreadName( const char* name )
+{
+	GameProfilerRing* ring = GetThreadRing();
+	if( ring != nullptr )
+	{
+		ring->threadName = name;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* GameProfilerBeginFrame
+*/
+void GameProfilerBeginFrame()
+{
+	s_frameStartNs = GameProfilerNowNs();
+}
+
+//--------------------------------------------------------------------------
+/**
+* GameProfilerEndFrame
+* Folds every zone that ended during the frame into the summary, one entry
+* per zone name. Entries keep the order they were first seen in.
+*/
+void GameProfilerEndFrame()
+{
+	uint64_t frameEndNs = GameProfilerNowNs();
+	s_lastFrameMs = (double) ( frameEndNs - s_frameStartNs ) * 1e-6;
+
+	s_scratchZones.clear();
+	int ringCount = std::min( s_ringCount.load( std::memory_order_acquire ), GAME_PROFILER_MAX_THREADS );
+	for( int ringIdx = 0; ringIdx < ringCount; ++ringIdx )
+	{
+		const GameProfilerRing* ring = s_rings[ringIdx].get();
+		if( ring != nullptr )
+		{
+			CopyRingZones( *ring, s_frameStartNs, &s_scratchZones );
+		}
+	}
+	std::sort( s_scratchZones.begin(), s_scratchZones.end(), []( const GameProfilerZone& a, const GameProfilerZone& b ) { return a.startNs < b.startNs; } );
+
+	for( GameProfilerSummaryEntry& entry : s_summary )
+	{
+		entry.callsLastFrame = 0;
+		entry.msLastFrame = 0.0;
+	}
+
+	for( const GameProfilerZone& zone : s_scratchZones )
+	{
+		GameProfilerSummaryEntry* found = nullptr;
+		for( GameProfilerSummaryEntry& entry : s_summary )
+		{
+			if( entry.name == zone.name || strcmp( entry.name, zone.name ) == 0 )
+			{
+				found = &entry;
+				break;
+			}
+		}
+		if( found == nullptr )
+		{
+			s_summary.emplace_back();
+			found = &s_summary.back();
+			found->name = zone.name;
+			found->depth = zone.depth;
+		}
+		found->callsLastFrame += 1;
+		found->msLastFrame += (double) ( zone.endNs - zone.startNs ) * 1e-6;
+	}
+
+	for( GameProfilerSummaryEntry& entry : s_summary )
+	{
+		entry.msAverage += ( entry.msLastFrame - entry.msAverage ) * GAME_PROFILER_AVERAGE_WEIGHT;
+		entry.msMax = std::max( entry.msMax, entry.msLastFrame );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* GameProfilerGetLastFrameMs
+*/
+double GameProfilerGetLastFrameMs()
+{
+	return s_lastFrameMs;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GameProfilerGetSummary
+*/
+const std::vector<GameProfilerSummaryEntry>& GameProfilerGetSummary()
+{
+	return s_summary;
+}
+
+//--------------------------------------------------------------------------
+/**
+* WriteJsonString
+* Zone names are literals, but escape the two characters that would break
+* the file anyway.
+*/
+static void WriteJsonString( FILE* file, const char* text )
+{
+	fputc( '"', file );
+	for( const char* c = text; *c != '\0'; ++c )
+	{
+		if( *c == '"' || *c == '\\' )
+		{
+			fputc( '\\', file );
+		}
+		fputc( *c, file );
+	}
+	fputc( '"', file );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GameProfilerExportChromeTrace
+* Writes everything still in the rings as Chrome trace event JSON, which
+* chrome://tracing and Perfetto both open.
+*/
+bool GameProfilerExportChromeTrace( const std::string& filePath )
+{
+	FILE* file = fopen( filePath.c_str(), "w" );
+	if( file == nullptr )
+	{
+		return false;
+	}
+
+	fprintf( file, "{\"traceEvents\":[\n" );
+	bool isFirstEvent = true;
+	std::vector<GameProfilerZone> zones;
+	int ringCount = std::min( s_ringCount.load( std::memory_order_acquire ), GAME_PROFILER_MAX_THREADS );
+	for( int ringIdx = 0; ringIdx < ringCount; ++ringIdx )
+	{
+		const GameProfilerRing* ring = s_rings[ringIdx].get();
+		if( ring == nullptr )
+		{
+			continue;
+		}
+
+		if( ring->threadName != nullptr )
+		{
+			fprintf( file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":", isFirstEvent ? "" : ",\n", ring->threadIndex );
+			WriteJsonString( file, ring->threadName );
+			fprintf( file, "}}" );
+			isFirstEvent = false;
+		}
+
+		zones.clear();
+		CopyRingZones( *ring, 0, &zones );
+		for( size_t zoneIdx = zones.size(); zoneIdx > 0; --zoneIdx )
+		{
+			const GameProfilerZone& zone = zones[zoneIdx - 1];
+			fprintf( file, "%s{\"name\":", isFirstEvent ? "" : ",\n" );
+			WriteJsonString( file, zone.name );
+			fprintf( file, ",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", ring->threadIndex, (double) zone.startNs * 1e-3, (double) ( zone.endNs - zone.startNs ) * 1e-3 );
+			isFirstEvent = false;
+		}
+	}
+	fprintf( file, "\n]}\n" );
+	fclose( file );
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GameProfilerImGUIWidget
+*/
+void GameProfilerImGUIWidget( int windowFlags )
+{
+	char line[256];
+	g_theEngineBackends->BeginWindow( "Profiler", windowFlags );
+	snprintf( line, sizeof( line ), "Frame: %.3f ms", s_lastFrameMs );
+	g_theEngineBackends->Text( line );
+	for( const GameProfilerSummaryEntry& entry : s_summary )
+	{
+		snprintf( line, sizeof( line ), "%*s%s  %.3f ms  avg %.3f  max %.3f  x%d", entry.depth * 2, "", entry.name, entry.msLastFrame, entry.msAverage, entry.msMax, entry.callsLastFrame );
+		g_theEngineBackends->Text( line );
+	}
+	g_theEngineBackends->EndWindow();
+}
+
+//--------------------------------------------------------------------------
+/**
+* Command_ExportProfile
+* profile_export [file=Data/Log/ProfileTrace.json]
+*/
+bool Command_ExportProfile( EventArgs& args )
+{
+	std::string filePath = args.GetValue( "file", "Data/Log/ProfileTrace.json" );
+	if( GameProfilerExportChromeTrace( filePath ) )
+	{
+		BenchmarkPrint( "Profile trace written to " + filePath );
+	}
+	else
+	{
+		BenchmarkPrint( "Could not write profile trace to " + filePath );
+	}
+	return true;
+}
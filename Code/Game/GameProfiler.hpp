@@ -0,0 +1,78 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//--------------------------------------------------------------------------
+// Game side scoped zone profiler.
+//
+// GAME_PROFILE_SCOPE( "Name" ) records a zone from that line to the end of
+// the enclosing block into a ring buffer owned by the calling thread. Only
+// the owning thread writes its ring, so recording is a couple of stores and
+// a release, no locks. Readers (the live summary and the trace export) copy
+// out and discard anything the writer lapped while they were copying.
+//
+// Rings live for the whole process, so keep threads long lived (pool them).
+// Names must be string literals, or otherwise outlive the profiler.
+// Define GAME_PROFILER_DISABLED to compile every zone out.
+//--------------------------------------------------------------------------
+constexpr int GAME_PROFILER_RING_BITS = 16;
+constexpr int GAME_PROFILER_RING_SIZE = 1 << GAME_PROFILER_RING_BITS;
+constexpr int GAME_PROFILER_MAX_THREADS = 64;
+constexpr float GAME_PROFILER_AVERAGE_WEIGHT = 0.05f;
+
+struct GameProfilerZone
+{
+	const char* name = nullptr;
+	uint64_t startNs = 0;
+	uint64_t endNs = 0;
+	int depth = 0;
+};
+
+//--------------------------------------------------------------------------
+// One line of the live panel, totals across every thread for a zone name.
+//--------------------------------------------------------------------------
+struct GameProfilerSummaryEntry
+{
+	const char* name = nullptr;
+	int depth = 0;
+	int callsLastFrame = 0;
+	double msLastFrame = 0.0;
+	double msAverage = 0.0;
+	double msMax = 0.0;
+};
+
+//--------------------------------------------------------------------------
+class GameProfileScope
+{
+public:
+	explicit GameProfileScope( const char* name );
+	~GameProfileScope();
+
+private:
+	const char* m_name = nullptr;
+	uint64_t m_startNs = 0;
+};
+
+uint64_t GameProfilerNowNs();
+void GameProfilerSetThreadName( const char* name );
+
+void GameProfilerBeginFrame();
+void GameProfilerEndFrame();
+double GameProfilerGetLastFrameMs();
+const std::vector<GameProfilerSummaryEntry>& GameProfilerGetSummary();
+
+bool GameProfilerExportChromeTrace( const std::string& filePath );
+void GameProfilerImGUIWidget( int windowFlags );
+
+bool Command_ExportProfile( EventArgs& args );
+
+#define GAME_PROFILE_CONCAT_INNER( a, b ) a##b
+#define GAME_PROFILE_CONCAT( a, b ) GAME_PROFILE_CONCAT_INNER( a, b )
+#if defined(GAME_PROFILER_DISABLED)
+#define GAME_PROFILE_SCOPE( name )
+#else
+#define GAME_PROFILE_SCOPE( name ) GameProfileScope GAME_PROFILE_CONCAT( gameProfileScope_, __LINE__ )( name )
+#endif
@@ -0,0 +1,442 @@
+#include "Game/GameRandom.hpp"
+#include "Game/EntityStore.hpp"
+#include "Game/InputJournal.hpp"
+#include "Game/GameUtils.hpp"
+
+#if defined(GAME_AVX2_DISPATCH)
+#define RANDOM_AVX2
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define RANDOM_SSE2
+#include <emmintrin.h>
+#endif
+
+//--------------------------------------------------------------------------
+// Philox4x32 constants from Salmon et al, "Parallel Random Numbers: As
+// Easy as 1, 2, 3". The counter is { block lo, block hi, stream lo,
+// stream hi } and the key comes from the seed.
+//--------------------------------------------------------------------------
+constexpr uint32_t PHILOX_M0 = 0xD2511F53u;
+constexpr uint32_t PHILOX_M1 = 0xCD9E8D57u;
+constexpr uint32_t PHILOX_W0 = 0x9E3779B9u;
+constexpr uint32_t PHILOX_W1 = 0xBB67AE85u;
+constexpr int PHILOX_ROUNDS = 10;
+
+constexpr float UINT24_TO_FLOAT = 1.0f / 16777216.0f;
+constexpr uint64_t ENTITY_STREAM_BIT = 0x8000000000000000ull;
+
+//--------------------------------------------------------------------------
+/**
+* UIntToFloatZeroToOne
+* Top 24 bits, so every result is exactly representable and below 1.
+*/
+static inline float UIntToFloatZeroToOne( uint32_t value )
+{
+	return (float) ( value >> 8 ) * UINT24_TO_FLOAT;
+}
+
+//--------------------------------------------------------------------------
+/**
+* RandomStream
+*/
+RandomStream::RandomStream()
+	: RandomStream( 0, 0 )
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* RandomStream
+*/
+RandomStream::RandomStream( uint64_t seed, uint64_t streamId )
+	: m_seed( seed )
+	, m_streamId( streamId )
+{
+	uint64_t key = SplitMix64( seed );
+	m_key[0] = (uint32_t) key;
+	m_key[1] = (uint32_t) ( key >> 32 );
+}
+
+//--------------------------------------------------------------------------
+/**
+* NextUInt
+*/
+uint32_t RandomStream::NextUInt()
+{
+	if( ( m_position & 3 ) == 0 )
+	{
+		GenerateBlock( m_position >> 2, m_buffer );
+	}
+	return m_buffer[m_position++ & 3];
+}
+
+//--------------------------------------------------------------------------
+/**
+* NextFloatZeroToOne
+*/
+float RandomStream::NextFloatZeroToOne()
+{
+	return UIntToFloatZeroToOne( NextUInt() );
+}
+
+//--------------------------------------------------------------------------
+/**
+* NextFloatInRange
+*/
+float RandomStream::NextFloatInRange( float minInclusive, float maxExclusive )
+{
+	return minInclusive + ( maxExclusive - minInclusive ) * NextFloatZeroToOne();
+}
+
+//--------------------------------------------------------------------------
+/**
+* NextIntInRange
+* Multiply and shift rather than modulo, the bias is below range / 2^32.
+*/
+int RandomStream::NextIntInRange( int minInclusive, int maxInclusive )
+{
+	if( maxInclusive <= minInclusive )
+	{
+		return minInclusive;
+	}
+	uint64_t range = (uint64_t) ( (int64_t) maxInclusive - (int64_t) minInclusive ) + 1;
+	return (int) ( (int64_t) minInclusive + (int64_t) ( ( (uint64_t) NextUInt() * range ) >> 32 ) );
+}
+
+//--------------------------------------------------------------------------
+/**
+* NextChance
+*/
+bool RandomStream::NextChance( float probability )
+{
+	return NextFloatZeroToOne() < probability;
+}
+
+//--------------------------------------------------------------------------
+/**
+* FillUInts
+* Finishes the buffered block one value at a time, generates the whole
+* blocks straight into out, then buffers the block the tail comes from.
+*/
+void RandomStream::FillUInts( uint32_t* out, int count )
+{
+	while( count > 0 && ( m_position & 3 ) != 0 )
+	{
+		*out++ = NextUInt();
+		--count;
+	}
+
+	int blockCount = count >> 2;
+	if( blockCount > 0 )
+	{
+		GenerateBlocks( m_position >> 2, blockCount, out );
+		m_position += (uint64_t) blockCount * 4;
+		out += blockCount * 4;
+		count -= blockCount * 4;
+	}
+
+	while( count > 0 )
+	{
+		*out++ = NextUInt();
+		--count;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* FillFloatsZeroToOne
+*/
+void RandomStream::FillFloatsZeroToOne( float* out, int count )
+{
+	constexpr int CHUNK_SIZE = 256;
+	uint32_t values[CHUNK_SIZE];
+	while( count > 0 )
+	{
+		int chunkCount = count < CHUNK_SIZE ? count : CHUNK_SIZE;
+		FillUInts( values, chunkCount );
+		for( int valueIdx = 0; valueIdx < chunkCount; ++valueIdx )
+		{
+			out[valueIdx] = UIntToFloatZeroToOne( values[valueIdx] );
+		}
+		out += chunkCount;
+		count -= chunkCount;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* SetPosition
+* Jumps anywhere in the stream in constant time.
+*/
+void RandomStream::SetPosition( uint64_t position )
+{
+	m_position = position;
+	if( ( m_position & 3 ) != 0 )
+	{
+		GenerateBlock( m_position >> 2, m_buffer );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* Fork
+* A child stream that depends only on this stream's id, not its position,
+* so forking is safe to do in any order.
+*/
+RandomStream RandomStream::Fork( uint64_t subStreamId ) const
+{
+	return RandomStream( m_seed, SplitMix64( m_streamId ^ SplitMix64( subStreamId ) ) );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GenerateBlock
+*/
+void RandomStream::GenerateBlock( uint64_t blockIndex, uint32_t* out ) const
+{
+	uint32_t ctr0 = (uint32_t) blockIndex;
+	uint32_t ctr1 = (uint32_t) ( blockIndex >> 32 );
+	uint32_t ctr2 = (uint32_t) m_streamId;
+	uint32_t ctr3 = (uint32_t) ( m_streamId >> 32 );
+	uint32_t key0 = m_key[0];
+	uint32_t key1 = m_key[1];
+
+	for( int roundIdx = 0; roundIdx < PHILOX_ROUNDS; ++roundIdx )
+	{
+		if( roundIdx > 0 )
+		{
+			key0 += PHILOX_W0;
+			key1 += PHILOX_W1;
+		}
+		uint64_t product0 = (uint64_t) PHILOX_M0 * ctr0;
+		uint64_t product1 = (uint64_t) PHILOX_M1 * ctr2;
+		uint32_t next0 = (uint32_t) ( product1 >> 32 ) ^ ctr1 ^ key0;
+		uint32_t next2 = (uint32_t) ( product0 >> 32 ) ^ ctr3 ^ key1;
+		ctr1 = (uint32_t) product1;
+		ctr3 = (uint32_t) product0;
+		ctr0 = next0;
+		ctr2 = next2;
+	}
+
+	out[0] = ctr0;
+	out[1] = ctr1;
+	out[2] = ctr2;
+	out[3] = ctr3;
+}
+
+#if defined(RANDOM_AVX2)
+//--------------------------------------------------------------------------
+/**
+* MulHiLo
+* Eight 32x32 -> 64 bit products, split into high and low halves.
+*/
+static inline GAME_TARGET_AVX2 void MulHiLo( __m256i a, __m256i multiplier, __m256i& hi, __m256i& lo )
+{
+	__m256i evenProducts = _mm256_mul_epu32( a, multiplier );
+	__m256i oddProducts = _mm256_mul_epu32( _mm256_srli_epi64( a, 32 ), multiplier );
+	lo = _mm256_unpacklo_epi32( _mm256_shuffle_epi32( evenProducts, _MM_SHUFFLE( 0, 0, 2, 0 ) ), _mm256_shuffle_epi32( oddProducts, _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+	hi = _mm256_unpacklo_epi32( _mm256_shuffle_epi32( evenProducts, _MM_SHUFFLE( 0, 0, 3, 1 ) ), _mm256_shuffle_epi32( oddProducts, _MM_SHUFFLE( 0, 0, 3, 1 ) ) );
+}
+#endif
+#if defined(RANDOM_SSE2)
+//--------------------------------------------------------------------------
+/**
+* MulHiLo
+* Four 32x32 -> 64 bit products, split into high and low halves.
+*/
+static inline void MulHiLo( __m128i a, __m128i multiplier, __m128i& hi, __m128i& lo )
+{
+	__m128i evenProducts = _mm_mul_epu32( a, multiplier );
+	__m128i oddProducts = _mm_mul_epu32( _mm_srli_epi64( a, 32 ), multiplier );
+	lo = _mm_unpacklo_epi32( _mm_shuffle_epi32( evenProducts, _MM_SHUFFLE( 0, 0, 2, 0 ) ), _mm_shuffle_epi32( oddProducts, _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+	hi = _mm_unpacklo_epi32( _mm_shuffle_epi32( evenProducts, _MM_SHUFFLE( 0, 0, 3, 1 ) ), _mm_shuffle_epi32( oddProducts, _MM_SHUFFLE( 0, 0, 3, 1 ) ) );
+}
+#endif
+
+#if defined(RANDOM_AVX2)
+//--------------------------------------------------------------------------
+/**
+* GenerateBlocksAVX2
+* Whole groups of 8 blocks, returns how many it wrote.
+*/
+static GAME_TARGET_AVX2 int GenerateBlocksAVX2( const uint32_t* key, uint64_t streamId, uint64_t firstBlockIndex, int blockCount, uint32_t* out )
+{
+	int blockIdx = 0;
+	const __m256i multiplier0 = _mm256_set1_epi32( (int) PHILOX_M0 );
+	const __m256i multiplier1 = _mm256_set1_epi32( (int) PHILOX_M1 );
+	const __m256i streamLo = _mm256_set1_epi32( (int) (uint32_t) streamId );
+	const __m256i streamHi = _mm256_set1_epi32( (int) (uint32_t) ( streamId >> 32 ) );
+	for( ; blockIdx + 8 <= blockCount; blockIdx += 8 )
+	{
+		uint32_t blockLo[8];
+		uint32_t blockHi[8];
+		for( int laneIdx = 0; laneIdx < 8; ++laneIdx )
+		{
+			uint64_t laneBlock = firstBlockIndex + (uint64_t) ( blockIdx + laneIdx );
+			blockLo[laneIdx] = (uint32_t) laneBlock;
+			blockHi[laneIdx] = (uint32_t) ( laneBlock >> 32 );
+		}
+
+		__m256i ctr0 = _mm256_loadu_si256( (const __m256i*) blockLo );
+		__m256i ctr1 = _mm256_loadu_si256( (const __m256i*) blockHi );
+		__m256i ctr2 = streamLo;
+		__m256i ctr3 = streamHi;
+		uint32_t key0 = key[0];
+		uint32_t key1 = key[1];
+		for( int roundIdx = 0; roundIdx < PHILOX_ROUNDS; ++roundIdx )
+		{
+			if( roundIdx > 0 )
+			{
+				key0 += PHILOX_W0;
+				key1 += PHILOX_W1;
+			}
+			__m256i hi0, lo0, hi1, lo1;
+			MulHiLo( ctr0, multiplier0, hi0, lo0 );
+			MulHiLo( ctr2, multiplier1, hi1, lo1 );
+			ctr0 = _mm256_xor_si256( _mm256_xor_si256( hi1, ctr1 ), _mm256_set1_epi32( (int) key0 ) );
+			ctr1 = lo1;
+			ctr2 = _mm256_xor_si256( _mm256_xor_si256( hi0, ctr3 ), _mm256_set1_epi32( (int) key1 ) );
+			ctr3 = lo0;
+		}
+
+		__m256i words01Lo = _mm256_unpacklo_epi32( ctr0, ctr1 );
+		__m256i words23Lo = _mm256_unpacklo_epi32( ctr2, ctr3 );
+		__m256i words01Hi = _mm256_unpackhi_epi32( ctr0, ctr1 );
+		__m256i words23Hi = _mm256_unpackhi_epi32( ctr2, ctr3 );
+		__m256i blocks04 = _mm256_unpacklo_epi64( words01Lo, words23Lo );
+		__m256i blocks15 = _mm256_unpackhi_epi64( words01Lo, words23Lo );
+		__m256i blocks26 = _mm256_unpacklo_epi64( words01Hi, words23Hi );
+		__m256i blocks37 = _mm256_unpackhi_epi64( words01Hi, words23Hi );
+		__m256i* dest = (__m256i*) ( out + blockIdx * 4 );
+		_mm256_storeu_si256( dest + 0, _mm256_permute2x128_si256( blocks04, blocks15, 0x20 ) );
+		_mm256_storeu_si256( dest + 1, _mm256_permute2x128_si256( blocks26, blocks37, 0x20 ) );
+		_mm256_storeu_si256( dest + 2, _mm256_permute2x128_si256( blocks04, blocks15, 0x31 ) );
+		_mm256_storeu_si256( dest + 3, _mm256_permute2x128_si256( blocks26, blocks37, 0x31 ) );
+	}
+	return blockIdx;
+}
+#endif
+
+//--------------------------------------------------------------------------
+/**
+* GenerateBlocks
+* Runs eight (AVX2, when the CPU has it) or four (SSE2) counters through the rounds side by
+* side, one counter word per register, then transposes back to block
+* order. Leftover blocks go through the scalar path, which gives the same
+* bits.
+*/
+void RandomStream::GenerateBlocks( uint64_t firstBlockIndex, int blockCount, uint32_t* out ) const
+{
+	int blockIdx = 0;
+
+#if defined(RANDOM_AVX2)
+	if( IsAVX2Supported() )
+	{
+		blockIdx = GenerateBlocksAVX2( m_key, m_streamId, firstBlockIndex, blockCount, out );
+	}
+#endif
+#if defined(RANDOM_SSE2)
+	const __m128i multiplier0 = _mm_set1_epi32( (int) PHILOX_M0 );
+	const __m128i multiplier1 = _mm_set1_epi32( (int) PHILOX_M1 );
+	const __m128i streamLo = _mm_set1_epi32( (int) (uint32_t) m_streamId );
+	const __m128i streamHi = _mm_set1_epi32( (int) (uint32_t) ( m_streamId >> 32 ) );
+	for( ; blockIdx + 4 <= blockCount; blockIdx += 4 )
+	{
+		uint32_t blockLo[4];
+		uint32_t blockHi[4];
+		for( int laneIdx = 0; laneIdx < 4; ++laneIdx )
+		{
+			uint64_t laneBlock = firstBlockIndex + (uint64_t) ( blockIdx + laneIdx );
+			blockLo[laneIdx] = (uint32_t) laneBlock;
+			blockHi[laneIdx] = (uint32_t) ( laneBlock >> 32 );
+		}
+
+		__m128i ctr0 = _mm_loadu_si128( (const __m128i*) blockLo );
+		__m128i ctr1 = _mm_loadu_si128( (const __m128i*) blockHi );
+		__m128i ctr2 = streamLo;
+		__m128i ctr3 = streamHi;
+		uint32_t key0 = m_key[0];
+		uint32_t key1 = m_key[1];
+		for( int roundIdx = 0; roundIdx < PHILOX_ROUNDS; ++roundIdx )
+		{
+			if( roundIdx > 0 )
+			{
+				key0 += PHILOX_W0;
+				key1 += PHILOX_W1;
+			}
+			__m128i hi0, lo0, hi1, lo1;
+			MulHiLo( ctr0, multiplier0, hi0, lo0 );
+			MulHiLo( ctr2, multiplier1, hi1, lo1 );
+			ctr0 = _mm_xor_si128( _mm_xor_si128( hi1, ctr1 ), _mm_set1_epi32( (int) key0 ) );
+			ctr1 = lo1;
+			ctr2 = _mm_xor_si128( _mm_xor_si128( hi0, ctr3 ), _mm_set1_epi32( (int) key1 ) );
+			ctr3 = lo0;
+		}
+
+		__m128i words01Lo = _mm_unpacklo_epi32( ctr0, ctr1 );
+		__m128i words23Lo = _mm_unpacklo_epi32( ctr2, ctr3 );
+		__m128i words01Hi = _mm_unpackhi_epi32( ctr0, ctr1 );
+		__m128i words23Hi = _mm_unpackhi_epi32( ctr2, ctr3 );
+		__m128i* dest = (__m128i*) ( out + blockIdx * 4 );
+		_mm_storeu_si128( dest + 0, _mm_unpacklo_epi64( words01Lo, words23Lo ) );
+		_mm_storeu_si128( dest + 1, _mm_unpackhi_epi64( words01Lo, words23Lo ) );
+		_mm_storeu_si128( dest + 2, _mm_unpacklo_epi64( words01Hi, words23Hi ) );
+		_mm_storeu_si128( dest + 3, _mm_unpackhi_epi64( words01Hi, words23Hi ) );
+	}
+#endif
+
+	for( ; blockIdx < blockCount; ++blockIdx )
+	{
+		GenerateBlock( firstBlockIndex + (uint64_t) blockIdx, out + blockIdx * 4 );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* GameRandom
+*/
+GameRandom::GameRandom( uint64_t seed )
+{
+	Reseed( seed );
+}
+
+//--------------------------------------------------------------------------
+/**
+* Reseed
+* Every stream restarts from position zero.
+*/
+void GameRandom::Reseed( uint64_t seed )
+{
+	m_seed = seed;
+	for( int streamIdx = 0; streamIdx < NUM_RANDOM_STREAMS; ++streamIdx )
+	{
+		m_streams[streamIdx] = RandomStream( seed, (uint64_t) streamIdx );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* MakeEntityStream
+* Keyed on slot and generation, so a reused slot gets a fresh stream.
+*/
+RandomStream GameRandom::MakeEntityStream( const EntityHandle& handle ) const
+{
+	uint64_t streamId = ENTITY_STREAM_BIT | ( (uint64_t) ( handle.generation & 0x7FFFFFFFu ) << 32 ) | handle.slotIndex;
+	return RandomStream( m_seed, streamId );
+}
+
+//--------------------------------------------------------------------------
+/**
+* HashState
+* Stream positions are all the state there is.
+*/
+uint64_t GameRandom::HashState( uint64_t hash ) const
+{
+	for( int streamIdx = 0; streamIdx < NUM_RANDOM_STREAMS; ++streamIdx )
+	{
+		uint64_t position = m_streams[streamIdx].GetPosition();
+		hash = HashBytes( hash, &position, sizeof( position ) );
+	}
+	return hash;
+}
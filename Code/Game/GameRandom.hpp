@@ -0,0 +1,78 @@
+#pragma once
+#include <stdint.h>
+
+struct EntityHandle;
+
+//--------------------------------------------------------------------------
+// Counter based random numbers (Philox4x32-10). A stream is a key derived
+// from the session seed plus a 64 bit stream id, and the n-th value of a
+// stream is a pure function of (seed, stream id, n). Streams never share
+// state, so each subsystem or entity can draw from its own stream on any
+// thread, in any order, and still replay bit for bit.
+//--------------------------------------------------------------------------
+class RandomStream
+{
+public:
+	RandomStream();
+	RandomStream( uint64_t seed, uint64_t streamId );
+
+	uint32_t NextUInt();
+	float NextFloatZeroToOne();								// [0, 1)
+	float NextFloatInRange( float minInclusive, float maxExclusive );
+	int NextIntInRange( int minInclusive, int maxInclusive );
+	bool NextChance( float probability );
+
+	// Batch versions, identical to calling the single value versions count
+	// times, but whole blocks are generated four or eight at a time.
+	void FillUInts( uint32_t* out, int count );
+	void FillFloatsZeroToOne( float* out, int count );
+
+	// Position is in 32 bit values drawn since the start of the stream.
+	uint64_t GetPosition() const { return m_position; }
+	void SetPosition( uint64_t position );
+
+	uint64_t GetStreamId() const { return m_streamId; }
+	RandomStream Fork( uint64_t subStreamId ) const;
+
+private:
+	void GenerateBlock( uint64_t blockIndex, uint32_t* out ) const;
+	void GenerateBlocks( uint64_t firstBlockIndex, int blockCount, uint32_t* out ) const;
+
+private:
+	uint64_t m_seed = 0;
+	uint64_t m_streamId = 0;
+	uint32_t m_key[2] = { 0, 0 };
+	uint64_t m_position = 0;
+	uint32_t m_buffer[4] = { 0, 0, 0, 0 };	// Block m_position / 4, valid while m_position % 4 != 0.
+};
+
+//--------------------------------------------------------------------------
+// One stream per gameplay subsystem. Entity streams are made on demand from
+// the handle so they cost nothing until used.
+//--------------------------------------------------------------------------
+enum eRandomStream : uint8_t
+{
+	RANDOM_STREAM_GENERAL = 0,
+	RANDOM_STREAM_DIALOGUE,
+	RANDOM_STREAM_SPAWN,
+
+	NUM_RANDOM_STREAMS
+};
+
+class GameRandom
+{
+public:
+	explicit GameRandom( uint64_t seed );
+
+	void Reseed( uint64_t seed );
+	uint64_t GetSeed() const { return m_seed; }
+
+	RandomStream& GetStream( eRandomStream stream ) { return m_streams[stream]; }
+	RandomStream MakeEntityStream( const EntityHandle& handle ) const;
+
+	uint64_t HashState( uint64_t hash ) const;
+
+private:
+	uint64_t m_seed = 0;
+	RandomStream m_streams[NUM_RANDOM_STREAMS];
+};
@@ -1,40 +1,24 @@
 #include "Game/GameUtils.hpp"
-#include "Engine/Renderer/RenderContext.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Math/RNG.hpp"
-#include "Engine/Renderer/Camera.hpp"
 #include "Game/Entity.hpp"
 #include "Game/App.hpp"
+#include "Game/RenderCommandBuffer.hpp"
+#include "Game/GameRandom.hpp"
+
+#if defined(GAME_AVX2_DISPATCH) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
 
 
 //--------------------------------------------------------------------------
 /**
 * DrawDisc
+* Queues the disc on the frame being recorded, drawn when the App flushes it.
 */
 void DrawDisc( const Vertex_PCU translation, float radius )
 {
-	constexpr int NUM_DISC_SIDES = 64;
-	constexpr int NUM_DISC_VERTS = 64 * 3;
-
-	float toAddDegrees = 360.0f / NUM_DISC_SIDES;
-	float theta = 0.0f;
-	Vertex_PCU VertsToDraw[ NUM_DISC_VERTS ] = {};
-
-	for( int i = 0; i < NUM_DISC_VERTS; i += 3 )
-	{
-		VertsToDraw[i] = translation;
-
-		Vec2 point2d = Vec2::MakeFromPolarDegrees(theta, radius);
-		Vec3 point3d = Vec3( point2d.x, point2d.y, 0.0f );
-		VertsToDraw[i + 1] = Vertex_PCU( translation.position + point3d , translation.color, translation.uv );
-
-		theta += toAddDegrees;
-		point2d = Vec2::MakeFromPolarDegrees(theta, radius);
-		point3d = Vec3( point2d.x, point2d.y, 0.0f );
-		VertsToDraw[i + 2] = Vertex_PCU( translation.position + point3d , translation.color, translation.uv );
-	}
-
-	g_theRenderer->DrawVertexArray( NUM_DISC_VERTS, VertsToDraw );
+	g_theApp->GetRenderCommands()->AddDisc( translation.position, radius, translation.color );
 }
 
 //--------------------------------------------------------------------------
@@ -48,10 +32,72 @@ float GetDistanceBetween( const Entity* entityA, const Entity* entiryB )
 
 float GetRandomlyChosenFloat( float a, float b )
 {
-	int randomf = g_theRNG->GetRandomIntInRange(0, 1);
+	int randomf = g_theGameRandom->GetStream( RANDOM_STREAM_GENERAL ).NextIntInRange( 0, 1 );
 	if( randomf == 0 )
 	{
 		return a;
 	}
 	return b;
 }
+
+#if defined(GAME_AVX2_DISPATCH)
+//--------------------------------------------------------------------------
+/**
+* DetectAVX2
+* The CPU has to report AVX2 and the OS has to save the ymm registers
+* (OSXSAVE, then XCR0 bits 1 and 2).
+*/
+static bool DetectAVX2()
+{
+#if defined(_MSC_VER)
+	int registers[4];
+	__cpuid( registers, 0 );
+	if( registers[0] < 7 )
+	{
+		return false;
+	}
+	__cpuid( registers, 1 );
+	uint32_t leaf1Ecx = (uint32_t) registers[2];
+	__cpuidex( registers, 7, 0 );
+	uint32_t leaf7Ebx = (uint32_t) registers[1];
+#else
+	unsigned int eax, ebx, ecx, edx;
+	if( __get_cpuid_max( 0, nullptr ) < 7 )
+	{
+		return false;
+	}
+	__cpuid( 1, eax, ebx, ecx, edx );
+	uint32_t leaf1Ecx = ecx;
+	__cpuid_count( 7, 0, eax, ebx, ecx, edx );
+	uint32_t leaf7Ebx = ebx;
+#endif
+
+	constexpr uint32_t OSXSAVE_BIT = 1u << 27;
+	constexpr uint32_t AVX_BIT = 1u << 28;
+	constexpr uint32_t AVX2_BIT = 1u << 5;
+	if( ( leaf1Ecx & ( OSXSAVE_BIT | AVX_BIT ) ) != ( OSXSAVE_BIT | AVX_BIT ) || ( leaf7Ebx & AVX2_BIT ) == 0 )
+	{
+		return false;
+	}
+
+#if defined(_MSC_VER)
+	uint64_t xcr0 = _xgetbv( 0 );
+#else
+	uint32_t xcr0Lo, xcr0Hi;
+	__asm__( "xgetbv" : "=a"( xcr0Lo ), "=d"( xcr0Hi ) : "c"( 0 ) );
+	uint64_t xcr0 = ( (uint64_t) xcr0Hi << 32 ) | xcr0Lo;
+#endif
+	return ( xcr0 & 6 ) == 6;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsAVX2Supported
+* Checked once, the answer can't change while the game runs.
+*/
+bool IsAVX2Supported()
+{
+	static const bool s_supported = DetectAVX2();
+	return s_supported;
+}
+#endif
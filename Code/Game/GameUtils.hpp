@@ -1,4 +1,8 @@
 #pragma once
+#include <stdint.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 struct Vertex_PCU;
 class Entity;
@@ -8,4 +12,63 @@ void DrawDisc( const Vertex_PCU translation, float radius );
 float GetDistanceBetween( const Entity* entityA, const Entity* entiryB );
 float GetRandomlyChosenFloat( float a, float b );
 
+//--------------------------------------------------------------------------
+// Bit helpers, value must be non zero for CountTrailingZeros.
+//--------------------------------------------------------------------------
+inline int CountTrailingZeros( uint64_t value )
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64( &index, value );
+	return (int) index;
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if( _BitScanForward( &index, (unsigned long) value ) )
+	{
+		return (int) index;
+	}
+	_BitScanForward( &index, (unsigned long) ( value >> 32 ) );
+	return (int) index + 32;
+#else
+	return __builtin_ctzll( value );
+#endif
+}
 
+inline int CountSetBits( uint64_t value )
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	return (int) __popcnt64( value );
+#elif defined(_MSC_VER)
+	return (int) ( __popcnt( (unsigned int) value ) + __popcnt( (unsigned int) ( value >> 32 ) ) );
+#else
+	return __builtin_popcountll( value );
+#endif
+}
+
+//--------------------------------------------------------------------------
+// The project doesn't build with /arch:AVX2, so the AVX2 kernels are
+// compiled into every x86 build and picked at run time off
+// IsAVX2Supported(). MSVC emits the intrinsics anywhere, GCC and Clang only
+// in functions marked GAME_TARGET_AVX2.
+//--------------------------------------------------------------------------
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define GAME_AVX2_DISPATCH
+#if defined(_MSC_VER) && !defined(__clang__)
+#define GAME_TARGET_AVX2
+#else
+#define GAME_TARGET_AVX2 __attribute__(( target( "avx2" ) ))
+#endif
+bool IsAVX2Supported();
+#endif
+
+//--------------------------------------------------------------------------
+// SplitMix64 finalizer. A bijection that spreads inputs differing by one
+// bit over the whole result, for seeding and for hash keys.
+//--------------------------------------------------------------------------
+inline uint64_t SplitMix64( uint64_t value )
+{
+	value += 0x9E3779B97F4A7C15ull;
+	value = ( value ^ ( value >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+	value = ( value ^ ( value >> 27 ) ) * 0x94D049BB133111EBull;
+	return value ^ ( value >> 31 );
+}
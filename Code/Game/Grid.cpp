@@ -1,3 +1,800 @@
-#include "Game/Block.hpp"
+#include "Game/Grid.hpp"
+#include "Game/GridConnectivity.hpp"
+#include "Game/GridHistory.hpp"
+#include "Game/GridLevelFile.hpp"
+#include "Game/GridShapeMatcher.hpp"
+#include "Game/MappedFile.hpp"
+#include "Game/GameUtils.hpp"
+#include "Engine/Core/EngineCommon.hpp"
 
+#include <string.h>
+#include <algorithm>
 
+//--------------------------------------------------------------------------
+/**
+* Grid
+*/
+Grid::Grid( const IntVec2& dimensions )
+{
+	ASSERT_OR_DIE( dimensions.x > 0 && dimensions.y > 0, "Grid dimensions must be positive" );
+	ASSERT_OR_DIE( dimensions.x <= GRID_MAX_DIMENSION && dimensions.y <= GRID_MAX_DIMENSION, "Grid dimensions too large" );
+	Resize( dimensions );
+
+	m_palette.reserve( GRID_MAX_PALETTE_SIZE );
+	m_palette.push_back( Rgba::WHITE );
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~Grid
+*/
+Grid::~Grid()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* Clear
+*/
+void Grid::Clear()
+{
+	for( int chunkIdx = 0; chunkIdx < (int) m_chunks.size(); ++chunkIdx )
+	{
+		GridChunk& chunk = m_chunks[chunkIdx];
+		if( chunk.cells )
+		{
+			if( m_history )
+			{
+				m_history->OnChunkWrite( chunkIdx );
+			}
+			chunk.cells.reset();
+			chunk.isMapped = false;
+			chunk.blockCount = 0;
+			MarkChunkDirty( chunkIdx );
+		}
+	}
+	m_blockCount = 0;
+	m_zobristHash = 0;
+
+	if( m_connectivity )
+	{
+		m_connectivity->Rebuild();
+	}
+	if( m_shapeMatcher )
+	{
+		m_shapeMatcher->InvalidateAll();
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* CopyFrom
+* Shares every chunk's cells with other, whichever side writes a chunk first
+* copies it. Connectivity and history stay as enabled here and start over.
+*/
+void Grid::CopyFrom( const Grid& other )
+{
+	Resize( other.m_dimensions );
+	for( int chunkIdx = 0; chunkIdx < (int) m_chunks.size(); ++chunkIdx )
+	{
+		const GridChunk& otherChunk = other.m_chunks[chunkIdx];
+		GridChunk& chunk = m_chunks[chunkIdx];
+		chunk.cells = otherChunk.cells;
+		chunk.blockCount = otherChunk.blockCount;
+		chunk.isMapped = otherChunk.isMapped;
+	}
+	m_palette = other.m_palette;
+	m_blockCount = other.m_blockCount;
+	m_zobristHash = other.m_zobristHash;
+
+	MarkAllChunksDirty();
+	if( m_connectivity )
+	{
+		m_connectivity->Rebuild();
+	}
+	if( m_history )
+	{
+		m_history->Reset();
+	}
+	if( m_shapeMatcher )
+	{
+		m_shapeMatcher->InvalidateAll();
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* LoadLevelFile
+* Maps the file and binds to it, the mapping lives as long as any chunk
+* still points into it.
+*/
+bool Grid::LoadLevelFile( const std::string& levelPath, eLevelTrust trust )
+{
+	std::shared_ptr<MappedFile> mappedFile = std::make_shared<MappedFile>();
+	if( !mappedFile->Open( levelPath ) )
+	{
+		return false;
+	}
+	return BindLevel( mappedFile, mappedFile->GetData(), mappedFile->GetSize(), trust );
+}
+
+//--------------------------------------------------------------------------
+/**
+* LoadLevelBlob
+* Takes ownership of a level built in memory, see BuildGridLevel.
+*/
+bool Grid::LoadLevelBlob( std::vector<uint8_t>&& blob, eLevelTrust trust )
+{
+	std::shared_ptr<std::vector<uint8_t>> ownedBlob = std::make_shared<std::vector<uint8_t>>( std::move( blob ) );
+	return BindLevel( ownedBlob, ownedBlob->data(), ownedBlob->size(), trust );
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsSectionInLevel
+*/
+static bool IsSectionInLevel( size_t levelSize, uint32_t offset, uint64_t count, size_t recordSize, uint32_t alignment )
+{
+	return ( offset % alignment ) == 0 && (uint64_t) offset + count * recordSize <= (uint64_t) levelSize;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsChunkImageValid
+* The image's block count matches the chunk table and no cell names a color
+* outside the palette. Doesn't depend on where the image is used, so an
+* image shared by several chunks is only checked once.
+*/
+static bool IsChunkImageValid( const GridChunkCells& cells, uint32_t blockCount, uint32_t paletteCount )
+{
+	uint32_t occupiedCount = 0;
+	for( int localY = 0; localY < GRID_CHUNK_SIZE; ++localY )
+	{
+		occupiedCount += (uint32_t) CountSetBits( cells.occupancy[localY] );
+	}
+	if( occupiedCount != blockCount )
+	{
+		return false;
+	}
+
+	for( int localIdx = 0; localIdx < GRID_CHUNK_CELL_COUNT; ++localIdx )
+	{
+		if( cells.colorIndices[localIdx] >= paletteCount )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsChunkImageInBounds
+* No block sits past the edge of the board, only edge chunks can fail.
+*/
+static bool IsChunkImageInBounds( const GridChunkCells& cells, const IntVec2& cellsInChunk )
+{
+	if( cellsInChunk.x == GRID_CHUNK_SIZE && cellsInChunk.y == GRID_CHUNK_SIZE )
+	{
+		return true;
+	}
+
+	uint32_t rowMask = cellsInChunk.x < GRID_CHUNK_SIZE ? ( 1U << cellsInChunk.x ) - 1 : 0xFFFFFFFFu;
+	for( int localY = 0; localY < GRID_CHUNK_SIZE; ++localY )
+	{
+		uint32_t rowBits = cells.occupancy[localY];
+		if( ( rowBits & ~rowMask ) != 0 || ( localY >= cellsInChunk.y && rowBits != 0 ) )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* BindLevel
+* Checks the header, every section and the chunk table before touching the
+* board, so a bad level leaves the Grid as it was. Untrusted levels also
+* have each distinct chunk image checked once, each chunk kept inside the
+* board, and the Zobrist hash recomputed from the blocks to match the stored
+* one, it feeds the transposition cache. Chunks then point into the level
+* data, owner keeps it alive. Nothing is copied but the palette.
+*/
+bool Grid::BindLevel( const std::shared_ptr<const void>& owner, const uint8_t* data, size_t size, eLevelTrust trust )
+{
+	if( size < sizeof( GridLevelHeader ) || ( (uintptr_t) data % alignof( GridLevelHeader ) ) != 0 )
+	{
+		return false;
+	}
+
+	const GridLevelHeader* header = (const GridLevelHeader*) data;
+	if( header->magic != GRID_LEVEL_MAGIC || header->version != GRID_LEVEL_VERSION || header->totalBytes != size
+		|| header->cellsSize != sizeof( GridChunkCells ) )
+	{
+		return false;
+	}
+	if( header->width == 0 || header->height == 0 || header->width > GRID_MAX_DIMENSION || header->height > GRID_MAX_DIMENSION
+		|| header->chunkCountX != ( ( header->width + GRID_CHUNK_MASK ) >> GRID_CHUNK_SIZE_BITS )
+		|| header->chunkCountY != ( ( header->height + GRID_CHUNK_MASK ) >> GRID_CHUNK_SIZE_BITS )
+		|| header->paletteCount == 0 || header->paletteCount > GRID_MAX_PALETTE_SIZE )
+	{
+		return false;
+	}
+	uint32_t chunkCount = header->chunkCountX * header->chunkCountY;
+	if( !IsSectionInLevel( size, header->paletteOffset, header->paletteCount, sizeof( GridLevelColor ), 4 )
+		|| !IsSectionInLevel( size, header->chunkTableOffset, chunkCount, sizeof( GridLevelChunk ), 4 )
+		|| !IsSectionInLevel( size, header->imagesOffset, header->imageCount, sizeof( GridChunkCells ), GRID_LEVEL_IMAGE_ALIGNMENT ) )
+	{
+		return false;
+	}
+
+	const GridLevelChunk* chunkTable = (const GridLevelChunk*) ( data + header->chunkTableOffset );
+	const GridChunkCells* images = (const GridChunkCells*) ( data + header->imagesOffset );
+	int width = (int) header->width;
+	int height = (int) header->height;
+	bool isTrusted = trust == LEVEL_TRUSTED;
+	std::vector<uint32_t> checkedBlockCounts( isTrusted ? 0 : header->imageCount, 0 );	// Per image, 0 until checked.
+	uint64_t blockCount = 0;
+	uint64_t zobristHash = 0;
+	for( uint32_t chunkIdx = 0; chunkIdx < chunkCount; ++chunkIdx )
+	{
+		const GridLevelChunk& entry = chunkTable[chunkIdx];
+		if( entry.imageIndex == GRID_LEVEL_EMPTY_CHUNK )
+		{
+			continue;
+		}
+		if( entry.imageIndex >= header->imageCount || entry.blockCount == 0 )
+		{
+			return false;
+		}
+		blockCount += entry.blockCount;
+		if( isTrusted )
+		{
+			continue;
+		}
+
+		const GridChunkCells& cells = images[entry.imageIndex];
+		uint32_t& checkedBlockCount = checkedBlockCounts[entry.imageIndex];
+		if( checkedBlockCount == 0 )
+		{
+			if( !IsChunkImageValid( cells, entry.blockCount, header->paletteCount ) )
+			{
+				return false;
+			}
+			checkedBlockCount = entry.blockCount;
+		}
+		IntVec2 origin( (int) ( chunkIdx % header->chunkCountX ) << GRID_CHUNK_SIZE_BITS, (int) ( chunkIdx / header->chunkCountX ) << GRID_CHUNK_SIZE_BITS );
+		IntVec2 cellsInChunk( std::min( width - origin.x, GRID_CHUNK_SIZE ), std::min( height - origin.y, GRID_CHUNK_SIZE ) );
+		if( entry.blockCount != checkedBlockCount || !IsChunkImageInBounds( cells, cellsInChunk ) )
+		{
+			return false;
+		}
+
+		for( int localY = 0; localY < cellsInChunk.y; ++localY )
+		{
+			uint32_t rowBits = cells.occupancy[localY];
+			while( rowBits != 0 )
+			{
+				int localX = CountTrailingZeros( rowBits );
+				int localIndex = ( localY << GRID_CHUNK_SIZE_BITS ) | localX;
+				int cellIndex = ( origin.y + localY ) * width + origin.x + localX;
+				zobristHash ^= GetZobristKey( cellIndex, cells.colorIndices[localIndex], cells.materials[localIndex], cells.flags[localIndex] );
+				rowBits &= rowBits - 1;
+			}
+		}
+	}
+	if( blockCount != header->blockCount || ( !isTrusted && zobristHash != header->zobristHash ) )
+	{
+		return false;
+	}
+
+	Resize( IntVec2( width, height ) );
+
+	const GridLevelColor* palette = (const GridLevelColor*) ( data + header->paletteOffset );
+	m_palette.clear();
+	for( uint32_t colorIdx = 0; colorIdx < header->paletteCount; ++colorIdx )
+	{
+		const float* rgba = palette[colorIdx].rgba;
+		m_palette.push_back( Rgba( rgba[0], rgba[1], rgba[2], rgba[3] ) );
+	}
+
+	for( int chunkIdx = 0; chunkIdx < (int) chunkCount; ++chunkIdx )
+	{
+		const GridLevelChunk& entry = chunkTable[chunkIdx];
+		if( entry.imageIndex != GRID_LEVEL_EMPTY_CHUNK )
+		{
+			GridChunk& chunk = m_chunks[chunkIdx];
+			chunk.cells = std::shared_ptr<const GridChunkCells>( owner, &images[entry.imageIndex] );
+			chunk.isMapped = true;
+			chunk.blockCount = (int) entry.blockCount;
+		}
+	}
+	m_blockCount = (int) blockCount;
+	m_zobristHash = header->zobristHash;
+
+	MarkAllChunksDirty();
+	if( m_connectivity )
+	{
+		m_connectivity->Rebuild();
+	}
+	if( m_history )
+	{
+		m_history->Reset();
+	}
+	if( m_shapeMatcher )
+	{
+		m_shapeMatcher->InvalidateAll();
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsInBounds
+*/
+bool Grid::IsInBounds( const IntVec2& cell ) const
+{
+	return (unsigned int) cell.x < (unsigned int) m_dimensions.x 
+		&& (unsigned int) cell.y < (unsigned int) m_dimensions.y;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetCellCoords
+*/
+IntVec2 Grid::GetCellCoords( int cellIndex ) const
+{
+	return IntVec2( cellIndex % m_dimensions.x, cellIndex / m_dimensions.x );
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsOccupied
+*/
+bool Grid::IsOccupied( const IntVec2& cell ) const
+{
+	const GridChunkCells* cells = GetCells( cell );
+	if( !cells )
+	{
+		return false;
+	}
+	return ( cells->occupancy[cell.y & GRID_CHUNK_MASK] >> ( cell.x & GRID_CHUNK_MASK ) ) & 1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetRowBits
+* Returns 64 cells of row y starting at startX, bit 0 being startX. Cells off
+* the board read as empty.
+*/
+uint64_t Grid::GetRowBits( int y, int startX ) const
+{
+	if( (unsigned int) y >= (unsigned int) m_dimensions.y || startX >= m_dimensions.x || startX <= -64 )
+	{
+		return 0;
+	}
+
+	// Gather the three 32 bit chunk rows that can overlap the 64 bit window.
+	int firstChunkX = startX >> GRID_CHUNK_SIZE_BITS;	// Arithmetic shift, floors negatives.
+	int shift = startX & GRID_CHUNK_MASK;
+	int chunkRowStart = ( y >> GRID_CHUNK_SIZE_BITS ) * m_chunkDimensions.x;
+	int localY = y & GRID_CHUNK_MASK;
+
+	uint64_t words[3] = { 0, 0, 0 };
+	for( int wordIdx = 0; wordIdx < 3; ++wordIdx )
+	{
+		int chunkX = firstChunkX + wordIdx;
+		if( chunkX < 0 || chunkX >= m_chunkDimensions.x )
+		{
+			continue;
+		}
+		const GridChunkCells* cells = m_chunks[chunkRowStart + chunkX].cells.get();
+		if( cells )
+		{
+			words[wordIdx] = cells->occupancy[localY];
+		}
+	}
+
+	uint64_t low = words[0] | ( words[1] << 32 );
+	uint64_t bits = low >> shift;
+	if( shift > 0 )
+	{
+		bits |= words[2] << ( 64 - shift );
+	}
+	return bits;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetOccupiedCells
+* Every block's cell, row by row from the bottom.
+*/
+void Grid::GetOccupiedCells( std::vector<IntVec2>* out_cells ) const
+{
+	out_cells->clear();
+	out_cells->reserve( (size_t) m_blockCount );
+	for( int y = 0; y < m_dimensions.y; ++y )
+	{
+		for( int startX = 0; startX < m_dimensions.x; startX += 64 )
+		{
+			uint64_t rowBits = GetRowBits( y, startX );
+			while( rowBits != 0 )
+			{
+				out_cells->push_back( IntVec2( startX + CountTrailingZeros( rowBits ), y ) );
+				rowBits &= rowBits - 1;
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* PlaceBlock
+* Returns false if the cell is out of bounds or already holds a block.
+*/
+bool Grid::PlaceBlock( const Block& block )
+{
+	const IntVec2& cell = block.location;
+	if( !IsInBounds( cell ) || IsOccupied( cell ) )
+	{
+		return false;
+	}
+	ASSERT_RECOVERABLE( block.colorIndex < m_palette.size(), "Block color not in grid palette" );
+
+	int chunkIndex = GetChunkIndexForCell( cell );
+	GridChunkCells* cells = GetWritableCells( chunkIndex );
+	cells->occupancy[cell.y & GRID_CHUNK_MASK] |= 1U << ( cell.x & GRID_CHUNK_MASK );
+
+	int localIndex = GetLocalIndex( cell );
+	cells->colorIndices[localIndex] = block.colorIndex;
+	cells->materials[localIndex] = block.material;
+	cells->flags[localIndex] = block.flags;
+	m_zobristHash ^= GetZobristKey( GetCellIndex( cell ), block.colorIndex, block.material, block.flags );
+
+	++m_chunks[chunkIndex].blockCount;
+	++m_blockCount;
+	MarkChunkDirty( chunkIndex );
+
+	if( m_connectivity )
+	{
+		m_connectivity->OnBlockPlaced( cell );
+	}
+	if( m_shapeMatcher )
+	{
+		m_shapeMatcher->OnCellChanged( cell );
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* RemoveBlock
+* Returns false if there was nothing to remove.
+*/
+bool Grid::RemoveBlock( const IntVec2& cell )
+{
+	if( !IsOccupied( cell ) )
+	{
+		return false;
+	}
+
+	int chunkIndex = GetChunkIndexForCell( cell );
+	GridChunkCells* cells = GetWritableCells( chunkIndex );
+	cells->occupancy[cell.y & GRID_CHUNK_MASK] &= ~( 1U << ( cell.x & GRID_CHUNK_MASK ) );
+
+	int localIndex = GetLocalIndex( cell );
+	m_zobristHash ^= GetZobristKey( GetCellIndex( cell ), cells->colorIndices[localIndex], cells->materials[localIndex], cells->flags[localIndex] );
+	cells->colorIndices[localIndex] = 0;
+	cells->materials[localIndex] = BLOCK_MATERIAL_DEFAULT;
+	cells->flags[localIndex] = BLOCK_FLAG_NONE;
+
+	--m_chunks[chunkIndex].blockCount;
+	--m_blockCount;
+	MarkChunkDirty( chunkIndex );
+
+	if( m_connectivity )
+	{
+		m_connectivity->OnBlockRemoved( cell );
+	}
+	if( m_shapeMatcher )
+	{
+		m_shapeMatcher->OnCellChanged( cell );
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetBlock
+*/
+bool Grid::GetBlock( const IntVec2& cell, Block* out_block ) const
+{
+	if( !IsOccupied( cell ) )
+	{
+		return false;
+	}
+
+	const GridChunkCells* cells = GetCells( cell );
+	int localIndex = GetLocalIndex( cell );
+	out_block->location = cell;
+	out_block->colorIndex = cells->colorIndices[localIndex];
+	out_block->material = cells->materials[localIndex];
+	out_block->flags = cells->flags[localIndex];
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetColorIndex
+*/
+uint8_t Grid::GetColorIndex( const IntVec2& cell ) const
+{
+	const GridChunkCells* cells = GetCells( cell );
+	return cells ? cells->colorIndices[GetLocalIndex( cell )] : 0;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetMaterial
+*/
+uint8_t Grid::GetMaterial( const IntVec2& cell ) const
+{
+	const GridChunkCells* cells = GetCells( cell );
+	return cells ? cells->materials[GetLocalIndex( cell )] : (uint8_t) BLOCK_MATERIAL_DEFAULT;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetFlags
+*/
+uint8_t Grid::GetFlags( const IntVec2& cell ) const
+{
+	const GridChunkCells* cells = GetCells( cell );
+	return cells ? cells->flags[GetLocalIndex( cell )] : (uint8_t) BLOCK_FLAG_NONE;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetColor
+*/
+const Rgba& Grid::GetColor( const IntVec2& cell ) const
+{
+	return m_palette[GetColorIndex( cell )];
+}
+
+//--------------------------------------------------------------------------
+/**
+* SetFlags
+*/
+void Grid::SetFlags( const IntVec2& cell, uint8_t flags )
+{
+	if( !IsInBounds( cell ) )
+	{
+		return;
+	}
+
+	// Flags on an empty cell are overwritten by the next placement, so only
+	// occupied cells have them hashed.
+	int chunkIndex = GetChunkIndexForCell( cell );
+	GridChunkCells* cells = GetWritableCells( chunkIndex );
+	int localIndex = GetLocalIndex( cell );
+	if( IsOccupied( cell ) )
+	{
+		int cellIndex = GetCellIndex( cell );
+		m_zobristHash ^= GetZobristKey( cellIndex, cells->colorIndices[localIndex], cells->materials[localIndex], cells->flags[localIndex] );
+		m_zobristHash ^= GetZobristKey( cellIndex, cells->colorIndices[localIndex], cells->materials[localIndex], flags );
+	}
+	cells->flags[localIndex] = flags;
+	MarkChunkDirty( chunkIndex );
+}
+
+//--------------------------------------------------------------------------
+/**
+* AddPaletteColor
+* Returns the index of the color, reusing an existing entry if one matches.
+*/
+uint8_t Grid::AddPaletteColor( const Rgba& color )
+{
+	for( size_t paletteIdx = 0; paletteIdx < m_palette.size(); ++paletteIdx )
+	{
+		const Rgba& entry = m_palette[paletteIdx];
+		if( entry.r == color.r && entry.g == color.g && entry.b == color.b && entry.a == color.a )
+		{
+			return (uint8_t) paletteIdx;
+		}
+	}
+
+	if( m_palette.size() >= GRID_MAX_PALETTE_SIZE )
+	{
+		ERROR_RECOVERABLE( "Grid palette is full" );
+		return 0;
+	}
+	m_palette.push_back( color );
+	return (uint8_t) ( m_palette.size() - 1 );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetPaletteColor
+*/
+const Rgba& Grid::GetPaletteColor( uint8_t colorIndex ) const
+{
+	return m_palette[colorIndex];
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetChunkIndexForCell
+*/
+int Grid::GetChunkIndexForCell( const IntVec2& cell ) const
+{
+	return ( cell.y >> GRID_CHUNK_SIZE_BITS ) * m_chunkDimensions.x + ( cell.x >> GRID_CHUNK_SIZE_BITS );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetChunkOrigin
+* Cell coords of the chunk's bottom left cell.
+*/
+IntVec2 Grid::GetChunkOrigin( int chunkIndex ) const
+{
+	return IntVec2( ( chunkIndex % m_chunkDimensions.x ) << GRID_CHUNK_SIZE_BITS, ( chunkIndex / m_chunkDimensions.x ) << GRID_CHUNK_SIZE_BITS );
+}
+
+//--------------------------------------------------------------------------
+/**
+* TakeDirtyChunks
+* Hands over every chunk changed since the last call and clears their flags.
+*/
+void Grid::TakeDirtyChunks( std::vector<int>* out_chunkIndices )
+{
+	for( int chunkIndex : m_dirtyChunks )
+	{
+		m_chunks[chunkIndex].isDirty = false;
+	}
+	out_chunkIndices->swap( m_dirtyChunks );
+	m_dirtyChunks.clear();
+}
+
+//--------------------------------------------------------------------------
+/**
+* MarkAllChunksDirty
+*/
+void Grid::MarkAllChunksDirty()
+{
+	for( int chunkIdx = 0; chunkIdx < (int) m_chunks.size(); ++chunkIdx )
+	{
+		MarkChunkDirty( chunkIdx );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetZobristKey
+* Computed rather than looked up, a table for every cell and attribute
+* combination wouldn't fit. SplitMix64 is a bijection, so every distinct
+* cell and attribute set gets a distinct key.
+*/
+uint64_t Grid::GetZobristKey( int cellIndex, uint8_t colorIndex, uint8_t material, uint8_t flags )
+{
+	uint64_t packed = ( (uint64_t) (uint32_t) cellIndex << 24 ) | ( (uint64_t) colorIndex << 16 ) | ( (uint64_t) material << 8 ) | flags;
+	return SplitMix64( packed ^ GRID_ZOBRIST_SALT );
+}
+
+//--------------------------------------------------------------------------
+/**
+* EnableConnectivity
+* Built from whatever is on the board now, kept current from then on.
+*/
+void Grid::EnableConnectivity()
+{
+	if( !m_connectivity )
+	{
+		m_connectivity.reset( new GridConnectivity( *this ) );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* EnableHistory
+* The board as it is now is where a full rewind goes back to.
+*/
+void Grid::EnableHistory( int maxFrames )
+{
+	if( !m_history )
+	{
+		m_history.reset( new GridHistory( *this, maxFrames ) );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* EnableShapeMatching
+* Starts with no targets, see GridShapeMatcher::AddTarget.
+*/
+void Grid::EnableShapeMatching()
+{
+	if( !m_shapeMatcher )
+	{
+		m_shapeMatcher.reset( new GridShapeMatcher( *this ) );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetCells
+* nullptr if the cell is out of bounds or its chunk has never been written.
+*/
+const GridChunkCells* Grid::GetCells( const IntVec2& cell ) const
+{
+	if( !IsInBounds( cell ) )
+	{
+		return nullptr;
+	}
+	return m_chunks[GetChunkIndexForCell( cell )].cells.get();
+}
+
+//--------------------------------------------------------------------------
+/**
+* Resize
+* Drops every chunk, the board is empty afterwards.
+*/
+void Grid::Resize( const IntVec2& dimensions )
+{
+	m_dimensions = dimensions;
+	m_chunkDimensions.x = ( dimensions.x + GRID_CHUNK_MASK ) >> GRID_CHUNK_SIZE_BITS;
+	m_chunkDimensions.y = ( dimensions.y + GRID_CHUNK_MASK ) >> GRID_CHUNK_SIZE_BITS;
+	m_chunks.clear();
+	m_chunks.resize( (size_t) m_chunkDimensions.x * m_chunkDimensions.y );
+	m_dirtyChunks.clear();
+	m_blockCount = 0;
+	m_zobristHash = 0;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetWritableCells
+* Creates the chunk's cells on first write, and copies them first if they
+* are level memory or the history still holds them. Once past that the
+* cells are a heap copy only this chunk holds, so handing them out as
+* writable is safe.
+*/
+GridChunkCells* Grid::GetWritableCells( int chunkIndex )
+{
+	if( m_history )
+	{
+		m_history->OnChunkWrite( chunkIndex );
+	}
+
+	GridChunk& chunk = m_chunks[chunkIndex];
+	if( !chunk.cells )
+	{
+		std::shared_ptr<GridChunkCells> cells = std::make_shared<GridChunkCells>();
+		memset( cells.get(), 0, sizeof( GridChunkCells ) );
+		chunk.cells = cells;
+		return cells.get();
+	}
+	if( chunk.isMapped || chunk.cells.use_count() > 1 )
+	{
+		std::shared_ptr<GridChunkCells> cells = std::make_shared<GridChunkCells>( *chunk.cells );
+		chunk.cells = cells;
+		chunk.isMapped = false;
+		return cells.get();
+	}
+	return const_cast<GridChunkCells*>( chunk.cells.get() );
+}
+
+//--------------------------------------------------------------------------
+/**
+* MarkChunkDirty
+*/
+void Grid::MarkChunkDirty( int chunkIndex )
+{
+	GridChunk& chunk = m_chunks[chunkIndex];
+	if( !chunk.isDirty )
+	{
+		chunk.isDirty = true;
+		m_dirtyChunks.push_back( chunkIndex );
+	}
+}
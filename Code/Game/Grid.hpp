@@ -1,12 +1,166 @@
 #pragma once
 #include "Engine/Math/IntVec2.hpp"
-
 #include "Engine/Core/Graphics/Rgba.hpp"
 
+#include "Game/Block.hpp"
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+class GridConnectivity;
+class GridHistory;
+class GridShapeMatcher;
+
+constexpr int GRID_MAX_DIMENSION = 4096;
+constexpr int GRID_MAX_PALETTE_SIZE = 256;
+
+constexpr int GRID_CHUNK_SIZE_BITS = 5;
+constexpr int GRID_CHUNK_SIZE = 1 << GRID_CHUNK_SIZE_BITS;	// 32x32 cells, one uint32 of occupancy per row.
+constexpr int GRID_CHUNK_MASK = GRID_CHUNK_SIZE - 1;
+constexpr int GRID_CHUNK_CELL_COUNT = GRID_CHUNK_SIZE * GRID_CHUNK_SIZE;
+
+constexpr uint64_t GRID_ZOBRIST_SALT = 0x5A0B21C7D3E4F601ull;
+
+// How much of a level BindLevel reads before binding. Levels from anywhere
+// (level_load, blobs) have every chunk image checked and the Zobrist hash
+// recomputed. Levels the game ships and names in GameConfig.xml are trusted:
+// only the header and chunk table are checked and the stored hash is kept.
+enum eLevelTrust : uint8_t
+{
+	LEVEL_UNTRUSTED = 0,
+	LEVEL_TRUSTED,
+};
+
+//--------------------------------------------------------------------------
+// Cell storage for one chunk. Plain data, indexed by local y * 32 + local x.
+//--------------------------------------------------------------------------
+struct GridChunkCells
+{
+	uint32_t occupancy[GRID_CHUNK_SIZE];	// Bit x of row y.
+	uint8_t colorIndices[GRID_CHUNK_CELL_COUNT];
+	uint8_t materials[GRID_CHUNK_CELL_COUNT];
+	uint8_t flags[GRID_CHUNK_CELL_COUNT];
+};
+
+//--------------------------------------------------------------------------
+// A chunk only allocates its cells once something is placed in it, so
+// empty areas of a big board cost a few bytes each. Cells loaded from a
+// level point straight into the level's memory (which the shared pointer
+// keeps alive) and are copied the first time the chunk is written.
+//--------------------------------------------------------------------------
+struct GridChunk
+{
+	std::shared_ptr<const GridChunkCells> cells;	// Written only through Grid::GetWritableCells.
+	int blockCount = 0;
+	bool isMapped = false;		// cells is read only level memory.
+	bool isDirty = false;
+};
+
+//--------------------------------------------------------------------------
+// The board, split into 32x32 chunks. Every change marks its chunk dirty and
+// queues it once so consumers (the mesher) only revisit what changed.
+//
+// The Zobrist hash covers every block and its attributes. Each change xors
+// the cell's old key out and its new key in, so equal boards hash equal
+// however they were built, and an empty board hashes to 0.
+//
+// Connectivity is opt in: once enabled, every place and remove keeps the
+// board's connected components current. So is history (undo, redo and
+// rewind), which shares chunk cells with the board: cells held by more than
+// one owner are copied before they are written. And so is shape matching,
+// which rechecks only the area around each change.
+//--------------------------------------------------------------------------
 class Grid
 {
+	friend class GridHistory;
+
+public:
+	explicit Grid( const IntVec2& dimensions = IntVec2( 10, 10 ) );
+	~Grid();
+
+	void Clear();
+	void CopyFrom( const Grid& other );
+
+	// Levels, see GridLevelFile.hpp
+	bool LoadLevelFile( const std::string& levelPath, eLevelTrust trust = LEVEL_UNTRUSTED );
+	bool LoadLevelBlob( std::vector<uint8_t>&& blob, eLevelTrust trust = LEVEL_UNTRUSTED );
+	bool BindLevel( const std::shared_ptr<const void>& owner, const uint8_t* data, size_t size, eLevelTrust trust = LEVEL_UNTRUSTED );
+
+	// Cells
+	const IntVec2& GetDimensions() const { return m_dimensions; }
+	int GetCellCount() const { return m_dimensions.x * m_dimensions.y; }
+	int GetBlockCount() const { return m_blockCount; }
+	bool IsInBounds( const IntVec2& cell ) const;
+	int GetCellIndex( const IntVec2& cell ) const { return cell.y * m_dimensions.x + cell.x; }
+	IntVec2 GetCellCoords( int cellIndex ) const;
+
+	bool IsOccupied( const IntVec2& cell ) const;
+	uint64_t GetRowBits( int y, int startX ) const;
+	void GetOccupiedCells( std::vector<IntVec2>* out_cells ) const;
+
+	// Blocks
+	bool PlaceBlock( const Block& block );
+	bool RemoveBlock( const IntVec2& cell );
+	bool GetBlock( const IntVec2& cell, Block* out_block ) const;
+
+	uint8_t GetColorIndex( const IntVec2& cell ) const;
+	uint8_t GetMaterial( const IntVec2& cell ) const;
+	uint8_t GetFlags( const IntVec2& cell ) const;
+	const Rgba& GetColor( const IntVec2& cell ) const;
+	void SetFlags( const IntVec2& cell, uint8_t flags );
+
+	// Palette
+	uint8_t AddPaletteColor( const Rgba& color );
+	const Rgba& GetPaletteColor( uint8_t colorIndex ) const;
+	int GetPaletteSize() const { return (int) m_palette.size(); }
+
+	// Chunks
+	const IntVec2& GetChunkDimensions() const { return m_chunkDimensions; }
+	int GetChunkCount() const { return (int) m_chunks.size(); }
+	int GetChunkIndexForCell( const IntVec2& cell ) const;
+	IntVec2 GetChunkOrigin( int chunkIndex ) const;
+	const GridChunk& GetChunk( int chunkIndex ) const { return m_chunks[chunkIndex]; }
+	void TakeDirtyChunks( std::vector<int>* out_chunkIndices );
+	void MarkAllChunksDirty();
+
+	// Hashing
+	uint64_t GetZobristHash() const { return m_zobristHash; }
+	static uint64_t GetZobristKey( int cellIndex, uint8_t colorIndex, uint8_t material, uint8_t flags );
+
+	// Structure
+	void EnableConnectivity();
+	GridConnectivity* GetConnectivity() const { return m_connectivity.get(); }
+
+	// History, see GridHistory.hpp
+	void EnableHistory( int maxFrames );
+	GridHistory* GetHistory() const { return m_history.get(); }
+
+	// Target shapes, see GridShapeMatcher.hpp
+	void EnableShapeMatching();
+	GridShapeMatcher* GetShapeMatcher() const { return m_shapeMatcher.get(); }
+
+private:
+	void Resize( const IntVec2& dimensions );
+	const GridChunkCells* GetCells( const IntVec2& cell ) const;
+	GridChunkCells* GetWritableCells( int chunkIndex );
+	void MarkChunkDirty( int chunkIndex );
+
+	static int GetLocalIndex( const IntVec2& cell ) { return ( ( cell.y & GRID_CHUNK_MASK ) << GRID_CHUNK_SIZE_BITS ) | ( cell.x & GRID_CHUNK_MASK ); }
+
+private:
+	IntVec2 m_dimensions;
+	IntVec2 m_chunkDimensions;
+	int m_blockCount = 0;
+	uint64_t m_zobristHash = 0;
 
+	std::vector<GridChunk> m_chunks;
+	std::vector<int> m_dirtyChunks;
 
-	IntVec2 dimentions = IntVec2(10,10);
+	std::vector<Rgba> m_palette;
 
-};
\ No newline at end of file
+	std::unique_ptr<GridConnectivity> m_connectivity;
+	std::unique_ptr<GridHistory> m_history;
+	std::unique_ptr<GridShapeMatcher> m_shapeMatcher;
+};
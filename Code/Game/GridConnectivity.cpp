@@ -0,0 +1,519 @@
+#include "Game/GridConnectivity.hpp"
+#include "Game/Grid.hpp"
+#include "Game/GameProfiler.hpp"
+#include "Game/GameUtils.hpp"
+
+#include <algorithm>
+
+//--------------------------------------------------------------------------
+// Order matters for IsRemovalLocal: walking the ring, each diagonal sits
+// between the two orthogonal neighbors it can join.
+//--------------------------------------------------------------------------
+static const IntVec2 RING_OFFSETS[8] =
+{
+	IntVec2(  0,  1 ), IntVec2(  1,  1 ), IntVec2(  1,  0 ), IntVec2(  1, -1 ),
+	IntVec2(  0, -1 ), IntVec2( -1, -1 ), IntVec2( -1,  0 ), IntVec2( -1,  1 ),
+};
+
+static const IntVec2 NEIGHBOR_OFFSETS[4] =
+{
+	IntVec2( 1, 0 ), IntVec2( -1, 0 ), IntVec2( 0, 1 ), IntVec2( 0, -1 ),
+};
+
+constexpr int CONNECTIVITY_COMPACT_SLACK = 256;
+
+//--------------------------------------------------------------------------
+/**
+* GridConnectivity
+*/
+GridConnectivity::GridConnectivity( const Grid& grid )
+	: m_grid( grid )
+{
+	Rebuild();
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~GridConnectivity
+*/
+GridConnectivity::~GridConnectivity()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* Rebuild
+* From scratch off the Grid's occupancy, 64 cells of a row at a time.
+*/
+void GridConnectivity::Rebuild()
+{
+	GAME_PROFILE_SCOPE( "GridConnectivity::Rebuild" );
+	const IntVec2& dimensions = m_grid.GetDimensions();
+	m_cellNodes.assign( (size_t) m_grid.GetCellCount(), -1 );
+	m_parents.clear();
+	m_nextMembers.clear();
+	m_nodeCells.clear();
+	m_blockCounts.clear();
+	m_groundContacts.clear();
+	m_liveNodeCount = 0;
+	m_componentCount = 0;
+	m_groundedComponentCount = 0;
+
+	for( int y = 0; y < dimensions.y; ++y )
+	{
+		for( int startX = 0; startX < dimensions.x; startX += 64 )
+		{
+			uint64_t rowBits = m_grid.GetRowBits( y, startX );
+			while( rowBits != 0 )
+			{
+				int x = startX + CountTrailingZeros( rowBits );
+				rowBits &= rowBits - 1;
+
+				int cellIndex = y * dimensions.x + x;
+				int node = CreateNode( cellIndex, y == 0 );
+				if( x > 0 && m_cellNodes[cellIndex - 1] >= 0 )
+				{
+					Union( node, m_cellNodes[cellIndex - 1] );
+				}
+				if( y > 0 && m_cellNodes[cellIndex - dimensions.x] >= 0 )
+				{
+					Union( node, m_cellNodes[cellIndex - dimensions.x] );
+				}
+			}
+		}
+	}
+	++m_stats.fullRebuilds;
+}
+
+//--------------------------------------------------------------------------
+/**
+* OnBlockPlaced
+* Call after the Grid has the block. Returns the component it ended up in.
+*/
+GridComponentInfo GridConnectivity::OnBlockPlaced( const IntVec2& cell )
+{
+	int cellIndex = m_grid.GetCellIndex( cell );
+	if( m_cellNodes[cellIndex] >= 0 )
+	{
+		return GetComponent( cell );
+	}
+
+	int node = CreateNode( cellIndex, cell.y == 0 );
+	for( const IntVec2& offset : NEIGHBOR_OFFSETS )
+	{
+		IntVec2 neighbor( cell.x + offset.x, cell.y + offset.y );
+		if( m_grid.IsInBounds( neighbor ) && m_cellNodes[m_grid.GetCellIndex( neighbor )] >= 0 )
+		{
+			Union( node, m_cellNodes[m_grid.GetCellIndex( neighbor )] );
+		}
+	}
+
+	++m_stats.placements;
+	return GetComponent( cell );
+}
+
+//--------------------------------------------------------------------------
+/**
+* OnBlockRemoved
+* Call after the Grid has dropped the block.
+*/
+void GridConnectivity::OnBlockRemoved( const IntVec2& cell )
+{
+	int cellIndex = m_grid.GetCellIndex( cell );
+	int node = m_cellNodes[cellIndex];
+	if( node < 0 )
+	{
+		return;
+	}
+
+	int root = FindRoot( node );
+	m_cellNodes[cellIndex] = -1;
+	m_nodeCells[node] = -1;
+	--m_liveNodeCount;
+	--m_blockCounts[root];
+	++m_stats.removals;
+
+	if( cell.y == 0 && --m_groundContacts[root] == 0 )
+	{
+		--m_groundedComponentCount;
+	}
+
+	if( m_blockCounts[root] == 0 )
+	{
+		--m_componentCount;
+	}
+	else if( IsRemovalLocal( cell ) )
+	{
+		++m_stats.localRemovals;
+	}
+	else
+	{
+		RelinkComponent( root );
+	}
+	CompactIfNeeded();
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetComponent
+* Invalid if the cell is empty.
+*/
+GridComponentInfo GridConnectivity::GetComponent( const IntVec2& cell )
+{
+	GridComponentInfo info;
+	if( !m_grid.IsInBounds( cell ) )
+	{
+		return info;
+	}
+	int node = m_cellNodes[m_grid.GetCellIndex( cell )];
+	if( node < 0 )
+	{
+		return info;
+	}
+
+	int root = FindRoot( node );
+	info.componentId = root;
+	info.blockCount = m_blockCounts[root];
+	info.groundContacts = m_groundContacts[root];
+	return info;
+}
+
+//--------------------------------------------------------------------------
+/**
+* AreConnected
+*/
+bool GridConnectivity::AreConnected( const IntVec2& cellA, const IntVec2& cellB )
+{
+	GridComponentInfo infoA = GetComponent( cellA );
+	return infoA.IsValid() && infoA.componentId == GetComponent( cellB ).componentId;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetFloatingCells
+* Every block in a component with no ground contact. Scans the board.
+*/
+void GridConnectivity::GetFloatingCells( std::vector<IntVec2>* out_cells )
+{
+	out_cells->clear();
+	if( GetFloatingComponentCount() == 0 )
+	{
+		return;
+	}
+	for( int cellIdx = 0; cellIdx < (int) m_cellNodes.size(); ++cellIdx )
+	{
+		int node = m_cellNodes[cellIdx];
+		if( node >= 0 && m_groundContacts[FindRoot( node )] == 0 )
+		{
+			out_cells->push_back( m_grid.GetCellCoords( cellIdx ) );
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* CreateNode
+* A new single block component.
+*/
+int GridConnectivity::CreateNode( int cellIndex, bool isGrounded )
+{
+	int node = (int) m_parents.size();
+	m_parents.push_back( node );
+	m_nextMembers.push_back( node );
+	m_nodeCells.push_back( cellIndex );
+	m_blockCounts.push_back( 1 );
+	m_groundContacts.push_back( isGrounded ? 1 : 0 );
+	m_cellNodes[cellIndex] = node;
+
+	++m_liveNodeCount;
+	++m_componentCount;
+	if( isGrounded )
+	{
+		++m_groundedComponentCount;
+	}
+	return node;
+}
+
+//--------------------------------------------------------------------------
+/**
+* FindRoot
+* Path halving.
+*/
+int GridConnectivity::FindRoot( int node )
+{
+	while( m_parents[node] != node )
+	{
+		m_parents[node] = m_parents[m_parents[node]];
+		node = m_parents[node];
+	}
+	return node;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Union
+* Smaller component under the larger, member lists spliced in O(1).
+*/
+void GridConnectivity::Union( int nodeA, int nodeB )
+{
+	int rootA = FindRoot( nodeA );
+	int rootB = FindRoot( nodeB );
+	if( rootA == rootB )
+	{
+		return;
+	}
+	if( m_blockCounts[rootA] < m_blockCounts[rootB] )
+	{
+		int swapRoot = rootA;
+		rootA = rootB;
+		rootB = swapRoot;
+	}
+
+	if( m_groundContacts[rootA] > 0 && m_groundContacts[rootB] > 0 )
+	{
+		--m_groundedComponentCount;
+	}
+	--m_componentCount;
+
+	m_parents[rootB] = rootA;
+	m_blockCounts[rootA] += m_blockCounts[rootB];
+	m_groundContacts[rootA] += m_groundContacts[rootB];
+
+	int nextA = m_nextMembers[rootA];
+	m_nextMembers[rootA] = m_nextMembers[rootB];
+	m_nextMembers[rootB] = nextA;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsRemovalLocal
+* True if the removed cell's filled neighbors still reach each other
+* through the ring of 8 around it, in which case the component is intact.
+*/
+bool GridConnectivity::IsRemovalLocal( const IntVec2& cell ) const
+{
+	bool isFilled[8];
+	for( int ringIdx = 0; ringIdx < 8; ++ringIdx )
+	{
+		IntVec2 ringCell( cell.x + RING_OFFSETS[ringIdx].x, cell.y + RING_OFFSETS[ringIdx].y );
+		isFilled[ringIdx] = m_grid.IsInBounds( ringCell ) && m_cellNodes[m_grid.GetCellIndex( ringCell )] >= 0;
+	}
+
+	int neighborCount = 0;
+	int linkCount = 0;
+	for( int ringIdx = 0; ringIdx < 8; ringIdx += 2 )
+	{
+		if( isFilled[ringIdx] )
+		{
+			++neighborCount;
+			if( isFilled[ringIdx + 1] && isFilled[( ringIdx + 2 ) & 7] )
+			{
+				++linkCount;
+			}
+		}
+	}
+
+	// Four neighbors linked all the way around is one group, not zero.
+	int groupCount = linkCount == 4 ? 1 : neighborCount - linkCount;
+	return groupCount <= 1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* RelinkComponent
+* The removed block may have split this component. Its surviving blocks
+* are re-linked among themselves, everything outside the component is
+* untouched.
+*/
+void GridConnectivity::RelinkComponent( int root )
+{
+	GAME_PROFILE_SCOPE( "GridConnectivity::RelinkComponent" );
+
+	std::vector<int> liveNodes;
+	liveNodes.reserve( (size_t) m_blockCounts[root] );
+	ResetComponentMembers( root, &liveNodes );
+
+	// Every filled neighbor of a member is a member, so looking right and up
+	// from each one covers every link.
+	int width = m_grid.GetDimensions().x;
+	int height = m_grid.GetDimensions().y;
+	for( int liveNode : liveNodes )
+	{
+		int cellIndex = m_nodeCells[liveNode];
+		int x = cellIndex % width;
+		int y = cellIndex / width;
+		if( x + 1 < width && m_cellNodes[cellIndex + 1] >= 0 )
+		{
+			Union( liveNode, m_cellNodes[cellIndex + 1] );
+		}
+		if( y + 1 < height && m_cellNodes[cellIndex + width] >= 0 )
+		{
+			Union( liveNode, m_cellNodes[cellIndex + width] );
+		}
+	}
+
+	++m_stats.splitRebuilds;
+	m_stats.cellsRelinked += (uint64_t) liveNodes.size();
+}
+
+//--------------------------------------------------------------------------
+/**
+* ResetComponentMembers
+* Live members keep their nodes but start over as singletons. The dead
+* ones drop out, nothing live points through them anymore.
+*/
+void GridConnectivity::ResetComponentMembers( int root, std::vector<int>* out_liveNodes )
+{
+	--m_componentCount;
+	if( m_groundContacts[root] > 0 )
+	{
+		--m_groundedComponentCount;
+	}
+
+	int width = m_grid.GetDimensions().x;
+	int node = root;
+	do
+	{
+		int nextNode = m_nextMembers[node];
+		int cellIndex = m_nodeCells[node];
+		if( cellIndex >= 0 )
+		{
+			bool isGrounded = cellIndex < width;
+			out_liveNodes->push_back( node );
+			m_parents[node] = node;
+			m_nextMembers[node] = node;
+			m_blockCounts[node] = 1;
+			m_groundContacts[node] = isGrounded ? 1 : 0;
+			++m_componentCount;
+			if( isGrounded )
+			{
+				++m_groundedComponentCount;
+			}
+		}
+		node = nextNode;
+	}
+	while( node != root );
+}
+
+//--------------------------------------------------------------------------
+/**
+* LinkToNeighbors
+* Unions the node with every filled cell next to it.
+*/
+void GridConnectivity::LinkToNeighbors( int node )
+{
+	IntVec2 cell = m_grid.GetCellCoords( m_nodeCells[node] );
+	for( const IntVec2& offset : NEIGHBOR_OFFSETS )
+	{
+		IntVec2 neighbor( cell.x + offset.x, cell.y + offset.y );
+		if( m_grid.IsInBounds( neighbor ) && m_cellNodes[m_grid.GetCellIndex( neighbor )] >= 0 )
+		{
+			Union( node, m_cellNodes[m_grid.GetCellIndex( neighbor )] );
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* OnChunksRestored
+* Call after the Grid has swapped in whole chunks, which may have added
+* and removed any number of blocks. Every component with a block in those
+* chunks comes apart, its blocks there are dropped and the chunks' blocks
+* now get fresh nodes, then all of those nodes are linked again. Costs the
+* chunks plus the components touching them, not the board.
+*/
+void GridConnectivity::OnChunksRestored( const std::vector<int>& chunkIndices )
+{
+	GAME_PROFILE_SCOPE( "GridConnectivity::OnChunksRestored" );
+	const IntVec2& dimensions = m_grid.GetDimensions();
+
+	std::vector<uint8_t> isRestoredChunk( (size_t) m_grid.GetChunkCount(), 0 );
+	std::vector<int> affectedRoots;
+	for( int chunkIndex : chunkIndices )
+	{
+		isRestoredChunk[chunkIndex] = 1;
+		IntVec2 origin = m_grid.GetChunkOrigin( chunkIndex );
+		int endX = std::min( origin.x + GRID_CHUNK_SIZE, dimensions.x );
+		int endY = std::min( origin.y + GRID_CHUNK_SIZE, dimensions.y );
+		for( int y = origin.y; y < endY; ++y )
+		{
+			for( int x = origin.x; x < endX; ++x )
+			{
+				int node = m_cellNodes[y * dimensions.x + x];
+				if( node >= 0 )
+				{
+					affectedRoots.push_back( FindRoot( node ) );
+				}
+			}
+		}
+	}
+	std::sort( affectedRoots.begin(), affectedRoots.end() );
+	affectedRoots.erase( std::unique( affectedRoots.begin(), affectedRoots.end() ), affectedRoots.end() );
+
+	std::vector<int> relinkNodes;
+	for( int root : affectedRoots )
+	{
+		ResetComponentMembers( root, &relinkNodes );
+	}
+
+	// Old blocks in the chunks die, surviving members elsewhere stay queued.
+	size_t keptCount = 0;
+	for( int node : relinkNodes )
+	{
+		int chunkIndex = m_grid.GetChunkIndexForCell( m_grid.GetCellCoords( m_nodeCells[node] ) );
+		if( isRestoredChunk[chunkIndex] == 0 )
+		{
+			relinkNodes[keptCount++] = node;
+			continue;
+		}
+		bool isGrounded = m_nodeCells[node] < dimensions.x;
+		m_cellNodes[m_nodeCells[node]] = -1;
+		m_nodeCells[node] = -1;
+		m_blockCounts[node] = 0;
+		--m_liveNodeCount;
+		--m_componentCount;
+		if( isGrounded )
+		{
+			m_groundContacts[node] = 0;
+			--m_groundedComponentCount;
+		}
+	}
+	relinkNodes.resize( keptCount );
+
+	for( int chunkIndex : chunkIndices )
+	{
+		IntVec2 origin = m_grid.GetChunkOrigin( chunkIndex );
+		int endY = std::min( origin.y + GRID_CHUNK_SIZE, dimensions.y );
+		for( int y = origin.y; y < endY; ++y )
+		{
+			uint64_t rowBits = m_grid.GetRowBits( y, origin.x ) & 0xFFFFFFFFull;
+			while( rowBits != 0 )
+			{
+				int x = origin.x + CountTrailingZeros( rowBits );
+				rowBits &= rowBits - 1;
+				relinkNodes.push_back( CreateNode( y * dimensions.x + x, y == 0 ) );
+			}
+		}
+	}
+
+	for( int node : relinkNodes )
+	{
+		LinkToNeighbors( node );
+	}
+
+	++m_stats.chunkRestores;
+	m_stats.cellsRelinked += (uint64_t) relinkNodes.size();
+	CompactIfNeeded();
+}
+
+//--------------------------------------------------------------------------
+/**
+* CompactIfNeeded
+*/
+void GridConnectivity::CompactIfNeeded()
+{
+	if( (int) m_parents.size() > 2 * m_liveNodeCount + CONNECTIVITY_COMPACT_SLACK )
+	{
+		Rebuild();
+	}
+}
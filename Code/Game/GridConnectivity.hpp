@@ -0,0 +1,97 @@
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+class Grid;
+
+//--------------------------------------------------------------------------
+// What a component looked like at the time it was asked for. The id is the
+// component's current root and only holds until the next change.
+//--------------------------------------------------------------------------
+struct GridComponentInfo
+{
+	int componentId = -1;
+	int blockCount = 0;
+	int groundContacts = 0;		// Blocks in row 0.
+
+	bool IsValid() const { return componentId >= 0; }
+	bool IsGrounded() const { return groundContacts > 0; }
+};
+
+struct GridConnectivityStats
+{
+	uint64_t placements = 0;
+	uint64_t removals = 0;
+	uint64_t localRemovals = 0;		// Neighbors provably still connected, O(1).
+	uint64_t splitRebuilds = 0;		// Re-linked just the affected component.
+	uint64_t cellsRelinked = 0;
+	uint64_t chunkRestores = 0;		// Re-linked around chunks swapped wholesale (undo, redo).
+	uint64_t fullRebuilds = 0;		// Compacting away dead nodes.
+};
+
+//--------------------------------------------------------------------------
+// Connected components (4-neighbor) of the blocks on a Grid, kept up to
+// date block by block with union-find, so structure queries never flood
+// the board.
+//
+// Placing a block is a handful of unions. Removing one can't be undone in
+// union-find, so the removed block's node stays behind as a dead link in
+// its tree and the cell gets a fresh node if it's filled again. When the
+// ring of 8 cells around the removed one shows its neighbors still touch
+// each other, nothing can have split and the removal is O(1). Otherwise
+// only that component is re-linked. Dead nodes are compacted away by a full
+// rebuild once they outnumber live blocks, which keeps removal amortized.
+//
+// When whole chunks are swapped under it (history undo and redo), only
+// the components that had blocks in those chunks are taken apart and
+// re-linked, together with whatever the chunks hold now.
+//
+// A component is grounded if any of its blocks sits in row 0.
+//--------------------------------------------------------------------------
+class GridConnectivity
+{
+public:
+	explicit GridConnectivity( const Grid& grid );
+	~GridConnectivity();
+
+	void Rebuild();
+	GridComponentInfo OnBlockPlaced( const IntVec2& cell );
+	void OnBlockRemoved( const IntVec2& cell );
+	void OnChunksRestored( const std::vector<int>& chunkIndices );
+
+	GridComponentInfo GetComponent( const IntVec2& cell );
+	bool AreConnected( const IntVec2& cellA, const IntVec2& cellB );
+	int GetComponentCount() const { return m_componentCount; }
+	int GetGroundedComponentCount() const { return m_groundedComponentCount; }
+	int GetFloatingComponentCount() const { return m_componentCount - m_groundedComponentCount; }
+	void GetFloatingCells( std::vector<IntVec2>* out_cells );
+	const GridConnectivityStats& GetStats() const { return m_stats; }
+
+private:
+	int CreateNode( int cellIndex, bool isGrounded );
+	int FindRoot( int node );
+	void Union( int nodeA, int nodeB );
+	bool IsRemovalLocal( const IntVec2& cell ) const;
+	void RelinkComponent( int root );
+	void ResetComponentMembers( int root, std::vector<int>* out_liveNodes );
+	void LinkToNeighbors( int node );
+	void CompactIfNeeded();
+
+private:
+	const Grid& m_grid;
+	std::vector<int> m_cellNodes;		// Per cell, -1 when empty.
+
+	// Per node. Sizes and ground contacts are only meaningful on roots.
+	std::vector<int> m_parents;
+	std::vector<int> m_nextMembers;		// Circular list of every node that ever joined the component.
+	std::vector<int> m_nodeCells;		// -1 once the block is gone.
+	std::vector<int> m_blockCounts;
+	std::vector<int> m_groundContacts;
+
+	int m_liveNodeCount = 0;
+	int m_componentCount = 0;
+	int m_groundedComponentCount = 0;
+	GridConnectivityStats m_stats;
+};
@@ -0,0 +1,402 @@
+#include "Game/GridHistory.hpp"
+#include "Game/Grid.hpp"
+#include "Game/GridConnectivity.hpp"
+#include "Game/GridShapeMatcher.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Game.hpp"
+#include "Game/Benchmarks.hpp"
+#include "Game/GameProfiler.hpp"
+
+#include <algorithm>
+#include <string>
+
+//--------------------------------------------------------------------------
+/**
+* GridHistory
+* The board as it is now is the start.
+*/
+GridHistory::GridHistory( Grid& grid, int maxFrames )
+	: m_grid( grid )
+	, m_maxFrames( maxFrames > 0 ? maxFrames : 1 )
+{
+	Reset();
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~GridHistory
+*/
+GridHistory::~GridHistory()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* Reset
+* Forgets every frame, the board as it is now becomes the start.
+*/
+void GridHistory::Reset()
+{
+	m_frames.clear();
+	m_redoFrames.clear();
+	m_chunkStamps.assign( (size_t) m_grid.GetChunkCount(), 0 );
+	m_mergeMarks.assign( (size_t) m_grid.GetChunkCount(), 0 );
+	m_restoredChunks.clear();
+	m_restoredMarks.assign( (size_t) m_grid.GetChunkCount(), 0 );
+	m_openStamp = 0;
+	OpenFrame();
+}
+
+//--------------------------------------------------------------------------
+/**
+* Checkpoint
+* Closes the open frame. Nothing happens if the board hasn't changed since
+* the last checkpoint, so this can be called every tick.
+*/
+void GridHistory::Checkpoint()
+{
+	if( m_frames.back().chunks.empty() )
+	{
+		return;
+	}
+	++m_stats.checkpoints;
+	OpenFrame();
+	if( (int) m_frames.size() - 1 > m_maxFrames )
+	{
+		MergeOldestFrames();
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* OnChunkWrite
+* Called by the Grid before it changes a chunk.
+*/
+void GridHistory::OnChunkWrite( int chunkIndex )
+{
+	if( m_chunkStamps[chunkIndex] == m_openStamp )
+	{
+		return;
+	}
+	m_chunkStamps[chunkIndex] = m_openStamp;
+	m_redoFrames.clear();
+
+	const GridChunk& chunk = m_grid.m_chunks[chunkIndex];
+	ChunkState state;
+	state.chunkIndex = chunkIndex;
+	state.cells = chunk.cells;
+	state.blockCount = chunk.blockCount;
+	state.isMapped = chunk.isMapped;
+	m_frames.back().chunks.push_back( std::move( state ) );
+	++m_stats.chunksRecorded;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Undo
+* Back to the last checkpoint, or the one before if nothing changed since.
+*/
+bool GridHistory::Undo()
+{
+	if( !UndoFrame() )
+	{
+		return false;
+	}
+	OnRestored();
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Redo
+*/
+bool GridHistory::Redo()
+{
+	if( !RedoFrame() )
+	{
+		return false;
+	}
+	OnRestored();
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Rewind
+* Returns how many frames were undone.
+*/
+int GridHistory::Rewind( int frameCount )
+{
+	int undoneCount = 0;
+	while( undoneCount < frameCount && UndoFrame() )
+	{
+		++undoneCount;
+	}
+	if( undoneCount > 0 )
+	{
+		OnRestored();
+	}
+	return undoneCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* RewindToStart
+* Back to the board as it was at the last Reset. Costs the chunks changed
+* since, not the board.
+*/
+int GridHistory::RewindToStart()
+{
+	GAME_PROFILE_SCOPE( "GridHistory::RewindToStart" );
+	return Rewind( GetUndoCount() );
+}
+
+//--------------------------------------------------------------------------
+/**
+* Replay
+* Redoes up to frameCount frames, returns how many were.
+*/
+int GridHistory::Replay( int frameCount )
+{
+	int redoneCount = 0;
+	while( redoneCount < frameCount && RedoFrame() )
+	{
+		++redoneCount;
+	}
+	if( redoneCount > 0 )
+	{
+		OnRestored();
+	}
+	return redoneCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetUndoCount
+* Closed frames, plus the open one if it has changes.
+*/
+int GridHistory::GetUndoCount() const
+{
+	return (int) m_frames.size() - ( m_frames.back().chunks.empty() ? 1 : 0 );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetRetainedChunkCount
+* Chunk pages only the history keeps alive, what undo costs in memory.
+*/
+int GridHistory::GetRetainedChunkCount() const
+{
+	int retainedCount = 0;
+	for( const Frame& frame : m_frames )
+	{
+		for( const ChunkState& state : frame.chunks )
+		{
+			retainedCount += ( state.cells != nullptr && !state.isMapped && state.cells != m_grid.m_chunks[state.chunkIndex].cells ) ? 1 : 0;
+		}
+	}
+	for( const Frame& frame : m_redoFrames )
+	{
+		for( const ChunkState& state : frame.chunks )
+		{
+			retainedCount += ( state.cells != nullptr && !state.isMapped ) ? 1 : 0;
+		}
+	}
+	return retainedCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* OpenFrame
+* A new stamp means every chunk is recorded again on its next write.
+*/
+void GridHistory::OpenFrame()
+{
+	++m_openStamp;
+	if( m_openStamp == 0 )
+	{
+		m_chunkStamps.assign( m_chunkStamps.size(), 0 );
+		m_openStamp = 1;
+	}
+
+	Frame frame;
+	frame.blockCount = m_grid.m_blockCount;
+	frame.zobristHash = m_grid.m_zobristHash;
+	m_frames.push_back( std::move( frame ) );
+}
+
+//--------------------------------------------------------------------------
+/**
+* UndoFrame
+* Leaves the restored frame open and empty, its start is the board now.
+*/
+bool GridHistory::UndoFrame()
+{
+	if( m_frames.back().chunks.empty() )
+	{
+		if( m_frames.size() == 1 )
+		{
+			return false;
+		}
+		m_frames.pop_back();
+	}
+
+	Frame inverse;
+	ApplyFrame( &m_frames.back(), &inverse );
+	m_redoFrames.push_back( std::move( inverse ) );
+
+	m_frames.pop_back();
+	OpenFrame();
+	++m_stats.undos;
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* RedoFrame
+* The open frame is empty here (any write drops the redo frames), so the
+* redone changes become its contents and it is closed.
+*/
+bool GridHistory::RedoFrame()
+{
+	if( m_redoFrames.empty() )
+	{
+		return false;
+	}
+
+	Frame& openFrame = m_frames.back();
+	ApplyFrame( &m_redoFrames.back(), &openFrame );
+	m_redoFrames.pop_back();
+
+	OpenFrame();
+	++m_stats.redos;
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* ApplyFrame
+* Swaps the frame's chunks and board totals into the Grid. out_inverse gets
+* what they replaced, applying it puts the board back.
+*/
+void GridHistory::ApplyFrame( Frame* frame, Frame* out_inverse )
+{
+	out_inverse->chunks.clear();
+	out_inverse->chunks.reserve( frame->chunks.size() );
+	for( ChunkState& state : frame->chunks )
+	{
+		GridChunk& chunk = m_grid.m_chunks[state.chunkIndex];
+		ChunkState replaced;
+		replaced.chunkIndex = state.chunkIndex;
+		replaced.cells = std::move( chunk.cells );
+		replaced.blockCount = chunk.blockCount;
+		replaced.isMapped = chunk.isMapped;
+		out_inverse->chunks.push_back( std::move( replaced ) );
+
+		chunk.cells = std::move( state.cells );
+		chunk.blockCount = state.blockCount;
+		chunk.isMapped = state.isMapped;
+		m_grid.MarkChunkDirty( state.chunkIndex );
+
+		if( m_restoredMarks[state.chunkIndex] == 0 )
+		{
+			m_restoredMarks[state.chunkIndex] = 1;
+			m_restoredChunks.push_back( state.chunkIndex );
+		}
+	}
+	m_stats.chunksRestored += frame->chunks.size();
+	frame->chunks.clear();
+
+	out_inverse->blockCount = m_grid.m_blockCount;
+	out_inverse->zobristHash = m_grid.m_zobristHash;
+	m_grid.m_blockCount = frame->blockCount;
+	m_grid.m_zobristHash = frame->zobristHash;
+}
+
+//--------------------------------------------------------------------------
+/**
+* MergeOldestFrames
+* The merged frame keeps the older start and, per chunk, the older state.
+*/
+void GridHistory::MergeOldestFrames()
+{
+	Frame& oldest = m_frames[0];
+	Frame& next = m_frames[1];
+	for( const ChunkState& state : oldest.chunks )
+	{
+		m_mergeMarks[state.chunkIndex] = 1;
+	}
+	for( ChunkState& state : next.chunks )
+	{
+		if( m_mergeMarks[state.chunkIndex] == 0 )
+		{
+			oldest.chunks.push_back( std::move( state ) );
+		}
+	}
+	for( const ChunkState& state : oldest.chunks )
+	{
+		m_mergeMarks[state.chunkIndex] = 0;
+	}
+
+	next.chunks.swap( oldest.chunks );
+	next.blockCount = oldest.blockCount;
+	next.zobristHash = oldest.zobristHash;
+	m_frames.pop_front();
+	++m_stats.framesMerged;
+}
+
+//--------------------------------------------------------------------------
+/**
+* OnRestored
+* Connectivity and shape matching have no undo of their own. Both are told
+* which chunks were swapped and redo only the area around them.
+*/
+void GridHistory::OnRestored()
+{
+	if( m_grid.m_connectivity )
+	{
+		m_grid.m_connectivity->OnChunksRestored( m_restoredChunks );
+	}
+	if( m_grid.m_shapeMatcher )
+	{
+		const IntVec2& dimensions = m_grid.GetDimensions();
+		for( int chunkIndex : m_restoredChunks )
+		{
+			IntVec2 minCell = m_grid.GetChunkOrigin( chunkIndex );
+			IntVec2 maxCell( std::min( minCell.x + GRID_CHUNK_SIZE, dimensions.x ) - 1, std::min( minCell.y + GRID_CHUNK_SIZE, dimensions.y ) - 1 );
+			m_grid.m_shapeMatcher->OnRegionChanged( minCell, maxCell );
+		}
+	}
+
+	for( int chunkIndex : m_restoredChunks )
+	{
+		m_restoredMarks[chunkIndex] = 0;
+	}
+	m_restoredChunks.clear();
+}
+
+//--------------------------------------------------------------------------
+/**
+* Command_UndoGrid
+* grid_undo [steps=1]
+*/
+bool Command_UndoGrid( EventArgs& args )
+{
+	GridHistory* history = g_theGame->GetGrid()->GetHistory();
+	int undoneCount = history->Rewind( args.GetValue( "steps", 1 ) );
+	BenchmarkPrint( "Undid " + std::to_string( undoneCount ) + " grid steps, " + std::to_string( history->GetUndoCount() ) + " left" );
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Command_RedoGrid
+* grid_redo [steps=1]
+*/
+bool Command_RedoGrid( EventArgs& args )
+{
+	GridHistory* history = g_theGame->GetGrid()->GetHistory();
+	int redoneCount = history->Replay( args.GetValue( "steps", 1 ) );
+	BenchmarkPrint( "Redid " + std::to_string( redoneCount ) + " grid steps, " + std::to_string( history->GetRedoCount() ) + " left" );
+	return true;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+
+#include <stdint.h>
+#include <deque>
+#include <memory>
+#include <vector>
+
+class Grid;
+struct GridChunkCells;
+
+constexpr int DEFAULT_GRID_HISTORY_SIZE = 256;
+
+struct GridHistoryStats
+{
+	uint64_t checkpoints = 0;
+	uint64_t undos = 0;
+	uint64_t redos = 0;
+	uint64_t chunksRecorded = 0;
+	uint64_t chunksRestored = 0;
+	uint64_t framesMerged = 0;
+};
+
+//--------------------------------------------------------------------------
+// Undo, redo and rewind for a Grid, a chunk at a time.
+//
+// The history is a list of frames, one per checkpoint. The first time a
+// chunk is written in a frame, the frame keeps the chunk's cells as they
+// were, which is just another reference to them: the Grid copies cells that
+// are shared before writing. So a checkpoint is O(1), undoing a frame is
+// O(chunks it changed), and the history only holds chunks that actually
+// changed, each page shared between the board and every frame that saw it.
+//
+// Past the size limit the two oldest frames are merged rather than dropped,
+// so the start stays reachable and at most one old copy of each chunk is
+// kept for it.
+//
+// After a restore, connectivity re-links and shape matching rechecks only
+// around the chunks that were swapped, so a rewind costs what changed.
+//--------------------------------------------------------------------------
+class GridHistory
+{
+public:
+	GridHistory( Grid& grid, int maxFrames );
+	~GridHistory();
+
+	void Reset();
+	void Checkpoint();
+	void OnChunkWrite( int chunkIndex );
+
+	bool Undo();
+	bool Redo();
+	int Rewind( int frameCount );
+	int RewindToStart();
+	int Replay( int frameCount );
+
+	int GetUndoCount() const;
+	int GetRedoCount() const { return (int) m_redoFrames.size(); }
+	int GetRetainedChunkCount() const;
+	const GridHistoryStats& GetStats() const { return m_stats; }
+
+private:
+	struct ChunkState
+	{
+		int chunkIndex = -1;
+		std::shared_ptr<const GridChunkCells> cells;
+		int blockCount = 0;
+		bool isMapped = false;
+	};
+
+	struct Frame
+	{
+		std::vector<ChunkState> chunks;		// As they were when the frame began.
+		int blockCount = 0;
+		uint64_t zobristHash = 0;
+	};
+
+	void OpenFrame();
+	bool UndoFrame();
+	bool RedoFrame();
+	void ApplyFrame( Frame* frame, Frame* out_inverse );
+	void MergeOldestFrames();
+	void OnRestored();
+
+private:
+	Grid& m_grid;
+	int m_maxFrames = DEFAULT_GRID_HISTORY_SIZE;
+
+	std::deque<Frame> m_frames;			// Back is the open frame, recording now.
+	std::vector<Frame> m_redoFrames;	// Back is the next to redo.
+
+	std::vector<uint32_t> m_chunkStamps;	// Per chunk, the stamp of the frame that last recorded it.
+	uint32_t m_openStamp = 0;
+	std::vector<uint8_t> m_mergeMarks;
+	std::vector<int> m_restoredChunks;		// Since the last OnRestored, each once.
+	std::vector<uint8_t> m_restoredMarks;
+
+	GridHistoryStats m_stats;
+};
+
+bool Command_UndoGrid( EventArgs& args );
+bool Command_RedoGrid( EventArgs& args );
@@ -0,0 +1,159 @@
+#include "Game/GridLevelFile.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Game.hpp"
+#include "Game/Benchmarks.hpp"
+#include "Game/InputJournal.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <unordered_map>
+
+//--------------------------------------------------------------------------
+/**
+* AlignUp
+*/
+static uint32_t AlignUp( uint32_t offset, uint32_t alignment )
+{
+	return ( offset + alignment - 1 ) & ~( alignment - 1 );
+}
+
+//--------------------------------------------------------------------------
+/**
+* BuildGridLevel
+* Identical chunk images are found by content hash, then compared in full.
+*/
+void BuildGridLevel( const Grid& grid, std::vector<uint8_t>* out_blob )
+{
+	const IntVec2& chunkDimensions = grid.GetChunkDimensions();
+	int chunkCount = grid.GetChunkCount();
+
+	std::vector<GridLevelChunk> chunkTable( (size_t) chunkCount );
+	std::vector<const GridChunkCells*> images;
+	std::unordered_multimap<uint64_t, uint32_t> imagesByHash;
+	for( int chunkIdx = 0; chunkIdx < chunkCount; ++chunkIdx )
+	{
+		const GridChunk& chunk = grid.GetChunk( chunkIdx );
+		GridLevelChunk& entry = chunkTable[chunkIdx];
+		entry.imageIndex = GRID_LEVEL_EMPTY_CHUNK;
+		entry.blockCount = 0;
+		if( chunk.cells == nullptr || chunk.blockCount == 0 )
+		{
+			continue;
+		}
+
+		const GridChunkCells* cells = chunk.cells.get();
+		uint64_t hash = HashBytes( STATE_HASH_SEED, cells, sizeof( GridChunkCells ) );
+		auto range = imagesByHash.equal_range( hash );
+		for( auto it = range.first; it != range.second; ++it )
+		{
+			if( memcmp( images[it->second], cells, sizeof( GridChunkCells ) ) == 0 )
+			{
+				entry.imageIndex = it->second;
+				break;
+			}
+		}
+		if( entry.imageIndex == GRID_LEVEL_EMPTY_CHUNK )
+		{
+			entry.imageIndex = (uint32_t) images.size();
+			imagesByHash.emplace( hash, entry.imageIndex );
+			images.push_back( cells );
+		}
+		entry.blockCount = (uint32_t) chunk.blockCount;
+	}
+
+	GridLevelHeader header;
+	memset( &header, 0, sizeof( header ) );
+	header.magic = GRID_LEVEL_MAGIC;
+	header.version = GRID_LEVEL_VERSION;
+	header.cellsSize = (uint32_t) sizeof( GridChunkCells );
+	header.width = (uint32_t) grid.GetDimensions().x;
+	header.height = (uint32_t) grid.GetDimensions().y;
+	header.chunkCountX = (uint32_t) chunkDimensions.x;
+	header.chunkCountY = (uint32_t) chunkDimensions.y;
+	header.blockCount = (uint32_t) grid.GetBlockCount();
+	header.paletteCount = (uint32_t) grid.GetPaletteSize();
+	header.zobristHash = grid.GetZobristHash();
+	header.paletteOffset = (uint32_t) sizeof( GridLevelHeader );
+	header.chunkTableOffset = header.paletteOffset + header.paletteCount * (uint32_t) sizeof( GridLevelColor );
+	header.imageCount = (uint32_t) images.size();
+	header.imagesOffset = AlignUp( header.chunkTableOffset + (uint32_t) chunkCount * (uint32_t) sizeof( GridLevelChunk ), GRID_LEVEL_IMAGE_ALIGNMENT );
+	header.totalBytes = header.imagesOffset + header.imageCount * (uint32_t) sizeof( GridChunkCells );
+
+	out_blob->assign( header.totalBytes, 0 );
+	uint8_t* blob = out_blob->data();
+	memcpy( blob, &header, sizeof( header ) );
+
+	GridLevelColor* palette = (GridLevelColor*) ( blob + header.paletteOffset );
+	for( int colorIdx = 0; colorIdx < grid.GetPaletteSize(); ++colorIdx )
+	{
+		const Rgba& color = grid.GetPaletteColor( (uint8_t) colorIdx );
+		palette[colorIdx].rgba[0] = color.r;
+		palette[colorIdx].rgba[1] = color.g;
+		palette[colorIdx].rgba[2] = color.b;
+		palette[colorIdx].rgba[3] = color.a;
+	}
+
+	memcpy( blob + header.chunkTableOffset, chunkTable.data(), chunkTable.size() * sizeof( GridLevelChunk ) );
+	for( size_t imageIdx = 0; imageIdx < images.size(); ++imageIdx )
+	{
+		memcpy( blob + header.imagesOffset + imageIdx * sizeof( GridChunkCells ), images[imageIdx], sizeof( GridChunkCells ) );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* SaveGridLevel
+*/
+bool SaveGridLevel( const Grid& grid, const std::string& levelPath )
+{
+	std::vector<uint8_t> blob;
+	BuildGridLevel( grid, &blob );
+
+	FILE* file = fopen( levelPath.c_str(), "wb" );
+	if( file == nullptr )
+	{
+		return false;
+	}
+	size_t written = fwrite( blob.data(), 1, blob.size(), file );
+	fclose( file );
+	return written == blob.size();
+}
+
+//--------------------------------------------------------------------------
+/**
+* Command_SaveLevel
+* level_save [file=Data/Levels/Level.glvl]
+*/
+bool Command_SaveLevel( EventArgs& args )
+{
+	std::string levelPath = args.GetValue( "file", DEFAULT_LEVEL_PATH );
+	if( SaveGridLevel( *g_theGame->GetGrid(), levelPath ) )
+	{
+		BenchmarkPrint( "Level saved to " + levelPath );
+	}
+	else
+	{
+		BenchmarkPrint( "Could not write level " + levelPath );
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Command_LoadLevel
+* level_load [file=Data/Levels/Level.glvl]
+*/
+bool Command_LoadLevel( EventArgs& args )
+{
+	std::string levelPath = args.GetValue( "file", DEFAULT_LEVEL_PATH );
+	Grid* grid = g_theGame->GetGrid();
+	if( grid->LoadLevelFile( levelPath ) )
+	{
+		BenchmarkPrint( "Loaded " + std::to_string( grid->GetBlockCount() ) + " blocks from " + levelPath );
+	}
+	else
+	{
+		BenchmarkPrint( "Could not load level " + levelPath );
+	}
+	return true;
+}
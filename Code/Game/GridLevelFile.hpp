@@ -0,0 +1,61 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include "Game/Grid.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+constexpr const char* DEFAULT_LEVEL_PATH = "Data/Levels/Level.glvl";
+
+//--------------------------------------------------------------------------
+// Level file layout (*.glvl). Laid out so a Grid can be bound straight to
+// a mapped file: chunk images are GridChunkCells exactly as the Grid keeps
+// them, 64 byte aligned, and chunks point into the file until they are
+// first written. Offsets are bytes from the start of the blob, little
+// endian.
+//
+// Empty chunks are left out and identical chunks (a floor, a repeated wall)
+// share one image, which is where the size goes on a big board. Anything
+// denser, like run length coding, would need a decoded copy and lose the
+// zero copy load.
+//--------------------------------------------------------------------------
+constexpr uint32_t GRID_LEVEL_MAGIC = 0x4C564C47;	// "GLVL"
+constexpr uint32_t GRID_LEVEL_VERSION = 1;
+constexpr uint32_t GRID_LEVEL_IMAGE_ALIGNMENT = 64;
+constexpr uint32_t GRID_LEVEL_EMPTY_CHUNK = 0xFFFFFFFFu;
+
+struct GridLevelHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t totalBytes;
+	uint32_t cellsSize;				// sizeof( GridChunkCells ) when written.
+	uint32_t width;
+	uint32_t height;
+	uint32_t chunkCountX;
+	uint32_t chunkCountY;
+	uint32_t blockCount;
+	uint32_t paletteCount;
+	uint64_t zobristHash;
+	uint32_t paletteOffset;			// GridLevelColor[paletteCount]
+	uint32_t chunkTableOffset;		// GridLevelChunk[chunkCountX * chunkCountY]
+	uint32_t imageCount;
+	uint32_t imagesOffset;			// GridChunkCells[imageCount], GRID_LEVEL_IMAGE_ALIGNMENT aligned
+};
+
+struct GridLevelColor
+{
+	float rgba[4];
+};
+
+struct GridLevelChunk
+{
+	uint32_t imageIndex;			// GRID_LEVEL_EMPTY_CHUNK when the chunk has no blocks.
+	uint32_t blockCount;
+};
+
+void BuildGridLevel( const Grid& grid, std::vector<uint8_t>* out_blob );
+bool SaveGridLevel( const Grid& grid, const std::string& levelPath );
+bool Command_SaveLevel( EventArgs& args );
+bool Command_LoadLevel( EventArgs& args );
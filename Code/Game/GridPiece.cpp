@@ -0,0 +1,260 @@
+#include "Game/GridPiece.hpp"
+#include "Game/Grid.hpp"
+#include "Game/GameUtils.hpp"
+
+#if defined(GAME_AVX2_DISPATCH)
+#define PIECES_AVX2
+#include <immintrin.h>
+#endif
+
+//--------------------------------------------------------------------------
+/**
+* Capture
+*/
+void GridBitboard::Capture( const Grid& grid )
+{
+	m_dimensions = grid.GetDimensions();
+	m_boardWordsPerRow = ( m_dimensions.x + 63 ) >> 6;
+	m_wordsPerRow = PAD_WORDS_LEFT + m_boardWordsPerRow + PAD_WORDS_RIGHT;
+	m_words.assign( (size_t) ( m_dimensions.y + 2 * GUARD_ROWS ) * m_wordsPerRow, 0 );
+
+	for( int y = 0; y < m_dimensions.y; ++y )
+	{
+		uint64_t* rowWords = &m_words[(size_t) ( y + GUARD_ROWS ) * m_wordsPerRow + PAD_WORDS_LEFT];
+		for( int wordIdx = 0; wordIdx < m_boardWordsPerRow; ++wordIdx )
+		{
+			rowWords[wordIdx] = grid.GetRowBits( y, wordIdx << 6 );
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetInBoundsMask
+* Origins in [startX, startX + 64) where a piece this wide fits on the row.
+*/
+static uint64_t GetInBoundsMask( int boardWidth, int pieceWidth, int startX )
+{
+	int firstIndex = startX < 0 ? -startX : 0;
+	int endIndex = boardWidth - pieceWidth + 1 - startX;
+	endIndex = endIndex > 64 ? 64 : endIndex;
+	if( endIndex <= firstIndex )
+	{
+		return 0;
+	}
+	uint64_t endMask = endIndex == 64 ? ~0ull : ( 1ull << endIndex ) - 1;
+	return endMask & ~( ( 1ull << firstIndex ) - 1 );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetPiecePlacementMask
+* Bit i set if the piece fits with its bottom left at ( startX + i, y ).
+* One window per piece cell and per neighbor cell covers 64 origins.
+*/
+uint64_t GetPiecePlacementMask( const GridBitboard& board, const GridPieceShape& shape, int y, int startX, bool requireSupport )
+{
+	const IntVec2& dimensions = board.GetDimensions();
+	if( y < 0 || y + shape.height > dimensions.y )
+	{
+		return 0;
+	}
+
+	uint64_t blocked = 0;
+	for( int row = 0; row < shape.height; ++row )
+	{
+		uint32_t rowBits = shape.rows[row];
+		while( rowBits != 0 )
+		{
+			blocked |= board.GetWindow( y + row, startX + CountTrailingZeros( rowBits ) );
+			rowBits &= rowBits - 1;
+		}
+	}
+	uint64_t legal = ~blocked & GetInBoundsMask( dimensions.x, shape.width, startX );
+
+	if( requireSupport && y > 0 && legal != 0 )
+	{
+		uint64_t supported = 0;
+		for( int row = 0; row < shape.height + 2; ++row )
+		{
+			uint32_t rowBits = shape.neighborRows[row];
+			while( rowBits != 0 )
+			{
+				supported |= board.GetWindow( y + row - 1, startX + CountTrailingZeros( rowBits ) - 1 );
+				rowBits &= rowBits - 1;
+			}
+		}
+		legal &= supported;
+	}
+	return legal;
+}
+
+#if defined(PIECES_AVX2)
+//--------------------------------------------------------------------------
+/**
+* LoadWindows4
+* GetWindow for x, x + 64, x + 128 and x + 192. A shift of 64 or more
+* zeroes a lane, which covers the aligned case.
+*/
+static inline GAME_TARGET_AVX2 __m256i LoadWindows4( const GridBitboard& board, int y, int x )
+{
+	int bitIndex = x + GridBitboard::PAD_WORDS_LEFT * 64;
+	const uint64_t* words = board.GetRowWords( y ) + ( bitIndex >> 6 );
+	int shift = bitIndex & 63;
+	__m256i low = _mm256_loadu_si256( (const __m256i*) words );
+	__m256i high = _mm256_loadu_si256( (const __m256i*) ( words + 1 ) );
+	return _mm256_or_si256( _mm256_srl_epi64( low, _mm_cvtsi32_si128( shift ) ), _mm256_sll_epi64( high, _mm_cvtsi32_si128( 64 - shift ) ) );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetPiecePlacementRowAVX2
+* Whole groups of 4 words, returns how many it wrote.
+*/
+static GAME_TARGET_AVX2 int GetPiecePlacementRowAVX2( const GridBitboard& board, const GridPieceShape& shape, int y, bool requireSupport, uint64_t* out_masks )
+{
+	int wordCount = board.GetWordsPerRow();
+	int wordIdx = 0;
+	const IntVec2& dimensions = board.GetDimensions();
+	if( y >= 0 && y + shape.height <= dimensions.y )
+	{
+		for( ; wordIdx + 4 <= wordCount; wordIdx += 4 )
+		{
+			int startX = wordIdx << 6;
+			__m256i blocked = _mm256_setzero_si256();
+			for( int row = 0; row < shape.height; ++row )
+			{
+				uint32_t rowBits = shape.rows[row];
+				while( rowBits != 0 )
+				{
+					blocked = _mm256_or_si256( blocked, LoadWindows4( board, y + row, startX + CountTrailingZeros( rowBits ) ) );
+					rowBits &= rowBits - 1;
+				}
+			}
+			__m256i legal = _mm256_andnot_si256( blocked, _mm256_set1_epi64x( -1 ) );
+
+			if( requireSupport && y > 0 )
+			{
+				__m256i supported = _mm256_setzero_si256();
+				for( int row = 0; row < shape.height + 2; ++row )
+				{
+					uint32_t rowBits = shape.neighborRows[row];
+					while( rowBits != 0 )
+					{
+						supported = _mm256_or_si256( supported, LoadWindows4( board, y + row - 1, startX + CountTrailingZeros( rowBits ) - 1 ) );
+						rowBits &= rowBits - 1;
+					}
+				}
+				legal = _mm256_and_si256( legal, supported );
+			}
+
+			_mm256_storeu_si256( (__m256i*) &out_masks[wordIdx], legal );
+			for( int laneIdx = 0; laneIdx < 4; ++laneIdx )
+			{
+				out_masks[wordIdx + laneIdx] &= GetInBoundsMask( dimensions.x, shape.width, startX + ( laneIdx << 6 ) );
+			}
+		}
+	}
+	return wordIdx;
+}
+#endif
+
+//--------------------------------------------------------------------------
+/**
+* GetPiecePlacementRow
+* Masks for every origin on row y, out_masks[word] covering x from
+* 64 * word. 256 origins a pass when the CPU has AVX2.
+*/
+void GetPiecePlacementRow( const GridBitboard& board, const GridPieceShape& shape, int y, bool requireSupport, uint64_t* out_masks )
+{
+	int wordCount = board.GetWordsPerRow();
+	int wordIdx = 0;
+#if defined(PIECES_AVX2)
+	if( IsAVX2Supported() )
+	{
+		wordIdx = GetPiecePlacementRowAVX2( board, shape, y, requireSupport, out_masks );
+	}
+#endif
+	for( ; wordIdx < wordCount; ++wordIdx )
+	{
+		out_masks[wordIdx] = GetPiecePlacementMask( board, shape, y, wordIdx << 6, requireSupport );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* CountPiecePlacements
+* Legal origins over the whole board.
+*/
+int CountPiecePlacements( const GridBitboard& board, const GridPieceShape& shape, bool requireSupport )
+{
+	std::vector<uint64_t> masks( (size_t) board.GetWordsPerRow() );
+	int placementCount = 0;
+	for( int y = 0; y < board.GetDimensions().y; ++y )
+	{
+		GetPiecePlacementRow( board, shape, y, requireSupport, masks.data() );
+		for( uint64_t mask : masks )
+		{
+			placementCount += CountSetBits( mask );
+		}
+	}
+	return placementCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* CanPlacePiece
+* One placement straight off the Grid's rows, for when capturing a
+* GridBitboard isn't worth it (a ghost under the cursor).
+*/
+bool CanPlacePiece( const Grid& grid, const GridPieceShape& shape, const IntVec2& origin, bool requireSupport )
+{
+	const IntVec2& dimensions = grid.GetDimensions();
+	if( origin.x < 0 || origin.y < 0 || origin.x + shape.width > dimensions.x || origin.y + shape.height > dimensions.y )
+	{
+		return false;
+	}
+	for( int row = 0; row < shape.height; ++row )
+	{
+		if( ( grid.GetRowBits( origin.y + row, origin.x ) & shape.rows[row] ) != 0 )
+		{
+			return false;
+		}
+	}
+	if( !requireSupport || origin.y == 0 )
+	{
+		return true;
+	}
+	for( int row = 0; row < shape.height + 2; ++row )
+	{
+		if( ( grid.GetRowBits( origin.y + row - 1, origin.x - 1 ) & shape.neighborRows[row] ) != 0 )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+//--------------------------------------------------------------------------
+/**
+* PlacePiece
+* All or nothing: false without touching the Grid if any cell is taken or
+* off the board.
+*/
+bool PlacePiece( Grid& grid, const GridPieceShape& shape, const IntVec2& origin, uint8_t colorIndex, uint8_t material )
+{
+	if( !CanPlacePiece( grid, shape, origin, false ) )
+	{
+		return false;
+	}
+	for( int row = 0; row < shape.height; ++row )
+	{
+		uint32_t rowBits = shape.rows[row];
+		while( rowBits != 0 )
+		{
+			grid.PlaceBlock( Block( IntVec2( origin.x + CountTrailingZeros( rowBits ), origin.y + row ), colorIndex, material ) );
+			rowBits &= rowBits - 1;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,277 @@
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class Grid;
+
+constexpr int GRID_PIECE_MAX_SIZE = 4;			// Pieces fit in 4x4 cells.
+constexpr int GRID_PIECE_MAX_ORIENTATIONS = 8;	// 4 rotations, each mirrored.
+
+//--------------------------------------------------------------------------
+// The free polyominoes up to four cells. Mirror images count as the same
+// piece (S covers Z, L covers J), every orientation is in its table.
+//--------------------------------------------------------------------------
+enum eGridPiece
+{
+	GRID_PIECE_MONOMINO = 0,
+	GRID_PIECE_DOMINO,
+	GRID_PIECE_TROMINO_I,
+	GRID_PIECE_TROMINO_L,
+	GRID_PIECE_TETROMINO_I,
+	GRID_PIECE_TETROMINO_O,
+	GRID_PIECE_TETROMINO_T,
+	GRID_PIECE_TETROMINO_S,
+	GRID_PIECE_TETROMINO_L,
+
+	NUM_GRID_PIECES
+};
+
+// Rows top to bottom, '|' between rows, '#' for a cell.
+constexpr const char* GRID_PIECE_ART[NUM_GRID_PIECES] =
+{
+	"#",
+	"##",
+	"###",
+	"#.|##",
+	"####",
+	"##|##",
+	"###|.#.",
+	".##|##.",
+	"#..|###",
+};
+
+//--------------------------------------------------------------------------
+// One orientation of a piece as row bitmasks, anchored at its bottom left.
+// neighborRows are the cells touching the piece (not in it) in a frame one
+// cell down and left, so row 0 bit 0 is the cell at (-1, -1).
+//--------------------------------------------------------------------------
+struct GridPieceShape
+{
+	uint8_t rows[GRID_PIECE_MAX_SIZE] = {};				// Bit x of row y, row 0 at the bottom.
+	uint8_t neighborRows[GRID_PIECE_MAX_SIZE + 2] = {};
+	int width = 0;
+	int height = 0;
+	int cellCount = 0;
+};
+
+struct GridPieceOrientations
+{
+	GridPieceShape shapes[GRID_PIECE_MAX_ORIENTATIONS] = {};
+	int count = 0;
+};
+
+struct GridPieceTable
+{
+	GridPieceOrientations pieces[NUM_GRID_PIECES] = {};
+};
+
+//--------------------------------------------------------------------------
+/**
+* MakeGridPieceShape
+* Fills in the size, cell count and neighbors once the rows are set, with
+* the shape pushed against the bottom left.
+*/
+constexpr GridPieceShape MakeGridPieceShape( const uint8_t ( &cells )[GRID_PIECE_MAX_SIZE][GRID_PIECE_MAX_SIZE] )
+{
+	int minX = GRID_PIECE_MAX_SIZE;
+	int minY = GRID_PIECE_MAX_SIZE;
+	for( int y = 0; y < GRID_PIECE_MAX_SIZE; ++y )
+	{
+		for( int x = 0; x < GRID_PIECE_MAX_SIZE; ++x )
+		{
+			if( cells[y][x] )
+			{
+				minX = x < minX ? x : minX;
+				minY = y < minY ? y : minY;
+			}
+		}
+	}
+
+	GridPieceShape shape;
+	for( int y = minY; y < GRID_PIECE_MAX_SIZE; ++y )
+	{
+		for( int x = minX; x < GRID_PIECE_MAX_SIZE; ++x )
+		{
+			if( cells[y][x] )
+			{
+				shape.rows[y - minY] |= (uint8_t) ( 1 << ( x - minX ) );
+				shape.width = x - minX + 1 > shape.width ? x - minX + 1 : shape.width;
+				shape.height = y - minY + 1;
+				++shape.cellCount;
+			}
+		}
+	}
+
+	for( int y = 0; y < shape.height; ++y )
+	{
+		uint8_t row = (uint8_t) ( shape.rows[y] << 1 );
+		shape.neighborRows[y + 1] |= (uint8_t) ( ( row << 1 ) | ( row >> 1 ) );
+		shape.neighborRows[y] |= row;
+		shape.neighborRows[y + 2] |= row;
+	}
+	for( int y = 0; y < shape.height; ++y )
+	{
+		shape.neighborRows[y + 1] &= (uint8_t) ~( shape.rows[y] << 1 );
+	}
+	return shape;
+}
+
+//--------------------------------------------------------------------------
+/**
+* MakeGridPieceOrientations
+* Every rotation of the art and of its mirror image, duplicates dropped.
+*/
+constexpr GridPieceOrientations MakeGridPieceOrientations( const char* art )
+{
+	int rowCount = 1;
+	for( const char* c = art; *c != '\0'; ++c )
+	{
+		rowCount += *c == '|' ? 1 : 0;
+	}
+
+	uint8_t cells[GRID_PIECE_MAX_SIZE][GRID_PIECE_MAX_SIZE] = {};
+	int x = 0;
+	int y = rowCount - 1;
+	for( const char* c = art; *c != '\0'; ++c )
+	{
+		if( *c == '|' )
+		{
+			x = 0;
+			--y;
+			continue;
+		}
+		cells[y][x++] = *c == '#' ? 1 : 0;
+	}
+
+	GridPieceOrientations orientations;
+	for( int mirror = 0; mirror < 2; ++mirror )
+	{
+		for( int rotation = 0; rotation < 4; ++rotation )
+		{
+			GridPieceShape shape = MakeGridPieceShape( cells );
+			bool isNew = true;
+			for( int shapeIdx = 0; shapeIdx < orientations.count; ++shapeIdx )
+			{
+				const GridPieceShape& other = orientations.shapes[shapeIdx];
+				bool isSame = other.width == shape.width && other.height == shape.height;
+				for( int row = 0; row < GRID_PIECE_MAX_SIZE; ++row )
+				{
+					isSame = isSame && other.rows[row] == shape.rows[row];
+				}
+				isNew = isNew && !isSame;
+			}
+			if( isNew )
+			{
+				orientations.shapes[orientations.count++] = shape;
+			}
+
+			// Quarter turn counterclockwise, (x, y) -> (size - 1 - y, x).
+			uint8_t turned[GRID_PIECE_MAX_SIZE][GRID_PIECE_MAX_SIZE] = {};
+			for( int cellY = 0; cellY < GRID_PIECE_MAX_SIZE; ++cellY )
+			{
+				for( int cellX = 0; cellX < GRID_PIECE_MAX_SIZE; ++cellX )
+				{
+					turned[cellX][GRID_PIECE_MAX_SIZE - 1 - cellY] = cells[cellY][cellX];
+				}
+			}
+			for( int cellY = 0; cellY < GRID_PIECE_MAX_SIZE; ++cellY )
+			{
+				for( int cellX = 0; cellX < GRID_PIECE_MAX_SIZE; ++cellX )
+				{
+					cells[cellY][cellX] = turned[cellY][cellX];
+				}
+			}
+		}
+
+		for( int cellY = 0; cellY < GRID_PIECE_MAX_SIZE; ++cellY )
+		{
+			for( int cellX = 0; cellX < GRID_PIECE_MAX_SIZE / 2; ++cellX )
+			{
+				uint8_t cell = cells[cellY][cellX];
+				cells[cellY][cellX] = cells[cellY][GRID_PIECE_MAX_SIZE - 1 - cellX];
+				cells[cellY][GRID_PIECE_MAX_SIZE - 1 - cellX] = cell;
+			}
+		}
+	}
+	return orientations;
+}
+
+//--------------------------------------------------------------------------
+/**
+* MakeGridPieceTable
+*/
+constexpr GridPieceTable MakeGridPieceTable()
+{
+	GridPieceTable table;
+	for( int pieceIdx = 0; pieceIdx < NUM_GRID_PIECES; ++pieceIdx )
+	{
+		table.pieces[pieceIdx] = MakeGridPieceOrientations( GRID_PIECE_ART[pieceIdx] );
+	}
+	return table;
+}
+
+// Built by the compiler, nothing runs at startup.
+inline constexpr GridPieceTable GRID_PIECE_TABLE = MakeGridPieceTable();
+
+static_assert( GRID_PIECE_TABLE.pieces[GRID_PIECE_MONOMINO].count == 1, "Piece table is wrong" );
+static_assert( GRID_PIECE_TABLE.pieces[GRID_PIECE_TETROMINO_I].count == 2, "Piece table is wrong" );
+static_assert( GRID_PIECE_TABLE.pieces[GRID_PIECE_TETROMINO_O].count == 1, "Piece table is wrong" );
+static_assert( GRID_PIECE_TABLE.pieces[GRID_PIECE_TETROMINO_T].count == 4, "Piece table is wrong" );
+static_assert( GRID_PIECE_TABLE.pieces[GRID_PIECE_TETROMINO_S].count == 4, "Piece table is wrong" );
+static_assert( GRID_PIECE_TABLE.pieces[GRID_PIECE_TETROMINO_L].count == 8, "Piece table is wrong" );
+static_assert( GRID_PIECE_TABLE.pieces[GRID_PIECE_TETROMINO_T].shapes[0].neighborRows[0] == 0x04, "Piece table is wrong" );
+
+inline const GridPieceOrientations& GetGridPieceOrientations( eGridPiece piece ) { return GRID_PIECE_TABLE.pieces[piece]; }
+
+//--------------------------------------------------------------------------
+// Grid occupancy copied into padded rows of 64 bit words, so a window of 64
+// cells at any x (and any y near the board) is two loads and a shift, with
+// no bounds checks. Off board reads as empty. Capture once, then test as
+// many placements as needed against it.
+//--------------------------------------------------------------------------
+class GridBitboard
+{
+public:
+	void Capture( const Grid& grid );
+
+	const IntVec2& GetDimensions() const { return m_dimensions; }
+	int GetWordsPerRow() const { return m_boardWordsPerRow; }
+	uint64_t GetWindow( int y, int x ) const;		// x from -64, y within GRID_PIECE_MAX_SIZE + 1 of the board.
+	const uint64_t* GetRowWords( int y ) const { return &m_words[(size_t) ( y + GUARD_ROWS ) * m_wordsPerRow]; }
+
+public:
+	static constexpr int GUARD_ROWS = GRID_PIECE_MAX_SIZE + 1;
+	static constexpr int PAD_WORDS_LEFT = 1;
+	static constexpr int PAD_WORDS_RIGHT = 5;	// A 4 word vector load past the last window.
+
+private:
+	IntVec2 m_dimensions;
+	int m_boardWordsPerRow = 0;
+	int m_wordsPerRow = 0;
+	std::vector<uint64_t> m_words;
+};
+
+//--------------------------------------------------------------------------
+/**
+* GridBitboard::GetWindow
+* Bit i is cell ( x + i, y ).
+*/
+inline uint64_t GridBitboard::GetWindow( int y, int x ) const
+{
+	int bitIndex = x + PAD_WORDS_LEFT * 64;
+	const uint64_t* words = GetRowWords( y ) + ( bitIndex >> 6 );
+	int shift = bitIndex & 63;
+	return shift == 0 ? words[0] : ( words[0] >> shift ) | ( words[1] << ( 64 - shift ) );
+}
+
+// Legality is: on the board, over empty cells, and if support is required,
+// touching a block or sitting on row 0.
+uint64_t GetPiecePlacementMask( const GridBitboard& board, const GridPieceShape& shape, int y, int startX, bool requireSupport );
+void GetPiecePlacementRow( const GridBitboard& board, const GridPieceShape& shape, int y, bool requireSupport, uint64_t* out_masks );
+int CountPiecePlacements( const GridBitboard& board, const GridPieceShape& shape, bool requireSupport );
+
+bool CanPlacePiece( const Grid& grid, const GridPieceShape& shape, const IntVec2& origin, bool requireSupport );
+bool PlacePiece( Grid& grid, const GridPieceShape& shape, const IntVec2& origin, uint8_t colorIndex, uint8_t material = 0 );
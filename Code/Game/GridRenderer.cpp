@@ -0,0 +1,178 @@
+#include "Game/GridRenderer.hpp"
+#include "Game/Grid.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/JobSystem.hpp"
+#include "Game/RenderCommandBuffer.hpp"
+
+//--------------------------------------------------------------------------
+/**
+* GridRenderer
+*/
+GridRenderer::GridRenderer( Grid* grid )
+	: m_grid( grid )
+{
+	m_chunkMeshes.resize( grid->GetChunkCount() );
+	FitToWorld( Vec2( 0.0f, 0.0f ), Vec2( WORLD_WIDTH, WORLD_HEIGHT ) );
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~GridRenderer
+*/
+GridRenderer::~GridRenderer()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* Update
+* Re-meshes only the chunks touched since the last update.
+*/
+void GridRenderer::Update()
+{
+	const IntVec2& dimensions = m_grid->GetDimensions();
+	if( dimensions.x != m_gridDimensions.x || dimensions.y != m_gridDimensions.y )
+	{
+		m_chunkMeshes.clear();
+		m_chunkMeshes.resize( m_grid->GetChunkCount() );
+		FitToWorld( m_worldMins, m_worldMaxs );
+	}
+
+	m_grid->TakeDirtyChunks( &m_dirtyChunks );
+	if( g_theJobSystem != nullptr && m_dirtyChunks.size() > 1 )
+	{
+		JobHandle rebuild = g_theJobSystem->ParallelFor( "RebuildChunkMeshes", (int) m_dirtyChunks.size(), CHUNK_MESH_JOB_BATCH_SIZE, RebuildChunkMeshesJob, this );
+		g_theJobSystem->Wait( rebuild );
+	}
+	else
+	{
+		RebuildChunkMeshesJob( this, 0, (int) m_dirtyChunks.size() );
+	}
+
+	m_chunksRebuiltLastUpdate = (int) m_dirtyChunks.size();
+	m_totalChunksRebuilt += m_chunksRebuiltLastUpdate;
+}
+
+//--------------------------------------------------------------------------
+/**
+* RebuildChunkMeshesJob
+* Chunks only write their own mesh, so any split is safe.
+*/
+void GridRenderer::RebuildChunkMeshesJob( void* gridRenderer, int startIndex, int endIndex )
+{
+	GridRenderer* renderer = (GridRenderer*) gridRenderer;
+	for( int dirtyIdx = startIndex; dirtyIdx < endIndex; ++dirtyIdx )
+	{
+		renderer->RebuildChunkMesh( renderer->m_dirtyChunks[dirtyIdx] );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* Render
+*/
+void GridRenderer::Render( RenderCommandBuffer& commands ) const
+{
+	for( const SharedVertexArray& mesh : m_chunkMeshes )
+	{
+		if( mesh )
+		{
+			commands.DrawVertexArray( mesh );
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* FitToWorld
+* Centers the board in the given world rect with square cells. Every chunk
+* has to be re-meshed afterwards.
+*/
+void GridRenderer::FitToWorld( const Vec2& worldMins, const Vec2& worldMaxs )
+{
+	const IntVec2& dimensions = m_grid->GetDimensions();
+	m_gridDimensions = dimensions;
+	m_worldMins = worldMins;
+	m_worldMaxs = worldMaxs;
+	float worldWidth = worldMaxs.x - worldMins.x;
+	float worldHeight = worldMaxs.y - worldMins.y;
+
+	float cellWidth = worldWidth / (float) dimensions.x;
+	float cellHeight = worldHeight / (float) dimensions.y;
+	m_cellSize = cellWidth < cellHeight ? cellWidth : cellHeight;
+
+	m_boardOrigin.x = worldMins.x + 0.5f * ( worldWidth - m_cellSize * (float) dimensions.x );
+	m_boardOrigin.y = worldMins.y + 0.5f * ( worldHeight - m_cellSize * (float) dimensions.y );
+
+	m_grid->MarkAllChunksDirty();
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetVertexCount
+*/
+int GridRenderer::GetVertexCount() const
+{
+	size_t vertexCount = 0;
+	for( const SharedVertexArray& mesh : m_chunkMeshes )
+	{
+		vertexCount += mesh ? mesh->size() : 0;
+	}
+	return (int) vertexCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* RebuildChunkMesh
+* Two triangles per occupied cell, walking the chunk's occupancy bits, into
+* a new mesh that replaces the old one.
+*/
+void GridRenderer::RebuildChunkMesh( int chunkIndex )
+{
+	const GridChunk& chunk = m_grid->GetChunk( chunkIndex );
+	if( !chunk.cells || chunk.blockCount == 0 )
+	{
+		m_chunkMeshes[chunkIndex] = nullptr;
+		return;
+	}
+
+	std::shared_ptr<std::vector<Vertex_PCU>> newMesh = std::make_shared<std::vector<Vertex_PCU>>();
+	std::vector<Vertex_PCU>& mesh = *newMesh;
+	mesh.reserve( (size_t) chunk.blockCount * 6 );
+
+	const GridChunkCells& cells = *chunk.cells;
+	IntVec2 chunkOrigin = m_grid->GetChunkOrigin( chunkIndex );
+	Vec2 uv( 0.0f, 0.0f );
+
+	for( int localY = 0; localY < GRID_CHUNK_SIZE; ++localY )
+	{
+		uint64_t rowBits = cells.occupancy[localY];
+		float minY = m_boardOrigin.y + (float) ( chunkOrigin.y + localY ) * m_cellSize;
+		float maxY = minY + m_cellSize;
+
+		while( rowBits != 0 )
+		{
+			int localX = CountTrailingZeros( rowBits );
+			rowBits &= rowBits - 1;
+
+			const Rgba& color = m_grid->GetPaletteColor( cells.colorIndices[( localY << GRID_CHUNK_SIZE_BITS ) | localX] );
+			float minX = m_boardOrigin.x + (float) ( chunkOrigin.x + localX ) * m_cellSize;
+			float maxX = minX + m_cellSize;
+
+			Vertex_PCU bottomLeft( Vec3( minX, minY, 0.0f ), color, uv );
+			Vertex_PCU bottomRight( Vec3( maxX, minY, 0.0f ), color, uv );
+			Vertex_PCU topLeft( Vec3( minX, maxY, 0.0f ), color, uv );
+			Vertex_PCU topRight( Vec3( maxX, maxY, 0.0f ), color, uv );
+
+			mesh.push_back( bottomLeft );
+			mesh.push_back( bottomRight );
+			mesh.push_back( topRight );
+
+			mesh.push_back( bottomLeft );
+			mesh.push_back( topRight );
+			mesh.push_back( topLeft );
+		}
+	}
+
+	m_chunkMeshes[chunkIndex] = std::move( newMesh );
+}
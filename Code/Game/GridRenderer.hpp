@@ -0,0 +1,53 @@
+#pragma once
+#include "Engine/Core/Vertex/Vertex_PCU.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Game/RenderCommandBuffer.hpp"
+
+#include <vector>
+
+class Grid;
+
+constexpr int CHUNK_MESH_JOB_BATCH_SIZE = 2;
+
+//--------------------------------------------------------------------------
+// Keeps one prebuilt vertex array per Grid chunk and only re-meshes the
+// chunks the Grid reports as dirty, a few chunks per job. Follows the Grid
+// if it is resized (a level load). A re-mesh replaces the chunk's mesh
+// rather than editing it, so frames still in flight keep drawing the old one
+// and Render hands meshes to the frame by reference, not by copy.
+//--------------------------------------------------------------------------
+class GridRenderer
+{
+public:
+	explicit GridRenderer( Grid* grid );
+	~GridRenderer();
+
+	void Update();
+	void Render( RenderCommandBuffer& commands ) const;
+
+	void FitToWorld( const Vec2& worldMins, const Vec2& worldMaxs );
+
+	int GetChunksRebuiltLastUpdate() const { return m_chunksRebuiltLastUpdate; }
+	int GetTotalChunksRebuilt() const { return m_totalChunksRebuilt; }
+	int GetVertexCount() const;
+
+private:
+	void RebuildChunkMesh( int chunkIndex );
+	static void RebuildChunkMeshesJob( void* gridRenderer, int startIndex, int endIndex );
+
+private:
+	Grid* m_grid = nullptr;
+
+	IntVec2 m_gridDimensions;
+	Vec2 m_worldMins;
+	Vec2 m_worldMaxs;
+	Vec2 m_boardOrigin;
+	float m_cellSize = 1.0f;
+
+	std::vector<SharedVertexArray> m_chunkMeshes;		// nullptr for an empty chunk
+	std::vector<int> m_dirtyChunks;
+
+	int m_chunksRebuiltLastUpdate = 0;
+	int m_totalChunksRebuilt = 0;
+};
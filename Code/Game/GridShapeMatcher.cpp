@@ -0,0 +1,609 @@
+#include "Game/GridShapeMatcher.hpp"
+#include "Game/Grid.hpp"
+#include "Game/GridLevelFile.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/GameUtils.hpp"
+#include "Game/Game.hpp"
+#include "Game/Benchmarks.hpp"
+#include "Game/GameProfiler.hpp"
+
+#include <algorithm>
+#include <limits.h>
+#include <string>
+
+//--------------------------------------------------------------------------
+/**
+* GridShapeMatcher
+* Nothing is scanned until the first query.
+*/
+GridShapeMatcher::GridShapeMatcher( const Grid& grid )
+	: m_grid( grid )
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~GridShapeMatcher
+*/
+GridShapeMatcher::~GridShapeMatcher()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* AddTarget
+* Returns the target's index, an existing one if the shape is a rotation or
+* mirror image of a target already added, or -1 if it is empty or more than
+* GRID_SHAPE_MAX_SIZE across.
+*/
+int GridShapeMatcher::AddTarget( const std::string& name, const std::vector<IntVec2>& cells )
+{
+	GridShapeTarget target;
+	target.name = name;
+	MakeOrientations( cells, &target.orientations );
+	if( target.orientations.empty() )
+	{
+		return -1;
+	}
+
+	const GridShapeOrientation& canonical = target.orientations[0];
+	for( uint64_t row : canonical.rows )
+	{
+		target.cellCount += CountSetBits( row );
+	}
+	target.canonicalHash = SplitMix64( canonical.hash ^ SplitMix64( ( (uint64_t) canonical.size.x << 32 ) | (uint32_t) canonical.size.y ) );
+
+	for( int targetIdx = 0; targetIdx < (int) m_targets.size(); ++targetIdx )
+	{
+		const GridShapeOrientation& other = m_targets[targetIdx].orientations[0];
+		if( m_targets[targetIdx].canonicalHash == target.canonicalHash && other.size == canonical.size && other.rows == canonical.rows )
+		{
+			return targetIdx;
+		}
+	}
+
+	m_targets.push_back( std::move( target ) );
+	m_targetMatchCounts.push_back( 0 );
+	BuildGroups();
+	InvalidateAll();
+	return (int) m_targets.size() - 1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* AddTargetFromLevel
+* Every block of a level is the shape, named after the file.
+*/
+int GridShapeMatcher::AddTargetFromLevel( const std::string& levelPath, eLevelTrust trust )
+{
+	Grid level;
+	if( !level.LoadLevelFile( levelPath, trust ) )
+	{
+		return -1;
+	}
+	std::vector<IntVec2> cells;
+	level.GetOccupiedCells( &cells );
+
+	size_t nameStart = levelPath.find_last_of( "/\\" );
+	nameStart = nameStart == std::string::npos ? 0 : nameStart + 1;
+	size_t nameEnd = levelPath.find_last_of( '.' );
+	nameEnd = nameEnd == std::string::npos || nameEnd < nameStart ? levelPath.size() : nameEnd;
+	return AddTarget( levelPath.substr( nameStart, nameEnd - nameStart ), cells );
+}
+
+//--------------------------------------------------------------------------
+/**
+* ClearTargets
+*/
+void GridShapeMatcher::ClearTargets()
+{
+	m_targets.clear();
+	m_groups.clear();
+	m_matchBuckets.clear();
+	m_matches.clear();
+	m_targetMatchCounts.clear();
+	m_totalMatchCount = 0;
+	InvalidateAll();
+}
+
+//--------------------------------------------------------------------------
+/**
+* OnCellChanged
+* Called by the Grid after a block is placed or removed. Queued until the
+* next query.
+*/
+void GridShapeMatcher::OnCellChanged( const IntVec2& cell )
+{
+	if( m_needsFullScan )
+	{
+		return;
+	}
+	if( (int) m_changedCells.size() >= GRID_SHAPE_MAX_QUEUED_CHANGES )
+	{
+		InvalidateAll();
+		return;
+	}
+	m_changedCells.push_back( cell );
+}
+
+//--------------------------------------------------------------------------
+/**
+* OnRegionChanged
+* Every cell in [minCell, maxCell] may have changed. Queued like a cell.
+*/
+void GridShapeMatcher::OnRegionChanged( const IntVec2& minCell, const IntVec2& maxCell )
+{
+	if( m_needsFullScan )
+	{
+		return;
+	}
+	if( (int) m_changedRegions.size() >= 2 * GRID_SHAPE_MAX_QUEUED_CHANGES )
+	{
+		InvalidateAll();
+		return;
+	}
+	m_changedRegions.push_back( minCell );
+	m_changedRegions.push_back( maxCell );
+}
+
+//--------------------------------------------------------------------------
+/**
+* InvalidateAll
+* For changes too big to follow cell by cell (a level load, a new board).
+*/
+void GridShapeMatcher::InvalidateAll()
+{
+	m_needsFullScan = true;
+	m_changedCells.clear();
+	m_changedRegions.clear();
+}
+
+//--------------------------------------------------------------------------
+/**
+* Update
+* Rechecks what changed since the last query. Changed cells close together
+* share a region, so a piece costs one recheck, not one per block.
+*/
+void GridShapeMatcher::Update()
+{
+	if( m_needsFullScan )
+	{
+		RescanAll();
+	}
+	else if( !m_changedCells.empty() || !m_changedRegions.empty() )
+	{
+		GAME_PROFILE_SCOPE( "GridShapeMatcher::Update" );
+		if( !m_changedCells.empty() )
+		{
+			IntVec2 minCell = m_changedCells[0];
+			IntVec2 maxCell = m_changedCells[0];
+			for( int cellIdx = 1; cellIdx < (int) m_changedCells.size(); ++cellIdx )
+			{
+				const IntVec2& cell = m_changedCells[cellIdx];
+				IntVec2 mergedMin( std::min( minCell.x, cell.x ), std::min( minCell.y, cell.y ) );
+				IntVec2 mergedMax( std::max( maxCell.x, cell.x ), std::max( maxCell.y, cell.y ) );
+				if( mergedMax.x - mergedMin.x < GRID_SHAPE_CHANGE_MERGE_SIZE && mergedMax.y - mergedMin.y < GRID_SHAPE_CHANGE_MERGE_SIZE )
+				{
+					minCell = mergedMin;
+					maxCell = mergedMax;
+					continue;
+				}
+				RescanRegion( minCell, maxCell );
+				minCell = cell;
+				maxCell = cell;
+			}
+			RescanRegion( minCell, maxCell );
+		}
+		for( int regionIdx = 0; regionIdx + 1 < (int) m_changedRegions.size(); regionIdx += 2 )
+		{
+			RescanRegion( m_changedRegions[regionIdx], m_changedRegions[regionIdx + 1] );
+		}
+	}
+	m_changedCells.clear();
+	m_changedRegions.clear();
+	m_needsFullScan = false;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetMatches
+* Every target found, every place it was found.
+*/
+const std::vector<GridShapeMatch>& GridShapeMatcher::GetMatches()
+{
+	Update();
+	if( !m_areMatchesGathered )
+	{
+		m_matches.clear();
+		for( const std::vector<GridShapeMatch>& bucket : m_matchBuckets )
+		{
+			m_matches.insert( m_matches.end(), bucket.begin(), bucket.end() );
+		}
+		m_areMatchesGathered = true;
+	}
+	return m_matches;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetMatchCount
+*/
+int GridShapeMatcher::GetMatchCount( int targetIndex )
+{
+	Update();
+	return m_targetMatchCounts[targetIndex];
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetTotalMatchCount
+*/
+int GridShapeMatcher::GetTotalMatchCount()
+{
+	Update();
+	return m_totalMatchCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetFoundTargetCount
+* Targets found at least once.
+*/
+int GridShapeMatcher::GetFoundTargetCount()
+{
+	Update();
+	int foundCount = 0;
+	for( int matchCount : m_targetMatchCounts )
+	{
+		foundCount += matchCount > 0 ? 1 : 0;
+	}
+	return foundCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* MakeOrientations
+* The four rotations of the cells and of their mirror image, duplicates
+* dropped, sorted so the canonical form comes first. Empty if there are no
+* cells or the shape is too big.
+*/
+void GridShapeMatcher::MakeOrientations( const std::vector<IntVec2>& cells, std::vector<GridShapeOrientation>* out_orientations )
+{
+	out_orientations->clear();
+	if( cells.empty() )
+	{
+		return;
+	}
+
+	std::vector<IntVec2> turnedCells( cells.size() );
+	for( int mirror = 0; mirror < 2; ++mirror )
+	{
+		for( int rotation = 0; rotation < 4; ++rotation )
+		{
+			IntVec2 minCell( INT_MAX, INT_MAX );
+			IntVec2 maxCell( INT_MIN, INT_MIN );
+			for( int cellIdx = 0; cellIdx < (int) cells.size(); ++cellIdx )
+			{
+				IntVec2 cell( mirror ? -cells[cellIdx].x : cells[cellIdx].x, cells[cellIdx].y );
+				for( int turnIdx = 0; turnIdx < rotation; ++turnIdx )
+				{
+					cell = IntVec2( -cell.y, cell.x );
+				}
+				turnedCells[cellIdx] = cell;
+				minCell = IntVec2( std::min( minCell.x, cell.x ), std::min( minCell.y, cell.y ) );
+				maxCell = IntVec2( std::max( maxCell.x, cell.x ), std::max( maxCell.y, cell.y ) );
+			}
+
+			GridShapeOrientation orientation;
+			orientation.size = IntVec2( maxCell.x - minCell.x + 1, maxCell.y - minCell.y + 1 );
+			if( orientation.size.x > GRID_SHAPE_MAX_SIZE || orientation.size.y > GRID_SHAPE_MAX_SIZE )
+			{
+				out_orientations->clear();
+				return;
+			}
+			orientation.rows.assign( (size_t) orientation.size.y, 0 );
+			for( const IntVec2& cell : turnedCells )
+			{
+				orientation.rows[cell.y - minCell.y] |= 1ull << ( cell.x - minCell.x );
+			}
+			orientation.hash = HashRows( orientation.rows.data(), orientation.size.y );
+
+			bool isNew = true;
+			for( const GridShapeOrientation& other : *out_orientations )
+			{
+				isNew = isNew && !( other.size == orientation.size && other.rows == orientation.rows );
+			}
+			if( isNew )
+			{
+				out_orientations->push_back( std::move( orientation ) );
+			}
+		}
+	}
+
+	std::sort( out_orientations->begin(), out_orientations->end(), []( const GridShapeOrientation& a, const GridShapeOrientation& b )
+	{
+		if( a.size.y != b.size.y )
+		{
+			return a.size.y < b.size.y;
+		}
+		if( a.size.x != b.size.x )
+		{
+			return a.size.x < b.size.x;
+		}
+		return a.rows < b.rows;
+	} );
+}
+
+//--------------------------------------------------------------------------
+/**
+* HashRows
+* Row 0 times GRID_SHAPE_HASH_BASE to the power rowCount - 1, down to the
+* last row times 1, wrapping at 64 bits. Rolling up a row is then a
+* multiply, a subtract and an add.
+*/
+uint64_t GridShapeMatcher::HashRows( const uint64_t* rows, int rowCount )
+{
+	uint64_t hash = 0;
+	for( int row = 0; row < rowCount; ++row )
+	{
+		hash = hash * GRID_SHAPE_HASH_BASE + rows[row];
+	}
+	return hash;
+}
+
+//--------------------------------------------------------------------------
+/**
+* BuildGroups
+* One group per orientation box size, its patterns sorted by hash.
+*/
+void GridShapeMatcher::BuildGroups()
+{
+	m_groups.clear();
+	m_maxPatternSize = IntVec2( 0, 0 );
+	for( int targetIdx = 0; targetIdx < (int) m_targets.size(); ++targetIdx )
+	{
+		const GridShapeTarget& target = m_targets[targetIdx];
+		for( int orientationIdx = 0; orientationIdx < (int) target.orientations.size(); ++orientationIdx )
+		{
+			const GridShapeOrientation& orientation = target.orientations[orientationIdx];
+			PatternGroup* group = nullptr;
+			for( PatternGroup& existing : m_groups )
+			{
+				group = existing.size == orientation.size ? &existing : group;
+			}
+			if( group == nullptr )
+			{
+				m_groups.emplace_back();
+				group = &m_groups.back();
+				group->size = orientation.size;
+				group->rowMask = orientation.size.x == 64 ? ~0ull : ( 1ull << orientation.size.x ) - 1;
+				group->bottomRowFactor = 1;
+				for( int row = 1; row < orientation.size.y; ++row )
+				{
+					group->bottomRowFactor *= GRID_SHAPE_HASH_BASE;
+				}
+			}
+
+			m_maxPatternSize = IntVec2( std::max( m_maxPatternSize.x, orientation.size.x ), std::max( m_maxPatternSize.y, orientation.size.y ) );
+			Pattern pattern;
+			pattern.hash = orientation.hash;
+			pattern.targetIndex = targetIdx;
+			pattern.orientationIndex = orientationIdx;
+			group->patterns.push_back( pattern );
+		}
+	}
+
+	for( PatternGroup& group : m_groups )
+	{
+		std::sort( group.patterns.begin(), group.patterns.end(), []( const Pattern& a, const Pattern& b ) { return a.hash < b.hash; } );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* ScanGroup
+* Checks every box of the group's size with its bottom left in
+* [minOrigin, maxOrigin], a column of boxes at a time. window is a ring of
+* the box's rows, bottomRow the index of its lowest.
+*/
+template <typename RowReader>
+void GridShapeMatcher::ScanGroup( const PatternGroup& group, const IntVec2& minOrigin, const IntVec2& maxOrigin, const RowReader& readRow )
+{
+	if( minOrigin.x > maxOrigin.x || minOrigin.y > maxOrigin.y )
+	{
+		return;
+	}
+
+	int height = group.size.y;
+	uint64_t window[GRID_SHAPE_MAX_SIZE];
+	for( int x = minOrigin.x; x <= maxOrigin.x; ++x )
+	{
+		uint64_t hash = 0;
+		int occupiedRows = 0;
+		for( int row = 0; row < height; ++row )
+		{
+			window[row] = readRow( minOrigin.y + row, x ) & group.rowMask;
+			hash = hash * GRID_SHAPE_HASH_BASE + window[row];
+			occupiedRows += window[row] != 0 ? 1 : 0;
+		}
+
+		int bottomRow = 0;
+		for( int y = minOrigin.y; y <= maxOrigin.y; ++y )
+		{
+			if( occupiedRows > 0 )
+			{
+				CheckWindow( group, hash, window, bottomRow, IntVec2( x, y ) );
+			}
+			if( y < maxOrigin.y )
+			{
+				uint64_t topRow = readRow( y + height, x ) & group.rowMask;
+				hash = ( hash - window[bottomRow] * group.bottomRowFactor ) * GRID_SHAPE_HASH_BASE + topRow;
+				occupiedRows += ( topRow != 0 ? 1 : 0 ) - ( window[bottomRow] != 0 ? 1 : 0 );
+				window[bottomRow] = topRow;
+				bottomRow = bottomRow + 1 == height ? 0 : bottomRow + 1;
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* CheckWindow
+* Rows are only compared when the hash matches. Targets never share an
+* orientation, so at most one pattern can.
+*/
+void GridShapeMatcher::CheckWindow( const PatternGroup& group, uint64_t hash, const uint64_t* window, int bottomRow, const IntVec2& origin )
+{
+	++m_stats.windowsChecked;
+	auto pattern = std::lower_bound( group.patterns.begin(), group.patterns.end(), hash, []( const Pattern& a, uint64_t value ) { return a.hash < value; } );
+	for( ; pattern != group.patterns.end() && pattern->hash == hash; ++pattern )
+	{
+		++m_stats.hashHits;
+		const GridShapeOrientation& orientation = m_targets[pattern->targetIndex].orientations[pattern->orientationIndex];
+		bool isSame = true;
+		int windowRow = bottomRow;
+		for( int row = 0; row < group.size.y && isSame; ++row )
+		{
+			isSame = window[windowRow] == orientation.rows[row];
+			windowRow = windowRow + 1 == group.size.y ? 0 : windowRow + 1;
+		}
+		if( !isSame )
+		{
+			++m_stats.falseHits;
+			continue;
+		}
+
+		GridShapeMatch match;
+		match.targetIndex = pattern->targetIndex;
+		match.orientationIndex = pattern->orientationIndex;
+		match.origin = origin;
+		match.size = group.size;
+		int bucketIndex = ( origin.y >> GRID_SHAPE_BUCKET_SIZE_BITS ) * m_bucketDimensions.x + ( origin.x >> GRID_SHAPE_BUCKET_SIZE_BITS );
+		m_matchBuckets[bucketIndex].push_back( match );
+		++m_targetMatchCounts[pattern->targetIndex];
+		++m_totalMatchCount;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* RescanAll
+* Every box on the board, read from a fresh bitboard.
+*/
+void GridShapeMatcher::RescanAll()
+{
+	GAME_PROFILE_SCOPE( "GridShapeMatcher::RescanAll" );
+	++m_stats.fullScans;
+	const IntVec2& dimensions = m_grid.GetDimensions();
+	int bucketMask = ( 1 << GRID_SHAPE_BUCKET_SIZE_BITS ) - 1;
+	m_bucketDimensions = IntVec2( ( dimensions.x + bucketMask ) >> GRID_SHAPE_BUCKET_SIZE_BITS, ( dimensions.y + bucketMask ) >> GRID_SHAPE_BUCKET_SIZE_BITS );
+	m_matchBuckets.resize( (size_t) m_bucketDimensions.x * m_bucketDimensions.y );
+	for( std::vector<GridShapeMatch>& bucket : m_matchBuckets )
+	{
+		bucket.clear();
+	}
+	m_areMatchesGathered = false;
+	m_targetMatchCounts.assign( m_targets.size(), 0 );
+	m_totalMatchCount = 0;
+	if( m_groups.empty() )
+	{
+		return;
+	}
+
+	m_board.Capture( m_grid );
+	auto readRow = [this]( int y, int x ) { return m_board.GetWindow( y, x ); };
+	for( const PatternGroup& group : m_groups )
+	{
+		ScanGroup( group, IntVec2( 0, 0 ), IntVec2( dimensions.x - group.size.x, dimensions.y - group.size.y ), readRow );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* RescanRegion
+* Matches whose box overlaps the changed cells are dropped (only buckets
+* within the largest pattern of them can hold one), then every box that
+* overlaps them is checked again. Rows come straight off the Grid, the
+* region is too small to be worth a bitboard.
+*/
+void GridShapeMatcher::RescanRegion( const IntVec2& minCell, const IntVec2& maxCell )
+{
+	++m_stats.regionScans;
+	m_areMatchesGathered = false;
+	IntVec2 minBucket( std::max( 0, minCell.x - m_maxPatternSize.x + 1 ) >> GRID_SHAPE_BUCKET_SIZE_BITS, std::max( 0, minCell.y - m_maxPatternSize.y + 1 ) >> GRID_SHAPE_BUCKET_SIZE_BITS );
+	IntVec2 maxBucket( std::min( m_bucketDimensions.x - 1, maxCell.x >> GRID_SHAPE_BUCKET_SIZE_BITS ), std::min( m_bucketDimensions.y - 1, maxCell.y >> GRID_SHAPE_BUCKET_SIZE_BITS ) );
+	for( int bucketY = minBucket.y; bucketY <= maxBucket.y; ++bucketY )
+	{
+		for( int bucketX = minBucket.x; bucketX <= maxBucket.x; ++bucketX )
+		{
+			std::vector<GridShapeMatch>& bucket = m_matchBuckets[bucketY * m_bucketDimensions.x + bucketX];
+			size_t keptCount = 0;
+			for( const GridShapeMatch& match : bucket )
+			{
+				bool overlaps = match.origin.x <= maxCell.x && match.origin.x + match.size.x > minCell.x && match.origin.y <= maxCell.y && match.origin.y + match.size.y > minCell.y;
+				if( overlaps )
+				{
+					--m_targetMatchCounts[match.targetIndex];
+					--m_totalMatchCount;
+					continue;
+				}
+				bucket[keptCount++] = match;
+			}
+			bucket.resize( keptCount );
+		}
+	}
+
+	const IntVec2& dimensions = m_grid.GetDimensions();
+	auto readRow = [this]( int y, int x ) { return m_grid.GetRowBits( y, x ); };
+	for( const PatternGroup& group : m_groups )
+	{
+		IntVec2 minOrigin( std::max( 0, minCell.x - group.size.x + 1 ), std::max( 0, minCell.y - group.size.y + 1 ) );
+		IntVec2 maxOrigin( std::min( dimensions.x - group.size.x, maxCell.x ), std::min( dimensions.y - group.size.y, maxCell.y ) );
+		ScanGroup( group, minOrigin, maxOrigin, readRow );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* Command_AddTargetShape
+* shape_add [file=Data/Levels/Level.glvl]
+*/
+bool Command_AddTargetShape( EventArgs& args )
+{
+	std::string levelPath = args.GetValue( "file", DEFAULT_LEVEL_PATH );
+	GridShapeMatcher* matcher = g_theGame->GetGrid()->GetShapeMatcher();
+	int targetIndex = matcher->AddTargetFromLevel( levelPath );
+	if( targetIndex < 0 )
+	{
+		BenchmarkPrint( "Could not add a target shape from " + levelPath );
+		return true;
+	}
+	const GridShapeTarget& target = matcher->GetTarget( targetIndex );
+	BenchmarkPrint( "Target shape " + std::to_string( targetIndex ) + ": " + target.name + ", " + std::to_string( target.cellCount ) + " blocks, " + std::to_string( target.orientations.size() ) + " orientations" );
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Command_FindTargetShapes
+* shape_find, lists where each target shape is on the board.
+*/
+bool Command_FindTargetShapes( EventArgs& args )
+{
+	UNUSED( args );
+	GridShapeMatcher* matcher = g_theGame->GetGrid()->GetShapeMatcher();
+	const std::vector<GridShapeMatch>& matches = matcher->GetMatches();
+	for( int targetIdx = 0; targetIdx < matcher->GetTargetCount(); ++targetIdx )
+	{
+		std::string line = matcher->GetTarget( targetIdx ).name + ": " + std::to_string( matcher->GetMatchCount( targetIdx ) ) + " found";
+		for( const GridShapeMatch& match : matches )
+		{
+			if( match.targetIndex == targetIdx )
+			{
+				line += " (" + std::to_string( match.origin.x ) + "," + std::to_string( match.origin.y ) + ")";
+			}
+		}
+		BenchmarkPrint( line );
+	}
+	return true;
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Core/EventSystem.hpp"
+
+#include "Game/Grid.hpp"
+#include "Game/GridPiece.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+constexpr int GRID_SHAPE_MAX_SIZE = 64;					// One 64 bit word per row.
+constexpr int GRID_SHAPE_MAX_QUEUED_CHANGES = 256;		// Past this the next update rescans the board.
+constexpr int GRID_SHAPE_CHANGE_MERGE_SIZE = 8;			// Changes within a box this size are rechecked together.
+constexpr int GRID_SHAPE_BUCKET_SIZE_BITS = 3;			// Matches are kept in 8x8 cell buckets by origin.
+constexpr uint64_t GRID_SHAPE_HASH_BASE = 0x9E3779B97F4A7C15ull;	// Odd, so every power of it is too.
+
+//--------------------------------------------------------------------------
+// One orientation of a target, row 0 at the bottom, bit x of a row for
+// column x of its bounding box.
+//--------------------------------------------------------------------------
+struct GridShapeOrientation
+{
+	IntVec2 size;
+	std::vector<uint64_t> rows;
+	uint64_t hash = 0;			// Rows in the rolling hash, see GridShapeMatcher.
+};
+
+struct GridShapeTarget
+{
+	std::string name;
+	int cellCount = 0;
+	uint64_t canonicalHash = 0;		// Equal for every rotation and mirror image of the shape.
+	std::vector<GridShapeOrientation> orientations;		// The distinct ones, canonical form first.
+};
+
+struct GridShapeMatch
+{
+	int targetIndex = -1;
+	int orientationIndex = 0;
+	IntVec2 origin;				// Bottom left of the orientation's box on the board.
+	IntVec2 size;
+};
+
+struct GridShapeMatcherStats
+{
+	uint64_t fullScans = 0;
+	uint64_t regionScans = 0;
+	uint64_t windowsChecked = 0;	// Boxes hashed that held any block.
+	uint64_t hashHits = 0;			// Of those, hashes equal to a pattern's.
+	uint64_t falseHits = 0;			// Of those, rows that differed.
+};
+
+//--------------------------------------------------------------------------
+// Finds target shapes anywhere on a Grid, in any rotation or mirror image.
+// A shape is there when its blocks are all on the board and the rest of its
+// bounding box is empty.
+//
+// Each target is kept in its distinct orientations. The least of them (by
+// size, then rows) is its canonical form, which identifies the shape
+// however it was drawn: adding a rotated copy of a target returns the
+// target already there.
+//
+// Orientations are grouped by box size and each group scans with a rolling
+// 2D hash. A row of a box is one masked 64 bit window of the board, and
+// moving the box up a row takes the bottom row's term out of the hash and
+// puts the new top row's in, so every box costs one row read and a lookup
+// in the group's sorted hashes. Only boxes whose hash matches are compared
+// row by row.
+//
+// On a Grid with shape matching enabled, every place and remove queues its
+// cell. The next query rechecks only the boxes that overlap what changed,
+// and drops old matches from the buckets near it, so a placement costs the
+// area around it rather than the board or the number of matches. Whole
+// areas swapped at once (history restoring chunks) are queued as regions
+// and rechecked the same way.
+//--------------------------------------------------------------------------
+class GridShapeMatcher
+{
+public:
+	explicit GridShapeMatcher( const Grid& grid );
+	~GridShapeMatcher();
+
+	int AddTarget( const std::string& name, const std::vector<IntVec2>& cells );
+	int AddTargetFromLevel( const std::string& levelPath, eLevelTrust trust = LEVEL_UNTRUSTED );
+	void ClearTargets();
+	int GetTargetCount() const { return (int) m_targets.size(); }
+	const GridShapeTarget& GetTarget( int targetIndex ) const { return m_targets[targetIndex]; }
+
+	void OnCellChanged( const IntVec2& cell );
+	void OnRegionChanged( const IntVec2& minCell, const IntVec2& maxCell );
+	void InvalidateAll();
+	void Update();
+
+	const std::vector<GridShapeMatch>& GetMatches();
+	int GetMatchCount( int targetIndex );
+	int GetTotalMatchCount();
+	int GetFoundTargetCount();
+	const GridShapeMatcherStats& GetStats() const { return m_stats; }
+
+	static void MakeOrientations( const std::vector<IntVec2>& cells, std::vector<GridShapeOrientation>* out_orientations );
+	static uint64_t HashRows( const uint64_t* rows, int rowCount );
+
+private:
+	struct Pattern
+	{
+		uint64_t hash = 0;
+		int targetIndex = -1;
+		int orientationIndex = 0;
+	};
+
+	struct PatternGroup
+	{
+		IntVec2 size;
+		uint64_t rowMask = 0;
+		uint64_t bottomRowFactor = 0;		// GRID_SHAPE_HASH_BASE to the power height - 1.
+		std::vector<Pattern> patterns;		// Sorted by hash.
+	};
+
+	void BuildGroups();
+	void RescanAll();
+	void RescanRegion( const IntVec2& minCell, const IntVec2& maxCell );
+	template <typename RowReader>
+	void ScanGroup( const PatternGroup& group, const IntVec2& minOrigin, const IntVec2& maxOrigin, const RowReader& readRow );
+	void CheckWindow( const PatternGroup& group, uint64_t hash, const uint64_t* window, int bottomRow, const IntVec2& origin );
+
+private:
+	const Grid& m_grid;
+	std::vector<GridShapeTarget> m_targets;
+	std::vector<PatternGroup> m_groups;
+
+	IntVec2 m_maxPatternSize;
+	IntVec2 m_bucketDimensions;
+	std::vector<std::vector<GridShapeMatch>> m_matchBuckets;	// By the bucket holding the match's origin.
+	std::vector<GridShapeMatch> m_matches;						// Every bucket's, gathered when asked for.
+	bool m_areMatchesGathered = false;
+	std::vector<int> m_targetMatchCounts;
+	int m_totalMatchCount = 0;
+	std::vector<IntVec2> m_changedCells;
+	std::vector<IntVec2> m_changedRegions;						// Min and max cell pairs.
+	bool m_needsFullScan = true;
+
+	GridBitboard m_board;		// Full scans read from here, region scans from the Grid.
+	GridShapeMatcherStats m_stats;
+};
+
+bool Command_AddTargetShape( EventArgs& args );
+bool Command_FindTargetShapes( EventArgs& args );
@@ -0,0 +1,211 @@
+#include "Game/InputJournal.hpp"
+
+#include <string.h>
+
+//--------------------------------------------------------------------------
+/**
+* ~InputJournal
+* A recording that was never ended still keeps what was flushed, but has
+* no END record so it can't be verified.
+*/
+InputJournal::~InputJournal()
+{
+	if( m_file != nullptr )
+	{
+		Flush();
+		fclose( m_file );
+		m_file = nullptr;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* BeginRecording
+*/
+bool InputJournal::BeginRecording( const std::string& filePath, uint64_t seed, float tickSeconds )
+{
+	m_file = fopen( filePath.c_str(), "wb" );
+	if( m_file == nullptr )
+	{
+		return false;
+	}
+
+	memset( &m_header, 0, sizeof( m_header ) );
+	m_header.magic = INPUT_JOURNAL_MAGIC;
+	m_header.version = INPUT_JOURNAL_VERSION;
+	m_header.seed = seed;
+	m_header.tickSeconds = tickSeconds;
+	fwrite( &m_header, sizeof( m_header ), 1, m_file );
+
+	m_lastTick = 0;
+	m_pendingBytes.clear();
+	m_pendingBytes.reserve( INPUT_JOURNAL_FLUSH_BYTES + 16 );
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Record
+*/
+void InputJournal::Record( uint64_t tick, eInputEventType type, uint8_t code )
+{
+	if( m_file == nullptr )
+	{
+		return;
+	}
+	WriteRecord( tick, type, code );
+	if( m_pendingBytes.size() >= INPUT_JOURNAL_FLUSH_BYTES )
+	{
+		Flush();
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* EndRecording
+* Rewrites the header too, for what was set after recording began.
+*/
+bool InputJournal::EndRecording( uint64_t finalTick, uint64_t stateHash )
+{
+	if( m_file == nullptr )
+	{
+		return false;
+	}
+
+	WriteRecord( finalTick, INPUT_EVENT_END, 0 );
+	const uint8_t* hashBytes = (const uint8_t*) &stateHash;
+	m_pendingBytes.insert( m_pendingBytes.end(), hashBytes, hashBytes + sizeof( stateHash ) );
+	Flush();
+	fseek( m_file, 0, SEEK_SET );
+	fwrite( &m_header, sizeof( m_header ), 1, m_file );
+
+	bool isWritten = ferror( m_file ) == 0;
+	fclose( m_file );
+	m_file = nullptr;
+	return isWritten;
+}
+
+//--------------------------------------------------------------------------
+/**
+* LoadForReplay
+* Journals are small, so the whole thing is decoded up front.
+*/
+bool InputJournal::LoadForReplay( const std::string& filePath )
+{
+	FILE* file = fopen( filePath.c_str(), "rb" );
+	if( file == nullptr )
+	{
+		return false;
+	}
+	std::vector<uint8_t> bytes;
+	uint8_t buffer[4096];
+	size_t readCount;
+	while( ( readCount = fread( buffer, 1, sizeof( buffer ), file ) ) > 0 )
+	{
+		bytes.insert( bytes.end(), buffer, buffer + readCount );
+	}
+	fclose( file );
+
+	if( bytes.size() < sizeof( InputJournalHeader ) )
+	{
+		return false;
+	}
+	memcpy( &m_header, bytes.data(), sizeof( m_header ) );
+	if( m_header.magic != INPUT_JOURNAL_MAGIC || m_header.version != INPUT_JOURNAL_VERSION )
+	{
+		return false;
+	}
+
+	m_events.clear();
+	m_nextEvent = 0;
+	size_t readPos = sizeof( InputJournalHeader );
+	uint64_t tick = 0;
+	while( readPos < bytes.size() )
+	{
+		uint64_t tickDelta = 0;
+		int shift = 0;
+		while( readPos < bytes.size() && shift < 64 )
+		{
+			uint8_t byte = bytes[readPos++];
+			tickDelta |= (uint64_t) ( byte & 0x7F ) << shift;
+			shift += 7;
+			if( ( byte & 0x80 ) == 0 )
+			{
+				break;
+			}
+		}
+		if( readPos + 2 > bytes.size() )
+		{
+			return false;
+		}
+
+		InputEvent event;
+		tick += tickDelta;
+		event.tick = tick;
+		event.type = (eInputEventType) bytes[readPos++];
+		event.code = bytes[readPos++];
+		if( event.type == INPUT_EVENT_END )
+		{
+			if( readPos + sizeof( m_finalStateHash ) > bytes.size() )
+			{
+				return false;
+			}
+			memcpy( &m_finalStateHash, bytes.data() + readPos, sizeof( m_finalStateHash ) );
+			m_finalTick = tick;
+			m_isReplaying = true;
+			return true;
+		}
+		m_events.push_back( event );
+	}
+
+	// Never ended, most likely the recording session crashed.
+	return false;
+}
+
+//--------------------------------------------------------------------------
+/**
+* PopEventForTick
+* Call until it returns false before running each tick.
+*/
+bool InputJournal::PopEventForTick( uint64_t tick, InputEvent* out_event )
+{
+	if( m_nextEvent >= m_events.size() || m_events[m_nextEvent].tick > tick )
+	{
+		return false;
+	}
+	*out_event = m_events[m_nextEvent++];
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* WriteRecord
+*/
+void InputJournal::WriteRecord( uint64_t tick, eInputEventType type, uint8_t code )
+{
+	uint64_t tickDelta = tick >= m_lastTick ? tick - m_lastTick : 0;
+	m_lastTick += tickDelta;
+	do
+	{
+		uint8_t byte = (uint8_t) ( tickDelta & 0x7F );
+		tickDelta >>= 7;
+		m_pendingBytes.push_back( tickDelta != 0 ? (uint8_t) ( byte | 0x80 ) : byte );
+	}
+	while( tickDelta != 0 );
+	m_pendingBytes.push_back( (uint8_t) type );
+	m_pendingBytes.push_back( code );
+}
+
+//--------------------------------------------------------------------------
+/**
+* Flush
+*/
+void InputJournal::Flush()
+{
+	if( m_file != nullptr && !m_pendingBytes.empty() )
+	{
+		fwrite( m_pendingBytes.data(), 1, m_pendingBytes.size(), m_file );
+		fflush( m_file );
+	}
+	m_pendingBytes.clear();
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+//--------------------------------------------------------------------------
+// Everything that reaches the simulation from outside, stamped with the
+// simulation tick it was applied before. Recording a live session and
+// replaying it against the same seed reproduces the session tick for tick.
+//--------------------------------------------------------------------------
+enum eInputEventType : uint8_t
+{
+	INPUT_EVENT_KEY_DOWN,
+	INPUT_EVENT_KEY_UP,
+	INPUT_EVENT_CHAR,
+	INPUT_EVENT_UI,		// code is an eGameUIEvent
+
+	INPUT_EVENT_END,	// Last record, followed by the final state hash.
+};
+
+struct InputEvent
+{
+	uint64_t tick = 0;
+	eInputEventType type = INPUT_EVENT_END;
+	uint8_t code = 0;
+};
+
+//--------------------------------------------------------------------------
+// File layout: a fixed header, then one record per event of
+// [varint tick delta][type byte][code byte]. The END record carries the
+// final tick the same way and is followed by the 8 byte state hash. The
+// header is written again when the recording ends, with the entity count
+// known by then.
+//--------------------------------------------------------------------------
+constexpr uint32_t INPUT_JOURNAL_MAGIC = 0x524A4E49;	// "INJR"
+constexpr uint32_t INPUT_JOURNAL_VERSION = 1;
+constexpr size_t INPUT_JOURNAL_FLUSH_BYTES = 4096;
+
+struct InputJournalHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t seed;
+	float tickSeconds;
+	uint32_t startEntityCount;		// Spawned before the first tick. Was reserved, always 0.
+};
+
+class InputJournal
+{
+public:
+	InputJournal() {}
+	~InputJournal();
+
+	bool BeginRecording( const std::string& filePath, uint64_t seed, float tickSeconds );
+	void Record( uint64_t tick, eInputEventType type, uint8_t code );
+	void SetStartEntityCount( int entityCount ) { m_header.startEntityCount = (uint32_t) entityCount; }
+	bool EndRecording( uint64_t finalTick, uint64_t stateHash );
+
+	bool LoadForReplay( const std::string& filePath );
+	bool PopEventForTick( uint64_t tick, InputEvent* out_event );
+
+	bool IsRecording() const { return m_file != nullptr; }
+	bool IsReplaying() const { return m_isReplaying; }
+	bool IsReplayFinished( uint64_t tick ) const { return m_isReplaying && tick >= m_finalTick; }
+
+	uint64_t GetSeed() const { return m_header.seed; }
+	float GetTickSeconds() const { return m_header.tickSeconds; }
+	int GetStartEntityCount() const { return (int) m_header.startEntityCount; }
+	uint64_t GetFinalTick() const { return m_finalTick; }
+	uint64_t GetFinalStateHash() const { return m_finalStateHash; }
+	int GetEventCount() const { return (int) m_events.size(); }
+
+private:
+	void WriteRecord( uint64_t tick, eInputEventType type, uint8_t code );
+	void Flush();
+
+private:
+	InputJournalHeader m_header = {};
+
+	FILE* m_file = nullptr;
+	std::vector<uint8_t> m_pendingBytes;
+	uint64_t m_lastTick = 0;
+
+	bool m_isReplaying = false;
+	std::vector<InputEvent> m_events;
+	size_t m_nextEvent = 0;
+	uint64_t m_finalTick = 0;
+	uint64_t m_finalStateHash = 0;
+};
+
+//--------------------------------------------------------------------------
+// FNV-1a, used to fold simulation state into one comparable number.
+//--------------------------------------------------------------------------
+constexpr uint64_t STATE_HASH_SEED = 0xcbf29ce484222325ull;
+
+inline uint64_t HashBytes( uint64_t hash, const void* data, size_t byteCount )
+{
+	const uint8_t* bytes = (const uint8_t*) data;
+	for( size_t byteIdx = 0; byteIdx < byteCount; ++byteIdx )
+	{
+		hash = ( hash ^ bytes[byteIdx] ) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+template <typename T>
+uint64_t HashVector( uint64_t hash, const std::vector<T>& values )
+{
+	uint64_t count = (uint64_t) values.size();
+	hash = HashBytes( hash, &count, sizeof( count ) );
+	return values.empty() ? hash : HashBytes( hash, values.data(), values.size() * sizeof( T ) );
+}
@@ -0,0 +1,59 @@
+#include "Game/InputQueue.hpp"
+
+//--------------------------------------------------------------------------
+/**
+* Push
+* Indices run freely and wrap, the slot is the index masked.
+*/
+bool InputQueue::Push( eInputEventType type, uint8_t code, uint64_t timestampNs )
+{
+	uint32_t tail = m_tail.load( std::memory_order_relaxed );
+	if( tail - m_cachedHead >= INPUT_QUEUE_CAPACITY )
+	{
+		m_cachedHead = m_head.load( std::memory_order_acquire );
+		if( tail - m_cachedHead >= INPUT_QUEUE_CAPACITY )
+		{
+			m_droppedCount.fetch_add( 1, std::memory_order_relaxed );
+			return false;
+		}
+	}
+
+	TimedInputEvent& event = m_events[tail & INPUT_QUEUE_MASK];
+	event.timestampNs = timestampNs;
+	event.type = type;
+	event.code = code;
+	m_tail.store( tail + 1, std::memory_order_release );
+	m_pushedCount.fetch_add( 1, std::memory_order_relaxed );
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Pop
+*/
+bool InputQueue::Pop( TimedInputEvent* out_event )
+{
+	uint32_t head = m_head.load( std::memory_order_relaxed );
+	if( head == m_cachedTail )
+	{
+		m_cachedTail = m_tail.load( std::memory_order_acquire );
+		if( head == m_cachedTail )
+		{
+			return false;
+		}
+	}
+
+	*out_event = m_events[head & INPUT_QUEUE_MASK];
+	m_head.store( head + 1, std::memory_order_release );
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsEmpty
+* Consumer side, a cheap check before deciding to drain.
+*/
+bool InputQueue::IsEmpty() const
+{
+	return m_head.load( std::memory_order_relaxed ) == m_tail.load( std::memory_order_acquire );
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "Game/InputJournal.hpp"
+
+#include <stdint.h>
+#include <atomic>
+
+//--------------------------------------------------------------------------
+// Bounded single producer, single consumer queue of timestamped input.
+// Whatever samples input pushes, App drains at the start of each
+// simulation tick, so events keep the order and time they were sampled in
+// no matter when the frame gets around to them.
+//
+// Lock free: each side owns one index and only reads the other's, keeping
+// a cached copy so it doesn't touch the other side's cache line until it
+// looks full or empty. A full queue drops the new event and counts it.
+//--------------------------------------------------------------------------
+constexpr uint32_t INPUT_QUEUE_CAPACITY_BITS = 10;
+constexpr uint32_t INPUT_QUEUE_CAPACITY = 1u << INPUT_QUEUE_CAPACITY_BITS;
+constexpr uint32_t INPUT_QUEUE_MASK = INPUT_QUEUE_CAPACITY - 1;
+
+struct TimedInputEvent
+{
+	uint64_t timestampNs = 0;	// GameProfilerNowNs when sampled.
+	eInputEventType type = INPUT_EVENT_END;
+	uint8_t code = 0;
+};
+
+//--------------------------------------------------------------------------
+// Sampled to applied, measured when the tick drains the event.
+//--------------------------------------------------------------------------
+struct InputLatencyStats
+{
+	int eventsLastFrame = 0;
+	double averageMsLastFrame = 0.0;
+	double maxMsLastFrame = 0.0;
+
+	uint64_t totalEvents = 0;
+	double maxMs = 0.0;
+	double totalMs = 0.0;
+	uint64_t droppedEvents = 0;
+};
+
+//--------------------------------------------------------------------------
+class InputQueue
+{
+public:
+	InputQueue() {}
+	~InputQueue() {}
+
+	bool Push( eInputEventType type, uint8_t code, uint64_t timestampNs );	// Producer only.
+	bool Pop( TimedInputEvent* out_event );									// Consumer only.
+
+	bool IsEmpty() const;
+	uint64_t GetPushedCount() const { return m_pushedCount.load( std::memory_order_relaxed ); }
+	uint64_t GetDroppedCount() const { return m_droppedCount.load( std::memory_order_relaxed ); }
+
+private:
+	TimedInputEvent m_events[INPUT_QUEUE_CAPACITY];
+
+	// Producer side.
+	alignas( 64 ) std::atomic<uint32_t> m_tail { 0 };
+	uint32_t m_cachedHead = 0;
+	std::atomic<uint64_t> m_pushedCount { 0 };
+	std::atomic<uint64_t> m_droppedCount { 0 };
+
+	// Consumer side.
+	alignas( 64 ) std::atomic<uint32_t> m_head { 0 };
+	uint32_t m_cachedTail = 0;
+};
@@ -0,0 +1,73 @@
+#include "Game/InputSampler.hpp"
+#include "Game/InputQueue.hpp"
+#include "Game/GameProfiler.hpp"
+
+#include <chrono>
+
+//--------------------------------------------------------------------------
+/**
+* ~InputSampler
+*/
+InputSampler::~InputSampler()
+{
+	Stop();
+}
+
+//--------------------------------------------------------------------------
+/**
+* Start
+*/
+void InputSampler::Start( InputQueue* queue, float tapsPerSecond )
+{
+	if( m_thread.joinable() || queue == nullptr || tapsPerSecond <= 0.0f )
+	{
+		return;
+	}
+
+	m_queue = queue;
+	m_tapPeriodNs = (uint64_t) ( 1000000000.0 / (double) tapsPerSecond );
+	m_isQuitting.store( false, std::memory_order_relaxed );
+	m_thread = std::thread( &InputSampler::ThreadMain, this );
+}
+
+//--------------------------------------------------------------------------
+/**
+* Stop
+*/
+void InputSampler::Stop()
+{
+	if( !m_thread.joinable() )
+	{
+		return;
+	}
+	m_isQuitting.store( true, std::memory_order_relaxed );
+	m_thread.join();
+}
+
+//--------------------------------------------------------------------------
+/**
+* ThreadMain
+* Presses on one tap and releases on the next, keeping the schedule
+* absolute so oversleeping doesn't slowly lower the rate.
+*/
+void InputSampler::ThreadMain()
+{
+	GameProfilerSetThreadName( "InputSampler" );
+
+	bool isKeyDown = false;
+	std::chrono::steady_clock::time_point nextTapTime = std::chrono::steady_clock::now();
+	while( !m_isQuitting.load( std::memory_order_relaxed ) )
+	{
+		nextTapTime += std::chrono::nanoseconds( m_tapPeriodNs );
+		std::this_thread::sleep_until( nextTapTime );
+
+		isKeyDown = !isKeyDown;
+		m_queue->Push( isKeyDown ? INPUT_EVENT_KEY_DOWN : INPUT_EVENT_KEY_UP, INPUT_SAMPLER_KEY, GameProfilerNowNs() );
+	}
+
+	// Never leave the key held.
+	if( isKeyDown )
+	{
+		m_queue->Push( INPUT_EVENT_KEY_UP, INPUT_SAMPLER_KEY, GameProfilerNowNs() );
+	}
+}
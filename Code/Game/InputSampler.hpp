@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+
+class InputQueue;
+
+//--------------------------------------------------------------------------
+// Stand-in for a keyboard on headless runs: a thread that taps an unbound
+// key at a fixed rate into App's InputQueue. Exercises the same cross
+// thread path real input takes and gives the input latency stats numbers
+// to report without a window.
+//--------------------------------------------------------------------------
+constexpr uint8_t INPUT_SAMPLER_KEY = 0x87;		// VK_F24, nothing binds it.
+
+class InputSampler
+{
+public:
+	InputSampler() {}
+	~InputSampler();
+
+	void Start( InputQueue* queue, float tapsPerSecond );
+	void Stop();
+
+	bool IsRunning() const { return m_thread.joinable(); }
+
+private:
+	void ThreadMain();
+
+private:
+	InputQueue* m_queue = nullptr;
+	uint64_t m_tapPeriodNs = 0;
+	std::atomic<bool> m_isQuitting { false };
+	std::thread m_thread;
+};
@@ -0,0 +1,572 @@
+#include "Game/JobSystem.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/GameProfiler.hpp"
+
+#include <stdio.h>
+
+constexpr int WORKER_SPINS_BEFORE_SLEEP = 64;
+constexpr int MAX_TRACKED_JOB_NESTING = 64;
+
+static thread_local int t_jobThreadIndex = -1;
+static thread_local uint32_t t_runningJobIds[MAX_TRACKED_JOB_NESTING];	// Jobs that Wait runs nest on the same thread.
+static thread_local int t_runningJobDepth = 0;
+static char s_workerThreadNames[MAX_JOB_THREADS][16];
+
+//--------------------------------------------------------------------------
+/**
+* Push
+* Owner only. Fails when full, the caller runs the job itself.
+*/
+bool JobDeque::Push( uint32_t jobId )
+{
+	int64_t bottom = m_bottom.load( std::memory_order_relaxed );
+	int64_t top = m_top.load( std::memory_order_acquire );
+	if( bottom - top >= JOB_DEQUE_CAPACITY )
+	{
+		return false;
+	}
+	m_jobIds[bottom & ( JOB_DEQUE_CAPACITY - 1 )].store( jobId, std::memory_order_relaxed );
+	m_bottom.store( bottom + 1, std::memory_order_release );
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Pop
+* Owner only, newest first. Races thieves for the last job.
+*/
+bool JobDeque::Pop( uint32_t* out_jobId )
+{
+	int64_t bottom = m_bottom.load( std::memory_order_relaxed ) - 1;
+	m_bottom.store( bottom, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	int64_t top = m_top.load( std::memory_order_relaxed );
+
+	if( top > bottom )
+	{
+		m_bottom.store( bottom + 1, std::memory_order_relaxed );
+		return false;
+	}
+
+	*out_jobId = m_jobIds[bottom & ( JOB_DEQUE_CAPACITY - 1 )].load( std::memory_order_relaxed );
+	if( top == bottom )
+	{
+		bool isWon = m_top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed );
+		m_bottom.store( bottom + 1, std::memory_order_relaxed );
+		return isWon;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Steal
+* Any thread, oldest first.
+*/
+bool JobDeque::Steal( uint32_t* out_jobId )
+{
+	int64_t top = m_top.load( std::memory_order_acquire );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	int64_t bottom = m_bottom.load( std::memory_order_acquire );
+	if( top >= bottom )
+	{
+		return false;
+	}
+
+	*out_jobId = m_jobIds[top & ( JOB_DEQUE_CAPACITY - 1 )].load( std::memory_order_relaxed );
+	return m_top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed );
+}
+
+//--------------------------------------------------------------------------
+/**
+* JobSystem
+* The constructing thread becomes thread 0.
+*/
+JobSystem::JobSystem( int workerCount )
+{
+	if( workerCount < 0 )
+	{
+		int coreCount = (int) std::thread::hardware_concurrency();
+		workerCount = coreCount > 1 ? coreCount - 1 : 0;
+	}
+	if( workerCount > MAX_JOB_THREADS - 1 )
+	{
+		workerCount = MAX_JOB_THREADS - 1;
+	}
+
+	m_jobs = new Job[JOB_POOL_SIZE];
+	m_threadCount = workerCount + 1;
+	m_deques = new JobDeque[m_threadCount];
+	t_jobThreadIndex = 0;
+
+	m_workers.reserve( (size_t) workerCount );
+	for( int threadIndex = 1; threadIndex <= workerCount; ++threadIndex )
+	{
+		m_workers.emplace_back( &JobSystem::WorkerMain, this, threadIndex );
+	}
+	m_lastFrameStats.workerCount = workerCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~JobSystem
+*/
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock( m_wakeMutex );
+		m_isQuitting = true;
+	}
+	m_wakeCondition.notify_all();
+	for( std::thread& worker : m_workers )
+	{
+		worker.join();
+	}
+	m_workers.clear();
+
+	delete[] m_deques;
+	m_deques = nullptr;
+	delete[] m_jobs;
+	m_jobs = nullptr;
+}
+
+//--------------------------------------------------------------------------
+/**
+* CreateJob
+*/
+JobHandle JobSystem::CreateJob( const char* name, JobFunction function, void* userData )
+{
+	uint32_t jobId = AllocateJob( name );
+	GetJob( jobId ).function = function;
+	GetJob( jobId ).userData = userData;
+
+	JobHandle handle;
+	handle.id = jobId;
+	return handle;
+}
+
+//--------------------------------------------------------------------------
+/**
+* AddDependency
+* Nothing to wait for if dependsOn already finished. Only a full
+* continuation list makes us wait here instead.
+*/
+void JobSystem::AddDependency( JobHandle job, JobHandle dependsOn )
+{
+	if( dependsOn.IsNull() )
+	{
+		return;
+	}
+
+	Job& dependency = GetJob( dependsOn.id );
+	while( dependency.continuationLock.test_and_set( std::memory_order_acquire ) )
+	{
+		std::this_thread::yield();
+	}
+
+	bool isListFull = false;
+	if( dependency.id.load( std::memory_order_acquire ) == dependsOn.id && !dependency.isFinished.load( std::memory_order_acquire ) )
+	{
+		if( dependency.continuationCount < MAX_JOB_CONTINUATIONS )
+		{
+			GetJob( job.id ).pendingDependencies.fetch_add( 1, std::memory_order_relaxed );
+			dependency.continuations[dependency.continuationCount++] = job.id;
+		}
+		else
+		{
+			isListFull = true;
+		}
+	}
+	dependency.continuationLock.clear( std::memory_order_release );
+
+	if( isListFull )
+	{
+		ERROR_RECOVERABLE( "job has too many dependents, waiting for it instead" );
+		Wait( dependsOn );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* Submit
+* Drops the hold CreateJob put on the job, it runs once its dependencies
+* are done.
+*/
+void JobSystem::Submit( JobHandle job )
+{
+	if( GetJob( job.id ).pendingDependencies.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+	{
+		Enqueue( job.id );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* Schedule
+*/
+JobHandle JobSystem::Schedule( const char* name, JobFunction function, void* userData, const JobHandle* dependencies, int dependencyCount )
+{
+	JobHandle job = CreateJob( name, function, userData );
+	for( int dependencyIdx = 0; dependencyIdx < dependencyCount; ++dependencyIdx )
+	{
+		AddDependency( job, dependencies[dependencyIdx] );
+	}
+	Submit( job );
+	return job;
+}
+
+//--------------------------------------------------------------------------
+/**
+* ParallelFor
+* The returned job spawns the batches when it runs, so they only go out
+* once its dependencies are met.
+*/
+JobHandle JobSystem::ParallelFor( const char* name, int count, int batchSize, JobRangeFunction function, void* userData, const JobHandle* dependencies, int dependencyCount )
+{
+	JobHandle job = CreateJob( name, nullptr, userData );
+	Job& root = GetJob( job.id );
+	root.rangeFunction = function;
+	root.endIndex = count;
+	root.batchSize = batchSize > 0 ? batchSize : 1;
+	if( (int64_t) count > (int64_t) root.batchSize * MAX_PARALLEL_FOR_BATCHES )
+	{
+		root.batchSize = ( count + MAX_PARALLEL_FOR_BATCHES - 1 ) / MAX_PARALLEL_FOR_BATCHES;
+	}
+
+	for( int dependencyIdx = 0; dependencyIdx < dependencyCount; ++dependencyIdx )
+	{
+		AddDependency( job, dependencies[dependencyIdx] );
+	}
+	Submit( job );
+	return job;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetCurrentThreadIndex
+* Stable for the life of the job system, so it can index per thread scratch.
+*/
+int JobSystem::GetCurrentThreadIndex()
+{
+	return t_jobThreadIndex;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Wait
+*/
+void JobSystem::Wait( JobHandle job )
+{
+	int threadIndex = t_jobThreadIndex;
+	ASSERT_RECOVERABLE( threadIndex >= 0, "JobSystem::Wait from a thread the job system doesn't own" );
+	while( !IsComplete( job ) )
+	{
+		if( threadIndex < 0 || !TryRunOneJob( threadIndex ) )
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsComplete
+*/
+bool JobSystem::IsComplete( JobHandle job ) const
+{
+	if( job.IsNull() )
+	{
+		return true;
+	}
+	const Job& slot = GetJob( job.id );
+	return slot.id.load( std::memory_order_acquire ) != job.id || slot.isFinished.load( std::memory_order_acquire );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetJobMilliseconds
+* Time spent in the job's own function, not its children.
+*/
+double JobSystem::GetJobMilliseconds( JobHandle job ) const
+{
+	if( !IsComplete( job ) || GetJob( job.id ).id.load( std::memory_order_acquire ) != job.id )
+	{
+		return 0.0;
+	}
+	return GetJob( job.id ).durationMs;
+}
+
+//--------------------------------------------------------------------------
+/**
+* EndFrame
+* Moves the counters into the per frame stats.
+*/
+void JobSystem::EndFrame()
+{
+	m_lastFrameStats.workerCount = GetWorkerCount();
+	m_lastFrameStats.jobsRun = m_jobsRun.exchange( 0, std::memory_order_relaxed );
+	m_lastFrameStats.jobsStolen = m_jobsStolen.exchange( 0, std::memory_order_relaxed );
+	m_lastFrameStats.jobsRunInline = m_jobsRunInline.exchange( 0, std::memory_order_relaxed );
+	m_lastFrameStats.busyMs = (double) m_busyNs.exchange( 0, std::memory_order_relaxed ) * 0.000001;
+}
+
+//--------------------------------------------------------------------------
+/**
+* AllocateJob
+* Takes the next pool slot. If its last job is somehow still in flight the
+* pool is too small for the frame, so help out until it's done. That can't
+* work when the slot belongs to the job asking, or one of its parents.
+*/
+uint32_t JobSystem::AllocateJob( const char* name )
+{
+	uint32_t jobId = m_nextJobId.fetch_add( 1, std::memory_order_relaxed );
+	if( jobId == 0 )
+	{
+		jobId = m_nextJobId.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	Job& job = GetJob( jobId );
+	uint32_t previousId = job.id.load( std::memory_order_acquire );
+	if( previousId != 0 && !job.isFinished.load( std::memory_order_acquire ) )
+	{
+		ASSERT_OR_DIE( !IsRunningOnThisThread( previousId ), "job pool lapped a job that is still allocating, raise JOB_POOL_SIZE_BITS" );
+		ERROR_RECOVERABLE( "job pool exhausted, raise JOB_POOL_SIZE_BITS" );
+		while( !job.isFinished.load( std::memory_order_acquire ) )
+		{
+			if( !TryRunOneJob( t_jobThreadIndex >= 0 ? t_jobThreadIndex : 0 ) )
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	// Retire the old id under the continuation lock first, so an AddDependency
+	// still holding it either finishes before the list is cleared or sees the
+	// slot isn't its job any more.
+	while( job.continuationLock.test_and_set( std::memory_order_acquire ) )
+	{
+		std::this_thread::yield();
+	}
+	job.id.store( 0, std::memory_order_relaxed );
+	job.continuationCount = 0;
+	job.continuationLock.clear( std::memory_order_release );
+
+	job.name = name;
+	job.function = nullptr;
+	job.rangeFunction = nullptr;
+	job.userData = nullptr;
+	job.beginIndex = 0;
+	job.endIndex = 0;
+	job.batchSize = 0;
+	job.parentId = 0;
+	job.durationMs = 0.0;
+	job.unfinishedCount.store( 1, std::memory_order_relaxed );
+	job.pendingDependencies.store( 1, std::memory_order_relaxed );
+	job.isFinished.store( false, std::memory_order_relaxed );
+	job.id.store( jobId, std::memory_order_release );
+	return jobId;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsRunningOnThisThread
+* Any job this thread is part way through, or a parent of one. None of
+* them can finish until the thread gets back to it.
+*/
+bool JobSystem::IsRunningOnThisThread( uint32_t jobId ) const
+{
+	int trackedDepth = t_runningJobDepth < MAX_TRACKED_JOB_NESTING ? t_runningJobDepth : MAX_TRACKED_JOB_NESTING;
+	for( int depthIdx = 0; depthIdx < trackedDepth; ++depthIdx )
+	{
+		for( uint32_t runningId = t_runningJobIds[depthIdx]; runningId != 0; runningId = GetJob( runningId ).parentId )
+		{
+			if( runningId == jobId )
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Enqueue
+* Onto the calling thread's deque, or run now if that's full.
+*/
+void JobSystem::Enqueue( uint32_t jobId )
+{
+	int threadIndex = t_jobThreadIndex;
+	ASSERT_RECOVERABLE( threadIndex >= 0, "jobs submitted from a thread the job system doesn't own run inline" );
+	if( threadIndex < 0 || !m_deques[threadIndex].Push( jobId ) )
+	{
+		m_jobsRunInline.fetch_add( 1, std::memory_order_relaxed );
+		Execute( jobId, threadIndex );
+		return;
+	}
+
+	m_queuedJobs.fetch_add( 1, std::memory_order_release );
+	if( !m_workers.empty() )
+	{
+		m_wakeCondition.notify_one();
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* TryRunOneJob
+* Own deque first, then steal round robin starting after ourselves.
+*/
+bool JobSystem::TryRunOneJob( int threadIndex )
+{
+	uint32_t jobId = 0;
+	bool isFound = m_deques[threadIndex].Pop( &jobId );
+	for( int offset = 1; !isFound && offset < m_threadCount; ++offset )
+	{
+		isFound = m_deques[( threadIndex + offset ) % m_threadCount].Steal( &jobId );
+		if( isFound )
+		{
+			m_jobsStolen.fetch_add( 1, std::memory_order_relaxed );
+		}
+	}
+
+	if( !isFound )
+	{
+		return false;
+	}
+	m_queuedJobs.fetch_sub( 1, std::memory_order_relaxed );
+	Execute( jobId, threadIndex );
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Execute
+* A ParallelFor root pushes its batches, everything else runs its function.
+*/
+void JobSystem::Execute( uint32_t jobId, int threadIndex )
+{
+	UNUSED( threadIndex );
+	Job& job = GetJob( jobId );
+	uint64_t startNs = GameProfilerNowNs();
+	if( t_runningJobDepth < MAX_TRACKED_JOB_NESTING )
+	{
+		t_runningJobIds[t_runningJobDepth] = jobId;
+	}
+	++t_runningJobDepth;
+
+	if( job.batchSize > 0 )
+	{
+		int batchCount = ( job.endIndex + job.batchSize - 1 ) / job.batchSize;
+		if( batchCount > 0 )
+		{
+			job.unfinishedCount.fetch_add( batchCount, std::memory_order_relaxed );
+		}
+		for( int batchIdx = 0; batchIdx < batchCount; ++batchIdx )
+		{
+			uint32_t batchId = AllocateJob( job.name );
+			Job& batch = GetJob( batchId );
+			batch.rangeFunction = job.rangeFunction;
+			batch.userData = job.userData;
+			batch.beginIndex = batchIdx * job.batchSize;
+			batch.endIndex = batch.beginIndex + job.batchSize < job.endIndex ? batch.beginIndex + job.batchSize : job.endIndex;
+			batch.parentId = jobId;
+			batch.pendingDependencies.store( 0, std::memory_order_relaxed );
+			Enqueue( batchId );
+		}
+	}
+	else
+	{
+		GAME_PROFILE_SCOPE( job.name );
+		if( job.function != nullptr )
+		{
+			job.function( job.userData );
+		}
+		else if( job.rangeFunction != nullptr )
+		{
+			job.rangeFunction( job.userData, job.beginIndex, job.endIndex );
+		}
+	}
+
+	--t_runningJobDepth;
+	uint64_t elapsedNs = GameProfilerNowNs() - startNs;
+	job.durationMs = (double) elapsedNs * 0.000001;
+	m_busyNs.fetch_add( elapsedNs, std::memory_order_relaxed );
+	m_jobsRun.fetch_add( 1, std::memory_order_relaxed );
+	FinishJob( jobId );
+}
+
+//--------------------------------------------------------------------------
+/**
+* FinishJob
+* Once the job and all its children are done, mark it finished, release
+* whatever was waiting on it and tell the parent.
+*/
+void JobSystem::FinishJob( uint32_t jobId )
+{
+	Job& job = GetJob( jobId );
+	if( job.unfinishedCount.fetch_sub( 1, std::memory_order_acq_rel ) != 1 )
+	{
+		return;
+	}
+
+	uint32_t parentId = job.parentId;
+	uint32_t continuations[MAX_JOB_CONTINUATIONS];
+	while( job.continuationLock.test_and_set( std::memory_order_acquire ) )
+	{
+		std::this_thread::yield();
+	}
+	int continuationCount = job.continuationCount;
+	for( int continuationIdx = 0; continuationIdx < continuationCount; ++continuationIdx )
+	{
+		continuations[continuationIdx] = job.continuations[continuationIdx];
+	}
+	job.isFinished.store( true, std::memory_order_release );
+	job.continuationLock.clear( std::memory_order_release );
+
+	for( int continuationIdx = 0; continuationIdx < continuationCount; ++continuationIdx )
+	{
+		if( GetJob( continuations[continuationIdx] ).pendingDependencies.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+		{
+			Enqueue( continuations[continuationIdx] );
+		}
+	}
+
+	if( parentId != 0 )
+	{
+		FinishJob( parentId );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* WorkerMain
+* Spins a little before sleeping since frame work comes in bursts. The
+* sleep times out so a missed wake only costs a millisecond.
+*/
+void JobSystem::WorkerMain( int threadIndex )
+{
+	t_jobThreadIndex = threadIndex;
+	snprintf( s_workerThreadNames[threadIndex], sizeof( s_workerThreadNames[threadIndex] ), "Worker %d", threadIndex );
+	GameProfilerSetThreadName( s_workerThreadNames[threadIndex] );
+
+	int idleSpins = 0;
+	while( !m_isQuitting.load( std::memory_order_acquire ) )
+	{
+		if( TryRunOneJob( threadIndex ) )
+		{
+			idleSpins = 0;
+			continue;
+		}
+
+		if( ++idleSpins < WORKER_SPINS_BEFORE_SLEEP )
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock( m_wakeMutex );
+		m_wakeCondition.wait_for( lock, std::chrono::milliseconds( 1 ), [this]() { return m_queuedJobs.load( std::memory_order_acquire ) > 0 || m_isQuitting.load( std::memory_order_acquire ); } );
+		idleSpins = 0;
+	}
+}
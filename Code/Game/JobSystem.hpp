@@ -0,0 +1,147 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//--------------------------------------------------------------------------
+// Work stealing job scheduler. Every participating thread (the main thread
+// is thread 0, then the workers) owns a deque: it pushes and pops its own
+// jobs at the bottom, idle threads steal from the top of someone else's.
+//
+// Jobs form a dependency graph. Create a job, add the jobs it waits on,
+// then Submit it; it becomes runnable once they have all finished. Jobs
+// live in a fixed pool and handles go stale once their slot is reused,
+// a stale handle reads as complete.
+//
+// Only the main thread and jobs themselves may create and submit jobs.
+// Every job shows up as a zone in the GameProfiler under its name, which
+// has to be a string literal.
+//--------------------------------------------------------------------------
+constexpr int JOB_POOL_SIZE_BITS = 12;
+constexpr int JOB_POOL_SIZE = 1 << JOB_POOL_SIZE_BITS;
+constexpr int JOB_DEQUE_CAPACITY = JOB_POOL_SIZE;
+constexpr int MAX_JOB_CONTINUATIONS = 16;
+constexpr int MAX_PARALLEL_FOR_BATCHES = JOB_POOL_SIZE / 8;	// Batches grow past this so a root never laps the pool.
+constexpr int MAX_JOB_THREADS = 32;
+
+typedef void (*JobFunction)( void* userData );
+typedef void (*JobRangeFunction)( void* userData, int beginIndex, int endIndex );
+
+struct JobHandle
+{
+	uint32_t id = 0;	// Zero is never handed out.
+
+	bool IsNull() const { return id == 0; }
+};
+
+struct JobSystemStats
+{
+	int workerCount = 0;
+	uint64_t jobsRun = 0;
+	uint64_t jobsStolen = 0;
+	uint64_t jobsRunInline = 0;		// Deque was full, ran on the spot.
+	double busyMs = 0.0;			// Summed over every thread.
+};
+
+//--------------------------------------------------------------------------
+// Chase-Lev deque of job ids, fixed capacity. Push and Pop are for the
+// owning thread only, Steal is for everyone else.
+//--------------------------------------------------------------------------
+class JobDeque
+{
+public:
+	bool Push( uint32_t jobId );
+	bool Pop( uint32_t* out_jobId );
+	bool Steal( uint32_t* out_jobId );
+
+private:
+	std::atomic<int64_t> m_top { 0 };
+	std::atomic<int64_t> m_bottom { 0 };
+	std::atomic<uint32_t> m_jobIds[JOB_DEQUE_CAPACITY];
+};
+
+//--------------------------------------------------------------------------
+class JobSystem
+{
+public:
+	explicit JobSystem( int workerCount );	// Less than zero picks one per spare core.
+	~JobSystem();
+
+	JobHandle CreateJob( const char* name, JobFunction function, void* userData );
+	void AddDependency( JobHandle job, JobHandle dependsOn );	// Before the job is submitted.
+	void Submit( JobHandle job );
+
+	// Create, depend and submit in one go.
+	JobHandle Schedule( const char* name, JobFunction function, void* userData, const JobHandle* dependencies = nullptr, int dependencyCount = 0 );
+
+	// Splits [0, count) into batches of batchSize and runs them as children of
+	// the returned job, which completes when every batch has. Batches grow
+	// when there would be more than MAX_PARALLEL_FOR_BATCHES of them.
+	JobHandle ParallelFor( const char* name, int count, int batchSize, JobRangeFunction function, void* userData, const JobHandle* dependencies = nullptr, int dependencyCount = 0 );
+
+	// Runs other jobs while waiting, so it's fine to call from inside a job.
+	void Wait( JobHandle job );
+	bool IsComplete( JobHandle job ) const;
+	double GetJobMilliseconds( JobHandle job ) const;	// Zero until it has run.
+
+	void EndFrame();
+	int GetWorkerCount() const { return (int) m_workers.size(); }
+	int GetThreadCount() const { return m_threadCount; }
+	static int GetCurrentThreadIndex();		// 0 for the main thread, -1 for threads the job system doesn't own.
+	const JobSystemStats& GetLastFrameStats() const { return m_lastFrameStats; }
+
+private:
+	struct Job
+	{
+		std::atomic<uint32_t> id { 0 };
+		const char* name = nullptr;
+		JobFunction function = nullptr;
+		JobRangeFunction rangeFunction = nullptr;
+		void* userData = nullptr;
+		int beginIndex = 0;
+		int endIndex = 0;
+		int batchSize = 0;							// Non zero for a ParallelFor root.
+		uint32_t parentId = 0;
+		double durationMs = 0.0;
+
+		std::atomic<int> unfinishedCount { 0 };		// Itself plus unfinished children.
+		std::atomic<int> pendingDependencies { 0 };	// Plus one until submitted.
+		std::atomic<bool> isFinished { false };
+
+		std::atomic_flag continuationLock = ATOMIC_FLAG_INIT;
+		int continuationCount = 0;
+		uint32_t continuations[MAX_JOB_CONTINUATIONS];
+	};
+
+	Job& GetJob( uint32_t jobId ) { return m_jobs[jobId & ( JOB_POOL_SIZE - 1 )]; }
+	const Job& GetJob( uint32_t jobId ) const { return m_jobs[jobId & ( JOB_POOL_SIZE - 1 )]; }
+
+	uint32_t AllocateJob( const char* name );
+	bool IsRunningOnThisThread( uint32_t jobId ) const;
+	void Enqueue( uint32_t jobId );
+	bool TryRunOneJob( int threadIndex );
+	void Execute( uint32_t jobId, int threadIndex );
+	void FinishJob( uint32_t jobId );
+	void WorkerMain( int threadIndex );
+
+private:
+	Job* m_jobs = nullptr;
+	std::atomic<uint32_t> m_nextJobId { 1 };
+	JobDeque* m_deques = nullptr;
+	int m_threadCount = 1;
+	std::vector<std::thread> m_workers;
+
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wakeCondition;
+	std::atomic<int> m_queuedJobs { 0 };
+	std::atomic<bool> m_isQuitting { false };
+
+	std::atomic<uint64_t> m_jobsRun { 0 };
+	std::atomic<uint64_t> m_jobsStolen { 0 };
+	std::atomic<uint64_t> m_jobsRunInline { 0 };
+	std::atomic<uint64_t> m_busyNs { 0 };
+	JobSystemStats m_lastFrameStats;
+};
@@ -0,0 +1,240 @@
+#if defined(GAME_HEADLESS)
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/XML/XMLUtils.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/App.hpp"
+#include "Game/Game.hpp"
+#include "Game/Benchmarks.hpp"
+#include "Game/Checks.hpp"
+#include "Game/GameProfiler.hpp"
+#include "Game/DialogueBankBuilder.hpp"
+#include "Game/FrameScheduler.hpp"
+#include "Game/BuildSolver.hpp"
+#include "Game/JobSystem.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+//-----------------------------------------------------------------------------------------------
+// Headless entry point: no window, no GPU, no audio. Drives App::RunFrame as fast as the
+// simulation allows so we can measure raw ticks/second and soak the game logic on build boxes.
+//
+// Usage: LudumDare_Headless [-ticks=N] [-sessions=N] [-entities=N] [-inputHz=N] [-bench=collision|pieces|shapes] [-trace=file.json]
+//        LudumDare_Headless -replay=input.journal
+//        LudumDare_Headless -check
+//        LudumDare_Headless -compileDialogue [-dialogueXml=in.xml] [-dialogueBank=out.dlgb]
+//        LudumDare_Headless -solve=target.glvl [-start=start.glvl] [-beam=N] [-maxDepth=N] [-threads=N]
+//
+constexpr int DEFAULT_HEADLESS_TICKS = 10000;
+constexpr int DEFAULT_HEADLESS_SESSIONS = 1;
+
+
+//-----------------------------------------------------------------------------------------------
+static int ParseIntArg( int argc, char** argv, const char* name, int defaultValue )
+{
+	size_t nameLength = strlen( name );
+	for( int argIdx = 1; argIdx < argc; ++argIdx )
+	{
+		const char* arg = argv[argIdx];
+		if( arg[0] == '-' && strncmp( arg + 1, name, nameLength ) == 0 && arg[nameLength + 1] == '=' )
+		{
+			return atoi( arg + nameLength + 2 );
+		}
+	}
+	return defaultValue;
+}
+
+//-----------------------------------------------------------------------------------------------
+static const char* ParseStringArg( int argc, char** argv, const char* name, const char* defaultValue )
+{
+	size_t nameLength = strlen( name );
+	for( int argIdx = 1; argIdx < argc; ++argIdx )
+	{
+		const char* arg = argv[argIdx];
+		if( arg[0] == '-' && strncmp( arg + 1, name, nameLength ) == 0 && arg[nameLength + 1] == '=' )
+		{
+			return arg + nameLength + 2;
+		}
+	}
+	return defaultValue;
+}
+
+//-----------------------------------------------------------------------------------------------
+static bool HasArg( int argc, char** argv, const char* arg )
+{
+	for( int argIdx = 1; argIdx < argc; ++argIdx )
+	{
+		if( strcmp( argv[argIdx], arg ) == 0 )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------------------------
+void Startup()
+{
+	tinyxml2::XMLDocument config;
+	config.LoadFile("Data/GameConfig.xml");
+	XmlElement* root = config.RootElement();
+	if( root )
+	{
+		g_gameConfigBlackboard.PopulateFromXmlElementAttributes(*root);
+	}
+	g_theApp = new App();
+	g_theApp->Startup();
+
+	// One tick per frame, as fast as they run.
+	g_theApp->GetFrameScheduler()->SetLockstep( true );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Shutdown()
+{
+	g_theApp->Shutdown();
+
+	delete g_theApp;
+	g_theApp = nullptr;
+}
+
+//-----------------------------------------------------------------------------------------------
+// Replays a recorded input journal as fast as possible and checks the final state against the
+// hash stored at the end of the recording. Returns non zero on a mismatch.
+//
+static int RunReplay( const char* journalPath )
+{
+	if( !g_theApp->BeginReplay( journalPath ) )
+	{
+		printf( "could not load input journal %s\n", journalPath );
+		Shutdown();
+		return 1;
+	}
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+	while( !g_theApp->IsReplayFinished() && !g_theApp->IsQuitting() )
+	{
+		g_theApp->RunFrame();
+	}
+	auto endTime = std::chrono::high_resolution_clock::now();
+
+	unsigned long long ticks = (unsigned long long) g_theApp->GetSimulationTick();
+	unsigned long long stateHash = (unsigned long long) g_theGame->ComputeStateHash();
+	unsigned long long expectedHash = (unsigned long long) g_theApp->GetExpectedReplayHash();
+	Shutdown();
+
+	double elapsedSeconds = std::chrono::duration<double>( endTime - startTime ).count();
+	double ticksPerSecond = elapsedSeconds > 0.0 ? (double) ticks / elapsedSeconds : 0.0;
+	bool isMatch = stateHash == expectedHash;
+	printf( "replay ticks: %llu  seconds: %.3f  ticks/sec: %.1f  hash: %016llx  expected: %016llx  %s\n", ticks, elapsedSeconds, ticksPerSecond, stateHash, expectedHash, isMatch ? "MATCH" : "MISMATCH" );
+	return isMatch ? 0 : 2;
+}
+
+//-----------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+	int numTicks = ParseIntArg( argc, argv, "ticks", DEFAULT_HEADLESS_TICKS );
+	int numSessions = ParseIntArg( argc, argv, "sessions", DEFAULT_HEADLESS_SESSIONS );
+	int numEntities = ParseIntArg( argc, argv, "entities", 0 );
+	int inputHz = ParseIntArg( argc, argv, "inputHz", 0 );
+	const char* tracePath = ParseStringArg( argc, argv, "trace", nullptr );
+
+	if( HasArg( argc, argv, "-compileDialogue" ) )
+	{
+		const char* xmlPath = ParseStringArg( argc, argv, "dialogueXml", DIALOGUE_XML_PATH );
+		const char* bankPath = ParseStringArg( argc, argv, "dialogueBank", DIALOGUE_BANK_PATH );
+		return CompileDialogueBank( xmlPath, bankPath ) ? 0 : 1;
+	}
+
+	// Every block of the target level is the build to reach. Exits non zero
+	// if no solution is found, so level validation can run on build boxes.
+	const char* solvePath = ParseStringArg( argc, argv, "solve", nullptr );
+	if( solvePath != nullptr )
+	{
+		BuildSolverSettings settings;
+		settings.beamWidth = ParseIntArg( argc, argv, "beam", DEFAULT_SOLVER_BEAM_WIDTH );
+		settings.maxDepth = ParseIntArg( argc, argv, "maxDepth", 0 );
+		JobSystem jobSystem( ParseIntArg( argc, argv, "threads", -1 ) );
+		return RunBuildSolver( solvePath, ParseStringArg( argc, argv, "start", "" ), settings, &jobSystem );
+	}
+
+	// Exits non zero if any check fails, for build boxes.
+	if( HasArg( argc, argv, "-check" ) )
+	{
+		return RunChecks() == 0 ? 0 : 1;
+	}
+
+	if( HasArg( argc, argv, "-bench=collision" ) )
+	{
+		RunCollisionBenchmark();
+		return 0;
+	}
+
+	if( HasArg( argc, argv, "-bench=pieces" ) )
+	{
+		RunPieceBenchmark();
+		return 0;
+	}
+
+	if( HasArg( argc, argv, "-bench=shapes" ) )
+	{
+		RunShapeBenchmark();
+		return 0;
+	}
+
+	Startup();
+
+	const char* replayPath = ParseStringArg( argc, argv, "replay", nullptr );
+	if( replayPath != nullptr )
+	{
+		return RunReplay( replayPath );
+	}
+
+	// Stand-in keyboard on its own thread, so the input queue and its latency
+	// numbers get exercised without a window.
+	if( inputHz > 0 )
+	{
+		g_theApp->StartInputSampler( (float) inputHz );
+	}
+
+	long long totalTicks = 0;
+	auto startTime = std::chrono::high_resolution_clock::now();
+	for( int sessionIdx = 0; sessionIdx < numSessions && !g_theApp->IsQuitting(); ++sessionIdx )
+	{
+		if( sessionIdx > 0 )
+		{
+			g_theApp->RestartGame();
+		}
+		g_theApp->SpawnStartEntities( numEntities );
+
+		for( int tickIdx = 0; tickIdx < numTicks && !g_theApp->IsQuitting(); ++tickIdx )
+		{
+			g_theApp->RunFrame();
+			++totalTicks;
+		}
+	}
+	auto endTime = std::chrono::high_resolution_clock::now();
+	InputLatencyStats inputStats = g_theApp->GetInputLatencyStats();
+
+	if( tracePath != nullptr && !GameProfilerExportChromeTrace( tracePath ) )
+	{
+		printf( "could not write trace to %s\n", tracePath );
+	}
+	Shutdown();
+
+	double elapsedSeconds = std::chrono::duration<double>( endTime - startTime ).count();
+	double ticksPerSecond = elapsedSeconds > 0.0 ? (double) totalTicks / elapsedSeconds : 0.0;
+	printf( "sessions: %d  ticks: %lld  seconds: %.3f  ticks/sec: %.1f\n", numSessions, totalTicks, elapsedSeconds, ticksPerSecond );
+	if( inputHz > 0 )
+	{
+		double averageMs = inputStats.totalEvents > 0 ? inputStats.totalMs / (double) inputStats.totalEvents : 0.0;
+		printf( "input events: %llu  dropped: %llu  latency avg ms: %.3f  max ms: %.3f\n", (unsigned long long) inputStats.totalEvents, (unsigned long long) inputStats.droppedEvents, averageMs, inputStats.maxMs );
+	}
+	return 0;
+}
+
+#endif
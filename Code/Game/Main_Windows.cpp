@@ -1,5 +1,8 @@
+#if !defined(GAME_HEADLESS)
 #define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
 #include <windows.h>			// #include this (massive, platform-specific) header in very few places
+#include <mmsystem.h>			// timeBeginPeriod, so frame pacing sleeps wake on time
+#pragma comment( lib, "winmm.lib" )
 #include <math.h>
 #include <cassert>
 #include <crtdbg.h>
@@ -58,32 +61,23 @@ static bool AppWindowProc( void* windowHandle, uint32_t wmMessageCode, uintptr_t
 	}
 
 	// Raw physical keyboard "key-was-just-depressed" event (case-insensitive, not translated)
+	// Keys are queued with the time they came in and applied at the start of the next
+	// simulation tick, ESC included (App handles the console/quit part).
 	case WM_KEYDOWN:
 	{
 		unsigned char asKey = (unsigned char) wParam;
-		g_theApp->HandleKeyPressed(asKey);
-
-		if( asKey == VK_ESCAPE )
-		{
-			if( !g_theConsole->HandleESCPress() )
-			{
-				g_theEventSystem->FireEvent( "quit" );
-			}
-			//g_theApp->HandleQuitRequested();
-			return true; 
-		}
-
+		g_theApp->QueueInput( INPUT_EVENT_KEY_DOWN, asKey );
 		return true;
-		break;
 	}
 
 	// Raw physical keyboard "key-was-just-released" event (case-insensitive, not translated)
 	case WM_KEYUP:
 	{
 		unsigned char asKey = (unsigned char) wParam;
-		if(g_theApp->HandleKeyReleased(asKey))
+		g_theApp->QueueInput( INPUT_EVENT_KEY_UP, asKey );
+		if( g_theApp->IsKeyReleaseConsumed( asKey ) )
 		{
-			return true; 
+			return true;
 		}
 
 		break;
@@ -91,7 +85,8 @@ static bool AppWindowProc( void* windowHandle, uint32_t wmMessageCode, uintptr_t
 	case WM_CHAR:
 	{
 		unsigned char asKey = (unsigned char) wParam;
-		if(g_theApp->HandleCharPressed(asKey))
+		g_theApp->QueueInput( INPUT_EVENT_CHAR, asKey );
+		if( g_theApp->IsCharConsumed( asKey ) )
 		{
 			return true;
 		}
@@ -145,6 +140,20 @@ void RunMessagePump()
 	g_theWindowContext->BeginFrame(); 
 }
 
+//-----------------------------------------------------------------------------------------------
+// Keyboard messages only, for App to sample input between simulation ticks. Anything else
+// waits for the next frame's full pump.
+//
+static void PumpKeyboardMessages()
+{
+	MSG message;
+	while( PeekMessage( &message, nullptr, WM_KEYFIRST, WM_KEYLAST, PM_REMOVE ) )
+	{
+		TranslateMessage( &message );
+		DispatchMessage( &message );
+	}
+}
+
 //-----------------------------------------------------------------------------------------------
 // One "frame" of the game.  Generally: Input, Update, Render.  We call this 60+ times per second.
 //
@@ -165,6 +174,7 @@ void Startup()
 	CreateWindowAndRenderContext( CLIENT_ASPECT );
 	g_theApp = new App();
 	g_theApp->Startup();
+	g_theApp->SetInputPump( PumpKeyboardMessages );
 }
 
 
@@ -190,16 +200,19 @@ int WINAPI WinMain( HINSTANCE applicationInstanceHandle, HINSTANCE, LPSTR comman
 	UNUSED( commandLineString );
 
 	Startup();
-
+	timeBeginPeriod( 1 );
 
 	// Program main loop; keep running frames until it's time to quit
 	while( !g_theApp->IsQuitting()) 
 	{
 		RunFrame();
 		//SwapBuffers( g_displayDeviceContext );
-		Sleep(0);
+		g_theApp->WaitForNextFrame();
 	}
 
+	timeEndPeriod( 1 );
 	Shutdown();
 	return 0;
 }
+
+#endif
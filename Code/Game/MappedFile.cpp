@@ -0,0 +1,120 @@
+#include "Game/MappedFile.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//--------------------------------------------------------------------------
+/**
+* ~MappedFile
+*/
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+//--------------------------------------------------------------------------
+/**
+* Open
+* Empty files fail to open, there is nothing to map.
+*/
+bool MappedFile::Open( const std::string& filePath )
+{
+	Close();
+
+#if defined(_WIN32)
+	HANDLE fileHandle = CreateFileA( filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if( fileHandle == INVALID_HANDLE_VALUE )
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if( !GetFileSizeEx( fileHandle, &fileSize ) || fileSize.QuadPart == 0 )
+	{
+		CloseHandle( fileHandle );
+		return false;
+	}
+
+	HANDLE mappingHandle = CreateFileMappingA( fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	if( mappingHandle == nullptr )
+	{
+		CloseHandle( fileHandle );
+		return false;
+	}
+
+	void* view = MapViewOfFile( mappingHandle, FILE_MAP_READ, 0, 0, 0 );
+	if( view == nullptr )
+	{
+		CloseHandle( mappingHandle );
+		CloseHandle( fileHandle );
+		return false;
+	}
+
+	m_fileHandle = fileHandle;
+	m_mappingHandle = mappingHandle;
+	m_data = (const uint8_t*) view;
+	m_size = (size_t) fileSize.QuadPart;
+#else
+	int fileDescriptor = open( filePath.c_str(), O_RDONLY );
+	if( fileDescriptor < 0 )
+	{
+		return false;
+	}
+
+	struct stat fileStat;
+	if( fstat( fileDescriptor, &fileStat ) != 0 || fileStat.st_size == 0 )
+	{
+		close( fileDescriptor );
+		return false;
+	}
+
+	void* view = mmap( nullptr, (size_t) fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0 );
+	close( fileDescriptor );	// The mapping keeps its own reference to the file.
+	if( view == MAP_FAILED )
+	{
+		return false;
+	}
+
+	m_data = (const uint8_t*) view;
+	m_size = (size_t) fileStat.st_size;
+#endif
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Close
+*/
+void MappedFile::Close()
+{
+#if defined(_WIN32)
+	if( m_data != nullptr )
+	{
+		UnmapViewOfFile( m_data );
+	}
+	if( m_mappingHandle != nullptr )
+	{
+		CloseHandle( (HANDLE) m_mappingHandle );
+	}
+	if( m_fileHandle != nullptr )
+	{
+		CloseHandle( (HANDLE) m_fileHandle );
+	}
+	m_mappingHandle = nullptr;
+	m_fileHandle = nullptr;
+#else
+	if( m_data != nullptr )
+	{
+		munmap( (void*) m_data, m_size );
+	}
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+//--------------------------------------------------------------------------
+// Read only view of a whole file through the OS page cache. The pages are
+// shared with every other mapping of the file and only faulted in when
+// touched, so opening a large asset costs a couple of system calls rather
+// than a read and a copy.
+//--------------------------------------------------------------------------
+class MappedFile
+{
+public:
+	MappedFile() {}
+	~MappedFile();
+
+	MappedFile( const MappedFile& ) = delete;
+	MappedFile& operator=( const MappedFile& ) = delete;
+
+	bool Open( const std::string& filePath );
+	void Close();
+
+	bool IsOpen() const { return m_data != nullptr; }
+	const uint8_t* GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+private:
+	const uint8_t* m_data = nullptr;
+	size_t m_size = 0;
+#if defined(_WIN32)
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,190 @@
+#include "Game/RenderCommandBuffer.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/DiscBatcher.hpp"
+#include "Game/EngineBackends.hpp"
+#include "Game/GameProfiler.hpp"
+
+//--------------------------------------------------------------------------
+/**
+* RenderCommandBuffer
+*/
+RenderCommandBuffer::RenderCommandBuffer()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~RenderCommandBuffer
+*/
+RenderCommandBuffer::~RenderCommandBuffer()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* Reset
+* Keeps the capacity, a frame is usually about the size of the last one.
+* Drops this buffer's hold on shared vertex arrays.
+*/
+void RenderCommandBuffer::Reset()
+{
+	m_commands.clear();
+	m_vertices.clear();
+	m_sharedVertexArrays.clear();
+	m_sharedVertexCount = 0;
+	m_discs.clear();
+	m_firstUnflushedDisc = 0;
+}
+
+//--------------------------------------------------------------------------
+/**
+* ClearScreen
+*/
+void RenderCommandBuffer::ClearScreen( const Rgba& color )
+{
+	RenderCommand command;
+	command.type = RENDER_COMMAND_CLEAR_SCREEN;
+	command.clearColor = color;
+	m_commands.push_back( command );
+}
+
+//--------------------------------------------------------------------------
+/**
+* BeginCamera
+*/
+void RenderCommandBuffer::BeginCamera( Camera* camera )
+{
+	RenderCommand command;
+	command.type = RENDER_COMMAND_BEGIN_CAMERA;
+	command.camera = camera;
+	m_commands.push_back( command );
+}
+
+//--------------------------------------------------------------------------
+/**
+* DrawVertexArray
+*/
+void RenderCommandBuffer::DrawVertexArray( int vertexCount, const Vertex_PCU* vertices )
+{
+	if( vertexCount <= 0 )
+	{
+		return;
+	}
+
+	RenderCommand command;
+	command.type = RENDER_COMMAND_DRAW_VERTICES;
+	command.first = (uint32_t) m_vertices.size();
+	command.count = (uint32_t) vertexCount;
+	m_vertices.insert( m_vertices.end(), vertices, vertices + vertexCount );
+	m_commands.push_back( command );
+}
+
+//--------------------------------------------------------------------------
+/**
+* DrawVertexArray
+* Keeps a reference instead of copying, so a draw costs the same whatever
+* its size.
+*/
+void RenderCommandBuffer::DrawVertexArray( const SharedVertexArray& vertices )
+{
+	if( !vertices || vertices->empty() )
+	{
+		return;
+	}
+
+	RenderCommand command;
+	command.type = RENDER_COMMAND_DRAW_SHARED_VERTICES;
+	command.first = (uint32_t) m_sharedVertexArrays.size();
+	command.count = (uint32_t) vertices->size();
+	m_sharedVertexArrays.push_back( vertices );
+	m_sharedVertexCount += vertices->size();
+	m_commands.push_back( command );
+}
+
+//--------------------------------------------------------------------------
+/**
+* AddDisc
+* Held until FlushDiscs, the render thread builds the triangles.
+*/
+void RenderCommandBuffer::AddDisc( const Vec3& center, float radius, const Rgba& color )
+{
+	RenderDisc disc;
+	disc.center = center;
+	disc.radius = radius;
+	disc.color = color;
+	m_discs.push_back( disc );
+}
+
+//--------------------------------------------------------------------------
+/**
+* FlushDiscs
+* Every disc added since the last flush becomes one batched draw here.
+*/
+void RenderCommandBuffer::FlushDiscs()
+{
+	uint32_t discCount = (uint32_t) m_discs.size() - m_firstUnflushedDisc;
+	if( discCount == 0 )
+	{
+		return;
+	}
+
+	RenderCommand command;
+	command.type = RENDER_COMMAND_DRAW_DISCS;
+	command.first = m_firstUnflushedDisc;
+	command.count = discCount;
+	m_commands.push_back( command );
+	m_firstUnflushedDisc = (uint32_t) m_discs.size();
+}
+
+//--------------------------------------------------------------------------
+/**
+* AddCallback
+*/
+void RenderCommandBuffer::AddCallback( RenderCallback callback, void* userData )
+{
+	RenderCommand command;
+	command.type = RENDER_COMMAND_CALLBACK;
+	command.callback = callback;
+	command.userData = userData;
+	m_commands.push_back( command );
+}
+
+//--------------------------------------------------------------------------
+/**
+* Execute
+* Replays the frame in order. Only the thread that currently owns the
+* renderer may call this.
+*/
+void RenderCommandBuffer::Execute( DiscBatcher& discBatcher ) const
+{
+	GAME_PROFILE_SCOPE( "RenderCommandBuffer::Execute" );
+	for( const RenderCommand& command : m_commands )
+	{
+		switch( command.type )
+		{
+		case RENDER_COMMAND_CLEAR_SCREEN:
+			g_theEngineBackends->ClearScreen( command.clearColor );
+			break;
+		case RENDER_COMMAND_BEGIN_CAMERA:
+			g_theEngineBackends->BeginCamera( command.camera );
+			break;
+		case RENDER_COMMAND_DRAW_VERTICES:
+			g_theEngineBackends->DrawVertexArray( (int) command.count, &m_vertices[command.first] );
+			break;
+		case RENDER_COMMAND_DRAW_SHARED_VERTICES:
+			g_theEngineBackends->DrawVertexArray( (int) command.count, m_sharedVertexArrays[command.first]->data() );
+			break;
+		case RENDER_COMMAND_DRAW_DISCS:
+			for( uint32_t discIdx = command.first; discIdx < command.first + command.count; ++discIdx )
+			{
+				const RenderDisc& disc = m_discs[discIdx];
+				discBatcher.AddDisc( disc.center, disc.radius, disc.color );
+			}
+			discBatcher.Flush();
+			break;
+		case RENDER_COMMAND_CALLBACK:
+			command.callback( command.userData );
+			break;
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "Engine/Core/Vertex/Vertex_PCU.hpp"
+#include "Engine/Core/Graphics/Rgba.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+class Camera;
+class DiscBatcher;
+
+typedef void (*RenderCallback)( void* userData );
+typedef std::shared_ptr<const std::vector<Vertex_PCU>> SharedVertexArray;
+
+//--------------------------------------------------------------------------
+// One frame of draw work, recorded on the main thread and replayed against
+// the renderer by the RenderThread. Vertices and discs are copied in, so
+// nothing recorded points at simulation state. A SharedVertexArray is never
+// edited once built (its owner swaps in a new one instead), so it's held by
+// reference rather than copied, and let go at the buffer's next Reset, once
+// the frame's fence has passed. Cameras and callback data are pointers and
+// must stay untouched until the frame's fence passes.
+// Beginning a camera points it at the renderer's current targets, so
+// only the render thread asks the renderer for them.
+//--------------------------------------------------------------------------
+enum eRenderCommandType : uint8_t
+{
+	RENDER_COMMAND_CLEAR_SCREEN,
+	RENDER_COMMAND_BEGIN_CAMERA,
+	RENDER_COMMAND_DRAW_VERTICES,		// m_vertices[first, first + count)
+	RENDER_COMMAND_DRAW_SHARED_VERTICES,	// All of m_sharedVertexArrays[first]
+	RENDER_COMMAND_DRAW_DISCS,			// m_discs[first, first + count) in one batch
+	RENDER_COMMAND_CALLBACK,			// For engine systems that draw themselves.
+};
+
+struct RenderCommand
+{
+	eRenderCommandType type = RENDER_COMMAND_CALLBACK;
+	uint32_t first = 0;
+	uint32_t count = 0;
+	Camera* camera = nullptr;
+	RenderCallback callback = nullptr;
+	void* userData = nullptr;
+	Rgba clearColor;
+};
+
+struct RenderDisc
+{
+	Vec3 center;
+	float radius = 0.0f;
+	Rgba color;
+};
+
+//--------------------------------------------------------------------------
+class RenderCommandBuffer
+{
+public:
+	RenderCommandBuffer();
+	~RenderCommandBuffer();
+
+	void Reset();
+
+	void ClearScreen( const Rgba& color );
+	void BeginCamera( Camera* camera );
+	void DrawVertexArray( int vertexCount, const Vertex_PCU* vertices );
+	void DrawVertexArray( const SharedVertexArray& vertices );
+	void AddDisc( const Vec3& center, float radius, const Rgba& color );
+	void FlushDiscs();
+	void AddCallback( RenderCallback callback, void* userData );
+
+	void Execute( DiscBatcher& discBatcher ) const;
+
+	int GetCommandCount() const { return (int) m_commands.size(); }
+	int GetVertexCount() const { return (int) ( m_vertices.size() + m_sharedVertexCount ); }
+	int GetDiscCount() const { return (int) m_discs.size(); }
+
+private:
+	std::vector<RenderCommand> m_commands;
+	std::vector<Vertex_PCU> m_vertices;
+	std::vector<SharedVertexArray> m_sharedVertexArrays;
+	size_t m_sharedVertexCount = 0;
+	std::vector<RenderDisc> m_discs;
+	uint32_t m_firstUnflushedDisc = 0;
+};
@@ -0,0 +1,165 @@
+#include "Game/RenderThread.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/DiscBatcher.hpp"
+#include "Game/GameProfiler.hpp"
+
+//--------------------------------------------------------------------------
+/**
+* RenderThread
+*/
+RenderThread::RenderThread()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~RenderThread
+*/
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+//--------------------------------------------------------------------------
+/**
+* Start
+*/
+void RenderThread::Start( bool useThread )
+{
+	if( useThread && !m_thread.joinable() )
+	{
+		m_isQuitting = false;
+		m_thread = std::thread( &RenderThread::ThreadMain, this );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* Stop
+* Every submitted frame still executes before the thread exits.
+*/
+void RenderThread::Stop()
+{
+	if( !m_thread.joinable() )
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_isQuitting = true;
+	}
+	m_submitCondition.notify_one();
+	m_thread.join();
+}
+
+//--------------------------------------------------------------------------
+/**
+* BeginFrame
+* Hands out the next frame's buffer once the frame that last used it has
+* executed.
+*/
+RenderCommandBuffer& RenderThread::BeginFrame()
+{
+	m_stats.waitMs = 0.0;
+	m_stats.executeMs = (double) m_lastExecuteNs.load( std::memory_order_relaxed ) * 0.000001;
+
+	m_recordingFrame = m_submittedFrame + 1;
+	if( m_recordingFrame > RENDER_FRAME_BUFFER_COUNT )
+	{
+		WaitForFence( m_recordingFrame - RENDER_FRAME_BUFFER_COUNT );
+	}
+
+	RenderCommandBuffer& buffer = m_buffers[m_recordingFrame % RENDER_FRAME_BUFFER_COUNT];
+	buffer.Reset();
+	return buffer;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Submit
+* Returns the frame number to wait on.
+*/
+uint64_t RenderThread::Submit()
+{
+	ASSERT_RECOVERABLE( m_recordingFrame == m_submittedFrame + 1, "RenderThread::Submit without BeginFrame" );
+	m_submittedFrame = m_recordingFrame;
+
+	const RenderCommandBuffer& buffer = m_buffers[m_submittedFrame % RENDER_FRAME_BUFFER_COUNT];
+	m_stats.commandCount = buffer.GetCommandCount();
+	m_stats.vertexCount = buffer.GetVertexCount();
+	m_stats.discCount = buffer.GetDiscCount();
+
+	if( !m_thread.joinable() )
+	{
+		ExecuteFrame( m_submittedFrame );
+		return m_submittedFrame;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_frameToExecute = m_submittedFrame;
+	}
+	m_submitCondition.notify_one();
+	return m_submittedFrame;
+}
+
+//--------------------------------------------------------------------------
+/**
+* WaitForFence
+*/
+void RenderThread::WaitForFence( uint64_t frameNumber )
+{
+	if( m_completedFrame.load( std::memory_order_acquire ) >= frameNumber )
+	{
+		return;
+	}
+
+	GAME_PROFILE_SCOPE( "RenderThread::WaitForFence" );
+	uint64_t startNs = GameProfilerNowNs();
+	{
+		std::unique_lock<std::mutex> lock( m_mutex );
+		m_fenceCondition.wait( lock, [this, frameNumber]() { return m_completedFrame.load( std::memory_order_acquire ) >= frameNumber; } );
+	}
+	m_stats.waitMs += (double) ( GameProfilerNowNs() - startNs ) * 0.000001;
+}
+
+//--------------------------------------------------------------------------
+/**
+* ThreadMain
+*/
+void RenderThread::ThreadMain()
+{
+	GameProfilerSetThreadName( "Render" );
+
+	uint64_t nextFrame = m_completedFrame.load( std::memory_order_acquire ) + 1;
+	for( ;; )
+	{
+		{
+			std::unique_lock<std::mutex> lock( m_mutex );
+			m_submitCondition.wait( lock, [this, nextFrame]() { return m_isQuitting || m_frameToExecute >= nextFrame; } );
+			if( m_frameToExecute < nextFrame )
+			{
+				break;
+			}
+		}
+		ExecuteFrame( nextFrame );
+		++nextFrame;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* ExecuteFrame
+*/
+void RenderThread::ExecuteFrame( uint64_t frameNumber )
+{
+	uint64_t startNs = GameProfilerNowNs();
+	m_buffers[frameNumber % RENDER_FRAME_BUFFER_COUNT].Execute( *g_theDiscBatcher );
+	m_lastExecuteNs.store( GameProfilerNowNs() - startNs, std::memory_order_relaxed );
+
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_completedFrame.store( frameNumber, std::memory_order_release );
+	}
+	m_fenceCondition.notify_all();
+}
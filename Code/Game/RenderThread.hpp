@@ -0,0 +1,71 @@
+#pragma once
+#include "Game/RenderCommandBuffer.hpp"
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+//--------------------------------------------------------------------------
+// Replays recorded frames on a dedicated thread so the main thread can run
+// the next simulation ticks while the last frame is submitted.
+//
+// Frames are numbered from 1 and double buffered: frame N records into
+// buffer N % 2, which is free once frame N - 2 has executed. The fence is
+// the last frame number that finished executing. Engine systems (renderer,
+// ImGUI, console, debug render) aren't thread safe, so the main thread
+// must wait for the fence before touching them again.
+//
+// With the thread turned off, Submit executes the frame on the spot.
+//--------------------------------------------------------------------------
+constexpr int RENDER_FRAME_BUFFER_COUNT = 2;
+
+struct RenderThreadStats
+{
+	double executeMs = 0.0;		// Render thread, last frame.
+	double waitMs = 0.0;		// Main thread blocked on the fence, last frame.
+	int commandCount = 0;
+	int vertexCount = 0;
+	int discCount = 0;
+};
+
+//--------------------------------------------------------------------------
+class RenderThread
+{
+public:
+	RenderThread();
+	~RenderThread();
+
+	void Start( bool useThread );
+	void Stop();
+
+	RenderCommandBuffer& BeginFrame();
+	uint64_t Submit();
+	void WaitForFence( uint64_t frameNumber );
+	void WaitForIdle() { WaitForFence( m_submittedFrame ); }
+
+	bool IsThreaded() const { return m_thread.joinable(); }
+	uint64_t GetCompletedFrame() const { return m_completedFrame.load( std::memory_order_acquire ); }
+	const RenderThreadStats& GetStats() const { return m_stats; }
+
+private:
+	void ThreadMain();
+	void ExecuteFrame( uint64_t frameNumber );
+
+private:
+	RenderCommandBuffer m_buffers[RENDER_FRAME_BUFFER_COUNT];
+	uint64_t m_recordingFrame = 0;
+	uint64_t m_submittedFrame = 0;
+	std::atomic<uint64_t> m_completedFrame { 0 };
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_submitCondition;
+	std::condition_variable m_fenceCondition;
+	uint64_t m_frameToExecute = 0;		// Guarded by m_mutex.
+	bool m_isQuitting = false;			// Guarded by m_mutex.
+
+	RenderThreadStats m_stats;
+	std::atomic<uint64_t> m_lastExecuteNs { 0 };
+};
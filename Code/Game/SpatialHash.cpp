@@ -0,0 +1,314 @@
+#include "Game/SpatialHash.hpp"
+
+#include <math.h>
+
+constexpr int SPATIAL_HASH_MAX_CELLS_PER_AXIS = 1024;
+
+//--------------------------------------------------------------------------
+/**
+* SpatialHash
+*/
+SpatialHash::SpatialHash( const Vec2& worldMins, const Vec2& worldMaxs, float minCellSize )
+	: m_worldMins( worldMins )
+	, m_worldMaxs( worldMaxs )
+	, m_minCellSize( minCellSize )
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~SpatialHash
+*/
+SpatialHash::~SpatialHash()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* Clear
+* Forgets the added items, the last build stays queryable until the next one.
+*/
+void SpatialHash::Clear()
+{
+	m_addedX.clear();
+	m_addedY.clear();
+	m_addedRadius.clear();
+	m_addedIds.clear();
+	m_entityHandles.clear();
+}
+
+//--------------------------------------------------------------------------
+/**
+* AddItem
+*/
+void SpatialHash::AddItem( float x, float y, float radius, uint32_t id )
+{
+	m_addedX.push_back( x );
+	m_addedY.push_back( y );
+	m_addedRadius.push_back( radius );
+	m_addedIds.push_back( id );
+}
+
+//--------------------------------------------------------------------------
+/**
+* Build
+* Sizes the cells from the largest radius, then counting sorts every item
+* into its cell: count, prefix sum, scatter. O(items + cells).
+*/
+void SpatialHash::Build()
+{
+	int itemCount = (int) m_addedIds.size();
+
+	m_maxRadius = 0.0f;
+	for( int itemIdx = 0; itemIdx < itemCount; ++itemIdx )
+	{
+		m_maxRadius = m_addedRadius[itemIdx] > m_maxRadius ? m_addedRadius[itemIdx] : m_maxRadius;
+	}
+
+	float worldWidth = m_worldMaxs.x - m_worldMins.x;
+	float worldHeight = m_worldMaxs.y - m_worldMins.y;
+	m_cellSize = 2.0f * m_maxRadius > m_minCellSize ? 2.0f * m_maxRadius : m_minCellSize;
+	float largestSide = worldWidth > worldHeight ? worldWidth : worldHeight;
+	if( largestSide / m_cellSize > (float) SPATIAL_HASH_MAX_CELLS_PER_AXIS )
+	{
+		m_cellSize = largestSide / (float) SPATIAL_HASH_MAX_CELLS_PER_AXIS;
+	}
+	m_inverseCellSize = 1.0f / m_cellSize;
+	m_cellsWide = (int) ceilf( worldWidth * m_inverseCellSize );
+	m_cellsHigh = (int) ceilf( worldHeight * m_inverseCellSize );
+	m_cellsWide = m_cellsWide > 0 ? m_cellsWide : 1;
+	m_cellsHigh = m_cellsHigh > 0 ? m_cellsHigh : 1;
+
+	int cellCount = m_cellsWide * m_cellsHigh;
+	m_cellStarts.assign( (size_t) cellCount + 1, 0 );
+	m_itemCells.resize( itemCount );
+
+	for( int itemIdx = 0; itemIdx < itemCount; ++itemIdx )
+	{
+		uint32_t cell = (uint32_t) ( GetCellY( m_addedY[itemIdx] ) * m_cellsWide + GetCellX( m_addedX[itemIdx] ) );
+		m_itemCells[itemIdx] = cell;
+		++m_cellStarts[cell + 1];
+	}
+	for( int cellIdx = 0; cellIdx < cellCount; ++cellIdx )
+	{
+		m_cellStarts[cellIdx + 1] += m_cellStarts[cellIdx];
+	}
+
+	m_itemX.resize( itemCount );
+	m_itemY.resize( itemCount );
+	m_itemRadius.resize( itemCount );
+	m_itemIds.resize( itemCount );
+
+	// Scatter using a running cursor per cell, then the cursors are the starts again.
+	std::vector<uint32_t> cursors( m_cellStarts.begin(), m_cellStarts.end() - 1 );
+	for( int itemIdx = 0; itemIdx < itemCount; ++itemIdx )
+	{
+		uint32_t sortedIdx = cursors[m_itemCells[itemIdx]]++;
+		m_itemX[sortedIdx] = m_addedX[itemIdx];
+		m_itemY[sortedIdx] = m_addedY[itemIdx];
+		m_itemRadius[sortedIdx] = m_addedRadius[itemIdx];
+		m_itemIds[sortedIdx] = m_addedIds[itemIdx];
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* BuildFromEntities
+* Every entity by its physics radius, ids index GetEntityHandle.
+*/
+void SpatialHash::BuildFromEntities( const EntityStore& entities )
+{
+	Clear();
+	for( int typeIdx = 0; typeIdx < NUM_ENTITY_TYPES; ++typeIdx )
+	{
+		eEntityType type = (eEntityType) typeIdx;
+		const EntityBucket& bucket = entities.GetBucket( type );
+		for( int entityIdx = 0; entityIdx < bucket.GetCount(); ++entityIdx )
+		{
+			AddItem( bucket.positionX[entityIdx], bucket.positionY[entityIdx], bucket.physicsRadius[entityIdx], (uint32_t) m_entityHandles.size() );
+			m_entityHandles.push_back( entities.GetHandle( type, entityIdx ) );
+		}
+	}
+	Build();
+}
+
+//--------------------------------------------------------------------------
+/**
+* QueryRadius
+* Ids of every item whose circle overlaps the query circle.
+*/
+void SpatialHash::QueryRadius( const Vec2& center, float radius, std::vector<uint32_t>* out_ids ) const
+{
+	out_ids->clear();
+	if( m_itemIds.empty() )
+	{
+		return;
+	}
+
+	float reach = radius + m_maxRadius;
+	int minCellX = GetCellX( center.x - reach );
+	int maxCellX = GetCellX( center.x + reach );
+	int minCellY = GetCellY( center.y - reach );
+	int maxCellY = GetCellY( center.y + reach );
+
+	for( int cellY = minCellY; cellY <= maxCellY; ++cellY )
+	{
+		for( int cellX = minCellX; cellX <= maxCellX; ++cellX )
+		{
+			int cell = cellY * m_cellsWide + cellX;
+			for( uint32_t itemIdx = m_cellStarts[cell]; itemIdx < m_cellStarts[cell + 1]; ++itemIdx )
+			{
+				float deltaX = m_itemX[itemIdx] - center.x;
+				float deltaY = m_itemY[itemIdx] - center.y;
+				float combinedRadius = m_itemRadius[itemIdx] + radius;
+				if( deltaX * deltaX + deltaY * deltaY < combinedRadius * combinedRadius )
+				{
+					out_ids->push_back( m_itemIds[itemIdx] );
+				}
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* QueryAABB
+* Ids of every item whose circle overlaps the box.
+*/
+void SpatialHash::QueryAABB( const Vec2& mins, const Vec2& maxs, std::vector<uint32_t>* out_ids ) const
+{
+	out_ids->clear();
+	if( m_itemIds.empty() )
+	{
+		return;
+	}
+
+	int minCellX = GetCellX( mins.x - m_maxRadius );
+	int maxCellX = GetCellX( maxs.x + m_maxRadius );
+	int minCellY = GetCellY( mins.y - m_maxRadius );
+	int maxCellY = GetCellY( maxs.y + m_maxRadius );
+
+	for( int cellY = minCellY; cellY <= maxCellY; ++cellY )
+	{
+		for( int cellX = minCellX; cellX <= maxCellX; ++cellX )
+		{
+			int cell = cellY * m_cellsWide + cellX;
+			for( uint32_t itemIdx = m_cellStarts[cell]; itemIdx < m_cellStarts[cell + 1]; ++itemIdx )
+			{
+				float x = m_itemX[itemIdx];
+				float y = m_itemY[itemIdx];
+				float nearestX = x < mins.x ? mins.x : ( x > maxs.x ? maxs.x : x );
+				float nearestY = y < mins.y ? mins.y : ( y > maxs.y ? maxs.y : y );
+				float deltaX = x - nearestX;
+				float deltaY = y - nearestY;
+				float radius = m_itemRadius[itemIdx];
+				if( deltaX * deltaX + deltaY * deltaY < radius * radius || ( deltaX == 0.0f && deltaY == 0.0f ) )
+				{
+					out_ids->push_back( m_itemIds[itemIdx] );
+				}
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* FindOverlapPairs
+* Each cell is tested against itself and its right, and three upper
+* neighbours, so every neighbouring cell pair is visited exactly once.
+*/
+void SpatialHash::FindOverlapPairs( std::vector<SpatialHashPair>* out_pairs ) const
+{
+	out_pairs->clear();
+	for( int cellY = 0; cellY < m_cellsHigh; ++cellY )
+	{
+		for( int cellX = 0; cellX < m_cellsWide; ++cellX )
+		{
+			int cell = cellY * m_cellsWide + cellX;
+			if( m_cellStarts[cell] == m_cellStarts[cell + 1] )
+			{
+				continue;
+			}
+
+			TestCellPairs( cell, cell, out_pairs );
+			if( cellX + 1 < m_cellsWide )
+			{
+				TestCellPairs( cell, cell + 1, out_pairs );
+			}
+			if( cellY + 1 < m_cellsHigh )
+			{
+				int upCell = cell + m_cellsWide;
+				if( cellX > 0 )
+				{
+					TestCellPairs( cell, upCell - 1, out_pairs );
+				}
+				TestCellPairs( cell, upCell, out_pairs );
+				if( cellX + 1 < m_cellsWide )
+				{
+					TestCellPairs( cell, upCell + 1, out_pairs );
+				}
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetCellX
+*/
+int SpatialHash::GetCellX( float x ) const
+{
+	int cellX = (int) ( ( x - m_worldMins.x ) * m_inverseCellSize );
+	if( x < m_worldMins.x || cellX < 0 )
+	{
+		return 0;
+	}
+	return cellX < m_cellsWide ? cellX : m_cellsWide - 1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetCellY
+*/
+int SpatialHash::GetCellY( float y ) const
+{
+	int cellY = (int) ( ( y - m_worldMins.y ) * m_inverseCellSize );
+	if( y < m_worldMins.y || cellY < 0 )
+	{
+		return 0;
+	}
+	return cellY < m_cellsHigh ? cellY : m_cellsHigh - 1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* TestCellPairs
+* Within one cell only pairs with j > i, across two cells every combination.
+*/
+void SpatialHash::TestCellPairs( int cellA, int cellB, std::vector<SpatialHashPair>* out_pairs ) const
+{
+	uint32_t endA = m_cellStarts[cellA + 1];
+	uint32_t startB = m_cellStarts[cellB];
+	uint32_t endB = m_cellStarts[cellB + 1];
+
+	for( uint32_t itemA = m_cellStarts[cellA]; itemA < endA; ++itemA )
+	{
+		float x = m_itemX[itemA];
+		float y = m_itemY[itemA];
+		float radius = m_itemRadius[itemA];
+
+		for( uint32_t itemB = ( cellA == cellB ? itemA + 1 : startB ); itemB < endB; ++itemB )
+		{
+			float deltaX = m_itemX[itemB] - x;
+			float deltaY = m_itemY[itemB] - y;
+			float combinedRadius = m_itemRadius[itemB] + radius;
+			if( deltaX * deltaX + deltaY * deltaY < combinedRadius * combinedRadius )
+			{
+				SpatialHashPair pair;
+				pair.idA = m_itemIds[itemA];
+				pair.idB = m_itemIds[itemB];
+				out_pairs->push_back( pair );
+			}
+		}
+	}
+}
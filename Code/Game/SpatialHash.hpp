@@ -0,0 +1,77 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+
+#include "Game/EntityStore.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+//--------------------------------------------------------------------------
+// Two items whose circles overlap, by the ids they were added with.
+//--------------------------------------------------------------------------
+struct SpatialHashPair
+{
+	uint32_t idA;
+	uint32_t idB;
+};
+
+//--------------------------------------------------------------------------
+// Uniform grid broad phase over a fixed world rect. Items are circles added
+// by center and radius, then Build counting-sorts them by cell into flat
+// arrays. Cells are at least twice the biggest radius, so any overlapping
+// pair sits in the same or a neighbouring cell. Items outside the world are
+// clamped into the border cells.
+//--------------------------------------------------------------------------
+class SpatialHash
+{
+public:
+	SpatialHash( const Vec2& worldMins, const Vec2& worldMaxs, float minCellSize );
+	~SpatialHash();
+
+	void Clear();
+	void AddItem( float x, float y, float radius, uint32_t id );
+	void Build();
+	void BuildFromEntities( const EntityStore& entities );
+
+	void QueryRadius( const Vec2& center, float radius, std::vector<uint32_t>* out_ids ) const;
+	void QueryAABB( const Vec2& mins, const Vec2& maxs, std::vector<uint32_t>* out_ids ) const;
+	void FindOverlapPairs( std::vector<SpatialHashPair>* out_pairs ) const;
+
+	// Valid after BuildFromEntities, ids are indices into this table.
+	EntityHandle GetEntityHandle( uint32_t id ) const { return m_entityHandles[id]; }
+
+	int GetItemCount() const { return (int) m_itemIds.size(); }
+	float GetCellSize() const { return m_cellSize; }
+
+private:
+	int GetCellX( float x ) const;
+	int GetCellY( float y ) const;
+	void TestCellPairs( int cellA, int cellB, std::vector<SpatialHashPair>* out_pairs ) const;
+
+private:
+	Vec2 m_worldMins;
+	Vec2 m_worldMaxs;
+	float m_minCellSize = 1.0f;
+
+	float m_cellSize = 1.0f;
+	float m_inverseCellSize = 1.0f;
+	int m_cellsWide = 0;
+	int m_cellsHigh = 0;
+	float m_maxRadius = 0.0f;
+
+	// Added items, in insertion order.
+	std::vector<float> m_addedX;
+	std::vector<float> m_addedY;
+	std::vector<float> m_addedRadius;
+	std::vector<uint32_t> m_addedIds;
+
+	// Built items, sorted by cell. Cell c owns [m_cellStarts[c], m_cellStarts[c + 1]).
+	std::vector<uint32_t> m_cellStarts;
+	std::vector<float> m_itemX;
+	std::vector<float> m_itemY;
+	std::vector<float> m_itemRadius;
+	std::vector<uint32_t> m_itemIds;
+	std::vector<uint32_t> m_itemCells;
+
+	std::vector<EntityHandle> m_entityHandles;
+};
@@ -0,0 +1,358 @@
+#include "Game/TimerWheel.hpp"
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Core/EventSystem.hpp"
+
+#include <math.h>
+
+//--------------------------------------------------------------------------
+/**
+* TimerWheel
+*/
+TimerWheel::TimerWheel( float tickSeconds )
+	: m_tickSeconds( tickSeconds > 0.0f ? tickSeconds : 1.0f / 60.0f )
+{
+	for( uint32_t& head : m_listHeads )
+	{
+		head = INVALID_TIMER_INDEX;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~TimerWheel
+*/
+TimerWheel::~TimerWheel()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* Schedule
+* Calls callback( userData ) after delaySeconds of game time, then every
+* repeatSeconds if that's above zero. Always at least one tick out.
+*/
+TimerHandle TimerWheel::Schedule( float delaySeconds, TimerCallback callback, void* userData, float repeatSeconds )
+{
+	TimerHandle handle = Allocate( delaySeconds, repeatSeconds );
+	Timer& timer = m_timers[handle.index];
+	timer.callback = callback;
+	timer.userData = userData;
+	Insert( handle.index );
+	return handle;
+}
+
+//--------------------------------------------------------------------------
+/**
+* ScheduleEvent
+* Fires eventName on the event system instead of calling back.
+*/
+TimerHandle TimerWheel::ScheduleEvent( float delaySeconds, const std::string& eventName, float repeatSeconds )
+{
+	TimerHandle handle = Allocate( delaySeconds, repeatSeconds );
+	m_timers[handle.index].eventName = eventName;
+	Insert( handle.index );
+	return handle;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Cancel
+* Safe on stale handles. Leaves the handle invalid either way.
+*/
+bool TimerWheel::Cancel( TimerHandle& handle )
+{
+	bool wasPending = false;
+	if( GetTimer( handle ) != nullptr )
+	{
+		Unlink( handle.index );
+		Free( handle.index );
+		wasPending = true;
+	}
+	handle = TimerHandle();
+	return wasPending;
+}
+
+//--------------------------------------------------------------------------
+/**
+* IsPending
+*/
+bool TimerWheel::IsPending( const TimerHandle& handle ) const
+{
+	return GetTimer( handle ) != nullptr;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetSecondsRemaining
+*/
+float TimerWheel::GetSecondsRemaining( const TimerHandle& handle ) const
+{
+	const Timer* timer = GetTimer( handle );
+	if( timer == nullptr || timer->dueTick <= m_currentTick )
+	{
+		return 0.0f;
+	}
+	return (float) ( timer->dueTick - m_currentTick ) * m_tickSeconds - (float) m_accumulatedSeconds;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Advance
+* With nothing scheduled the wheel just moves its clock forward.
+*/
+void TimerWheel::Advance( float deltaSeconds )
+{
+	m_firedLastAdvance = 0;
+	m_accumulatedSeconds += deltaSeconds > 0.0f ? deltaSeconds : 0.0f;
+
+	// Tolerance so a whole tick of float time isn't lost to rounding.
+	uint64_t numTicks = (uint64_t) ( m_accumulatedSeconds / m_tickSeconds + 1e-4 );
+	m_accumulatedSeconds -= (double) numTicks * m_tickSeconds;
+	if( m_accumulatedSeconds < 0.0 )
+	{
+		m_accumulatedSeconds = 0.0;
+	}
+
+	for( uint64_t tickIdx = 0; tickIdx < numTicks; ++tickIdx )
+	{
+		if( m_pendingCount == 0 )
+		{
+			m_currentTick += numTicks - tickIdx;
+			break;
+		}
+		StepTick();
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* Allocate
+*/
+TimerHandle TimerWheel::Allocate( float delaySeconds, float repeatSeconds )
+{
+	uint32_t timerIndex;
+	if( !m_freeTimers.empty() )
+	{
+		timerIndex = m_freeTimers.back();
+		m_freeTimers.pop_back();
+	}
+	else
+	{
+		timerIndex = (uint32_t) m_timers.size();
+		m_timers.emplace_back();
+	}
+
+	Timer& timer = m_timers[timerIndex];
+	timer.dueTick = m_currentTick + SecondsToTicks( delaySeconds );
+	timer.periodTicks = repeatSeconds > 0.0f ? SecondsToTicks( repeatSeconds ) : 0;
+	timer.callback = nullptr;
+	timer.userData = nullptr;
+	timer.eventName.clear();
+	++m_pendingCount;
+
+	TimerHandle handle;
+	handle.index = timerIndex;
+	handle.generation = timer.generation;
+	return handle;
+}
+
+//--------------------------------------------------------------------------
+/**
+* SecondsToTicks
+* Rounds up, never less than one tick. The slack absorbs float error in
+* delays that are meant to be a whole number of ticks.
+*/
+uint64_t TimerWheel::SecondsToTicks( float seconds ) const
+{
+	double ticks = ceil( (double) seconds / (double) m_tickSeconds - 0.01 );
+	return ticks > 1.0 ? (uint64_t) ticks : 1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Free
+* Bumping the generation is what makes outstanding handles stale.
+*/
+void TimerWheel::Free( uint32_t timerIndex )
+{
+	Timer& timer = m_timers[timerIndex];
+	timer.generation += 1;
+	timer.listIndex = -1;
+	timer.callback = nullptr;
+	timer.userData = nullptr;
+	m_freeTimers.push_back( timerIndex );
+	--m_pendingCount;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Insert
+* Picks the level from how far away the timer is due. Anything due now or
+* in the past goes in the current level 0 slot, which is about to fire.
+*/
+void TimerWheel::Insert( uint32_t timerIndex )
+{
+	uint64_t dueTick = m_timers[timerIndex].dueTick;
+	if( dueTick <= m_currentTick )
+	{
+		Link( timerIndex, (int) ( m_currentTick & ( TIMER_WHEEL_SLOTS - 1 ) ) );
+		return;
+	}
+
+	uint64_t deltaTicks = dueTick - m_currentTick;
+	if( deltaTicks > TIMER_WHEEL_MAX_DELTA_TICKS )
+	{
+		// Parks in the top level and gets re-inserted from there.
+		dueTick = m_currentTick + TIMER_WHEEL_MAX_DELTA_TICKS;
+		deltaTicks = TIMER_WHEEL_MAX_DELTA_TICKS;
+	}
+
+	int level = 0;
+	while( level < TIMER_WHEEL_LEVELS - 1 && deltaTicks >= ( 1ull << ( TIMER_WHEEL_SLOT_BITS * ( level + 1 ) ) ) )
+	{
+		++level;
+	}
+	int slot = (int) ( ( dueTick >> ( TIMER_WHEEL_SLOT_BITS * level ) ) & ( TIMER_WHEEL_SLOTS - 1 ) );
+	Link( timerIndex, level * TIMER_WHEEL_SLOTS + slot );
+}
+
+//--------------------------------------------------------------------------
+/**
+* Link
+*/
+void TimerWheel::Link( uint32_t timerIndex, int listIndex )
+{
+	Timer& timer = m_timers[timerIndex];
+	timer.listIndex = listIndex;
+	timer.prev = INVALID_TIMER_INDEX;
+	timer.next = m_listHeads[listIndex];
+	if( timer.next != INVALID_TIMER_INDEX )
+	{
+		m_timers[timer.next].prev = timerIndex;
+	}
+	m_listHeads[listIndex] = timerIndex;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Unlink
+*/
+void TimerWheel::Unlink( uint32_t timerIndex )
+{
+	Timer& timer = m_timers[timerIndex];
+	if( timer.prev != INVALID_TIMER_INDEX )
+	{
+		m_timers[timer.prev].next = timer.next;
+	}
+	else
+	{
+		m_listHeads[timer.listIndex] = timer.next;
+	}
+	if( timer.next != INVALID_TIMER_INDEX )
+	{
+		m_timers[timer.next].prev = timer.prev;
+	}
+	timer.prev = INVALID_TIMER_INDEX;
+	timer.next = INVALID_TIMER_INDEX;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Cascade
+* Moves every timer in a coarse slot down to where it now belongs.
+*/
+void TimerWheel::Cascade( int level, int slot )
+{
+	int listIndex = level * TIMER_WHEEL_SLOTS + slot;
+	uint32_t timerIndex = m_listHeads[listIndex];
+	m_listHeads[listIndex] = INVALID_TIMER_INDEX;
+	while( timerIndex != INVALID_TIMER_INDEX )
+	{
+		uint32_t nextIndex = m_timers[timerIndex].next;
+		Insert( timerIndex );
+		timerIndex = nextIndex;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* StepTick
+* Callbacks may schedule or cancel anything, including timers still
+* waiting to fire this tick, so they're moved to their own list first and
+* taken off it one at a time.
+*/
+void TimerWheel::StepTick()
+{
+	++m_currentTick;
+
+	// Wrapping a level brings the matching slot of the level above down,
+	// highest first so timers can fall more than one level.
+	int wrappedLevels = 0;
+	while( wrappedLevels < TIMER_WHEEL_LEVELS - 1 && ( ( m_currentTick >> ( TIMER_WHEEL_SLOT_BITS * ( wrappedLevels + 1 ) ) ) << ( TIMER_WHEEL_SLOT_BITS * ( wrappedLevels + 1 ) ) ) == m_currentTick )
+	{
+		++wrappedLevels;
+	}
+	for( int level = wrappedLevels; level > 0; --level )
+	{
+		Cascade( level, (int) ( ( m_currentTick >> ( TIMER_WHEEL_SLOT_BITS * level ) ) & ( TIMER_WHEEL_SLOTS - 1 ) ) );
+	}
+
+	int slotList = (int) ( m_currentTick & ( TIMER_WHEEL_SLOTS - 1 ) );
+	m_listHeads[FIRING_LIST] = m_listHeads[slotList];
+	m_listHeads[slotList] = INVALID_TIMER_INDEX;
+	for( uint32_t timerIndex = m_listHeads[FIRING_LIST]; timerIndex != INVALID_TIMER_INDEX; timerIndex = m_timers[timerIndex].next )
+	{
+		m_timers[timerIndex].listIndex = FIRING_LIST;
+	}
+
+	while( m_listHeads[FIRING_LIST] != INVALID_TIMER_INDEX )
+	{
+		uint32_t timerIndex = m_listHeads[FIRING_LIST];
+		Unlink( timerIndex );
+
+		Timer& timer = m_timers[timerIndex];
+		TimerCallback callback = timer.callback;
+		void* userData = timer.userData;
+		m_firingEventName.swap( timer.eventName );
+		if( timer.periodTicks > 0 )
+		{
+			timer.dueTick = m_currentTick + timer.periodTicks;
+			timer.eventName = m_firingEventName;
+			Insert( timerIndex );
+		}
+		else
+		{
+			Free( timerIndex );
+		}
+
+		++m_firedLastAdvance;
+		if( callback != nullptr )
+		{
+			callback( userData );
+		}
+		if( !m_firingEventName.empty() )
+		{
+			g_theEventSystem->FireEvent( m_firingEventName );
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetTimer
+* Null for invalid or stale handles.
+*/
+const TimerWheel::Timer* TimerWheel::GetTimer( const TimerHandle& handle ) const
+{
+	if( handle.index >= (uint32_t) m_timers.size() )
+	{
+		return nullptr;
+	}
+	const Timer& timer = m_timers[handle.index];
+	if( timer.generation != handle.generation || timer.listIndex < 0 )
+	{
+		return nullptr;
+	}
+	return &timer;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//--------------------------------------------------------------------------
+// Timers are owned by the wheel and referred to by handle. A handle goes
+// stale once its timer fires (one shot) or is cancelled.
+//--------------------------------------------------------------------------
+constexpr uint32_t INVALID_TIMER_INDEX = 0xFFFFFFFFu;
+
+struct TimerHandle
+{
+	uint32_t index = INVALID_TIMER_INDEX;
+	uint32_t generation = 0;
+
+	bool IsValid() const { return index != INVALID_TIMER_INDEX; }
+};
+
+typedef void (*TimerCallback)( void* userData );
+
+constexpr int TIMER_WHEEL_LEVELS = 4;
+constexpr int TIMER_WHEEL_SLOT_BITS = 6;
+constexpr int TIMER_WHEEL_SLOTS = 1 << TIMER_WHEEL_SLOT_BITS;
+constexpr uint64_t TIMER_WHEEL_MAX_DELTA_TICKS = ( 1ull << ( TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS ) ) - 1;
+
+//--------------------------------------------------------------------------
+// Hierarchical timing wheel. Time moves in whole ticks; level 0 has one
+// slot per tick, each level above has slots 64 times coarser. A timer sits
+// in the slot for its due tick at the coarsest level that still resolves
+// it, and drops a level each time the wheel below wraps. Scheduling and
+// cancelling are O(1) and advancing only touches the slots it passes, so
+// timers that aren't due cost nothing.
+//
+// Game advances it from the fixed simulation tick, which is how it
+// follows the game clock's pause and dilation. Delays past about 77 hours
+// of 60Hz ticks are re-cascaded until they fit.
+//--------------------------------------------------------------------------
+class TimerWheel
+{
+public:
+	explicit TimerWheel( float tickSeconds );
+	~TimerWheel();
+
+	TimerHandle Schedule( float delaySeconds, TimerCallback callback, void* userData, float repeatSeconds = 0.0f );
+	TimerHandle ScheduleEvent( float delaySeconds, const std::string& eventName, float repeatSeconds = 0.0f );
+	bool Cancel( TimerHandle& handle );
+
+	bool IsPending( const TimerHandle& handle ) const;
+	float GetSecondsRemaining( const TimerHandle& handle ) const;
+
+	void Advance( float deltaSeconds );
+
+	float GetTickSeconds() const { return m_tickSeconds; }
+	uint64_t GetCurrentTick() const { return m_currentTick; }
+	int GetPendingCount() const { return m_pendingCount; }
+	int GetFiredLastAdvance() const { return m_firedLastAdvance; }
+
+private:
+	struct Timer
+	{
+		uint64_t dueTick = 0;
+		uint64_t periodTicks = 0;
+		TimerCallback callback = nullptr;
+		void* userData = nullptr;
+		std::string eventName;
+		uint32_t generation = 0;
+		uint32_t prev = INVALID_TIMER_INDEX;
+		uint32_t next = INVALID_TIMER_INDEX;
+		int listIndex = -1;		// Slot list the timer is linked into, -1 when free.
+	};
+
+	TimerHandle Allocate( float delaySeconds, float repeatSeconds );
+	uint64_t SecondsToTicks( float seconds ) const;
+	void Free( uint32_t timerIndex );
+	void Insert( uint32_t timerIndex );
+	void Link( uint32_t timerIndex, int listIndex );
+	void Unlink( uint32_t timerIndex );
+	void Cascade( int level, int slot );
+	void StepTick();
+	const Timer* GetTimer( const TimerHandle& handle ) const;
+
+private:
+	static constexpr int FIRING_LIST = TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS;
+	static constexpr int NUM_LISTS = FIRING_LIST + 1;
+
+	float m_tickSeconds = 1.0f / 60.0f;
+	double m_accumulatedSeconds = 0.0;
+	uint64_t m_currentTick = 0;
+
+	std::vector<Timer> m_timers;
+	std::vector<uint32_t> m_freeTimers;
+	uint32_t m_listHeads[NUM_LISTS];
+	int m_pendingCount = 0;
+	int m_firedLastAdvance = 0;
+
+	std::string m_firingEventName;
+};
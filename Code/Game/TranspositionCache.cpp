@@ -0,0 +1,311 @@
+#include "Game/TranspositionCache.hpp"
+
+//--------------------------------------------------------------------------
+/**
+* TranspositionCache
+* The table keeps at least half its slots free so probes stay short.
+*/
+TranspositionCache::TranspositionCache( int capacity )
+{
+	capacity = capacity > 0 ? capacity : 1;
+	m_entries.resize( (size_t) capacity );
+
+	uint32_t slotCount = 2;
+	while( slotCount < (uint32_t) capacity * 2 )
+	{
+		slotCount <<= 1;
+	}
+	m_slots.assign( slotCount, 0 );
+	m_slotMask = slotCount - 1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~TranspositionCache
+*/
+TranspositionCache::~TranspositionCache()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* Find
+* A hit becomes the newest entry.
+*/
+bool TranspositionCache::Find( uint64_t key, BuildEvaluation* out_evaluation )
+{
+	++m_stats.lookups;
+	int slot = FindSlot( key );
+	if( slot < 0 )
+	{
+		return false;
+	}
+
+	++m_stats.hits;
+	int entryIndex = m_slots[slot] - 1;
+	*out_evaluation = m_entries[entryIndex].evaluation;
+	if( entryIndex != m_newest )
+	{
+		Unlink( entryIndex );
+		LinkNewest( entryIndex );
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Insert
+* Overwrites an existing entry for the key, otherwise evicts the oldest
+* once full.
+*/
+void TranspositionCache::Insert( uint64_t key, const BuildEvaluation& evaluation )
+{
+	++m_stats.inserts;
+	int slot = FindSlot( key );
+	if( slot >= 0 )
+	{
+		int entryIndex = m_slots[slot] - 1;
+		m_entries[entryIndex].evaluation = evaluation;
+		if( entryIndex != m_newest )
+		{
+			Unlink( entryIndex );
+			LinkNewest( entryIndex );
+		}
+		return;
+	}
+
+	int entryIndex;
+	if( m_size < (int) m_entries.size() )
+	{
+		entryIndex = m_size++;
+	}
+	else
+	{
+		entryIndex = m_oldest;
+		RemoveSlot( (uint32_t) FindSlot( m_entries[entryIndex].key ) );
+		Unlink( entryIndex );
+		++m_stats.evictions;
+	}
+
+	Entry& entry = m_entries[entryIndex];
+	entry.key = key;
+	entry.evaluation = evaluation;
+	LinkNewest( entryIndex );
+
+	uint32_t newSlot = GetHomeSlot( key );
+	while( m_slots[newSlot] != 0 )
+	{
+		newSlot = ( newSlot + 1 ) & m_slotMask;
+	}
+	m_slots[newSlot] = entryIndex + 1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Clear
+* Stats are kept, ResetStats clears those.
+*/
+void TranspositionCache::Clear()
+{
+	m_slots.assign( m_slots.size(), 0 );
+	m_size = 0;
+	m_newest = -1;
+	m_oldest = -1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* FindSlot
+* -1 if the key isn't cached.
+*/
+int TranspositionCache::FindSlot( uint64_t key ) const
+{
+	uint32_t slot = GetHomeSlot( key );
+	while( m_slots[slot] != 0 )
+	{
+		if( m_entries[m_slots[slot] - 1].key == key )
+		{
+			return (int) slot;
+		}
+		slot = ( slot + 1 ) & m_slotMask;
+	}
+	return -1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* RemoveSlot
+* Pulls later entries of the probe run back into the hole when their home
+* slot allows it, so lookups never need tombstones.
+*/
+void TranspositionCache::RemoveSlot( uint32_t slot )
+{
+	uint32_t hole = slot;
+	uint32_t probe = slot;
+	for( ;; )
+	{
+		probe = ( probe + 1 ) & m_slotMask;
+		if( m_slots[probe] == 0 )
+		{
+			break;
+		}
+		uint32_t home = GetHomeSlot( m_entries[m_slots[probe] - 1].key );
+		if( ( ( probe - home ) & m_slotMask ) >= ( ( probe - hole ) & m_slotMask ) )
+		{
+			m_slots[hole] = m_slots[probe];
+			hole = probe;
+		}
+	}
+	m_slots[hole] = 0;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Unlink
+*/
+void TranspositionCache::Unlink( int entryIndex )
+{
+	Entry& entry = m_entries[entryIndex];
+	if( entry.newer >= 0 )
+	{
+		m_entries[entry.newer].older = entry.older;
+	}
+	else
+	{
+		m_newest = entry.older;
+	}
+	if( entry.older >= 0 )
+	{
+		m_entries[entry.older].newer = entry.newer;
+	}
+	else
+	{
+		m_oldest = entry.newer;
+	}
+	entry.newer = -1;
+	entry.older = -1;
+}
+
+//--------------------------------------------------------------------------
+/**
+* LinkNewest
+*/
+void TranspositionCache::LinkNewest( int entryIndex )
+{
+	Entry& entry = m_entries[entryIndex];
+	entry.newer = -1;
+	entry.older = m_newest;
+	if( m_newest >= 0 )
+	{
+		m_entries[m_newest].newer = entryIndex;
+	}
+	m_newest = entryIndex;
+	if( m_oldest < 0 )
+	{
+		m_oldest = entryIndex;
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* SharedTranspositionCache
+* Shard count is rounded up to a power of two, capacity is split evenly.
+*/
+SharedTranspositionCache::SharedTranspositionCache( int capacity, int shardCount )
+{
+	uint32_t roundedShardCount = 1;
+	while( roundedShardCount < (uint32_t) shardCount )
+	{
+		roundedShardCount <<= 1;
+	}
+	m_shardMask = roundedShardCount - 1;
+
+	int shardCapacity = ( capacity + (int) roundedShardCount - 1 ) / (int) roundedShardCount;
+	m_shards.reserve( roundedShardCount );
+	for( uint32_t shardIdx = 0; shardIdx < roundedShardCount; ++shardIdx )
+	{
+		m_shards.emplace_back( new Shard( shardCapacity ) );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* ~SharedTranspositionCache
+*/
+SharedTranspositionCache::~SharedTranspositionCache()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* Find
+*/
+bool SharedTranspositionCache::Find( uint64_t key, BuildEvaluation* out_evaluation )
+{
+	Shard& shard = GetShard( key );
+	std::lock_guard<std::mutex> lock( shard.mutex );
+	return shard.cache.Find( key, out_evaluation );
+}
+
+//--------------------------------------------------------------------------
+/**
+* Insert
+*/
+void SharedTranspositionCache::Insert( uint64_t key, const BuildEvaluation& evaluation )
+{
+	Shard& shard = GetShard( key );
+	std::lock_guard<std::mutex> lock( shard.mutex );
+	shard.cache.Insert( key, evaluation );
+}
+
+//--------------------------------------------------------------------------
+/**
+* FindOrInsert
+* True if the key was already cached. Otherwise inserts it under the same
+* lock, so of several threads reaching a key at once exactly one gets false.
+*/
+bool SharedTranspositionCache::FindOrInsert( uint64_t key, const BuildEvaluation& evaluation )
+{
+	Shard& shard = GetShard( key );
+	std::lock_guard<std::mutex> lock( shard.mutex );
+	BuildEvaluation cached;
+	if( shard.cache.Find( key, &cached ) )
+	{
+		return true;
+	}
+	shard.cache.Insert( key, evaluation );
+	return false;
+}
+
+//--------------------------------------------------------------------------
+/**
+* Clear
+*/
+void SharedTranspositionCache::Clear()
+{
+	for( std::unique_ptr<Shard>& shard : m_shards )
+	{
+		std::lock_guard<std::mutex> lock( shard->mutex );
+		shard->cache.Clear();
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetStats
+* Summed over the shards.
+*/
+TranspositionCacheStats SharedTranspositionCache::GetStats() const
+{
+	TranspositionCacheStats stats;
+	for( const std::unique_ptr<Shard>& shard : m_shards )
+	{
+		std::lock_guard<std::mutex> lock( shard->mutex );
+		const TranspositionCacheStats& shardStats = shard->cache.GetStats();
+		stats.lookups += shardStats.lookups;
+		stats.hits += shardStats.hits;
+		stats.inserts += shardStats.inserts;
+		stats.evictions += shardStats.evictions;
+	}
+	return stats;
+}
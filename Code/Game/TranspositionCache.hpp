@@ -0,0 +1,101 @@
+#pragma once
+#include "Game/BuildEvaluator.hpp"
+
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct TranspositionCacheStats
+{
+	uint64_t lookups = 0;
+	uint64_t hits = 0;
+	uint64_t inserts = 0;
+	uint64_t evictions = 0;
+
+	double GetHitRate() const { return lookups > 0 ? (double) hits / (double) lookups : 0.0; }
+};
+
+//--------------------------------------------------------------------------
+// Fixed capacity LRU map from a board hash to its BuildEvaluation.
+//
+// Entries live in one array threaded on an intrusive recency list, indexed
+// by an open addressed table (linear probing, backward shift deletion, no
+// tombstones). Nothing allocates after construction. Find, Insert and
+// eviction are O(1).
+//--------------------------------------------------------------------------
+class TranspositionCache
+{
+public:
+	explicit TranspositionCache( int capacity );
+	~TranspositionCache();
+
+	bool Find( uint64_t key, BuildEvaluation* out_evaluation );
+	void Insert( uint64_t key, const BuildEvaluation& evaluation );
+	void Clear();
+
+	int GetSize() const { return m_size; }
+	int GetCapacity() const { return (int) m_entries.size(); }
+	const TranspositionCacheStats& GetStats() const { return m_stats; }
+	void ResetStats() { m_stats = TranspositionCacheStats(); }
+
+private:
+	struct Entry
+	{
+		uint64_t key = 0;
+		BuildEvaluation evaluation;
+		int newer = -1;
+		int older = -1;
+	};
+
+	uint32_t GetHomeSlot( uint64_t key ) const { return (uint32_t) ( key ^ ( key >> 32 ) ) & m_slotMask; }
+	int FindSlot( uint64_t key ) const;
+	void RemoveSlot( uint32_t slot );
+	void Unlink( int entryIndex );
+	void LinkNewest( int entryIndex );
+
+private:
+	std::vector<Entry> m_entries;
+	std::vector<int> m_slots;		// Entry index + 1, 0 when empty.
+	uint32_t m_slotMask = 0;
+	int m_size = 0;
+	int m_newest = -1;
+	int m_oldest = -1;
+
+	TranspositionCacheStats m_stats;
+};
+
+//--------------------------------------------------------------------------
+// TranspositionCache for many threads: keys are spread over shards by their
+// high bits, each shard its own cache behind its own lock, so threads only
+// contend when they hit the same shard at once.
+//--------------------------------------------------------------------------
+class SharedTranspositionCache
+{
+public:
+	SharedTranspositionCache( int capacity, int shardCount );
+	~SharedTranspositionCache();
+
+	bool Find( uint64_t key, BuildEvaluation* out_evaluation );
+	void Insert( uint64_t key, const BuildEvaluation& evaluation );
+	bool FindOrInsert( uint64_t key, const BuildEvaluation& evaluation );
+	void Clear();
+
+	int GetShardCount() const { return (int) m_shards.size(); }
+	TranspositionCacheStats GetStats() const;
+
+private:
+	struct alignas( 64 ) Shard
+	{
+		explicit Shard( int capacity ) : cache( capacity ) {}
+
+		mutable std::mutex mutex;
+		TranspositionCache cache;
+	};
+
+	Shard& GetShard( uint64_t key ) { return *m_shards[(uint32_t) ( key >> 48 ) & m_shardMask]; }
+
+private:
+	std::vector<std::unique_ptr<Shard>> m_shards;
+	uint32_t m_shardMask = 0;
+};
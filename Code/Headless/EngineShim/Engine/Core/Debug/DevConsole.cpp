@@ -0,0 +1,24 @@
+#include "Engine/Core/Debug/DevConsole.hpp"
+
+#include <stdio.h>
+
+DevConsole* g_theConsole = nullptr;
+
+//--------------------------------------------------------------------------
+/**
+* DevConsole
+*/
+DevConsole::DevConsole( const char* fontName )
+{
+	(void) fontName;
+}
+
+//--------------------------------------------------------------------------
+/**
+* PrintString
+*/
+void DevConsole::PrintString( const std::string& text, eConsoleMessageType messageType )
+{
+	FILE* stream = messageType == CONSOLE_INFO ? stdout : stderr;
+	fprintf( stream, "%s\n", text.c_str() );
+}
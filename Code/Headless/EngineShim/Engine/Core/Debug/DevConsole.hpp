@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+
+//--------------------------------------------------------------------------
+// No window to draw in or type into: never opens, consumes no keys, and
+// printed lines go to stdout.
+//--------------------------------------------------------------------------
+class DevConsole
+{
+public:
+	enum eConsoleMessageType
+	{
+		CONSOLE_INFO,
+		CONSOLE_WARNING,
+		CONSOLE_ERROR,
+	};
+
+public:
+	explicit DevConsole( const char* fontName );
+
+	void Startup()		{}
+	void Shutdown()		{}
+	void BeginFrame()	{}
+	void Update()		{}
+	void EndFrame()		{}
+
+	void PrintString( const std::string& text, eConsoleMessageType messageType = CONSOLE_INFO );
+
+	bool HandleKeyPress( unsigned char keyCode )		{ (void) keyCode; return false; }
+	bool HandleCharPress( unsigned char keyCode )		{ (void) keyCode; return false; }
+	bool HandleKeyReleased( unsigned char keyCode )		{ (void) keyCode; return false; }
+	bool HandleESCPress()								{ return false; }
+	bool IsOpen() const									{ return false; }
+};
+
+extern DevConsole* g_theConsole;
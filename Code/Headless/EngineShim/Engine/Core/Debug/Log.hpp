@@ -0,0 +1,5 @@
+#pragma once
+
+// Nothing is logged, headless output goes to stdout.
+inline void LogSystemStartup( const char* logFilePath )		{ (void) logFilePath; }
+inline void LogSystemShutdown()								{}
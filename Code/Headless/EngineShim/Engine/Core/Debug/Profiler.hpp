@@ -0,0 +1,5 @@
+#pragma once
+
+// The game's own GameProfiler covers headless runs.
+inline void ProfilerSystemInit()		{}
+inline void ProfilerSystemDeinit()		{}
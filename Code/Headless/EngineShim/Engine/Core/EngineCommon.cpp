@@ -0,0 +1,37 @@
+#include "Engine/Core/EngineCommon.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+NamedStrings g_gameConfigBlackboard;
+
+//--------------------------------------------------------------------------
+/**
+* FatalError
+* No message box without a window, stderr and abort.
+*/
+void FatalError( const char* filePath, int lineNum, const std::string& reasonForError, const char* conditionText )
+{
+	fprintf( stderr, "%s(%d): FATAL: %s", filePath, lineNum, reasonForError.c_str() );
+	if( conditionText )
+	{
+		fprintf( stderr, " (%s)", conditionText );
+	}
+	fprintf( stderr, "\n" );
+	fflush( stderr );
+	abort();
+}
+
+//--------------------------------------------------------------------------
+/**
+* RecoverableWarning
+*/
+void RecoverableWarning( const char* filePath, int lineNum, const std::string& reasonForWarning, const char* conditionText )
+{
+	fprintf( stderr, "%s(%d): WARNING: %s", filePath, lineNum, reasonForWarning.c_str() );
+	if( conditionText )
+	{
+		fprintf( stderr, " (%s)", conditionText );
+	}
+	fprintf( stderr, "\n" );
+}
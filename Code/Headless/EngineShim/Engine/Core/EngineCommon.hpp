@@ -0,0 +1,25 @@
+#pragma once
+//--------------------------------------------------------------------------
+// Engine core shim for the Linux headless build (CMakeLists.txt at the repo
+// root). The Engine submodule only builds on Windows with D3D11, so this
+// directory stands in for the part of it the GAME_HEADLESS sources include:
+// the same header paths, class names and signatures, and nothing else.
+// Keep it in step with the engine when game code starts using more of it.
+//--------------------------------------------------------------------------
+#include "Engine/Core/Strings/NamedStrings.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+#include <string>
+
+#define UNUSED(x) (void)(x)
+#define SAFE_DELETE(pointer) { delete (pointer); (pointer) = nullptr; }
+
+#define ERROR_AND_DIE( errorMessageText )							FatalError( __FILE__, __LINE__, errorMessageText )
+#define ASSERT_OR_DIE( condition, errorMessageText )				{ if( !(condition) ) { FatalError( __FILE__, __LINE__, errorMessageText, #condition ); } }
+#define ERROR_RECOVERABLE( errorMessageText )						RecoverableWarning( __FILE__, __LINE__, errorMessageText )
+#define ASSERT_RECOVERABLE( condition, errorMessageText )			{ if( !(condition) ) { RecoverableWarning( __FILE__, __LINE__, errorMessageText, #condition ); } }
+
+[[noreturn]] void FatalError( const char* filePath, int lineNum, const std::string& reasonForError, const char* conditionText = nullptr );
+void RecoverableWarning( const char* filePath, int lineNum, const std::string& reasonForWarning, const char* conditionText = nullptr );
+
+extern NamedStrings g_gameConfigBlackboard;
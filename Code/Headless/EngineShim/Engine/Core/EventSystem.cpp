@@ -0,0 +1,64 @@
+#include "Engine/Core/EventSystem.hpp"
+
+EventSystem* g_theEventSystem = nullptr;
+
+//--------------------------------------------------------------------------
+/**
+* SubscribeEventCallbackFunction
+*/
+void EventSystem::SubscribeEventCallbackFunction( const std::string& eventName, EventCallbackFunction callback )
+{
+	EventSubscription subscription;
+	subscription.eventName = eventName;
+	subscription.callback = callback;
+	m_subscriptions.push_back( subscription );
+}
+
+//--------------------------------------------------------------------------
+/**
+* UnsubscribeEventCallbackFunction
+*/
+void EventSystem::UnsubscribeEventCallbackFunction( const std::string& eventName, EventCallbackFunction callback )
+{
+	for( size_t subIdx = 0; subIdx < m_subscriptions.size(); ++subIdx )
+	{
+		if( m_subscriptions[subIdx].eventName == eventName && m_subscriptions[subIdx].callback == callback )
+		{
+			m_subscriptions.erase( m_subscriptions.begin() + subIdx );
+			return;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* FireEvent
+*/
+int EventSystem::FireEvent( const std::string& eventName )
+{
+	EventArgs args;
+	return FireEvent( eventName, args );
+}
+
+//--------------------------------------------------------------------------
+/**
+* FireEvent
+* Calls subscribers in order until one consumes the event, returns how many ran.
+*/
+int EventSystem::FireEvent( const std::string& eventName, EventArgs& args )
+{
+	int numCalled = 0;
+	for( size_t subIdx = 0; subIdx < m_subscriptions.size(); ++subIdx )
+	{
+		if( m_subscriptions[subIdx].eventName != eventName )
+		{
+			continue;
+		}
+		++numCalled;
+		if( m_subscriptions[subIdx].callback( args ) )
+		{
+			break;
+		}
+	}
+	return numCalled;
+}
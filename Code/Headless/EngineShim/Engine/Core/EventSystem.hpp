@@ -0,0 +1,33 @@
+#pragma once
+#include "Engine/Core/Strings/NamedStrings.hpp"
+
+#include <string>
+#include <vector>
+
+typedef NamedStrings EventArgs;
+typedef bool (*EventCallbackFunction)( EventArgs& args );
+
+//--------------------------------------------------------------------------
+class EventSystem
+{
+public:
+	void Startup()		{}
+	void Shutdown()		{}
+	void BeginFrame()	{}
+	void EndFrame()		{}
+
+	void SubscribeEventCallbackFunction( const std::string& eventName, EventCallbackFunction callback );
+	void UnsubscribeEventCallbackFunction( const std::string& eventName, EventCallbackFunction callback );
+	int FireEvent( const std::string& eventName );
+	int FireEvent( const std::string& eventName, EventArgs& args );
+
+private:
+	struct EventSubscription
+	{
+		std::string eventName;
+		EventCallbackFunction callback = nullptr;
+	};
+	std::vector<EventSubscription> m_subscriptions;
+};
+
+extern EventSystem* g_theEventSystem;
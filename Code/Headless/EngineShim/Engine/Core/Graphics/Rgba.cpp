@@ -0,0 +1,4 @@
+#include "Engine/Core/Graphics/Rgba.hpp"
+
+const Rgba Rgba::WHITE( 1.0f, 1.0f, 1.0f, 1.0f );
+const Rgba Rgba::BLACK( 0.0f, 0.0f, 0.0f, 1.0f );
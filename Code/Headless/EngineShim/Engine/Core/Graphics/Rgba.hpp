@@ -0,0 +1,19 @@
+#pragma once
+
+//--------------------------------------------------------------------------
+struct Rgba
+{
+public:
+	Rgba() {}
+	Rgba( float initialR, float initialG, float initialB, float initialA = 1.0f )
+		: r( initialR ), g( initialG ), b( initialB ), a( initialA ) {}
+
+public:
+	float r = 1.0f;
+	float g = 1.0f;
+	float b = 1.0f;
+	float a = 1.0f;
+
+	static const Rgba WHITE;
+	static const Rgba BLACK;
+};
@@ -0,0 +1,97 @@
+#include "Engine/Core/Strings/NamedStrings.hpp"
+
+#include <stdlib.h>
+
+//--------------------------------------------------------------------------
+/**
+* PopulateFromXmlElementAttributes
+*/
+void NamedStrings::PopulateFromXmlElementAttributes( const XmlElement& element )
+{
+	for( const tinyxml2::XMLAttribute* attribute = element.FirstAttribute(); attribute != nullptr; attribute = attribute->Next() )
+	{
+		SetValue( attribute->Name(), attribute->Value() );
+	}
+}
+
+//--------------------------------------------------------------------------
+/**
+* SetValue
+*/
+void NamedStrings::SetValue( const std::string& keyName, const std::string& newValue )
+{
+	m_keyValuePairs[keyName] = newValue;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetValue
+*/
+std::string NamedStrings::GetValue( const std::string& keyName, const char* defaultValue ) const
+{
+	return GetValue( keyName, std::string( defaultValue ) );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetValue
+*/
+std::string NamedStrings::GetValue( const std::string& keyName, const std::string& defaultValue ) const
+{
+	std::map<std::string, std::string>::const_iterator found = m_keyValuePairs.find( keyName );
+	if( found == m_keyValuePairs.end() )
+	{
+		return defaultValue;
+	}
+	return found->second;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetValue
+*/
+bool NamedStrings::GetValue( const std::string& keyName, bool defaultValue ) const
+{
+	std::map<std::string, std::string>::const_iterator found = m_keyValuePairs.find( keyName );
+	if( found == m_keyValuePairs.end() )
+	{
+		return defaultValue;
+	}
+	if( found->second == "true" || found->second == "1" )
+	{
+		return true;
+	}
+	if( found->second == "false" || found->second == "0" )
+	{
+		return false;
+	}
+	return defaultValue;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetValue
+*/
+int NamedStrings::GetValue( const std::string& keyName, int defaultValue ) const
+{
+	std::map<std::string, std::string>::const_iterator found = m_keyValuePairs.find( keyName );
+	if( found == m_keyValuePairs.end() )
+	{
+		return defaultValue;
+	}
+	return atoi( found->second.c_str() );
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetValue
+*/
+float NamedStrings::GetValue( const std::string& keyName, float defaultValue ) const
+{
+	std::map<std::string, std::string>::const_iterator found = m_keyValuePairs.find( keyName );
+	if( found == m_keyValuePairs.end() )
+	{
+		return defaultValue;
+	}
+	return (float) atof( found->second.c_str() );
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "Engine/Core/XML/XMLUtils.hpp"
+
+#include <map>
+#include <string>
+
+//--------------------------------------------------------------------------
+class NamedStrings
+{
+public:
+	void PopulateFromXmlElementAttributes( const XmlElement& element );
+	void SetValue( const std::string& keyName, const std::string& newValue );
+
+	std::string GetValue( const std::string& keyName, const char* defaultValue ) const;
+	std::string GetValue( const std::string& keyName, const std::string& defaultValue ) const;
+	bool GetValue( const std::string& keyName, bool defaultValue ) const;
+	int GetValue( const std::string& keyName, int defaultValue ) const;
+	float GetValue( const std::string& keyName, float defaultValue ) const;
+
+private:
+	std::map<std::string, std::string> m_keyValuePairs;
+};
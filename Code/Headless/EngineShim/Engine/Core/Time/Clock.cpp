@@ -0,0 +1,68 @@
+#include "Engine/Core/Time/Clock.hpp"
+
+#include <chrono>
+
+Clock Clock::Master;
+
+static std::chrono::steady_clock::time_point s_lastFrameTime;
+
+//--------------------------------------------------------------------------
+/**
+* Clock
+*/
+Clock::Clock()
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* Clock
+*/
+Clock::Clock( Clock* parent )
+	: m_parent( parent )
+{
+}
+
+//--------------------------------------------------------------------------
+/**
+* Step
+*/
+void Clock::Step( double deltaSeconds )
+{
+	m_frameTime = deltaSeconds;
+}
+
+//--------------------------------------------------------------------------
+/**
+* GetFrameTime
+*/
+double Clock::GetFrameTime() const
+{
+	if( m_isPaused )
+	{
+		return 0.0;
+	}
+	double frameTime = m_parent ? m_parent->GetFrameTime() : m_frameTime;
+	return frameTime * m_dilation;
+}
+
+//--------------------------------------------------------------------------
+/**
+* ClockSystemStartup
+*/
+void ClockSystemStartup()
+{
+	s_lastFrameTime = std::chrono::steady_clock::now();
+	Clock::Master.Step( 0.0 );
+}
+
+//--------------------------------------------------------------------------
+/**
+* ClockSystemBeginFrame
+*/
+void ClockSystemBeginFrame()
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	Clock::Master.Step( std::chrono::duration<double>( now - s_lastFrameTime ).count() );
+	s_lastFrameTime = now;
+}
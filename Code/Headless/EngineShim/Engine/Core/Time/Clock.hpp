@@ -0,0 +1,33 @@
+#pragma once
+
+//--------------------------------------------------------------------------
+// Master steps once per ClockSystemBeginFrame with the wall clock time since
+// the last step. Child clocks see their parent's frame time, dilated, or
+// zero while paused.
+//--------------------------------------------------------------------------
+class Clock
+{
+public:
+	Clock();
+	explicit Clock( Clock* parent );
+
+	void Step( double deltaSeconds );
+	void Dilate( float scale )			{ m_dilation = scale; }
+	void Pause()						{ m_isPaused = true; }
+	void Resume()						{ m_isPaused = false; }
+	bool IsPaused() const				{ return m_isPaused; }
+
+	double GetFrameTime() const;
+
+public:
+	static Clock Master;
+
+private:
+	Clock* m_parent = nullptr;
+	double m_frameTime = 0.0;
+	float m_dilation = 1.0f;
+	bool m_isPaused = false;
+};
+
+void ClockSystemStartup();
+void ClockSystemBeginFrame();
@@ -0,0 +1,18 @@
+#pragma once
+#include "Engine/Core/Graphics/Rgba.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+//--------------------------------------------------------------------------
+struct Vertex_PCU
+{
+public:
+	Vertex_PCU() {}
+	Vertex_PCU( const Vec3& initialPosition, const Rgba& initialColor, const Vec2& initialUVTexCoords )
+		: position( initialPosition ), color( initialColor ), uvTexCoords( initialUVTexCoords ) {}
+
+public:
+	Vec3 position;
+	Rgba color;
+	Vec2 uvTexCoords;
+};
@@ -0,0 +1,387 @@
+#include "Engine/Core/XML/XMLUtils.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace tinyxml2
+{
+	//--------------------------------------------------------------------------
+	static bool IsWhitespace( char c )
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	//--------------------------------------------------------------------------
+	static void SkipWhitespace( const char*& cursor, const char* end )
+	{
+		while( cursor < end && IsWhitespace( *cursor ) )
+		{
+			++cursor;
+		}
+	}
+
+	//--------------------------------------------------------------------------
+	static bool StartsWith( const char* cursor, const char* end, const char* prefix )
+	{
+		size_t prefixLength = strlen( prefix );
+		return (size_t) ( end - cursor ) >= prefixLength && memcmp( cursor, prefix, prefixLength ) == 0;
+	}
+
+	//--------------------------------------------------------------------------
+	// Moves past the next occurrence of terminator, false if there isn't one.
+	static bool SkipPast( const char*& cursor, const char* end, const char* terminator )
+	{
+		size_t terminatorLength = strlen( terminator );
+		for( ; cursor + terminatorLength <= end; ++cursor )
+		{
+			if( memcmp( cursor, terminator, terminatorLength ) == 0 )
+			{
+				cursor += terminatorLength;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//--------------------------------------------------------------------------
+	// Whitespace, declarations, comments and doctypes between elements.
+	static bool SkipMisc( const char*& cursor, const char* end )
+	{
+		for( ;; )
+		{
+			SkipWhitespace( cursor, end );
+			if( StartsWith( cursor, end, "<?" ) )
+			{
+				if( !SkipPast( cursor, end, "?>" ) )
+				{
+					return false;
+				}
+			}
+			else if( StartsWith( cursor, end, "<!--" ) )
+			{
+				if( !SkipPast( cursor, end, "-->" ) )
+				{
+					return false;
+				}
+			}
+			else if( StartsWith( cursor, end, "<!" ) )
+			{
+				if( !SkipPast( cursor, end, ">" ) )
+				{
+					return false;
+				}
+			}
+			else
+			{
+				return true;
+			}
+		}
+	}
+
+	//--------------------------------------------------------------------------
+	static std::string ReadName( const char*& cursor, const char* end )
+	{
+		const char* nameStart = cursor;
+		while( cursor < end && !IsWhitespace( *cursor ) && strchr( "/>=<", *cursor ) == nullptr )
+		{
+			++cursor;
+		}
+		return std::string( nameStart, cursor );
+	}
+
+	//--------------------------------------------------------------------------
+	static std::string DecodeEntities( const char* begin, const char* end )
+	{
+		static const char* const s_entities[][2] = { { "&amp;", "&" }, { "&lt;", "<" }, { "&gt;", ">" }, { "&quot;", "\"" }, { "&apos;", "'" } };
+
+		std::string decoded;
+		decoded.reserve( end - begin );
+		while( begin < end )
+		{
+			bool isEntity = false;
+			if( *begin == '&' )
+			{
+				for( const auto& entity : s_entities )
+				{
+					if( StartsWith( begin, end, entity[0] ) )
+					{
+						decoded += entity[1];
+						begin += strlen( entity[0] );
+						isEntity = true;
+						break;
+					}
+				}
+			}
+			if( !isEntity )
+			{
+				decoded += *begin;
+				++begin;
+			}
+		}
+		return decoded;
+	}
+
+	//--------------------------------------------------------------------------
+	/**
+	* Attribute
+	*/
+	const char* XMLElement::Attribute( const char* name ) const
+	{
+		for( const XMLAttribute& attribute : m_attributes )
+		{
+			if( strcmp( attribute.Name(), name ) == 0 )
+			{
+				return attribute.Value();
+			}
+		}
+		return nullptr;
+	}
+
+	//--------------------------------------------------------------------------
+	/**
+	* FirstChildElement
+	*/
+	const XMLElement* XMLElement::FirstChildElement( const char* name ) const
+	{
+		for( const XMLElement* child = m_firstChild; child != nullptr; child = child->m_nextSibling )
+		{
+			if( name == nullptr || child->m_name == name )
+			{
+				return child;
+			}
+		}
+		return nullptr;
+	}
+
+	//--------------------------------------------------------------------------
+	/**
+	* NextSiblingElement
+	*/
+	const XMLElement* XMLElement::NextSiblingElement( const char* name ) const
+	{
+		for( const XMLElement* sibling = m_nextSibling; sibling != nullptr; sibling = sibling->m_nextSibling )
+		{
+			if( name == nullptr || sibling->m_name == name )
+			{
+				return sibling;
+			}
+		}
+		return nullptr;
+	}
+
+	//--------------------------------------------------------------------------
+	/**
+	* FirstChildElement
+	*/
+	XMLElement* XMLElement::FirstChildElement( const char* name )
+	{
+		return const_cast<XMLElement*>( static_cast<const XMLElement*>( this )->FirstChildElement( name ) );
+	}
+
+	//--------------------------------------------------------------------------
+	/**
+	* NextSiblingElement
+	*/
+	XMLElement* XMLElement::NextSiblingElement( const char* name )
+	{
+		return const_cast<XMLElement*>( static_cast<const XMLElement*>( this )->NextSiblingElement( name ) );
+	}
+
+	//--------------------------------------------------------------------------
+	/**
+	* LoadFile
+	*/
+	XMLError XMLDocument::LoadFile( const char* filePath )
+	{
+		FILE* file = fopen( filePath, "rb" );
+		if( file == nullptr )
+		{
+			return XML_ERROR_FILE_NOT_FOUND;
+		}
+
+		std::string text;
+		char buffer[4096];
+		size_t numRead = 0;
+		while( ( numRead = fread( buffer, 1, sizeof( buffer ), file ) ) > 0 )
+		{
+			text.append( buffer, numRead );
+		}
+		fclose( file );
+
+		return Parse( text.data(), text.size() );
+	}
+
+	//--------------------------------------------------------------------------
+	/**
+	* Parse
+	*/
+	XMLError XMLDocument::Parse( const char* text, size_t length )
+	{
+		m_elements.clear();
+		m_root = nullptr;
+
+		const char* cursor = text;
+		const char* end = text + length;
+		if( StartsWith( cursor, end, "\xEF\xBB\xBF" ) )
+		{
+			cursor += 3;
+		}
+
+		if( !SkipMisc( cursor, end ) || cursor >= end || *cursor != '<' || !ParseElement( cursor, end, &m_root ) || !SkipMisc( cursor, end ) || cursor != end )
+		{
+			m_elements.clear();
+			m_root = nullptr;
+			return XML_ERROR_PARSING;
+		}
+		return XML_SUCCESS;
+	}
+
+	//--------------------------------------------------------------------------
+	/**
+	* NewElement
+	*/
+	XMLElement* XMLDocument::NewElement()
+	{
+		m_elements.emplace_back( new XMLElement() );
+		return m_elements.back().get();
+	}
+
+	//--------------------------------------------------------------------------
+	/**
+	* ParseElement
+	* cursor is on the element's '<' and ends up just past its close.
+	*/
+	bool XMLDocument::ParseElement( const char*& cursor, const char* end, XMLElement** out_element )
+	{
+		XMLElement* element = NewElement();
+		*out_element = element;
+
+		++cursor;
+		element->m_name = ReadName( cursor, end );
+		if( element->m_name.empty() )
+		{
+			return false;
+		}
+
+		// Attributes
+		bool isClosed = false;
+		for( ;; )
+		{
+			SkipWhitespace( cursor, end );
+			if( cursor >= end )
+			{
+				return false;
+			}
+			if( *cursor == '/' )
+			{
+				if( !StartsWith( cursor, end, "/>" ) )
+				{
+					return false;
+				}
+				cursor += 2;
+				isClosed = true;
+				break;
+			}
+			if( *cursor == '>' )
+			{
+				++cursor;
+				break;
+			}
+
+			XMLAttribute attribute;
+			attribute.m_name = ReadName( cursor, end );
+			SkipWhitespace( cursor, end );
+			if( attribute.m_name.empty() || cursor >= end || *cursor != '=' )
+			{
+				return false;
+			}
+			++cursor;
+			SkipWhitespace( cursor, end );
+			if( cursor >= end || ( *cursor != '"' && *cursor != '\'' ) )
+			{
+				return false;
+			}
+			const char* valueStart = cursor + 1;
+			const char* valueEnd = (const char*) memchr( valueStart, *cursor, end - valueStart );
+			if( valueEnd == nullptr )
+			{
+				return false;
+			}
+			attribute.m_value = DecodeEntities( valueStart, valueEnd );
+			element->m_attributes.push_back( attribute );
+			cursor = valueEnd + 1;
+		}
+		for( size_t attributeIdx = 0; attributeIdx + 1 < element->m_attributes.size(); ++attributeIdx )
+		{
+			element->m_attributes[attributeIdx].m_next = &element->m_attributes[attributeIdx + 1];
+		}
+		if( isClosed )
+		{
+			return true;
+		}
+
+		// Content: text, comments and child elements up to the closing tag.
+		XMLElement* lastChild = nullptr;
+		for( ;; )
+		{
+			if( cursor >= end )
+			{
+				return false;
+			}
+			if( StartsWith( cursor, end, "<!--" ) )
+			{
+				if( !SkipPast( cursor, end, "-->" ) )
+				{
+					return false;
+				}
+			}
+			else if( StartsWith( cursor, end, "</" ) )
+			{
+				cursor += 2;
+				std::string closingName = ReadName( cursor, end );
+				SkipWhitespace( cursor, end );
+				if( closingName != element->m_name || cursor >= end || *cursor != '>' )
+				{
+					return false;
+				}
+				++cursor;
+				return true;
+			}
+			else if( *cursor == '<' )
+			{
+				XMLElement* child = nullptr;
+				if( !ParseElement( cursor, end, &child ) )
+				{
+					return false;
+				}
+				if( lastChild == nullptr )
+				{
+					element->m_firstChild = child;
+				}
+				else
+				{
+					lastChild->m_nextSibling = child;
+				}
+				lastChild = child;
+			}
+			else
+			{
+				const char* textStart = cursor;
+				const char* textEnd = (const char*) memchr( textStart, '<', end - textStart );
+				if( textEnd == nullptr )
+				{
+					return false;
+				}
+				cursor = textEnd;
+
+				// Like tinyxml2, text only counts before the first child and whitespace alone isn't text.
+				const char* nonWhitespace = textStart;
+				SkipWhitespace( nonWhitespace, textEnd );
+				if( lastChild == nullptr && nonWhitespace < textEnd )
+				{
+					element->m_text += DecodeEntities( textStart, textEnd );
+				}
+			}
+		}
+	}
+}
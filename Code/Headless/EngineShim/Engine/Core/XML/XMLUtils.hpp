@@ -0,0 +1,82 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+//--------------------------------------------------------------------------
+// The part of tinyxml2 the game reads config and dialogue with: load a file,
+// walk elements by name, read attributes and text. Elements, attributes,
+// comments, declarations and the five predefined entities; no DTDs, CDATA
+// or numeric character references.
+//--------------------------------------------------------------------------
+namespace tinyxml2
+{
+	enum XMLError
+	{
+		XML_SUCCESS = 0,
+		XML_ERROR_FILE_NOT_FOUND,
+		XML_ERROR_PARSING,
+	};
+
+	//--------------------------------------------------------------------------
+	class XMLAttribute
+	{
+		friend class XMLDocument;
+
+	public:
+		const char* Name() const				{ return m_name.c_str(); }
+		const char* Value() const				{ return m_value.c_str(); }
+		const XMLAttribute* Next() const		{ return m_next; }
+
+	private:
+		std::string m_name;
+		std::string m_value;
+		const XMLAttribute* m_next = nullptr;
+	};
+
+	//--------------------------------------------------------------------------
+	class XMLElement
+	{
+		friend class XMLDocument;
+
+	public:
+		const char* Name() const				{ return m_name.c_str(); }
+		const char* GetText() const				{ return m_text.empty() ? nullptr : m_text.c_str(); }
+		const char* Attribute( const char* name ) const;
+		const XMLAttribute* FirstAttribute() const	{ return m_attributes.empty() ? nullptr : &m_attributes[0]; }
+
+		const XMLElement* FirstChildElement( const char* name = nullptr ) const;
+		const XMLElement* NextSiblingElement( const char* name = nullptr ) const;
+		XMLElement* FirstChildElement( const char* name = nullptr );
+		XMLElement* NextSiblingElement( const char* name = nullptr );
+
+	private:
+		std::string m_name;
+		std::string m_text;
+		std::vector<XMLAttribute> m_attributes;
+		XMLElement* m_firstChild = nullptr;
+		XMLElement* m_nextSibling = nullptr;
+	};
+
+	//--------------------------------------------------------------------------
+	class XMLDocument
+	{
+	public:
+		XMLError LoadFile( const char* filePath );
+		XMLError Parse( const char* text, size_t length );
+
+		const XMLElement* RootElement() const	{ return m_root; }
+		XMLElement* RootElement()				{ return m_root; }
+
+	private:
+		XMLElement* NewElement();
+		bool ParseElement( const char*& cursor, const char* end, XMLElement** out_element );
+
+	private:
+		std::vector<std::unique_ptr<XMLElement>> m_elements;
+		XMLElement* m_root = nullptr;
+	};
+}
+
+typedef tinyxml2::XMLElement XmlElement;
+typedef tinyxml2::XMLAttribute XmlAttribute;
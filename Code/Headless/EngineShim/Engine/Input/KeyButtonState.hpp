@@ -0,0 +1,15 @@
+#pragma once
+
+//--------------------------------------------------------------------------
+class KeyButtonState
+{
+public:
+	void UpdateStatus( bool isNowPressed )		{ m_wasPressedLastFrame = m_isPressed; m_isPressed = isNowPressed; }
+	bool IsPressed() const						{ return m_isPressed; }
+	bool WasJustPressed() const					{ return m_isPressed && !m_wasPressedLastFrame; }
+	bool WasJustReleased() const				{ return !m_isPressed && m_wasPressedLastFrame; }
+
+private:
+	bool m_isPressed = false;
+	bool m_wasPressedLastFrame = false;
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+
+//--------------------------------------------------------------------------
+struct AABB2
+{
+public:
+	AABB2() {}
+	AABB2( const Vec2& initialMins, const Vec2& initialMaxs ) : mins( initialMins ), maxs( initialMaxs ) {}
+
+	bool IsPointInside( const Vec2& point ) const	{ return point.x >= mins.x && point.x <= maxs.x && point.y >= mins.y && point.y <= maxs.y; }
+
+public:
+	Vec2 mins;
+	Vec2 maxs;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+//--------------------------------------------------------------------------
+struct IntVec2
+{
+public:
+	IntVec2() {}
+	IntVec2( int initialX, int initialY ) : x( initialX ), y( initialY ) {}
+
+	const IntVec2 operator+( const IntVec2& vecToAdd ) const		{ return IntVec2( x + vecToAdd.x, y + vecToAdd.y ); }
+	const IntVec2 operator-( const IntVec2& vecToSubtract ) const	{ return IntVec2( x - vecToSubtract.x, y - vecToSubtract.y ); }
+	bool operator==( const IntVec2& compare ) const					{ return x == compare.x && y == compare.y; }
+	bool operator!=( const IntVec2& compare ) const					{ return !( *this == compare ); }
+
+public:
+	int x = 0;
+	int y = 0;
+
+	static const IntVec2 ZERO;
+};
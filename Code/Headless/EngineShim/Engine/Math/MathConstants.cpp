@@ -0,0 +1,7 @@
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Matrix44.hpp"
+#include "Engine/Math/Vec2.hpp"
+
+const Vec2 Vec2::ZERO( 0.0f, 0.0f );
+const IntVec2 IntVec2::ZERO( 0, 0 );
+const Matrix44 Matrix44::IDENTITY;
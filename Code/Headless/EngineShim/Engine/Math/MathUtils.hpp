@@ -0,0 +1,15 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+
+#include <math.h>
+
+//--------------------------------------------------------------------------
+inline float ConvertDegreesToRadians( float degrees )		{ return degrees * ( 3.1415926535897932384626433832795f / 180.0f ); }
+inline float CosDegrees( float degrees )					{ return cosf( ConvertDegreesToRadians( degrees ) ); }
+inline float SinDegrees( float degrees )					{ return sinf( ConvertDegreesToRadians( degrees ) ); }
+inline float GetDistance( const Vec2& positionA, const Vec2& positionB )
+{
+	float deltaX = positionB.x - positionA.x;
+	float deltaY = positionB.y - positionA.y;
+	return sqrtf( deltaX * deltaX + deltaY * deltaY );
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+//--------------------------------------------------------------------------
+// Column major, basis vectors I, J, K and translation T.
+struct Matrix44
+{
+public:
+	float Ix = 1.0f;	float Iy = 0.0f;	float Iz = 0.0f;	float Iw = 0.0f;
+	float Jx = 0.0f;	float Jy = 1.0f;	float Jz = 0.0f;	float Jw = 0.0f;
+	float Kx = 0.0f;	float Ky = 0.0f;	float Kz = 1.0f;	float Kw = 0.0f;
+	float Tx = 0.0f;	float Ty = 0.0f;	float Tz = 0.0f;	float Tw = 1.0f;
+
+	static const Matrix44 IDENTITY;
+};
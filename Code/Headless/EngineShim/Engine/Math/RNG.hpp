@@ -0,0 +1,14 @@
+#pragma once
+
+//--------------------------------------------------------------------------
+// Game randomness comes from g_theGameRandom, this only holds the seed.
+class RNG
+{
+public:
+	explicit RNG( unsigned int seed = 0 ) : m_seed( seed ) {}
+
+	unsigned int GetSeed() const		{ return m_seed; }
+
+private:
+	unsigned int m_seed = 0;
+};
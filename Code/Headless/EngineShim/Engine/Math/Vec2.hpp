@@ -0,0 +1,24 @@
+#pragma once
+
+//--------------------------------------------------------------------------
+struct Vec2
+{
+public:
+	Vec2() {}
+	Vec2( float initialX, float initialY ) : x( initialX ), y( initialY ) {}
+
+	const Vec2 operator+( const Vec2& vecToAdd ) const		{ return Vec2( x + vecToAdd.x, y + vecToAdd.y ); }
+	const Vec2 operator-( const Vec2& vecToSubtract ) const	{ return Vec2( x - vecToSubtract.x, y - vecToSubtract.y ); }
+	const Vec2 operator*( float uniformScale ) const		{ return Vec2( x * uniformScale, y * uniformScale ); }
+	void operator+=( const Vec2& vecToAdd )					{ x += vecToAdd.x; y += vecToAdd.y; }
+	void operator-=( const Vec2& vecToSubtract )			{ x -= vecToSubtract.x; y -= vecToSubtract.y; }
+	void operator*=( float uniformScale )					{ x *= uniformScale; y *= uniformScale; }
+	bool operator==( const Vec2& compare ) const			{ return x == compare.x && y == compare.y; }
+	bool operator!=( const Vec2& compare ) const			{ return !( *this == compare ); }
+
+public:
+	float x = 0.0f;
+	float y = 0.0f;
+
+	static const Vec2 ZERO;
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+//--------------------------------------------------------------------------
+struct Vec3
+{
+public:
+	Vec3() {}
+	Vec3( float initialX, float initialY, float initialZ ) : x( initialX ), y( initialY ), z( initialZ ) {}
+
+public:
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+};
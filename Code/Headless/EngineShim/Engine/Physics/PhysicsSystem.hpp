@@ -0,0 +1,10 @@
+#pragma once
+
+//--------------------------------------------------------------------------
+// The game runs its own collision, nothing is simulated here.
+class PhysicsSystem
+{
+public:
+	void Startup()		{}
+	void Shutdown()		{}
+};
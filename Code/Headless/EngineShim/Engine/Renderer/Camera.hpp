@@ -0,0 +1,19 @@
+#pragma once
+#include "Engine/Math/Matrix44.hpp"
+#include "Engine/Math/Vec2.hpp"
+
+//--------------------------------------------------------------------------
+// Just the view bounds and model matrix, there are no render targets.
+class Camera
+{
+public:
+	void SetOrthographicProjection( const Vec2& bottomLeft, const Vec2& topRight )	{ m_orthoBottomLeft = bottomLeft; m_orthoTopRight = topRight; }
+	void SetModelMatrix( const Matrix44& modelMatrix )								{ m_modelMatrix = modelMatrix; }
+	const Vec2& GetOrthoBottomLeft() const											{ return m_orthoBottomLeft; }
+	const Vec2& GetOrthoTopRight() const											{ return m_orthoTopRight; }
+
+private:
+	Vec2 m_orthoBottomLeft;
+	Vec2 m_orthoTopRight;
+	Matrix44 m_modelMatrix;
+};